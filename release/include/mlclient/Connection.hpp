@@ -34,6 +34,33 @@
  * \brief the namespace which wraps all Core Public C++ API classes.
  */
 namespace mlclient {
+/**
+ * \brief Receives a response body in chunks as it is read from the network, rather than as one string
+ *
+ * See IConnection::searchStreamed().
+ *
+ * \since 8.0.3
+ */
+class IResponseBodyHandler {
+public:
+  MLCLIENT_API virtual ~IResponseBodyHandler();
+
+  /**
+   * \brief Called once the response code and headers have been received, before any of the body. Does nothing by default.
+   *
+   * \param response The Response, with its code and headers set, but no content
+   */
+  MLCLIENT_API virtual void onBodyStart(const Response& response);
+
+  /**
+   * \brief Called with each chunk of the body, in order
+   *
+   * \param data The next bytes of the body. Only valid until this function returns.
+   * \param length The number of bytes in data
+   */
+  MLCLIENT_API virtual void onBodyChunk(const char* data,const size_t length) = 0;
+};
+
 /**
  * \author Adam Fowler <adam.fowler@marklogic.com>
  * \since 8.0.0
@@ -266,6 +293,25 @@ public:
    */
   MLCLIENT_API virtual Response* getDocumentPermissions(Document& inout_document) = 0;
 
+  /**
+   * \brief Retrieves the content of a set of documents in a single request
+   *
+   * Performs a GET /v1/documents?uri=...&uri=... HTTP call with an Accept header of multipart/mixed. Use
+   * DocumentHelper::fromMultipartResponse to convert the Response in to Document instances.
+   *
+   * \param uris The set of document URIs to fetch
+   * \param startPosInclusive The first index of the URI in the set to fetch
+   * \param endPosInclusive The last index of the URI in the set to fetch
+   * \return The Response object. The caller is responsible for deleting the pointer.
+   *
+   * \exception NoCredentialsException The credentials for the Connection were not accepted by MarkLogic Server,
+   * or permission is denied for this request.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual Response* getDocuments(const DocumentUriSet& uris,const long startPosInclusive,
+      const long endPosInclusive) = 0;
+
   /**
    * \brief Saves a document to MarkLogic (either as new or an update), at the given document URI (MarkLogic unique document ID)
    *
@@ -305,6 +351,25 @@ public:
   MLCLIENT_API virtual Response* saveDocuments(const DocumentSet& documents,const long startPosInclusive,
       const long endPosInclusive) = 0;
 
+  /**
+   * \brief Saves a set of documents as a single batch in to the named forest
+   *
+   * As saveDocuments(), but passes the forest-name parameter so that the server writes every document in the
+   * range to that forest, rather than choosing a forest itself.
+   *
+   * The default implementation ignores the forest name and calls saveDocuments(). Connection overrides this.
+   *
+   * \param documents The set of documents to upload
+   * \param startPosInclusive The first index of the document in the set to upload
+   * \param endPostInclusive The last index of the document in the set to upload
+   * \param forestName The name of the forest to write the documents to
+   * \return The Response object
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual Response* saveDocumentsToForest(const DocumentSet& documents,const long startPosInclusive,
+      const long endPosInclusive,const std::string& forestName);
+
   /**
    * \brief Saves a document to MarkLogic (either as new or an update), at the given document URI (MarkLogic unique document ID)
    *
@@ -342,7 +407,8 @@ public:
    *
    * Uses a \link SearchDescription \endlink value object to wrap complex search parameters for MarkLogic Server.
    *
-   * Performs a POST /v1/search HTTP POST to MarkLogic Server
+   * Performs a POST /v1/search HTTP POST to MarkLogic Server. Includes the timestamp parameter if
+   * SearchDescription::getTimestamp() is set.
    *
    * \param[in] desc The SearchDescription defining the search, options, and query string
    * \return A unique_ptr for the \link Response \endlink object. The caller is repsonsible for deleting the pointer.
@@ -357,6 +423,24 @@ public:
    */
   MLCLIENT_API virtual Response* search(const SearchDescription& desc) = 0;
 
+  /**
+   * \brief Performs a search as search() does, passing the response body to the handler as it is received
+   *
+   * A 200 OK body is passed to the handler only, and is not held by the returned Response. Any other body is set
+   * as the Response's content, as for search(), and the handler is not called.
+   *
+   * The default implementation calls search(), then passes the whole body as one chunk. Connection overrides this
+   * to pass each chunk as it is read from the network, so the caller can process a large response without ever
+   * holding all of it.
+   *
+   * \param[in] desc The SearchDescription defining the search, options, and query string
+   * \param[in] handler Receives the body. In, but not OWNS.
+   * \return The Response, with its code and headers. The caller is responsible for deleting the pointer.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual Response* searchStreamed(const SearchDescription& desc,IResponseBodyHandler& handler);
+
   /**
    * \brief Performs a search against a REST extension that is compatible with POST /v1/search (i.e. Connection::search)
    *
@@ -693,6 +777,16 @@ public:
    */
   MLCLIENT_API virtual Response* getDocumentPermissions(Document& inout_document) override;
 
+  /**
+   * \brief Retrieves the content of a set of documents in a single request
+   *
+   * See IConnection for details.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API Response* getDocuments(const DocumentUriSet& uris,const long startPosInclusive,
+      const long endPosInclusive) override;
+
   /**
    * \brief Saves a document to MarkLogic (either as new or an update), at the given document URI (MarkLogic unique document ID)
    *
@@ -712,6 +806,16 @@ public:
   MLCLIENT_API Response* saveDocuments(const DocumentSet& documents,const long startPosInclusive,
       const long endPosInclusive) override;
 
+  /**
+   * \brief Saves a set of documents as a single batch in to the named forest
+   *
+   * See IConnection for details.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API Response* saveDocumentsToForest(const DocumentSet& documents,const long startPosInclusive,
+      const long endPosInclusive,const std::string& forestName) override;
+
   /**
    * \brief Saves the specified document to MarkLogic Server
    *
@@ -739,6 +843,15 @@ public:
    */
   MLCLIENT_API Response* search(const SearchDescription& desc) override;
 
+  /**
+   * \brief Performs a search, passing each chunk of the response body to the handler as it is read from the network
+   *
+   * See IConnection for details.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API Response* searchStreamed(const SearchDescription& desc,IResponseBodyHandler& handler) override;
+
   /**
    * \brief Performs a search against a REST extension that is compatible with POST /v1/search (i.e. Connection::search)
    *
@@ -13,6 +13,7 @@
 #include <mlclient/DocumentContent.hpp>
 #include <mlclient/Permission.hpp>
 #include <mlclient/mlclient.hpp>
+#include <memory>
 #include <vector>
 
 namespace mlclient {
@@ -68,6 +69,10 @@ typedef std::vector<DocumentUri>::const_iterator DocumentUriIterator;
  * \date 2016-08-04
  *
  * \note The top level Document object is implementation independent and so is a concrete class.
+ *
+ * Content and properties fragments are either borrowed raw pointers, which the caller keeps alive, or
+ * shared immutable fragments set with the std::shared_ptr overloads. Either way copying a Document
+ * (including into a DocumentSet) copies only its metadata, never its content.
  */
 class Document {
 public:
@@ -85,26 +90,46 @@ public:
    * \brief Creates a document with a URI and document content fragment
    *
    * \param[in] uri The URI for the Document within MarkLogic Server
-   * \param[in] own_content The content fragment. The Document class owns this reference, and deletes it upon destruction
+   * \param[in] own_content The content fragment. Not owned - the caller must keep it alive whilst this Document, or any copy of it, is used
    */
   MLCLIENT_API Document(const std::string& uri,IDocumentContent* own_content);
   /**
    * \brief Creates a Document with a URI, document content fragment, and a document properties document fragment
    *
    * \param[in] uri The URI for the Document within MarkLogic Server
-   * \param[in] own_content The content fragment. The Document class owns this reference, and deletes it upon destruction
-   * \param[in] own_properties The properties fragment. The Document class owns this reference, and deletes it upon destruction
+   * \param[in] own_content The content fragment. Not owned - the caller must keep it alive whilst this Document, or any copy of it, is used
+   * \param[in] own_properties The properties fragment. Not owned - the caller must keep it alive whilst this Document, or any copy of it, is used
    */
   MLCLIENT_API Document(const std::string& uri,IDocumentContent* own_content,IDocumentContent* own_properties);
   /**
    * \brief Creates a Document with a URI, document content fragment, and a document properties document fragment, and a set of permissions
    *
    * \param[in] uri The URI for the Document within MarkLogic Server
-   * \param[in] own_content The content fragment. The Document class owns this reference, and deletes it upon destruction
-   * \param[in] own_properties The properties fragment. The Document class owns this reference, and deletes it upon destruction
-   * \param[in] own_permissions The permission set to apply. The Document class owns this reference, and deletes it upon destruction
+   * \param[in] own_content The content fragment. Not owned - the caller must keep it alive whilst this Document, or any copy of it, is used
+   * \param[in] own_properties The properties fragment. Not owned - the caller must keep it alive whilst this Document, or any copy of it, is used
+   * \param[in] own_permissions The permission set to apply. Moved in to this Document
    */
   MLCLIENT_API Document(const std::string& uri,IDocumentContent* own_content,IDocumentContent* own_properties,PermissionSet own_permissions);
+  /**
+   * \brief Copy constructor. Copies the metadata, and shares the content and properties fragments.
+   */
+  Document(const Document& other) = default;
+  /**
+   * \brief Move constructor
+   *
+   * \since 8.0.3
+   */
+  Document(Document&& other) = default;
+  /**
+   * \brief Copy assignment operator. Copies the metadata, and shares the content and properties fragments.
+   */
+  Document& operator=(const Document& other) = default;
+  /**
+   * \brief Move assignment operator
+   *
+   * \since 8.0.3
+   */
+  Document& operator=(Document&& other) = default;
   /**
    * \brief Default Destructor
    */
@@ -169,9 +194,27 @@ public:
   /**
    * \brief Sets the content fragment of this document instance
    *
-   * \param own_content The content fragment. This class OWNS this pointer from this point on, and deletes it upon destruction.
+   * \param own_content The content fragment. Not owned - the caller must keep it alive whilst this Document, or any copy of it, is used.
    */
   MLCLIENT_API void setContent(IDocumentContent* own_content);
+  /**
+   * \brief Sets a shared, immutable content fragment on this document instance
+   *
+   * Copies of this Document share the fragment, which is deleted when the last of them is destroyed.
+   *
+   * \since 8.0.3
+   *
+   * \param shared_content The content fragment
+   */
+  MLCLIENT_API void setContent(std::shared_ptr<const IDocumentContent> shared_content);
+  /**
+   * \brief Returns the content fragment if it was set as a shared fragment
+   *
+   * \since 8.0.3
+   *
+   * \return The shared content fragment. nullptr if no content is set, or if it was set as a raw pointer.
+   */
+  MLCLIENT_API std::shared_ptr<const IDocumentContent> getSharedContent() const;
 
   /**
    * \brief Retrieves the property fragment of this document instance
@@ -188,9 +231,27 @@ public:
   /**
    * \brief Sets this document's properties fragment
    *
-   * \param own_properties The properties fragment. This class OWNS this pointer from this point on, and deletes it upon destruction.
+   * \param own_properties The properties fragment. Not owned - the caller must keep it alive whilst this Document, or any copy of it, is used.
    */
   MLCLIENT_API void setProperties(IDocumentContent* own_properties);
+  /**
+   * \brief Sets a shared, immutable properties fragment on this document instance
+   *
+   * Copies of this Document share the fragment, which is deleted when the last of them is destroyed.
+   *
+   * \since 8.0.3
+   *
+   * \param shared_properties The properties fragment
+   */
+  MLCLIENT_API void setProperties(std::shared_ptr<const IDocumentContent> shared_properties);
+  /**
+   * \brief Returns the properties fragment if it was set as a shared fragment
+   *
+   * \since 8.0.3
+   *
+   * \return The shared properties fragment. nullptr if no properties are set, or if they were set as a raw pointer.
+   */
+  MLCLIENT_API std::shared_ptr<const IDocumentContent> getSharedProperties() const;
 
   /**
    * \brief Returns the permissions set on this document instance
@@ -222,10 +283,12 @@ public:
 
 private:
   std::string uri;
-  IDocumentContent* content;
-  IDocumentContent* properties;
+  const IDocumentContent* content;
+  const IDocumentContent* properties;
   PermissionSet permissions;
   CollectionSet collections;
+  std::shared_ptr<const IDocumentContent> sharedContent; // keeps content alive when set as a shared fragment
+  std::shared_ptr<const IDocumentContent> sharedProperties; // keeps properties alive when set as a shared fragment
 };
 
 } // end namespace mlclient
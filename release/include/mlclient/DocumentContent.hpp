@@ -25,11 +25,73 @@
 #define SRC_DOCUMENTCONTENT_HPP_
 
 #include <mlclient/mlclient.hpp>
+#include <cstddef>
 #include <string>
 #include <iosfwd>
+#include <memory>
+#include <vector>
 
 namespace mlclient {
 
+/**
+ * \brief A read only view of a content's bytes, returned by IDocumentContent::contentView() without copying them
+ *
+ * Either refers to a buffer held elsewhere, E.g. by the content it came from, so is only valid until that is changed
+ * or deleted, or shares ownership of the buffer it refers to, so is valid on its own.
+ *
+ * \since 8.0.3
+ */
+class ContentView {
+public:
+  /**
+   * \brief Creates an empty view
+   */
+  MLCLIENT_API ContentView();
+  /**
+   * \brief Views a string held elsewhere. Not OWNED.
+   */
+  MLCLIENT_API ContentView(const std::string& text);
+  /**
+   * \brief Views size bytes held elsewhere. Not OWNED.
+   */
+  MLCLIENT_API ContentView(const char* data,const size_t size);
+  /**
+   * \brief Views a buffer, sharing ownership of it
+   */
+  MLCLIENT_API ContentView(std::shared_ptr<const std::string> shared);
+
+  MLCLIENT_API const char* data() const;
+  MLCLIENT_API size_t size() const;
+  MLCLIENT_API bool empty() const;
+  MLCLIENT_API const char* begin() const;
+  MLCLIENT_API const char* end() const;
+
+  /**
+   * \brief Returns a copy of the viewed bytes
+   */
+  MLCLIENT_API std::string str() const;
+
+  /**
+   * \brief Returns a new stream that reads the viewed bytes in place, without copying them
+   *
+   * \return The new stream. Caller owns. Holds a copy of this view, so a shared buffer stays valid for its lifetime.
+   */
+  MLCLIENT_API std::istream* openStream() const;
+
+  MLCLIENT_API bool operator==(const std::string& other) const;
+  MLCLIENT_API bool operator!=(const std::string& other) const;
+
+private:
+  const char* mData;
+  size_t mSize;
+  std::shared_ptr<const std::string> mShared;
+};
+
+/**
+ * \brief Writes the viewed bytes to os, without copying them
+ */
+MLCLIENT_API std::ostream& operator<<(std::ostream& os,const ContentView& view);
+
 /**
  * \brief This class represents the internal content of a Document. It can be XML, JSON, String or Binary (or a sub type thereof).
  *
@@ -76,6 +138,23 @@ public:
    */
   MLCLIENT_API virtual std::string getContent() const = 0;
 
+  /**
+   * \brief Returns this content's bytes without copying them. Prefer this to getContent() to send or write content.
+   *
+   * Content classes that hold their text override this to view it in place. The view is then only valid until the
+   * content is changed or deleted. The default copies getContent() once in to a buffer the view shares.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual ContentView contentView() const;
+
+  /**
+   * \brief Returns the number of bytes of content. Defaults to contentView().size().
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual size_t size() const;
+
   /**
    * \brief Returns the MIME type of this content.
    *
@@ -110,6 +189,210 @@ public:
 // TODO streaming operator
 
 
+class IDocumentNode; // forward declaration
+class IDocumentNodeKind; // forward declaration
+
+/**
+ * \brief A lightweight, non owning handle to a node within a document's tree
+ *
+ * A DocumentNodeRef is two pointers in size and is copied by value. Navigating with at() returns another
+ * DocumentNodeRef, so walking a document allocates nothing and there is nothing to delete. This is the preferred
+ * navigation API. The IDocumentNode methods that return new heap nodes remain for compatibility.
+ *
+ * A missing key or index returns an empty handle rather than throwing. Every method may be called on an empty
+ * handle - at() returns another empty handle and the as*() methods throw - so chains such as
+ * ref.at("a").at("b").getString("c") need no checks in between.
+ *
+ * \note A handle is only valid whilst the content it was obtained from exists and is not modified.
+ *
+ * \since 8.0.3
+ */
+class DocumentNodeRef {
+public:
+  /**
+   * \brief Creates an empty handle
+   */
+  MLCLIENT_API DocumentNodeRef();
+  /**
+   * \brief Creates a handle. Used by document implementations only.
+   *
+   * \param kind The implementation's operations for this kind of node. A static instance. nullptr for an empty handle.
+   * \param node The implementation's node pointer. Not OWNED.
+   */
+  MLCLIENT_API DocumentNodeRef(const IDocumentNodeKind* kind,const void* node);
+
+  /**
+   * \brief Whether this handle refers to no node. E.g. as returned by at() for a missing key.
+   */
+  MLCLIENT_API bool isEmpty() const;
+  MLCLIENT_API explicit operator bool() const;
+
+  /** \brief See IDocumentNode::isNull(). False for an empty handle. */
+  MLCLIENT_API bool isNull() const;
+  /** \brief See IDocumentNode::isBoolean(). False for an empty handle. */
+  MLCLIENT_API bool isBoolean() const;
+  /** \brief See IDocumentNode::isInteger(). False for an empty handle. */
+  MLCLIENT_API bool isInteger() const;
+  /** \brief See IDocumentNode::isDouble(). False for an empty handle. */
+  MLCLIENT_API bool isDouble() const;
+  /** \brief See IDocumentNode::isString(). False for an empty handle. */
+  MLCLIENT_API bool isString() const;
+  /** \brief See IDocumentNode::isArray(). False for an empty handle. */
+  MLCLIENT_API bool isArray() const;
+  /** \brief See IDocumentNode::isObject(). False for an empty handle. */
+  MLCLIENT_API bool isObject() const;
+
+  /**
+   * \brief Returns the boolean value of this node
+   * \throws InvalidFormatException if empty or not a simple value
+   */
+  MLCLIENT_API bool asBoolean() const;
+  /**
+   * \brief Returns the integer value of this node
+   * \throws InvalidFormatException if empty or not a simple value
+   */
+  MLCLIENT_API int32_t asInteger() const;
+  /**
+   * \brief Returns the double value of this node
+   * \throws InvalidFormatException if empty or not a simple value
+   */
+  MLCLIENT_API double asDouble() const;
+  /**
+   * \brief Returns the string value of this node
+   * \throws InvalidFormatException if empty or not a simple value
+   */
+  MLCLIENT_API std::string asString() const;
+
+  /**
+   * \brief Returns the named child element, attribute or property. Never throws.
+   *
+   * \param key the string key of the requested child
+   * \return A handle to the child, or an empty handle if there is none or this node is not an object
+   */
+  MLCLIENT_API DocumentNodeRef at(const std::string& key) const;
+  /**
+   * \brief Returns the array member at the zero based index. Never throws.
+   *
+   * \param idx The zero based index
+   * \return A handle to the member, or an empty handle if out of range or this node is not an array
+   */
+  MLCLIENT_API DocumentNodeRef at(const int32_t idx) const;
+  /**
+   * \brief Returns every member of an array, in order, or this node alone if it is not an array
+   *
+   * Prefer this to calling at(idx) for each index. Some implementations, E.g. XML, find a member by walking its
+   * siblings, which is linear for each at(idx) call, whereas this is linear in total.
+   *
+   * \return The members. Empty for an empty handle.
+   */
+  MLCLIENT_API std::vector<DocumentNodeRef> members() const;
+  /**
+   * \brief Whether this node has the named child element, attribute or property
+   */
+  MLCLIENT_API bool has(const std::string& key) const;
+  /**
+   * \brief Returns the names of this node's children. Empty for arrays and simple values.
+   */
+  MLCLIENT_API StringList keys() const;
+  /**
+   * \brief Returns the number of members of an array, 1 for any other node, or 0 for an empty handle
+   */
+  MLCLIENT_API int32_t size() const;
+
+  /**
+   * \brief Returns the string value of the named child, or defaultValue if there is none or it is not a simple value
+   */
+  MLCLIENT_API std::string getString(const std::string& key,const std::string& defaultValue = "") const;
+  /**
+   * \brief Returns the integer value of the named child, or defaultValue if there is none or it is not a number
+   */
+  MLCLIENT_API int32_t getInteger(const std::string& key,const int32_t defaultValue = 0) const;
+  /**
+   * \brief Returns the double value of the named child, or defaultValue if there is none or it is not a number
+   */
+  MLCLIENT_API double getDouble(const std::string& key,const double defaultValue = 0) const;
+  /**
+   * \brief Returns the boolean value of the named child, or defaultValue if there is none or it is not a simple value
+   */
+  MLCLIENT_API bool getBoolean(const std::string& key,const bool defaultValue = false) const;
+
+  /**
+   * \brief Creates a heap IDocumentNode for this node, for use with APIs that take an IDocumentNode
+   *
+   * \note The returned node, like this handle, is only valid whilst the content exists. Use IDocumentNode::newNode()
+   * or IDocumentNavigator::newNode() for a node that shares ownership of the content.
+   *
+   * \return The new node, which the caller owns, or nullptr if this handle is empty
+   */
+  MLCLIENT_API IDocumentNode* newNode() const;
+
+  /**
+   * \brief Whether both handles refer to the same node
+   */
+  MLCLIENT_API bool operator==(const DocumentNodeRef& other) const;
+  MLCLIENT_API bool operator!=(const DocumentNodeRef& other) const;
+
+  MLCLIENT_API const IDocumentNodeKind* getKind() const;
+  MLCLIENT_API const void* getNode() const;
+
+private:
+  const IDocumentNodeKind* kind;
+  const void* node;
+};
+
+/**
+ * \brief The operations a document implementation provides for one kind of node, for use by DocumentNodeRef
+ *
+ * Implementations are stateless static instances. Each method receives the node pointer held by the DocumentNodeRef.
+ * Application code uses DocumentNodeRef rather than calling these directly. See IDocumentNode for each method's
+ * meaning.
+ *
+ * \since 8.0.3
+ */
+class IDocumentNodeKind {
+public:
+  MLCLIENT_API IDocumentNodeKind();
+  MLCLIENT_API virtual ~IDocumentNodeKind();
+
+  MLCLIENT_API virtual bool isNull(const void* node) const = 0;
+  MLCLIENT_API virtual bool isBoolean(const void* node) const = 0;
+  MLCLIENT_API virtual bool isInteger(const void* node) const = 0;
+  MLCLIENT_API virtual bool isDouble(const void* node) const = 0;
+  MLCLIENT_API virtual bool isString(const void* node) const = 0;
+  MLCLIENT_API virtual bool isArray(const void* node) const = 0;
+  MLCLIENT_API virtual bool isObject(const void* node) const = 0;
+
+  MLCLIENT_API virtual bool asBoolean(const void* node) const = 0;
+  MLCLIENT_API virtual int32_t asInteger(const void* node) const = 0;
+  MLCLIENT_API virtual double asDouble(const void* node) const = 0;
+  MLCLIENT_API virtual std::string asString(const void* node) const = 0;
+
+  /**
+   * \brief Returns the named child, or an empty handle. Must not throw.
+   */
+  MLCLIENT_API virtual DocumentNodeRef at(const void* node,const std::string& key) const = 0;
+  /**
+   * \brief Returns the array member, or an empty handle. Must not throw.
+   */
+  MLCLIENT_API virtual DocumentNodeRef at(const void* node,const int32_t idx) const = 0;
+  /**
+   * \brief Defaults to calling at(node,idx) for each index below size(node), for arrays
+   */
+  MLCLIENT_API virtual std::vector<DocumentNodeRef> members(const void* node) const;
+  /**
+   * \brief Defaults to checking at(node,key) is not empty
+   */
+  MLCLIENT_API virtual bool has(const void* node,const std::string& key) const;
+  MLCLIENT_API virtual StringList keys(const void* node) const = 0;
+  MLCLIENT_API virtual int32_t size(const void* node) const = 0;
+
+  /**
+   * \brief Creates the implementation's heap IDocumentNode for this node. Caller owns the result.
+   */
+  MLCLIENT_API virtual IDocumentNode* newNode(const void* node) const = 0;
+};
+
+
 
 /**
  * \brief Acts as a generic lightweight document element interface
@@ -220,6 +503,85 @@ public:
   MLCLIENT_API virtual IDocumentNode* at(const std::string& key) const = 0;
   MLCLIENT_API virtual IDocumentNode* at(const int32_t idx) const = 0;
 
+  /**
+   * \brief Returns a non owning handle to this node, for allocation free navigation. See DocumentNodeRef.
+   *
+   * The handle remains valid after this IDocumentNode is deleted, for as long as the underlying content exists.
+   *
+   * \note The base implementation returns an empty handle. The JSON and XML implementations override this.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual DocumentNodeRef ref() const;
+
+  /**
+   * \brief Creates a heap node for a handle found by navigating from ref()
+   *
+   * Unlike DocumentNodeRef::newNode(), the new node shares this node's ownership of the underlying content, as the
+   * nodes returned by at() do, so it remains valid once this node is deleted.
+   *
+   * \note The base implementation returns ref.newNode(). The native JSON and XML implementations override this.
+   *
+   * \param ref A handle within this node's content
+   * \return The new node, which the caller owns, or nullptr if ref is empty
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual IDocumentNode* newNode(const DocumentNodeRef& ref) const;
+
+  /**
+   * \brief Returns the named child element, attribute or property, or nullptr if there is none. Never throws.
+   *
+   * Use instead of has() then at(), or at() in a try block, for optional children.
+   *
+   * \note The base implementation calls has() then at(), catching any exception. Implementations override this
+   * to look the key up once, without exceptions.
+   *
+   * \param key the string key of the requested child
+   * \return The child node, which the caller owns, or nullptr
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual IDocumentNode* tryAt(const std::string& key) const;
+  /**
+   * \brief Returns the array member at the zero based index, or nullptr if this node is not an array or the index is
+   * out of range. Never throws.
+   *
+   * \param idx The zero based index
+   * \return The member node, which the caller owns, or nullptr
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual IDocumentNode* tryAt(const int32_t idx) const;
+
+  /**
+   * \brief Returns the string value of the named child, or defaultValue if there is none or it is not a simple value
+   *
+   * Never throws for a missing child, so is cheap to use for optional fields.
+   *
+   * \param key the string key of the requested child
+   * \param defaultValue The value to return if the child cannot be read
+   * \return The string value, or defaultValue
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API std::string getString(const std::string& key,const std::string& defaultValue = "") const;
+  /**
+   * \brief Returns the integer value of the named child, or defaultValue if there is none or it is not a number
+   * \since 8.0.3
+   */
+  MLCLIENT_API int32_t getInteger(const std::string& key,const int32_t defaultValue = 0) const;
+  /**
+   * \brief Returns the double value of the named child, or defaultValue if there is none or it is not a number
+   * \since 8.0.3
+   */
+  MLCLIENT_API double getDouble(const std::string& key,const double defaultValue = 0) const;
+  /**
+   * \brief Returns the boolean value of the named child, or defaultValue if there is none or it is not a simple value
+   * \since 8.0.3
+   */
+  MLCLIENT_API bool getBoolean(const std::string& key,const bool defaultValue = false) const;
+
   /**
    * \brief Returns whether the object at the root of the navigator's tree has a particular named sub element/property
    *
@@ -301,6 +663,74 @@ public:
    * \return True if the key exists at the top level of the navigated document object
    */
   MLCLIENT_API virtual bool has(const std::string& key) const = 0;
+
+  /**
+   * \brief Returns a non owning handle to the navigated object, so that ref().at(key) finds the same node as at(key)
+   *
+   * The handle remains valid after this navigator is deleted, for as long as the underlying content exists.
+   *
+   * \note The base implementation returns an empty handle. The JSON and XML implementations override this.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual DocumentNodeRef ref() const;
+
+  /**
+   * \brief Creates a heap node for a handle found by navigating from ref()
+   *
+   * Unlike DocumentNodeRef::newNode(), the new node shares this navigator's ownership of the underlying content, as the
+   * nodes returned by at() do, so it remains valid once this navigator is deleted.
+   *
+   * \note The base implementation returns ref.newNode(). The native JSON and XML implementations override this.
+   *
+   * \param ref A handle within this navigator's content
+   * \return The new node, which the caller owns, or nullptr if ref is empty
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual IDocumentNode* newNode(const DocumentNodeRef& ref) const;
+
+  /**
+   * \brief Returns the named element, attribute or property underneath the document object, or nullptr if there
+   * is none. Never throws.
+   *
+   * \note The base implementation calls has() then at(), catching any exception. Implementations override this
+   * to look the key up once, without exceptions.
+   *
+   * \param key the string key of the requested object
+   * \return The node, which the caller owns, or nullptr
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API virtual IDocumentNode* tryAt(const std::string& key) const;
+
+  /**
+   * \brief Returns the string value of the named child, or defaultValue if there is none or it is not a simple value
+   *
+   * Never throws for a missing child, so is cheap to use for optional fields.
+   *
+   * \param key the string key of the requested child
+   * \param defaultValue The value to return if the child cannot be read
+   * \return The string value, or defaultValue
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API std::string getString(const std::string& key,const std::string& defaultValue = "") const;
+  /**
+   * \brief Returns the integer value of the named child, or defaultValue if there is none or it is not a number
+   * \since 8.0.3
+   */
+  MLCLIENT_API int32_t getInteger(const std::string& key,const int32_t defaultValue = 0) const;
+  /**
+   * \brief Returns the double value of the named child, or defaultValue if there is none or it is not a number
+   * \since 8.0.3
+   */
+  MLCLIENT_API double getDouble(const std::string& key,const double defaultValue = 0) const;
+  /**
+   * \brief Returns the boolean value of the named child, or defaultValue if there is none or it is not a simple value
+   * \since 8.0.3
+   */
+  MLCLIENT_API bool getBoolean(const std::string& key,const bool defaultValue = false) const;
 };
 
 
@@ -330,7 +760,7 @@ public:
    *
    * Assumes content string is non null
    *
-   * \param[in] The string content to copy in to this object.
+   * \param[in] The string content. Pass an rvalue (E.g. std::move(str)) to move it in to this object rather than copy it.
    */
   MLCLIENT_API virtual void setContent(std::string content) = 0;
 
@@ -375,6 +805,11 @@ public:
  * This class is used as the data holding class for all JSON and XML documents.
  * There are no JSON or XML specialisations (Use the JSON and XML helper classes in the \link utilities \endlink namespace
  * instead to create, modify, or introspect the JSON/XML.)
+ *
+ * The content is held in an immutable, reference counted buffer. Copies share that buffer, so copying
+ * this class (or a Document or SearchDescription holding it) never copies the content itself. setContent
+ * replaces the buffer rather than modifying it, so copies and views of the old content are unaffected and
+ * may be read safely from other threads.
  */
 class GenericTextDocumentContent : public ITextDocumentContent {
 public:
@@ -386,12 +821,12 @@ public:
   MLCLIENT_API GenericTextDocumentContent();
 
   /**
-   * \brief deep copy constructor
+   * \brief copy constructor. Shares the content buffer of doc rather than copying it.
    */
   MLCLIENT_API GenericTextDocumentContent(const GenericTextDocumentContent& doc);
 
   /**
-   * \brief deep copy constructor
+   * \brief copy constructor. Shares the content buffer if doc is a GenericTextDocumentContent, otherwise copies its content.
    */
   MLCLIENT_API GenericTextDocumentContent(const ITextDocumentContent& doc);
 
@@ -407,7 +842,9 @@ public:
    *
    * \test SearchResultSetTest::testCustomSnippetJson
    *
-   * \param[in] The string content to copy in to this object.
+   * Replaces the content buffer, so copies of this instance keep the previous content.
+   *
+   * \param[in] The string content. Pass an rvalue (E.g. std::move(str)) to move it in to this object rather than copy it.
    */
   MLCLIENT_API void setContent(std::string content) override;
 
@@ -416,9 +853,9 @@ public:
    *
    * This allows streaming to a HTTP request of this string content.
    *
-   * \note The stream may be read from asynchronously, so do not destroy the underlying content after returning the stream.
+   * \note The stream shares the content buffer, so remains valid after this instance is changed or deleted.
    *
-   * \return An istream instance wrapping the content of this Text Document Content instance
+   * \return An istream instance reading the content in place. Caller owns.
    */
   MLCLIENT_API std::istream* getStream() const override;
 
@@ -429,6 +866,12 @@ public:
    */
   MLCLIENT_API std::string getContent() const override;
 
+  /**
+   * \brief Views the content in place. The view shares the content buffer, so remains valid after this instance is changed or deleted.
+   */
+  MLCLIENT_API ContentView contentView() const override;
+  MLCLIENT_API size_t size() const override;
+
 
 
   /**
@@ -222,6 +222,18 @@ public:
    */
   MLCLIENT_API void setContent(std::string&& content);
 
+  /**
+   * \brief Moves the string content out of this Response, leaving it empty
+   *
+   * Used by parsers that take ownership of the body rather than copying it, such as
+   * PugiXmlHelper::toDocumentInPlace(). getContent() returns an empty string after this call.
+   *
+   * \since 8.0.3
+   *
+   * \return The response content. Owned by the caller.
+   */
+  MLCLIENT_API std::string releaseContent();
+
   // prevent compiler automatically defining the copy constructor and assignment operator:-
   MLCLIENT_API Response(const Response&) = delete;
   MLCLIENT_API Response& operator= (const Response&) = delete;
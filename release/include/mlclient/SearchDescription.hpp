@@ -49,8 +49,8 @@ public:
   MLCLIENT_API SearchDescription();
 
   /*
-   * \brief Deep copy constructor
-   * \param desc The description to deep copy from
+   * \brief Copy constructor. Shares the query and options content of desc rather than copying it.
+   * \param desc The description to copy from
    */
   MLCLIENT_API SearchDescription(const SearchDescription& desc);
 
@@ -173,6 +173,27 @@ public:
    * \return The MIME type string. See DocumentContent::MIME_JSON and DocumentContent::MIME_XML
    */
   MLCLIENT_API const std::string getResponseMimeType() const;
+
+  /**
+   * \brief Sets the point in time, as a MarkLogic Server timestamp, at which this search is evaluated
+   *
+   * Searches with the same timestamp see the same database state, whatever has been ingested since. Pass the
+   * ML-Effective-Timestamp header value from an earlier response to read consistent pages of results.
+   *
+   * \note The database's merge timestamp must be at or before this timestamp, else older fragments may have
+   * been merged away and the server rejects the request.
+   *
+   * \param timestamp The server timestamp. An empty string (the default) searches the latest state.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setTimestamp(const std::string& timestamp);
+  /**
+   * \brief Returns the point in time timestamp for this search, or an empty string if not set
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const std::string& getTimestamp() const;
   // @}
 
 private:
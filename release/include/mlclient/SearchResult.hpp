@@ -10,6 +10,9 @@
 
 #include <mlclient/mlclient.hpp>
 #include <mlclient/DocumentContent.hpp>
+
+#include <atomic>
+#include <memory>
 #include <string>
 
 namespace mlclient {
@@ -28,7 +31,7 @@ enum class Format {
  * A SearchResult in MarkLogic Server consistent of not just the result itself, but also its metadata.
  * Indeed, using the "none" snippet option means no content is returned, leaving just the metadata.
  *
- * \note Supports std::move and C++11 move semantics.
+ * \note Supports std::move and C++11 move semantics. Moving never allocates, and leaves the moved from result empty.
  *
  * \since 8.0.2
  *
@@ -49,29 +52,33 @@ public:
   MLCLIENT_API SearchResult();
   /**
    * Copy constructor
-   * \param other The SearchResult to copy (shallow copy)
+   *
+   * The copy has its own decoded fields, so calling releaseContent() on one result does not affect the other. A copy
+   * of a lazy result shares ownership of the parsed response, so remains usable once the result set is freed.
+   *
+   * \param other The SearchResult to copy
    */
-  MLCLIENT_API SearchResult(const SearchResult& other) = default;
+  MLCLIENT_API SearchResult(const SearchResult& other);
 
   /**
    * Move constructor
-   * \param other The SearchResult to move (deep reference move)
+   * \param other The SearchResult to move (deep reference move). Left empty.
    */
-  MLCLIENT_API SearchResult(SearchResult&& other);
+  MLCLIENT_API SearchResult(SearchResult&& other) noexcept;
 
   /**
    * Move assignment operator
    *
    * \note If this is not defined, it is implicitly deleted by the compiler
    */
-  MLCLIENT_API SearchResult& operator= (SearchResult&& other);
+  MLCLIENT_API SearchResult& operator= (SearchResult&& other) noexcept;
 
   /**
-   * Copy assignment operator
+   * Copy assignment operator. See the copy constructor.
    *
    * \note If this is not defined, it is implicitly deleted by the compiler
    */
-  MLCLIENT_API SearchResult& operator= (const SearchResult&& other);
+  MLCLIENT_API SearchResult& operator= (const SearchResult& other);
 
   /**
    * \brief Destructor
@@ -81,6 +88,8 @@ public:
 
   /**
    * Detail constructor. Used by SearchResultSet and other search result wrapping functions and classes.
+   *
+   * \note The strings are taken by value and moved in, so pass temporaries to avoid copying them.
    * \param index The index (position, 1 based) of this result in the total search result list, across all pages
    * \param uri The document URI this search result represents
    * \param path The XPath representing this document (more accurately, MarkLogic Fragment)
@@ -92,10 +101,31 @@ public:
    * \param mimeType The MIME type of the result content
    * \param format The REST API format of the result (can be "json" or "xml" or "binary" or "text" or "none")
    */
-  MLCLIENT_API SearchResult(const long index, const std::string& uri, const std::string& path,const long score,
+  MLCLIENT_API SearchResult(const long index, std::string uri, std::string path,const long score,
       const double confidence,const double fitness,const Detail& detail,
       std::shared_ptr<IDocumentNode>& detailContent,
-      const std::string& mimeType = "",const Format& format = Format::JSON);
+      std::string mimeType = "",const Format& format = Format::JSON);
+
+  /**
+   * \brief Lazy constructor. Used by SearchResultSet.
+   *
+   * Keeps a handle to the result's row in a parsed search response, and decodes fields only when first accessed.
+   * Nothing is allocated until then. The metadata (index, uri, path, score, confidence, fitness, MIME type and
+   * format) is decoded together on the first call to any getter. The detail content, including re-parsing a custom
+   * JSON snippet, is decoded on the first call to getDetail() or getDetailContent(). Iterating only URIs and scores
+   * therefore never builds the content nodes.
+   *
+   * \note The document is held by reference, as it is held once per page by SearchResultSet, so must outlive this
+   * result. Copies, and the node returned by getDetailContent(), take their own reference to it, so may outlive it.
+   *
+   * \param row The search:result row node (a JSON results array member, or an XML search:result element)
+   * \param snippetFormat The response's snippet-format, which determines where the detail content is
+   * \param document Owns the parsed response the row points in to
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API SearchResult(const DocumentNodeRef& row,const std::string& snippetFormat,
+      const std::shared_ptr<const void>& document);
 
   /**
    * \brief Returns the (1 based) index of this result in the total search results, across all pages
@@ -134,15 +164,30 @@ public:
   MLCLIENT_API const Detail& getDetail() const;
   /**
    * \brief Returns the raw text content of this result
-   * \return The raw text content of this result
+   * \return The raw text content of this result. Keeps the document it points in to alive.
    */
   MLCLIENT_API std::shared_ptr<IDocumentNode> getDetailContent() const;
+  /**
+   * \brief Returns whether the metadata has been decoded from a lazy result's row
+   * \return true once any getter has decoded it. Always false for a result built from values.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API bool isMetadataDecoded() const;
+  /**
+   * \brief Returns whether the detail content has been decoded from a lazy result's row
+   * \return true once getDetail() or getDetailContent() has decoded it. Always false for a result built from values.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API bool isContentDecoded() const;
   /**
    * \brief Releases the pointer on the underlying content document
    * 
    * The held content document is generally a very large in memory object. 
    * Calling this method allows you to keep the SearchResult in a container (preserving size and order of a collection)
-   * whilst removing the bulk of the underlying used memory. 
+   * whilst removing the bulk of the underlying used memory. A copy of a lazy result also releases its reference to
+   * the parsed response, keeping only its decoded metadata.
    */
   MLCLIENT_API void releaseContent(); 
   /**
@@ -157,20 +202,21 @@ public:
   MLCLIENT_API const Format& getFormat() const;
 
 private:
+  /**
+   * Where a lazy row's detail content is, from the response's snippet-format
+   */
+  enum class RowFormat : unsigned char {
+    MATCHES, RAW, CUSTOM
+  };
+
   class Impl; // forward declaration
-  Impl* mImpl;
-
-  long index;
-  std::string uri;
-  std::string path;
-  long score;
-  double confidence;
-  double fitness;
-  Detail detail;
-  std::shared_ptr<IDocumentNode> detailContent;
-  std::string mimeType;
-  Format format;
+  Impl& impl() const;
 
+  DocumentNodeRef mRow; // lazy results only - the row within the parsed response
+  const std::shared_ptr<const void>* mDocument; // lazy results only - the parsed response's owner, normally the page's
+  std::shared_ptr<const void> mOwnDocument; // copies of lazy results only - what mDocument points to
+  RowFormat mRowFormat;
+  mutable std::atomic<Impl*> mImpl; // the decoded fields. Owned. Allocated on first access.
 };
 
 } // end namespace mlclient
@@ -12,13 +12,60 @@
 #include <mlclient/SearchResult.hpp>
 #include <mlclient/Connection.hpp>
 #include <mlclient/SearchDescription.hpp>
+#include <mlclient/MarkLogicTypes.hpp>
 
+#include <cstddef>
+#include <iterator>
+#include <string>
 #include <vector>
 
 namespace mlclient {
 
 class SearchResultSetIterator; // fwd declaration - see end of file
 
+/**
+ * \brief An abstract class that receives each search result row as it is decoded. See SearchResultSet::visit().
+ *
+ * \note Can be subclassed directly in other wrappers (E.g. C#)
+ *
+ * \since 8.0.3
+ */
+class ISearchResultVisitor {
+public:
+  MLCLIENT_API virtual ~ISearchResultVisitor();
+
+  /**
+   * \brief Receives one search result
+   *
+   * \param uri The matching document's URI
+   * \param score The result's relevance score
+   * \param content The row's detail content, as SearchResult::getDetailContent() would find it for the snippet
+   * format, or nullptr if it has none. A custom JSON snippet is passed as its unparsed string node. Only valid
+   * during this call.
+   */
+  MLCLIENT_API virtual void onResult(const std::string& uri,const long score,const IDocumentNode* content) = 0;
+};
+
+/**
+ * \brief Time spent in each stage of a SearchResultSet's page pipeline. See SearchResultSet::getPipelineTimings().
+ *
+ * Stage times are summed over pages, so with several pages in flight they can exceed the elapsed time.
+ *
+ * \since 8.0.3
+ */
+struct PipelineTimings {
+  /** The number of pages received */
+  long pages;
+  /** Time page requests were running, from sending to receiving the whole response */
+  double networkMillis;
+  /** Time spent decoding received responses, including visiting rows during SearchResultSet::visit() */
+  double parseMillis;
+  /** Time the consuming thread was blocked waiting for a page */
+  double waitMillis;
+  /** The most pages held at once, counting those adopted by the set and those in flight */
+  long mostPagesHeld;
+};
+
 /**
  * \brief A self-advancing result set class
  *
@@ -47,9 +94,12 @@ public:
   /**
    * \brief Destroys a SearchResultSet and all of its owned resources
    *
+   * Waits for any prefetched pages still in flight, then frees all results, the parsed responses their detail
+   * content points in to, and the SearchDescription.
+   *
    * \test SearchResultSetTest::testCustomSnippetJson
    */
-  MLCLIENT_API virtual ~SearchResultSet() = default;
+  MLCLIENT_API virtual ~SearchResultSet();
 
   // iterator methods around each search result
   /**
@@ -69,9 +119,34 @@ public:
    */
   MLCLIENT_API SearchResultSetIterator* end() const;
 
-  // TODO initially, no request
-  // TODO then just make a request at end of a collection
-  // TODO in future though, specify how many pages we pre-fetch asynchronously between page processing operations (provide subclass of iterator)
+  /**
+   * \brief Returns an iterator, by value, at the first result in this result set
+   *
+   * Unlike begin(), nothing is allocated on the heap.
+   *
+   * \test SearchResultSetTest::testRangeFor
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const_iterator cbegin() const;
+  /**
+   * \brief Returns an iterator, by value, one past the last result in this result set
+   *
+   * \test SearchResultSetTest::testRangeFor
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const_iterator cend() const;
+  /**
+   * \brief Returns cbegin() and cend() as a pair, so all results can be visited with a range based for loop
+   *
+   * for (const SearchResult& result : results->items()) { ... }
+   *
+   * \test SearchResultSetTest::testRangeFor
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API IteratorRange<const_iterator> items() const;
 
   /**
    * \brief Uses the provided Connection and SearchDescription to perform a request, and initial this object and the list of results.
@@ -84,6 +159,26 @@ public:
    */
   MLCLIENT_API bool fetch();
 
+  /**
+   * \brief Performs the search, passing every result to the visitor rather than holding them in this set
+   *
+   * Each row is passed straight from the page's parsed response to the visitor, and the page is freed once its
+   * rows have been visited. No SearchResult is created, so memory use depends on the prefetched pages only, not on
+   * the number of results. Pages are prefetched as set by setPrefetchPages(). setParallelPages() is ignored, so
+   * rows arrive in result order. Search after mode and setMaxResults() are honoured.
+   *
+   * \note The visitor is called on the calling thread only, and visit() returns once all rows have been visited
+   * \note Use either visit() or fetch() and the iterators on an instance, not both
+   *
+   * \test SearchResultSetTest::testVisitor
+   *
+   * \param visitor The visitor to pass each result to. In, but not OWNS.
+   * \return true if no errors were raised, false otherwise. See getFetchException().
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API bool visit(ISearchResultVisitor& visitor);
+
   /**
    * \brief Returns the exception, if any, encountered by fetch(). nullptr is returned if no exception raised.
    *
@@ -169,6 +264,226 @@ public:
    */
   MLCLIENT_API void setMaxResults(long maxResults);
 
+  /**
+   * \brief Sets how many pages are fetched ahead of the iterator, on background tasks
+   *
+   * After fetch() returns, up to this many following pages are requested and parsed on background tasks. They are
+   * handed to the iterator in order as it reaches them, and another page is requested as each is handed over. The
+   * iterator therefore only blocks when it overtakes every page in flight.
+   *
+   * A connection sends one request at a time, holding later requests until the response headers of the current one
+   * arrive. So on this set's connection alone the page requests themselves run one after another, and only the
+   * downloading and parsing of response bodies overlap. Use setFetchConnections() to send page requests at once.
+   *
+   * \note Defaults to 1. Call before fetch(). Each page in flight holds a full page of parsed results in memory.
+   *
+   * \param pages The number of pages to keep in flight. Minimum 1.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setPrefetchPages(int pages);
+
+  /**
+   * \brief Sets the connections that background page requests are sent on, one request per connection at a time
+   *
+   * Each page request waits for an idle connection in this list, so up to connections.size() pages are requested
+   * at once, each on its own connection. The connections should be to the same database, with the same
+   * credentials, as this set's connection. An empty list (the default) sends every request on this set's
+   * connection, which serializes them.
+   *
+   * \note Call before fetch(). The connections are not owned, and must outlive this result set.
+   *
+   * \param connections The connections to send page requests on
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setFetchConnections(const std::vector<IConnection*>& connections);
+
+  /**
+   * \brief Sets whether results are streamed forward only, rather than all kept in memory
+   *
+   * By default every page fetched is kept until this result set is destroyed, so results can be revisited and
+   * memory grows with the number of results iterated. When streaming, each page is freed as soon as the iterator
+   * moves past its last result. Memory is then bounded by the page length times (1 + the prefetch page count +
+   * the parse backlog), however many results the search matches.
+   *
+   * \note Call before fetch(). Only a single forward pass with one iterator is supported. Accessing a result on a
+   * freed page throws std::out_of_range, and SearchResult copies must not use their detail content once its
+   * page is freed.
+   *
+   * \param streaming true to free pages once iterated past
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setStreaming(bool streaming);
+  /**
+   * \brief Returns whether results are streamed forward only
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const bool isStreaming() const;
+  /**
+   * \brief Returns how many pages are fetched ahead of the iterator
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const int getPrefetchPages() const;
+
+  /**
+   * \brief Sets whether every page after the first is read at the same point in time as the first
+   *
+   * When enabled (the default) the ML-Effective-Timestamp returned with the first page is passed as the timestamp
+   * of every later page request. Documents ingested or deleted whilst iterating then cannot shift results between
+   * pages, so no result is returned twice or skipped. If the SearchDescription already has a timestamp that is used
+   * instead.
+   *
+   * \note Call before fetch(). If the server sends no timestamp, later pages read the latest state as before.
+   * \note The database merge timestamp must be at or before the first page's timestamp for long iterations,
+   * else the server may reject later pages once the fragments they need have been merged away.
+   *
+   * \param pointInTime true to pin later pages to the first page's timestamp
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setPointInTime(bool pointInTime);
+  /**
+   * \brief Returns whether later pages are read at the first page's point in time
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const bool isPointInTime() const;
+  /**
+   * \brief Returns the server timestamp every page is read at, or an empty string if there is none
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const std::string& getTimestamp() const;
+
+  /**
+   * \brief Pages through results by sort key rather than by start offset
+   *
+   * Results are sorted on the given JSON property's range index. Each page after the first is requested from
+   * start 1 with the caller's query and-ed with a range query for keys after the last key of the page before.
+   * Page N therefore costs the server the same as page 1, rather than resolving and skipping every earlier result.
+   *
+   * \note Call before fetch(). Requires a JSON query and JSON options. Any sort-order in the options is replaced.
+   * \note The range index must exist, and each result's detail content must be a JSON object holding the
+   * property at its top level, E.g. by using the raw transform-results option.
+   * \note The key should be unique, E.g. an ID. Results sharing the last key of a page are otherwise skipped.
+   * \note Each page waits for the one before, so prefetched pages are fetched one after another.
+   * SearchResult::getIndex() restarts at 1 on each page.
+   *
+   * \param jsonProperty The JSON property with a range index to sort and page on. Empty disables this mode.
+   * \param type The range index type
+   * \param descending true to sort keys in descending order
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setSearchAfter(const std::string& jsonProperty,const RangeIndexType type,
+      const bool descending = false);
+  /**
+   * \brief Returns whether results are paged by sort key rather than by start offset
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const bool isSearchAfter() const;
+
+  /**
+   * \brief Fetches all remaining pages in parallel, slotting each in to place as it arrives
+   *
+   * Once fetch() has the total from the first page, up to maxConcurrent page requests are kept running until every
+   * page up to the total (or max results) has been requested. Pages are placed at their positions in whatever order
+   * they arrive, and a new request starts as each one completes. The iterator still returns results in order,
+   * blocking only until the page holding the next result has arrived.
+   *
+   * A connection sends one request at a time, holding later requests until the response headers of the current one
+   * arrive. On this set's connection alone the page requests are therefore sent one after another, and only the
+   * downloading and parsing of response bodies overlap. To request pages at once pass several connections to
+   * setFetchConnections(). Wall time for N pages is then close to one page's latency times
+   * N / min(maxConcurrent, connection count).
+   *
+   * \note Call before fetch(). Use when all results are wanted. Ignored when streaming or using search after
+   * paging, as those need pages in order. Point in time paging (the default) stops ingest moving results
+   * between pages.
+   * \note Replaces setPrefetchPages() whilst enabled. All pages are held in memory until this set is destroyed.
+   *
+   * \param maxConcurrent The maximum page requests running at once. 0 (the default) disables this mode.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setParallelPages(int maxConcurrent);
+  /**
+   * \brief Returns the maximum page requests running at once when fetching all pages in parallel, or 0 if disabled
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const int getParallelPages() const;
+
+  /**
+   * \brief Sets how many received pages may wait for, or be in, the parse stage whilst more pages are requested
+   *
+   * Each page passes through two stages on background tasks. The network stage sends the request and receives the
+   * response, and keeps up to the prefetch (or parallel) page count of requests running. The parse stage then
+   * decodes each received response. A received page counts against this backlog, rather than the request limit,
+   * until the iterator takes it. So the next request is started whilst earlier pages are parsed. On a single
+   * connection that request waits for any earlier request's response headers, so what overlaps parsing is the
+   * downloading of response bodies. With setFetchConnections() whole requests overlap parsing. Once the backlog is
+   * full no more requests are sent until the iterator catches up.
+   *
+   * \note Defaults to 1. Call before fetch(). 0 requests a page only once an earlier page has been taken by the
+   * iterator, as before 8.0.3. When streaming, memory is bounded by the page length times
+   * (1 + the prefetch page count + this backlog).
+   *
+   * \param pages The maximum received pages waiting for the iterator beyond the request limit. Minimum 0.
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setParseBacklog(int pages);
+  /**
+   * \brief Returns the maximum received pages waiting for the iterator beyond the request limit
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const int getParseBacklog() const;
+
+  /**
+   * \brief Sets whether visit() parses JSON pages whilst they are being received
+   *
+   * When enabled, visit() requests each page with IConnection::searchStreamed(), and parses the response as each
+   * chunk arrives from the network. Each result row is parsed on its own and passed to the visitor as soon as its
+   * text is complete, then freed. Memory is therefore bounded by one result row rather than by the page, and the
+   * first row is visited before the rest of its page has been received.
+   *
+   * \note Defaults to false. Call before visit(). Only used by visit() with a JSON response type, and not in search
+   * after mode. Pages are requested one after another on the calling thread, so setPrefetchPages() and
+   * setParseBacklog() are ignored, and the visitor runs whilst the page is being received.
+   * \note Page metadata, E.g. getTotal(), is set once each page has been received. Network timings include
+   * parsing and visiting.
+   *
+   * \test SearchResultSetTest::testStreamingParse
+   *
+   * \param streamingParse true to parse pages whilst they are being received
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API void setStreamingParse(bool streamingParse);
+  /**
+   * \brief Returns whether visit() parses JSON pages whilst they are being received
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const bool isStreamingParse() const;
+
+  /**
+   * \brief Returns the time spent so far in the network and parse stages, and waiting for pages
+   *
+   * \test SearchResultSetTest::testPipeline
+   * \test SearchResultSetTest::testStreaming
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const PipelineTimings getPipelineTimings() const;
+
   friend class SearchResultSetIterator;
 
 private:
@@ -177,11 +492,15 @@ private:
 };
 
 /**
- * \brief An STL compatible Iterator implementation
+ * \brief An STL input iterator over a SearchResultSet
  *
- * \warning Currently this isn't quite compatible - it returns pointers rather than references. This
- * should be fixed in 8.0.3. In particular in your loop you need to have this as your comparison:
- * (*iter) != (*(myresultset::end())) and for the increment operator: ++(*iter)
+ * SearchResultSet::cbegin(), cend() and items() return these by value, so results can be visited in a range based
+ * for loop without a heap allocation or a SearchResult copy per step. SearchResultSet::begin() and end() still
+ * return pointers for the SWIG bindings. With those your loop needs this comparison:
+ * (*iter) != (*(myresultset::end())) and this increment: ++(*iter)
+ *
+ * \note As with any input iterator, a reference obtained from an iterator may only be used until the next increment
+ * when streaming is enabled (see SearchResultSet::setStreaming()).
  *
  * See the SearchResultSetTest class for a sample use under release/test
  *
@@ -189,6 +508,12 @@ private:
  */
 class SearchResultSetIterator {
 public:
+  typedef std::input_iterator_tag iterator_category;
+  typedef SearchResult value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const SearchResult* pointer;
+  typedef const SearchResult& reference;
+
   /**
    * \brief Default constructor
    *
@@ -233,7 +558,7 @@ public:
    * \brief Equality operator for comparing an iterator instance to end()
    * \param other The other iterator instance to compare this instance against
    */
-  MLCLIENT_API bool operator==(const SearchResultSetIterator& other);
+  MLCLIENT_API bool operator==(const SearchResultSetIterator& other) const;
   /**
    * \brief Inequality operator for comparing an iterator instance to end()
    *
@@ -241,19 +566,40 @@ public:
    *
    * \param other The other iterator instance to compare this instance against
    */
-  MLCLIENT_API bool operator!=(const SearchResultSetIterator& other);
+  MLCLIENT_API bool operator!=(const SearchResultSetIterator& other) const;
   /**
    * \brief The iterator increment operator
    *
    * \test SearchResultSetTest::testCustomSnippetJson
+   *
+   * \return This iterator, at its new position
    */
-  MLCLIENT_API void operator++();
+  MLCLIENT_API SearchResultSetIterator& operator++();
+  /**
+   * \brief The post increment operator
+   *
+   * \test SearchResultSetTest::testRangeFor
+   *
+   * \return A copy of this iterator at its position before the increment
+   * \since 8.0.3
+   */
+  MLCLIENT_API SearchResultSetIterator operator++(int);
   /**
    * \brief The dereference operator, which returns the SearchResult at the current position in the SearchResultSet
    *
    * \test SearchResultSetTest::testCustomSnippetJson
+   *
+   * \return A reference to the result, valid whilst the SearchResultSet holds its page
+   */
+  MLCLIENT_API const SearchResult& operator*() const;
+  /**
+   * \brief The member access operator, for the SearchResult at the current position in the SearchResultSet
+   *
+   * \test SearchResultSetTest::testRangeFor
+   *
+   * \since 8.0.3
    */
-  MLCLIENT_API const SearchResult operator*();
+  MLCLIENT_API const SearchResult* operator->() const;
   /**
    * \brief Copy assignment operator
    *
@@ -261,7 +607,7 @@ public:
    *
    * \param other The other iterator to copy state from
    */
-  MLCLIENT_API SearchResultSetIterator operator=(const SearchResultSetIterator& other);
+  MLCLIENT_API SearchResultSetIterator& operator=(const SearchResultSetIterator& other);
 
   /**
    * \brief Returns the result at the current iterator position
@@ -12,6 +12,9 @@
 #include <mlclient/ValuesResult.hpp>
 #include <mlclient/Connection.hpp>
 
+#include <cstddef>
+#include <iterator>
+
 namespace mlclient {
 
 class ValuesIterator; // forward declaration - see end of file
@@ -65,6 +68,25 @@ public:
    */
   MLCLIENT_API ValuesIterator* end();
 
+  /**
+   * \brief Returns an iterator, by value, at the first values result. Waits for all lookups to complete.
+   * \since 8.0.3
+   */
+  MLCLIENT_API const_iterator cbegin() const;
+  /**
+   * \brief Returns an iterator, by value, one past the last values result
+   * \since 8.0.3
+   */
+  MLCLIENT_API const_iterator cend() const;
+  /**
+   * \brief Returns cbegin() and cend() as a pair, for use in a range based for loop
+   *
+   * for (const ValuesResult& result : vrs.items()) { ... }
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API IteratorRange<const_iterator> items() const;
+
   /**
    * \brief Uses the provided Connection to perform a request, and initialise this object and the list of values results.
    *
@@ -92,11 +114,11 @@ private:
 };
 
 /**
- * \brief Provides an STL compliant iterator implementation over a ValuesResultSet
+ * \brief Provides an STL input iterator over a ValuesResultSet
  *
- * \warning Not quite STL compliant - it returns pointers rather than references. This
- * should be fixed in 8.0.3. In particular in your loop you need to have this as your comparison:
- * (*iter) != (*(myresultset::end())) and for the increment operator: ++(*iter)
+ * ValuesResultSet::cbegin(), cend() and items() return these by value, for use in range based for loops.
+ * ValuesResultSet::begin() and end() still return pointers for the SWIG bindings. With those your loop needs this
+ * comparison: (*iter) != (*(myresultset::end())) and this increment: ++(*iter)
  *
  * See the ValuesResultSetTest class for a sample use under release/test
  *
@@ -104,6 +126,12 @@ private:
  */
 class ValuesIterator {
 public:
+  typedef std::input_iterator_tag iterator_category;
+  typedef ValuesResult value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const ValuesResult* pointer;
+  typedef const ValuesResult& reference;
+
   /**
    * \brief Default Constructor
    */
@@ -136,28 +164,40 @@ public:
    * \param other The ValuesIterator to compare this instance against
    * \return True if the iterators have the same position
    */
-  MLCLIENT_API bool operator==(const ValuesIterator& other);
+  MLCLIENT_API bool operator==(const ValuesIterator& other) const;
   /**
    * \brief Whether this instance is NOT the 'same' (same position value) as the other instance
    * \param other The ValuesIterator to compare this instance against
    * \return True if the iterators do not have the same position
    */
-  MLCLIENT_API bool operator!=(const ValuesIterator& other);
+  MLCLIENT_API bool operator!=(const ValuesIterator& other) const;
   /**
    * \brief increments this iterator instance's position
+   * \return This iterator, at its new position
    */
-  MLCLIENT_API void operator++();
+  MLCLIENT_API ValuesIterator& operator++();
   /**
-   * \brief Returns a pointer to the ValuesResult at the current position in the set
+   * \brief post increments this iterator instance's position
+   * \return A copy of this iterator at its position before the increment
+   * \since 8.0.3
+   */
+  MLCLIENT_API ValuesIterator operator++(int);
+  /**
+   * \brief Returns a reference to the ValuesResult at the current position in the set
    * \return The ValuesResult at this position
    */
-  MLCLIENT_API const ValuesResult operator*();
+  MLCLIENT_API const ValuesResult& operator*() const;
+  /**
+   * \brief Returns a pointer to the ValuesResult at the current position in the set
+   * \since 8.0.3
+   */
+  MLCLIENT_API const ValuesResult* operator->() const;
   /**
    * \brief copy assignment operator
    * \param other The ValuesIterator to copy
    * \return The current ValuesIterator instance
    */
-  MLCLIENT_API ValuesIterator operator=(const ValuesIterator& other);
+  MLCLIENT_API ValuesIterator& operator=(const ValuesIterator& other);
 
   /**
    * \brief Returns the first ValuesResult in the result set
@@ -34,6 +34,8 @@
 
 namespace mlclient {
 
+class IResponseBodyHandler; // fwd declaration - see Connection.hpp
+
 namespace internals {
 
 const mlclient::HttpHeaders blankHeaders;
@@ -99,6 +101,23 @@ public:
       const std::string& path,
       const IDocumentContent& body,
       const mlclient::HttpHeaders& headers = blankHeaders);
+  /**
+   * \brief A Synchronous HTTP POST whose 200 OK response body is passed to the handler as it is read
+   *
+   * Any other response body is set as the Response content, as for postSync().
+   *
+   * \param[in] host The hostname or IP Address to communicate with
+   * \param[in] path The URL path (E.g. /v1/search) to invoke
+   * \param[in] body The content to send as the POST body
+   * \param[in] handler Receives each chunk of a 200 OK response body. In, but not OWNS.
+   * \param[in\ headers The HTTP Headers to use (Optional. Defaults to a blank set of headers)
+   * \return A Response pointer that the call is responsible for deleting
+   */
+  Response* postStreamed(const std::string& host,
+      const std::string& path,
+      const IDocumentContent& body,
+      IResponseBodyHandler& handler,
+      const mlclient::HttpHeaders& headers = blankHeaders);
   /**
    * \brief A Synchronous HTTP POST with multi part MIME content
    *
@@ -140,12 +159,16 @@ public:
 private:
    AuthenticatingProxy(const AuthenticatingProxy& rhs); // hide copy constructor - not a valid operation
 
-   void buildBulkPayload(const DocumentSet& set,const long startIdx,const long endIdx, std::ostringstream& out);
+   /* Appends the multipart body for the documents from startIdx to endIdx inclusive to out */
+   void buildBulkPayload(const DocumentSet& set,const long startIdx,const long endIdx, std::string& out);
 
    /* Copies Microsoft CPPREST headers to useful mlclient::HttpHeaders class */
    static void copyHeaders(const web::http::http_headers& from, mlclient::HttpHeaders& to);
 
-   Response* doRequest(const std::string& mthd,const std::string& host,const std::string& path,const HttpHeaders& headers,const IDocumentContent* body = nullptr);
+   Response* doRequest(const std::string& mthd,const std::string& host,const std::string& path,const HttpHeaders& headers,const IDocumentContent* body = nullptr,IResponseBodyHandler* handler = nullptr);
+
+   /* Sets the body as the response content, or passes it to the handler in chunks if there is one and the response is 200 OK */
+   static void readBody(web::http::http_response& from, Response& to, IResponseBodyHandler* handler);
 
    Credentials credentials;
    uint32_t attempts;
@@ -57,6 +57,31 @@ typedef std::vector<std::string> StringList;
   {
     return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
   }
+
+  /**
+   * \brief A begin and end iterator pair, each held by value, for use in range based for loops
+   *
+   * Returned by SearchResultSet::items() and ValuesResultSet::items(), whose begin() and end() return pointers
+   * for the SWIG bindings.
+   *
+   * \since 8.0.3
+   */
+  template<typename Iter>
+  class IteratorRange {
+  public:
+    IteratorRange(Iter first,Iter last) : mBegin(first), mEnd(last) {
+      ;
+    }
+    Iter begin() const {
+      return mBegin;
+    }
+    Iter end() const {
+      return mEnd;
+    }
+  private:
+    Iter mBegin;
+    Iter mEnd;
+  };
 } // end namespace mlclient
 
 #endif /* defined(MLCLIENT_HPP) */
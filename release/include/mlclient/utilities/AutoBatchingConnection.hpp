@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file AutoBatchingConnection.hpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ * \since 8.0.3
+ */
+
+#ifndef INCLUDE_MLCLIENT_UTILITIES_AUTOBATCHINGCONNECTION_HPP_
+#define INCLUDE_MLCLIENT_UTILITIES_AUTOBATCHINGCONNECTION_HPP_
+
+#include <mlclient/mlclient.hpp>
+#include <mlclient/Connection.hpp>
+#include <mlclient/Document.hpp>
+#include <mlclient/DocumentContent.hpp>
+#include <mlclient/DocumentSet.hpp>
+#include <mlclient/Response.hpp>
+
+#include <future>
+#include <memory>
+#include <string>
+
+namespace mlclient {
+
+namespace utilities {
+
+/**
+ * \brief An IConnection wrapper that combines individual document saves in to multi document batches
+ *
+ * saveDocument() and saveDocumentContent() calls are buffered and sent by a background thread as a single
+ * IConnection::saveDocuments() call (one multipart POST to /v1/documents) once any of these is reached:-
+ *  - maxDocuments documents are buffered
+ *  - maxBytes bytes of content are buffered
+ *  - lingerMillis milliseconds have passed since the oldest buffered document was added
+ *
+ * Each call receives its own Response, with the batch's response code and headers, and a body holding only its
+ * own document's entry. Calls from many threads are therefore combined in to one HTTP round trip. A single threaded caller should use saveDocumentAsync() or setWriteBehind(true), else
+ * each call waits for its batch and gains nothing.
+ *
+ * Saves of the same URI buffered in one batch are combined, and the last one is sent. Every one of those
+ * calls receives the result of the write that was sent. If the server rejects a batch, each of its documents
+ * is resent on its own, so a bad document only fails its own caller.
+ *
+ * All other IConnection calls flush buffered saves first and then delegate to the wrapped connection, so reads
+ * always see earlier saves made through this instance.
+ *
+ * \note Content and properties are copied when a save is buffered, so the caller may reuse or change them at once.
+ * A GenericTextDocumentContent's text is shared rather than copied, as a change to it replaces the text.
+ *
+ * \since 8.0.3
+ */
+class AutoBatchingConnection : public IConnection {
+public:
+  /**
+   * \brief Wraps the given connection
+   *
+   * \param wrapped The connection used to send batches and all other calls. In, but not OWNS.
+   */
+  MLCLIENT_API AutoBatchingConnection(IConnection* wrapped);
+  MLCLIENT_API AutoBatchingConnection(const AutoBatchingConnection& other) = delete;
+  /**
+   * \brief Sends any buffered saves, waits for them to complete, then stops the background thread
+   */
+  MLCLIENT_API virtual ~AutoBatchingConnection();
+
+  /// \name auto_batching Auto batching functions
+  // @{
+
+  /**
+   * \brief Sets when buffered saves are sent
+   *
+   * \note Defaults to 100 documents, 1 MB of content, and a 10 millisecond linger time.
+   *
+   * \param maxDocuments Send once this many documents are buffered. Callers wait whilst the buffer is this full.
+   * \param maxBytes Send once this much content, in bytes, is buffered
+   * \param lingerMillis Send once the oldest buffered document has waited this long. 0 sends as soon as the
+   * background thread is free.
+   */
+  MLCLIENT_API void setFlushParameters(const long maxDocuments,const long maxBytes,const long lingerMillis);
+  MLCLIENT_API const long getMaxDocuments() const;
+  MLCLIENT_API const long getMaxBytes() const;
+  MLCLIENT_API const long getLingerMillis() const;
+
+  /**
+   * \brief Sets whether saveDocument() and saveDocumentContent() return before their batch is sent
+   *
+   * When true these return a Response with ResponseCode::ACCEPTED as soon as the document is buffered.
+   * Failures are then only reported by getFailedSaves() and the debug log. Defaults to false.
+   *
+   * \param writeBehind Whether to return before the batch is sent
+   */
+  MLCLIENT_API void setWriteBehind(const bool writeBehind);
+  MLCLIENT_API const bool isWriteBehind() const;
+
+  /**
+   * \brief Buffers a document for saving, returning a future for its Response
+   *
+   * \param doc The document to save. Its content and properties are copied.
+   * \return A future for this document's Response. The future holds the exception if the batch could not be sent.
+   */
+  MLCLIENT_API std::future<std::unique_ptr<Response>> saveDocumentAsync(const Document& doc);
+  /**
+   * \brief Buffers document content for saving at the given URI, returning a future for its Response
+   *
+   * \param uri The document URI
+   * \param payload The content to save. Copied.
+   * \return A future for this document's Response. The future holds the exception if the batch could not be sent.
+   */
+  MLCLIENT_API std::future<std::unique_ptr<Response>> saveDocumentContentAsync(const std::string& uri,
+      const IDocumentContent& payload);
+
+  /**
+   * \brief Sends all buffered saves now and waits for them to complete
+   */
+  MLCLIENT_API void flush();
+
+  /**
+   * \brief Returns the number of buffered saves whose batch failed, by exception or a non 2xx response code
+   */
+  MLCLIENT_API const long getFailedSaves() const;
+  /**
+   * \brief Returns the number of batches sent so far
+   */
+  MLCLIENT_API const long getBatchesSent() const;
+
+  // @}
+
+  /// \name batched_saves Batched IConnection functions
+  // @{
+
+  /**
+   * \brief Buffers the document, then waits for its batch unless write behind is enabled. See IConnection.
+   *
+   * \note The Response is that of the whole multipart POST, not of a single document PUT.
+   */
+  MLCLIENT_API Response* saveDocument(const Document& doc) override;
+  /**
+   * \brief Buffers the content, then waits for its batch unless write behind is enabled. See IConnection.
+   *
+   * \note The Response is that of the whole multipart POST, not of a single document PUT.
+   */
+  MLCLIENT_API Response* saveDocumentContent(const std::string& uri,const IDocumentContent& payload) override;
+
+  // @}
+
+  /// \name delegated Delegated IConnection functions. Each flushes buffered saves first, except where noted.
+  // @{
+
+  MLCLIENT_API void configure(const std::string& hostname, const std::string& port, const std::string& username,
+      const std::string& password, const bool usessl = false) override;
+  MLCLIENT_API bool connect() override;
+  MLCLIENT_API void disconnect() override;
+  MLCLIENT_API void setDatabaseName(const std::string& db) override;
+  /**
+   * \brief Does not flush
+   */
+  MLCLIENT_API std::string getDatabaseName() override;
+
+  MLCLIENT_API Response* doGet(const std::string& pathAndQuerystring) override;
+  MLCLIENT_API Response* doPut(const std::string& pathAndQuerystring,const IDocumentContent& payload) override;
+  MLCLIENT_API Response* doPost(const std::string& pathAndQuerystring,const IDocumentContent& payload) override;
+  MLCLIENT_API Response* doDelete(const std::string& pathAndQueryString) override;
+
+  MLCLIENT_API Response* getDocument(const std::string& uri) override;
+  MLCLIENT_API Response* getDocument(Document& inout_document) override;
+  MLCLIENT_API Response* getDocumentContent(Document& inout_document) override;
+  MLCLIENT_API Response* getDocumentProperties(Document& inout_document) override;
+  MLCLIENT_API Response* getDocumentPermissions(Document& inout_document) override;
+  MLCLIENT_API Response* getDocuments(const DocumentUriSet& uris,const long startPosInclusive,
+      const long endPosInclusive) override;
+  MLCLIENT_API Response* saveDocuments(const DocumentSet& documents,const long startPosInclusive,
+      const long endPosInclusive) override;
+  MLCLIENT_API Response* saveDocumentsToForest(const DocumentSet& documents,const long startPosInclusive,
+      const long endPosInclusive,const std::string& forestName) override;
+  MLCLIENT_API Response* deleteDocument(const std::string& uri) override;
+
+  MLCLIENT_API Response* search(const SearchDescription& desc) override;
+  /**
+   * \note The wrapped connection is held whilst the handler runs, so the handler must not call this instance
+   */
+  MLCLIENT_API Response* searchStreamed(const SearchDescription& desc,IResponseBodyHandler& handler) override;
+  MLCLIENT_API Response* searchExtension(const std::string& extensionName,const SearchDescription& desc) override;
+  MLCLIENT_API Response* saveSearchOptions(const std::string& optionsName,const IDocumentContent* optionsDoc) override;
+  MLCLIENT_API Response* values(const std::string& valuesName,const std::string& optionsName) override;
+  MLCLIENT_API Response* valuesExtension(const std::string& extensionName,const std::string& valuesName,
+      const std::string& optionsName,const SearchDescription& desc) override;
+  MLCLIENT_API Response* listRootCollections() override;
+  MLCLIENT_API Response* listCollections(const std::string& parentCollection) override;
+
+  // @}
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> mImpl;
+};
+
+} // end namespace utilities
+
+} // end namespace mlclient
+
+#endif /* INCLUDE_MLCLIENT_UTILITIES_AUTOBATCHINGCONNECTION_HPP_ */
@@ -79,6 +79,9 @@ public:
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API IDocumentNode* at(const int32_t idx) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const int32_t idx) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
 
   MLCLIENT_API StringList keys() const override;
   MLCLIENT_API int32_t size() const override;
@@ -110,6 +113,9 @@ public:
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API IDocumentNode* at(const int32_t idx) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const int32_t idx) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
 
   MLCLIENT_API StringList keys() const override;
   MLCLIENT_API int32_t size() const override;
@@ -154,6 +160,9 @@ public:
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API IDocumentNode* at(const int32_t idx) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const int32_t idx) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
 
   MLCLIENT_API StringList keys() const override;
   MLCLIENT_API int32_t size() const override;
@@ -182,6 +191,8 @@ public:
   MLCLIENT_API IDocumentNode* firstChild() const override;
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
 
 private:
   class Impl; // forward declaration
@@ -226,7 +237,8 @@ public:
    *
    * This allows streaming to a HTTP request of this string content.
    *
-   * \note The stream may be read from asynchronously, so do not destroy the underlying content after returning the stream.
+   * \note The stream shares the serialised text, so may be read from asynchronously, even after this content is
+   * changed or deleted.
    *
    * \return An istream instance wrapping the content of this Text Document Content instance
    */
@@ -244,10 +256,19 @@ public:
   /**
    * \brief Returns the content as a string
    *
+   * The value is serialised on the first call after it changes, and the text kept for getStream(), getLength() and
+   * later calls.
+   *
    * \return The string representation of the content.
    */
   MLCLIENT_API std::string getContent() const override;
 
+  /**
+   * \brief Views the serialised text in place. Shares it, so remains valid after the content is changed or deleted.
+   */
+  MLCLIENT_API ContentView contentView() const override;
+  MLCLIENT_API size_t size() const override;
+
   /**
    * \brief Returns the MIME type of this content.
    *
@@ -272,7 +293,7 @@ public:
    *
    * \note This number does not include C null characters - just std::string length
    *
-   * \return The number of characters in the string. Does not include C null character.
+   * \return The number of characters in the string. Does not include C null character. O(1) once serialised.
    */
   MLCLIENT_API int getLength() const override;
 
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file DocumentBatchExporter.hpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ * \since 8.0.3
+ */
+
+#ifndef INCLUDE_MLCLIENT_UTILITIES_DOCUMENTBATCHEXPORTER_HPP_
+#define INCLUDE_MLCLIENT_UTILITIES_DOCUMENTBATCHEXPORTER_HPP_
+
+#include <mlclient/DocumentSet.hpp>
+#include <mlclient/Connection.hpp>
+#include <mlclient/SearchDescription.hpp>
+#include <mlclient/utilities/DocumentBatchWriter.hpp>
+#include <mlclient/utilities/QueryBatcher.hpp>
+
+#include <mlclient/mlclient.hpp>
+
+#include <memory>
+#include <string>
+
+namespace mlclient {
+
+namespace utilities {
+
+/**
+ * \brief Where DocumentBatchExporter writes the documents it reads
+ * \since 8.0.3
+ */
+enum class ExportFormat {
+  /** One file per document under a root folder, mapped by DocumentBatchHelper::uriToFilePath() (Default) */
+  DIRECTORY = 0,
+  /** A single archive file of length prefixed records. See DocumentBatchExporter::readArchive() */
+  ARCHIVE = 1
+};
+
+/**
+ * \brief Exports every document in a collection, or matching a query, to disk
+ *
+ * Uses a QueryBatcher to read batches in parallel. Each batch read is handed to a single writer thread over
+ * a bounded queue, so disk writes do not hold up the readers, and readers wait whilst the queue is full. At
+ * most (parallel tasks + max pending batches) batches are held in memory at any time, whatever the size of
+ * the export.
+ *
+ * The ARCHIVE format is a sequence of records, each being:-
+ *  - uint32 URI length, then the URI bytes
+ *  - uint32 MIME type length, then the MIME type bytes
+ *  - uint64 content length, then the content bytes
+ *
+ * All lengths are little endian. There is no header, so archives may be concatenated.
+ *
+ * See the cppbatchexport sample for example usage.
+ *
+ * \since 8.0.3
+ */
+class DocumentBatchExporter {
+public:
+  /**
+   * \brief Constructs an exporter that reads using the provided IConnection instance
+   * \param conn The pointer to an IConnection subclass instance. In, but not OWNS.
+   */
+  MLCLIENT_API DocumentBatchExporter(IConnection* conn);
+  /**
+   * \brief The DELETED copy constructor
+   */
+  MLCLIENT_API DocumentBatchExporter(const DocumentBatchExporter& other) = delete;
+  /**
+   * \brief Stops and waits for the readers and writer, then destroys this instance
+   */
+  MLCLIENT_API ~DocumentBatchExporter();
+
+  /**
+   * \brief Exports every document matching the given search
+   * \param desc The SearchDescription to match documents with. Copied.
+   */
+  MLCLIENT_API void setQuery(const SearchDescription& desc);
+  /**
+   * \brief Exports every document in the given collection
+   * \param collection The collection URI
+   */
+  MLCLIENT_API void setCollection(const std::string& collection);
+
+  /**
+   * \brief Writes one file per document under the given folder
+   *
+   * \param folder The root folder. Created if it does not exist.
+   * \param appendBase The URI prefix to strip from each URI. Pass the same value to
+   * DocumentBatchHelper::addFilesToDocumentSet() to reload the export to the same URIs.
+   */
+  MLCLIENT_API void setDirectoryTarget(const std::string& folder,const std::string& appendBase);
+  /**
+   * \brief Writes all documents to a single archive file, replacing any existing file
+   *
+   * \param archive The archive file path
+   */
+  MLCLIENT_API void setArchiveTarget(const std::string& archive);
+  MLCLIENT_API const ExportFormat getFormat() const;
+
+  /**
+   * \brief Sets the read parameters for this export. See QueryBatcher::setBatchParameters().
+   *
+   * \param parallelTasks The number of parallel reader tasks
+   * \param batchSize The number of documents per batch
+   * \param maxRetries The number of times a failed batch read is retried
+   */
+  MLCLIENT_API void setBatchParameters(const int parallelTasks,const int batchSize,const int maxRetries);
+  /**
+   * \brief Sets the maximum number of read batches waiting to be written before readers pause. Defaults to 4.
+   *
+   * \param maxPending The queue capacity, in batches. Minimum 1.
+   */
+  MLCLIENT_API void setMaxPendingBatches(const int maxPending);
+  MLCLIENT_API const int getMaxPendingBatches() const;
+
+  /**
+   * \brief Begins the export
+   *
+   * \throws std::runtime_error if no target has been set, or the archive file cannot be opened
+   */
+  MLCLIENT_API void send();
+  /**
+   * \brief Cancels the export. Batches already read are still written.
+   */
+  MLCLIENT_API void stop();
+  /**
+   * \brief Causes the calling thread to wait for all reads and writes to finish
+   */
+  MLCLIENT_API void wait();
+
+  /**
+   * \brief Have all matching documents been read and written?
+   */
+  MLCLIENT_API const bool isFinished() const;
+  /**
+   * \brief Returns the number of documents written to disk so far
+   */
+  MLCLIENT_API const long getWrittenDocuments() const;
+  /**
+   * \brief Returns the number of documents that could not be read or written
+   */
+  MLCLIENT_API const long getFailedDocuments() const;
+  /**
+   * \brief Returns the read progress of this export. See QueryBatcher::getProgress().
+   */
+  MLCLIENT_API const Progress getProgress() const;
+
+  /**
+   * \brief Reads all documents from an archive written in the ARCHIVE format
+   *
+   * Each document's content is a GenericTextDocumentContent, owned by the caller.
+   *
+   * \param archive The archive file path
+   * \param addTo The DocumentSet to append the documents to
+   * \return The number of documents read
+   * \throws std::runtime_error if the file cannot be opened or a record is truncated
+   */
+  MLCLIENT_API static long readArchive(const std::string& archive,DocumentSet& addTo);
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> mImpl;
+};
+
+} // end namespace utilities
+
+} // end namespace mlclient
+
+#endif /* INCLUDE_MLCLIENT_UTILITIES_DOCUMENTBATCHEXPORTER_HPP_ */
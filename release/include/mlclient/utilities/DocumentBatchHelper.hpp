@@ -52,6 +52,24 @@ public:
       const CollectionSet& collections,const PermissionSet& permissions,IDocumentContent* properties,DocumentSet& addTo,
       bool showHiddenDirs = false);
 
+  /**
+   * \brief Returns the file path a document URI maps to when exporting to a folder
+   *
+   * The inverse of the mapping used by addFilesToDocumentSet() with stripBase set to true, so a folder
+   * exported with the same appendBase can be reloaded to the same URIs. If the URI does not start with
+   * appendBase the whole URI is used as the relative path.
+   *
+   * See the cppbatchexport sample for example usage.
+   *
+   * \param uri The document URI
+   * \param folder The root export folder
+   * \param appendBase The URI prefix that was passed to addFilesToDocumentSet()
+   * \return The file path, or a blank string if the URI contains a '..' path segment and so cannot be safely written
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API static std::string uriToFilePath(const std::string& uri,const std::string& folder,const std::string& appendBase);
+
 };
 
 } // end namespace utilities
@@ -23,9 +23,13 @@
 #include <mlclient/DocumentSet.hpp>
 #include <mlclient/Document.hpp>
 #include <mlclient/Connection.hpp>
+#include <mlclient/utilities/ForestTopology.hpp>
 
 #include <mlclient/mlclient.hpp>
 
+#include <exception>
+#include <string>
+
 namespace mlclient {
 
 namespace utilities {
@@ -38,6 +42,20 @@ enum class TransactionMode {
   PER_RECORD,PER_BATCH,ALL
 };
 
+/**
+ * \brief Represents how DocumentBatchWriter chooses the host each batch is sent to. Defaults to SINGLE_HOST
+ *
+ * SINGLE_HOST sends every batch through the connection given to the DocumentBatchWriter constructor.
+ * HOST_AFFINITY assigns each document a forest on the client, sends each batch directly to the host owning
+ * that forest, and names the forest on the write (the forest-name parameter) so the server does not move the
+ * documents on to a forest of its own choosing.
+ *
+ * \since 8.0.3
+ */
+enum class AssignmentMode {
+  SINGLE_HOST,HOST_AFFINITY
+};
+
 /**
  * \brief The progress of the upload within DocumentBatchWriter
  * \since 8.0.2
@@ -51,9 +69,95 @@ struct Progress {
   double rate;
 };
 
+/**
+ * \brief The order in which DocumentBatchWriter delivers batch events to its listeners. Defaults to UNORDERED
+ *
+ * UNORDERED delivers each event as soon as its batch completes. ORDERED holds events back until all
+ * earlier batches (by position in the DocumentSet) have been delivered.
+ *
+ * \since 8.0.3
+ */
+enum class NotificationMode {
+  UNORDERED,ORDERED
+};
+
+/**
+ * \brief The outcome of a single batch written by DocumentBatchWriter
+ *
+ * Move only. The event is built once on the upload task and handed to the notifier thread without
+ * copying its URI list.
+ *
+ * \since 8.0.3
+ */
+class BatchEvent {
+public:
+  /**
+   * \brief Creates a blank, successful event
+   */
+  MLCLIENT_API BatchEvent();
+  /**
+   * \brief Creates an event for the given batch
+   *
+   * \param sequence The zero based position of this batch within the DocumentSet
+   * \param uris The URIs processed by this batch. Moved from.
+   * \param success Whether all documents in the batch were written
+   * \param problem The exception raised by the batch, if any. May be empty.
+   */
+  MLCLIENT_API BatchEvent(long sequence,DocumentUriSet&& uris,bool success,std::exception_ptr problem);
+  /**
+   * \brief The DELETED copy constructor
+   */
+  MLCLIENT_API BatchEvent(const BatchEvent& other) = delete;
+  /**
+   * \brief The DELETED copy assignment operator
+   */
+  MLCLIENT_API BatchEvent& operator=(const BatchEvent& other) = delete;
+  /**
+   * \brief Move constructor
+   */
+  MLCLIENT_API BatchEvent(BatchEvent&& other);
+  /**
+   * \brief Move assignment operator
+   */
+  MLCLIENT_API BatchEvent& operator=(BatchEvent&& other);
+  MLCLIENT_API ~BatchEvent() = default;
+
+  /**
+   * \brief Returns the zero based position of this batch within the DocumentSet
+   */
+  MLCLIENT_API long getSequence() const;
+  /**
+   * \brief Returns the URIs processed by this batch (not necessarily succeeded in uploading)
+   */
+  MLCLIENT_API const DocumentUriSet& getUris() const;
+  /**
+   * \brief Returns whether all documents in this batch were written
+   */
+  MLCLIENT_API bool isSuccess() const;
+  /**
+   * \brief Returns the exception raised by this batch, or an empty exception_ptr
+   */
+  MLCLIENT_API std::exception_ptr getProblem() const;
+  /**
+   * \brief Returns the message of the exception raised by this batch, or a blank string
+   */
+  MLCLIENT_API const std::string& getMessage() const;
+
+private:
+  long sequence;
+  DocumentUriSet uris;
+  bool success;
+  std::exception_ptr problem;
+  std::string message;
+};
+
 /**
  * \brief An abstract class that supports notification when a Document (batch) action is completed
  *
+ * Events are delivered on the DocumentBatchWriter's notifier thread, never on an upload task. Override
+ * batchEventComplete to receive events without copying the URI list. The default implementation calls
+ * batchOperationComplete for existing listeners.
+ *
  * \note Can be subclassed directly in other wrappers (E.g. C#)
  *
  * \since 8.0.2
@@ -71,7 +175,16 @@ public:
    * \param success Whether all files were uploaded
    * \param problem The exception thrown by one of the batch upload attempts, if success is false
    */
-  MLCLIENT_API virtual void batchOperationComplete(const DocumentUriSet out_uris,bool success,std::exception problem) = 0;
+  MLCLIENT_API virtual void batchOperationComplete(const DocumentUriSet out_uris,bool success,std::exception problem);
+
+  /**
+   * \brief Receives a complete event from the DocumentBatchWriter class, by reference
+   *
+   * \since 8.0.3
+   *
+   * \param event The batch event. Only valid for the duration of this call.
+   */
+  MLCLIENT_API virtual void batchEventComplete(const BatchEvent& event);
 };
 
 /**
@@ -142,6 +255,37 @@ public:
    */
   MLCLIENT_API const TransactionMode getMode() const;
 
+  /**
+   * \brief Sets how batches are routed to hosts in the cluster
+   *
+   * In HOST_AFFINITY mode the topology is read once, at send(). Each document is assigned a forest by
+   * IForestTopology::assignForest, and each batch only contains documents for a single forest. A batch is
+   * sent through the connection for the host owning its forest, with IConnection::saveDocumentsToForest,
+   * so the server writes it to that forest. Batches for different forests are interleaved so parallel
+   * tasks spread their load across the cluster.
+   *
+   * \note If the topology cannot be read, or lists no forests, all batches are sent through the default
+   * connection as in SINGLE_HOST mode.
+   *
+   * \note Must be called before send(). The documents assigned to this writer are reordered by forest.
+   *
+   * \since 8.0.3
+   *
+   * \param mode The assignment mode to use
+   * \param topology The forest topology of the target database. In, but not OWNS. Required for HOST_AFFINITY.
+   * \param provider Supplies a connection per host. In, but not OWNS. Required for HOST_AFFINITY.
+   */
+  MLCLIENT_API void setAssignmentParameters(const AssignmentMode& mode,IForestTopology* topology,
+      IHostConnectionProvider* provider);
+  /**
+   * \brief Returns the assignment mode in use
+   *
+   * \since 8.0.3
+   *
+   * \return The AssignmentMode in use
+   */
+  MLCLIENT_API const AssignmentMode getAssignmentMode() const;
+
   /**
    * \brief Adds a listener for batch events
    *
@@ -155,6 +299,34 @@ public:
    */
   MLCLIENT_API void removeBatchListener(IBatchNotifiable* notifiable);
 
+  /**
+   * \brief Sets how batch events are queued for, and delivered to, listeners
+   *
+   * Listeners are called on a dedicated notifier thread. Upload tasks only ever add an event to its queue.
+   * If the queue is full because listeners are slower than the upload, upload tasks wait for space
+   * rather than holding an unbounded number of events in memory.
+   *
+   * \note Defaults to a queue of 64 events with UNORDERED delivery. Must be called before send().
+   *
+   * \since 8.0.3
+   *
+   * \param queueSize The maximum number of undelivered events held (minimum 1)
+   * \param mode Whether events are delivered in completion order or DocumentSet order
+   */
+  MLCLIENT_API void setNotificationParameters(const long queueSize,const NotificationMode& mode);
+  /**
+   * \brief Returns the maximum number of undelivered events held
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const long getNotificationQueueSize() const;
+  /**
+   * \brief Returns the event delivery order
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API const NotificationMode getNotificationMode() const;
+
   /**
    * \brief Begins the batch operation
    *
@@ -172,6 +344,8 @@ public:
    * \brief Causes the calling thread to wait for the completion of all batches assigned to all parallel tasks
    *
    * Useful for simple synchronous batch updates
+   *
+   * \note Also waits for all batch events to be delivered to listeners
    */
   MLCLIENT_API void wait() const;
 
@@ -24,11 +24,26 @@
 #include <mlclient/Document.hpp>
 #include <mlclient/Response.hpp>
 #include <mlclient/DocumentContent.hpp>
+#include <mlclient/DocumentSet.hpp>
+
+#include <memory>
+#include <string>
 
 namespace mlclient {
 
 namespace utilities {
 
+/**
+ * \brief Which IDocumentContent implementation DocumentHelper parses JSON responses with
+ * \since 8.0.3
+ */
+enum class JsonBackend {
+  /** CppRestJsonDocumentContent, which supports CppRestJsonDocumentContent::getJson() (Default) */
+  CPPREST = 0,
+  /** NativeJsonDocumentContent, which parses UTF-8 directly and is read only */
+  NATIVE = 1
+};
+
 /**
  * \brief Helper methods to work with Document and IDocumentContent instances
  * \since 8.0.2
@@ -74,6 +89,103 @@ public:
    * \return An IDocumentContent* instance created from the Response.
    */
   MLCLIENT_API static IDocumentContent* contentFromResponse(const Response& resp);
+
+  /**
+   * \brief As contentFromResponse(), but takes the body from the Response rather than copying it
+   *
+   * XML is parsed in place. See PugiXmlHelper::toDocumentInPlace(). Use this when the Response is discarded
+   * after its content is read.
+   *
+   * \since 8.0.3
+   *
+   * \throw InvalidFormatException if the Response does not have a mime type of application/xml or application/json or plain/text, or if a parsing error occurs.
+   *
+   * \param resp The MarkLogic C++ API Response object instance. Its content is empty after this call, except for
+   * JSON with the CPPREST backend.
+   * \return An IDocumentContent* instance created from the Response.
+   */
+  MLCLIENT_API static IDocumentContent* takeContentFromResponse(Response& resp);
+
+  /**
+   * \brief Sets which implementation JSON responses are parsed in to, for every later contentFromResponse() and
+   * takeContentFromResponse() call in this process. Also used by SearchResultSet.
+   *
+   * \note Code that casts JSON content to CppRestJsonDocumentContent must keep the CPPREST default.
+   *
+   * \since 8.0.3
+   *
+   * \param backend The JSON implementation to use
+   */
+  MLCLIENT_API static void setJsonBackend(const JsonBackend backend);
+  MLCLIENT_API static JsonBackend getJsonBackend();
+
+  /**
+   * \brief Appends a Document to the set for each part of a multipart/mixed Response
+   *
+   * Used with the Response from IConnection::getDocuments. The URI of each Document is taken from the filename
+   * in the Content-Disposition header of each part, and its content and mime type from the part body and
+   * Content-Type header. Content is held as GenericTextDocumentContent.
+   *
+   * \throw InvalidFormatException if the Response is not multipart, or has no boundary.
+   *
+   * \since 8.0.3
+   *
+   * \param resp The MarkLogic C++ API Response object instance.
+   * \param out The DocumentSet to append Documents to
+   * \return The number of Documents appended
+   */
+  MLCLIENT_API static long fromMultipartResponse(const Response& resp,DocumentSet& out);
+
+  /**
+   * \brief Returns the string value of a named child, freeing the node at() allocates for it
+   *
+   * \since 8.0.3
+   *
+   * \param node The IDocumentNode or IDocumentNavigator to look in
+   * \param key The child element or property name
+   * \return The child's string value
+   * \throws InvalidFormatException, or the parser's exception, if the child does not exist or is the wrong type
+   */
+  template <typename N>
+  static std::string stringAt(const N& node,const std::string& key) {
+    std::unique_ptr<IDocumentNode> child(node.at(key));
+    return child->asString();
+  }
+
+  /**
+   * \brief Returns the integer value of a named child, freeing the node at() allocates for it
+   *
+   * \since 8.0.3
+   */
+  template <typename N>
+  static long integerAt(const N& node,const std::string& key) {
+    std::unique_ptr<IDocumentNode> child(node.at(key));
+    return child->asInteger();
+  }
+
+  /**
+   * \brief Returns the double value of a named child, freeing the node at() allocates for it
+   *
+   * \since 8.0.3
+   */
+  template <typename N>
+  static double doubleAt(const N& node,const std::string& key) {
+    std::unique_ptr<IDocumentNode> child(node.at(key));
+    return child->asDouble();
+  }
+
+  /**
+   * \brief Takes ownership of a node returned by at(), and returns its object value
+   *
+   * asObject() returns the node itself for object nodes, but a new node for other nodes. This keeps whichever is
+   * returned and frees the other.
+   *
+   * \since 8.0.3
+   *
+   * \param own_node The node. OWNED by this function.
+   * \return The object value. May be empty if the node has no object value.
+   */
+  MLCLIENT_API static std::shared_ptr<IDocumentNode> objectOf(IDocumentNode* own_node);
 };
 
 } // end namespace utilities
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file DocumentMapping.hpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ * \since 8.0.3
+ * \brief Provides a compile time mapping between JSON or XML documents and C++ structs
+ */
+
+#ifndef INCLUDE_MLCLIENT_UTILITIES_DOCUMENTMAPPING_HPP_
+#define INCLUDE_MLCLIENT_UTILITIES_DOCUMENTMAPPING_HPP_
+
+#include <mlclient/mlclient.hpp>
+#include <mlclient/DocumentContent.hpp>
+#include <mlclient/InvalidFormatException.hpp>
+#include <mlclient/Response.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace mlclient {
+
+namespace utilities {
+
+/**
+ * \brief The kind of a single value read from a document, before conversion to a struct member's type
+ *
+ * \since 8.0.3
+ */
+enum class MappedValueType : int {
+  STRING = 0, ///< A JSON string, or XML element or attribute text
+  NUMBER = 1, ///< A JSON number, as its original text
+  BOOLEAN = 2, ///< A JSON boolean. The text is true or false.
+  NUL = 3 ///< A JSON null. The text is empty.
+};
+
+/**
+ * \brief Converts a value read from a document to a struct member's type. Used by StructMapping.
+ *
+ * Overload these for further member types. A std::vector member has each value at its path appended.
+ *
+ * \throw InvalidFormatException if the value cannot be converted, E.g. text that is not a number for a numeric member
+ *
+ * \since 8.0.3
+ */
+MLCLIENT_API void readMappedValue(std::string& to,const MappedValueType type,const std::string& text);
+MLCLIENT_API void readMappedValue(bool& to,const MappedValueType type,const std::string& text);
+MLCLIENT_API void readMappedValue(int32_t& to,const MappedValueType type,const std::string& text);
+MLCLIENT_API void readMappedValue(int64_t& to,const MappedValueType type,const std::string& text);
+MLCLIENT_API void readMappedValue(double& to,const MappedValueType type,const std::string& text);
+
+template <typename V>
+void readMappedValue(std::vector<V>& to,const MappedValueType type,const std::string& text) {
+  to.emplace_back();
+  readMappedValue(to.back(),type,text);
+}
+
+/**
+ * \brief Appends a struct member's value as a JSON value. Used by StructMapping.
+ *
+ * A std::vector member is written as a JSON array.
+ *
+ * \since 8.0.3
+ */
+MLCLIENT_API void writeMappedJson(std::string& out,const std::string& value);
+MLCLIENT_API void writeMappedJson(std::string& out,const bool value);
+MLCLIENT_API void writeMappedJson(std::string& out,const int32_t value);
+MLCLIENT_API void writeMappedJson(std::string& out,const int64_t value);
+MLCLIENT_API void writeMappedJson(std::string& out,const double value);
+
+template <typename V>
+void writeMappedJson(std::string& out,const std::vector<V>& value) {
+  out += '[';
+  for (auto iter = value.begin();iter != value.end();++iter) {
+    if (iter != value.begin()) {
+      out += ',';
+    }
+    writeMappedJson(out,*iter);
+  }
+  out += ']';
+}
+
+/**
+ * \brief Appends a struct member's value as an XML element with the given name. Used by StructMapping.
+ *
+ * A std::vector member is written as one element per member.
+ *
+ * \since 8.0.3
+ */
+MLCLIENT_API void writeMappedXml(std::string& out,const std::string& name,const std::string& value);
+MLCLIENT_API void writeMappedXml(std::string& out,const std::string& name,const bool value);
+MLCLIENT_API void writeMappedXml(std::string& out,const std::string& name,const int32_t value);
+MLCLIENT_API void writeMappedXml(std::string& out,const std::string& name,const int64_t value);
+MLCLIENT_API void writeMappedXml(std::string& out,const std::string& name,const double value);
+
+template <typename V>
+void writeMappedXml(std::string& out,const std::string& name,const std::vector<V>& value) {
+  for (auto iter = value.begin();iter != value.end();++iter) {
+    writeMappedXml(out,name,*iter);
+  }
+}
+
+/**
+ * \brief Reads and writes the fields of one struct instance by field index. Internal to StructMapping.
+ *
+ * \since 8.0.3
+ */
+class IMappedFields {
+public:
+  MLCLIENT_API virtual ~IMappedFields();
+
+  MLCLIENT_API virtual void read(const size_t field,const MappedValueType type,const std::string& text) = 0;
+  MLCLIENT_API virtual void writeJson(const size_t field,std::string& out) const = 0;
+  MLCLIENT_API virtual void writeXml(const size_t field,std::string& out,const std::string& name) const = 0;
+};
+
+/**
+ * \brief The field paths of a StructMapping, compiled in to a tree of steps. Internal to StructMapping.
+ *
+ * Holds everything that does not depend on the struct's type, so the parsers are compiled once in the library
+ * rather than in to every user of StructMapping.
+ *
+ * \since 8.0.3
+ */
+class MappingPlan {
+public:
+  MLCLIENT_API MappingPlan();
+  MLCLIENT_API MappingPlan(const MappingPlan& other);
+  MLCLIENT_API MappingPlan& operator=(const MappingPlan& other);
+  MLCLIENT_API ~MappingPlan();
+
+  /**
+   * \brief Adds the next field's path. Fields are numbered from zero in the order they are added.
+   *
+   * \throw InvalidFormatException if the path has no steps, or is already used by another field
+   */
+  MLCLIENT_API void addPath(const std::string& path);
+
+  /**
+   * \brief Parses JSON text, passing each value at a field's path to fields
+   *
+   * \throw InvalidFormatException if the text is not valid JSON, or a value cannot be converted
+   */
+  MLCLIENT_API void readJson(const char* data,const size_t length,IMappedFields& fields) const;
+
+  /**
+   * \brief Parses XML text, passing the text of each element or attribute at a field's path to fields
+   *
+   * \throw InvalidFormatException if the text is not valid XML, or a value cannot be converted
+   */
+  MLCLIENT_API void readXml(const char* data,const size_t length,IMappedFields& fields) const;
+
+  MLCLIENT_API void writeJson(std::string& out,const IMappedFields& fields) const;
+  MLCLIENT_API void writeXml(std::string& out,const std::string& rootElement,const IMappedFields& fields) const;
+
+private:
+  class Impl; // forward declaration
+  Impl* mImpl;
+};
+
+/**
+ * \brief A struct member and the path of its value within a document. Create with mapField().
+ *
+ * \since 8.0.3
+ */
+template <typename T,typename M>
+class MappedField {
+public:
+  MappedField(const std::string& p,M T::* m) : path(p), member(m) {}
+
+  std::string path;
+  M T::* member;
+};
+
+/**
+ * \brief Pairs a struct member with the path of its value within a document
+ *
+ * \param path Slash separated property or element names, relative to the JSON root object or XML root element.
+ * The last step of an XML path may name an attribute. Any prefix up to a colon is ignored, as for IDocumentNode::at().
+ * \param member The member, E.g. &Person::name
+ *
+ * \since 8.0.3
+ */
+template <typename T,typename M>
+MappedField<T,M> mapField(const std::string& path,M T::* member) {
+  return MappedField<T,M>(path,member);
+}
+
+/**
+ * \brief Reads documents directly in to a C++ struct, and writes them back, from field paths declared once
+ *
+ * Each member's type is known at compile time, so its conversion is selected then, by overloads of
+ * readMappedValue(), writeMappedJson() and writeMappedXml(). Supported member types are std::string, bool, int32_t,
+ * int64_t, double, and std::vector of any of these.
+ *
+ * No IDocumentContent, IDocumentNode or DOM is created for JSON. Its text is read once by a JsonEventParser, and
+ * only values at a field's path are converted. XML is read with pugixml's own tree, skipping the IDocumentNode layer.
+ *
+ * Values within arrays are each passed to the field. So a scalar member receives the last, and a std::vector member
+ * all of them. E.g. a path of "results/uri" reads the uri of every object in the results array.
+ *
+ * Example:-
+ * \code
+ * struct Person { std::string name; int32_t age; std::vector<std::string> tags; };
+ *
+ * static const auto personMapping = mapStruct(
+ *   mapField("name",&Person::name),
+ *   mapField("details/age",&Person::age),
+ *   mapField("tags",&Person::tags)
+ * );
+ *
+ * Person p;
+ * personMapping.fromResponse(*response,p);
+ * \endcode
+ *
+ * \note Members without a value in the document are left unchanged. Const instances may be shared by threads.
+ *
+ * \test DocumentMappingTest::testStructMapping
+ *
+ * \since 8.0.3
+ */
+template <typename T,typename... Fields>
+class StructMapping {
+public:
+  StructMapping(const Fields&... f) : fields(f...) {
+    addPaths<0>();
+  }
+
+  /**
+   * \brief Reads JSON text in to to
+   *
+   * \throw InvalidFormatException if the text is not valid JSON, or a value cannot be converted
+   */
+  void fromJson(const std::string& json,T& to) const {
+    Reader reader(*this,to);
+    plan.readJson(json.c_str(),json.length(),reader);
+  }
+
+  /**
+   * \brief Reads XML text in to to. Paths are relative to the root element.
+   *
+   * \throw InvalidFormatException if the text is not valid XML, or a value cannot be converted
+   */
+  void fromXml(const std::string& xml,T& to) const {
+    Reader reader(*this,to);
+    plan.readXml(xml.c_str(),xml.length(),reader);
+  }
+
+  /**
+   * \brief Reads a JSON or XML document's text in to to, by its MIME type
+   *
+   * \throw InvalidFormatException if the content is neither JSON nor XML, or cannot be read
+   */
+  void fromContent(const IDocumentContent& content,T& to) const {
+    read(content.getMimeType(),content.getContent(),to);
+  }
+
+  /**
+   * \brief Reads a JSON or XML response body in to to, by its Content-Type header
+   *
+   * \throw InvalidFormatException if the body is neither JSON nor XML, or cannot be read
+   */
+  void fromResponse(const Response& response,T& to) const {
+    const std::string& body = response.getContent();
+    Reader reader(*this,to);
+    if (ResponseType::JSON == response.getResponseType()) {
+      plan.readJson(body.c_str(),body.length(),reader);
+    } else if (ResponseType::XML == response.getResponseType()) {
+      plan.readXml(body.c_str(),body.length(),reader);
+    } else {
+      throw InvalidFormatException("Cannot map a response of type " + translate_responsetype(response.getResponseType()) +
+          " to a struct");
+    }
+  }
+
+  /**
+   * \brief Returns from as a JSON document
+   *
+   * \return A new ITextDocumentContent. Caller owns.
+   */
+  ITextDocumentContent* toJson(const T& from) const {
+    const Writer writer(*this,from);
+    std::string out;
+    plan.writeJson(out,writer);
+    GenericTextDocumentContent* content = new GenericTextDocumentContent;
+    content->setMimeType(IDocumentContent::MIME_JSON);
+    content->setContent(std::move(out));
+    return content;
+  }
+
+  /**
+   * \brief Returns from as an XML document
+   *
+   * \param rootElement The name of the root element, which field paths are relative to
+   * \return A new ITextDocumentContent. Caller owns.
+   */
+  ITextDocumentContent* toXml(const T& from,const std::string& rootElement) const {
+    const Writer writer(*this,from);
+    std::string out;
+    plan.writeXml(out,rootElement,writer);
+    GenericTextDocumentContent* content = new GenericTextDocumentContent;
+    content->setMimeType(IDocumentContent::MIME_XML);
+    content->setContent(std::move(out));
+    return content;
+  }
+
+private:
+  static const size_t FIELD_COUNT = sizeof...(Fields);
+
+  class Reader : public IMappedFields {
+  public:
+    Reader(const StructMapping& m,T& t) : mapping(m), target(t) {}
+
+    void read(const size_t field,const MappedValueType type,const std::string& text) override {
+      mapping.template readField<0>(target,field,type,text);
+    }
+    void writeJson(const size_t field,std::string& out) const override {}
+    void writeXml(const size_t field,std::string& out,const std::string& name) const override {}
+
+  private:
+    const StructMapping& mapping;
+    T& target;
+  };
+
+  class Writer : public IMappedFields {
+  public:
+    Writer(const StructMapping& m,const T& s) : mapping(m), source(s) {}
+
+    void read(const size_t field,const MappedValueType type,const std::string& text) override {}
+    void writeJson(const size_t field,std::string& out) const override {
+      mapping.template writeJsonField<0>(source,field,out);
+    }
+    void writeXml(const size_t field,std::string& out,const std::string& name) const override {
+      mapping.template writeXmlField<0>(source,field,out,name);
+    }
+
+  private:
+    const StructMapping& mapping;
+    const T& source;
+  };
+
+  void read(const std::string& mimeType,const std::string& text,T& to) const {
+    if (std::string::npos != mimeType.find("json")) {
+      fromJson(text,to);
+    } else if (std::string::npos != mimeType.find("xml")) {
+      fromXml(text,to);
+    } else {
+      throw InvalidFormatException("Cannot map content of MIME type '" + mimeType + "' to a struct");
+    }
+  }
+
+  // Each function below is unrolled at compile time in to a chain of comparisons against the field index
+
+  template <size_t I>
+  typename std::enable_if<I < FIELD_COUNT>::type addPaths() {
+    plan.addPath(std::get<I>(fields).path);
+    addPaths<I + 1>();
+  }
+  template <size_t I>
+  typename std::enable_if<I == FIELD_COUNT>::type addPaths() {}
+
+  template <size_t I>
+  typename std::enable_if<I < FIELD_COUNT>::type readField(T& to,const size_t field,
+      const MappedValueType type,const std::string& text) const {
+    if (I == field) {
+      readMappedValue(to.*(std::get<I>(fields).member),type,text);
+    } else {
+      readField<I + 1>(to,field,type,text);
+    }
+  }
+  template <size_t I>
+  typename std::enable_if<I == FIELD_COUNT>::type readField(T& to,const size_t field,
+      const MappedValueType type,const std::string& text) const {}
+
+  template <size_t I>
+  typename std::enable_if<I < FIELD_COUNT>::type writeJsonField(const T& from,const size_t field,
+      std::string& out) const {
+    if (I == field) {
+      writeMappedJson(out,from.*(std::get<I>(fields).member));
+    } else {
+      writeJsonField<I + 1>(from,field,out);
+    }
+  }
+  template <size_t I>
+  typename std::enable_if<I == FIELD_COUNT>::type writeJsonField(const T& from,const size_t field,
+      std::string& out) const {}
+
+  template <size_t I>
+  typename std::enable_if<I < FIELD_COUNT>::type writeXmlField(const T& from,const size_t field,
+      std::string& out,const std::string& name) const {
+    if (I == field) {
+      writeMappedXml(out,name,from.*(std::get<I>(fields).member));
+    } else {
+      writeXmlField<I + 1>(from,field,out,name);
+    }
+  }
+  template <size_t I>
+  typename std::enable_if<I == FIELD_COUNT>::type writeXmlField(const T& from,const size_t field,
+      std::string& out,const std::string& name) const {}
+
+  std::tuple<Fields...> fields;
+  MappingPlan plan;
+};
+
+/**
+ * \brief Creates a StructMapping from its fields. The struct type is deduced from the fields' members.
+ *
+ * \since 8.0.3
+ */
+template <typename T,typename... Members>
+StructMapping<T,MappedField<T,Members>...> mapStruct(const MappedField<T,Members>&... fields) {
+  return StructMapping<T,MappedField<T,Members>...>(fields...);
+}
+
+} // end utilities namespace
+
+} // end mlclient namespace
+
+#endif /* INCLUDE_MLCLIENT_UTILITIES_DOCUMENTMAPPING_HPP_ */
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file ForestTopology.hpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ * \since 8.0.3
+ */
+
+#ifndef INCLUDE_MLCLIENT_UTILITIES_FORESTTOPOLOGY_HPP_
+#define INCLUDE_MLCLIENT_UTILITIES_FORESTTOPOLOGY_HPP_
+
+#include <mlclient/mlclient.hpp>
+#include <mlclient/Connection.hpp>
+
+#include <string>
+#include <vector>
+
+namespace mlclient {
+
+namespace utilities {
+
+/**
+ * \brief Describes a single forest attached to a database, and the host that owns it
+ * \since 8.0.3
+ */
+struct ForestInfo {
+  std::string name;
+  std::string host;
+};
+
+/**
+ * \brief A list of forests for a database
+ * \since 8.0.3
+ */
+typedef std::vector<ForestInfo> ForestList;
+
+/**
+ * \brief Provides the forest and host layout of a database to DocumentBatchWriter and similar classes
+ *
+ * Implementations fetch the topology once and cache it, so calling getForests() repeatedly is cheap.
+ *
+ * \note Can be subclassed directly, e.g. to provide a fixed layout in tests
+ *
+ * \since 8.0.3
+ */
+class IForestTopology {
+public:
+  MLCLIENT_API virtual ~IForestTopology();
+
+  /**
+   * \brief Returns the forests of the database, fetching them on first call
+   *
+   * \return The list of forests. Empty if the database has no forests.
+   */
+  MLCLIENT_API virtual const ForestList& getForests() = 0;
+
+  /**
+   * \brief Returns the position within getForests() of the forest that should hold the given document URI
+   *
+   * The default implementation spreads URIs evenly and deterministically over all forests using an FNV-1a
+   * hash of the URI. Override this to match a specific server side assignment policy.
+   *
+   * DocumentBatchWriter names the chosen forest on the write, so this decides where the document is stored.
+   *
+   * \param uri The document URI
+   * \return The index into getForests(). Only valid if getForests() is not empty.
+   */
+  MLCLIENT_API virtual long assignForest(const std::string& uri);
+};
+
+/**
+ * \brief An IForestTopology with a fixed, caller supplied, forest layout
+ *
+ * Useful for testing, or where the management API is not reachable from the client.
+ *
+ * \since 8.0.3
+ */
+class StaticForestTopology : public IForestTopology {
+public:
+  /**
+   * \brief Creates a topology over the given forests
+   *
+   * \param forests The forests and owning hosts of the database
+   */
+  MLCLIENT_API StaticForestTopology(const ForestList& forests);
+  MLCLIENT_API virtual ~StaticForestTopology();
+
+  MLCLIENT_API const ForestList& getForests() override;
+
+private:
+  ForestList mForests;
+};
+
+/**
+ * \brief An IForestTopology that reads the forest layout of a database from the MarkLogic Management REST API
+ *
+ * Calls GET /manage/v2/databases/{database}/properties once to list forests, then
+ * GET /manage/v2/forests/{forest}/properties for each forest to find its host. The result is cached
+ * until refresh() is called.
+ *
+ * \since 8.0.3
+ */
+class ManagementForestTopology : public IForestTopology {
+public:
+  /**
+   * \brief Creates a topology reader for the given database
+   *
+   * \param manageConn A connection to the management API app server (normally port 8002). In, but not OWNS.
+   * \param database The name of the content database
+   */
+  MLCLIENT_API ManagementForestTopology(IConnection* manageConn,const std::string& database);
+  MLCLIENT_API virtual ~ManagementForestTopology();
+
+  /**
+   * \brief Returns the forests of the database, fetching them on first call
+   *
+   * \throws InvalidFormatException if the management API returns an error or an unexpected response
+   */
+  MLCLIENT_API const ForestList& getForests() override;
+
+  /**
+   * \brief Discards the cached topology, so the next call to getForests() fetches it again
+   */
+  MLCLIENT_API void refresh();
+
+private:
+  class Impl;
+  Impl* mImpl;
+};
+
+/**
+ * \brief Supplies a connection to a named host in the cluster
+ *
+ * Used by DocumentBatchWriter in host affinity mode to send each batch directly to the host owning its forests.
+ *
+ * \note Can be subclassed directly in other wrappers (E.g. C#)
+ *
+ * \since 8.0.3
+ */
+class IHostConnectionProvider {
+public:
+  MLCLIENT_API virtual ~IHostConnectionProvider();
+
+  /**
+   * \brief Returns a connection to the given host
+   *
+   * \param hostname The host name as reported by IForestTopology
+   * \return A connection to that host, or nullptr to use the default connection. The provider retains
+   * ownership of the returned connection, which must remain valid until the batch operation completes.
+   */
+  MLCLIENT_API virtual IConnection* getConnection(const std::string& hostname) = 0;
+};
+
+} // end namespace utilities
+
+} // end namespace mlclient
+
+#endif /* INCLUDE_MLCLIENT_UTILITIES_FORESTTOPOLOGY_HPP_ */
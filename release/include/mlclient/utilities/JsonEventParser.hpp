@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file JsonEventParser.hpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ * \since 8.0.3
+ * \brief Provides an event driven JSON parser that is fed text in chunks as it arrives
+ */
+
+#ifndef INCLUDE_MLCLIENT_UTILITIES_JSONEVENTPARSER_HPP_
+#define INCLUDE_MLCLIENT_UTILITIES_JSONEVENTPARSER_HPP_
+
+#include <mlclient/mlclient.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace mlclient {
+
+namespace utilities {
+
+/**
+ * \brief Receives the values of a JSON document, in document order, from a JsonEventParser
+ *
+ * Strings and keys are passed unescaped, as UTF-8. Numbers are passed as their original text, so no precision is
+ * lost, and may be converted as the handler needs.
+ *
+ * \note The string passed to any function is only valid until that function returns
+ *
+ * \since 8.0.3
+ */
+class IJsonEventHandler {
+public:
+  MLCLIENT_API virtual ~IJsonEventHandler();
+
+  MLCLIENT_API virtual void onStartObject() = 0;
+  MLCLIENT_API virtual void onEndObject() = 0;
+  MLCLIENT_API virtual void onStartArray() = 0;
+  MLCLIENT_API virtual void onEndArray() = 0;
+  /**
+   * \brief Called with an object member's name, before its value's events
+   */
+  MLCLIENT_API virtual void onKey(const std::string& key) = 0;
+  MLCLIENT_API virtual void onString(const std::string& value) = 0;
+  MLCLIENT_API virtual void onNumber(const std::string& text) = 0;
+  MLCLIENT_API virtual void onBoolean(const bool value) = 0;
+  MLCLIENT_API virtual void onNull() = 0;
+
+  /**
+   * \brief Called with the text of an object or array whose capture was requested. See JsonEventParser::captureValue().
+   *
+   * Does nothing by default.
+   *
+   * \param text The value's text, from its opening to its closing bracket. The handler may move from it.
+   */
+  MLCLIENT_API virtual void onCapture(std::string& text);
+};
+
+/**
+ * \brief A JSON parser that is fed text in chunks, and reports each value to an IJsonEventHandler as it completes
+ *
+ * Nothing is kept once a value has been reported, other than the token split across the end of the last chunk,
+ * so memory use does not depend on the length of the document. Used to process a response whilst it is still
+ * being received. See IConnection::searchStreamed().
+ *
+ * Any object or array may instead be captured whole, E.g. to parse each row of a large array as its own document.
+ * See captureValue(). Values of no interest may be skipped without being reported. See skipValue().
+ *
+ * \note Not thread safe. Each instance parses a single document.
+ *
+ * \since 8.0.3
+ */
+class JsonEventParser {
+public:
+  /**
+   * \brief Creates a parser that reports to the given handler
+   *
+   * \param handler The handler to report values to. In, but not OWNS.
+   */
+  MLCLIENT_API JsonEventParser(IJsonEventHandler& handler);
+  MLCLIENT_API JsonEventParser(const JsonEventParser& other) = delete;
+  MLCLIENT_API ~JsonEventParser();
+
+  /**
+   * \brief Parses the next chunk of the document. Chunks may split the text at any byte.
+   *
+   * \param data The UTF-8 text. Not kept once this function returns.
+   * \param length The number of bytes of data
+   *
+   * \throw InvalidFormatException if the text so far is not valid JSON. Exceptions thrown by the handler are
+   * passed on. The parser cannot be used further in either case.
+   */
+  MLCLIENT_API void feed(const char* data,const size_t length);
+
+  /**
+   * \brief Completes the document once all chunks have been fed
+   *
+   * \throw InvalidFormatException if the document is incomplete, E.g. the response was truncated
+   */
+  MLCLIENT_API void finish();
+
+  /**
+   * \brief Captures the object or array just started, rather than reporting its contents
+   *
+   * Only valid within IJsonEventHandler::onStartObject() or onStartArray(). No further events are reported until
+   * the value is complete. Its whole text is then passed to IJsonEventHandler::onCapture(), in place of its end
+   * event. The value's contents are only checked for balanced brackets and strings, so a parser given the
+   * captured text reports any other errors.
+   */
+  MLCLIENT_API void captureValue();
+
+  /**
+   * \brief Skips the object or array just started, rather than reporting its contents
+   *
+   * Only valid within IJsonEventHandler::onStartObject() or onStartArray(). As captureValue(), but the value's
+   * text is discarded as it is read, and no further events are reported for it, not even its end event.
+   */
+  MLCLIENT_API void skipValue();
+
+  /**
+   * \brief Returns the number of bytes fed so far
+   */
+  MLCLIENT_API size_t getOffset() const;
+
+private:
+  class Impl; // forward declaration
+  Impl* mImpl;
+};
+
+} // end utilities namespace
+
+} // end mlclient namespace
+
+#endif /* INCLUDE_MLCLIENT_UTILITIES_JSONEVENTPARSER_HPP_ */
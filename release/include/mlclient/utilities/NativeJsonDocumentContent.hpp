@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file NativeJsonDocumentContent.hpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ * \since 8.0.3
+ * \brief Provides a JSON IDocumentContent that parses UTF-8 directly, without the cpprest API
+ */
+
+#ifndef INCLUDE_MLCLIENT_UTILITIES_NATIVEJSONDOCUMENTCONTENT_HPP_
+#define INCLUDE_MLCLIENT_UTILITIES_NATIVEJSONDOCUMENTCONTENT_HPP_
+
+#include <mlclient/mlclient.hpp>
+#include <mlclient/DocumentContent.hpp>
+
+#include <memory>
+#include <string>
+
+namespace mlclient {
+
+namespace utilities {
+
+/**
+ * \brief A parsed JSON document. Internal to the NativeJson classes.
+ *
+ * Holds the source text, with strings unescaped in place, and a flat depth first list of its values.
+ * Each container records how many values its subtree spans, so siblings are found without recursion.
+ *
+ * \since 8.0.3
+ */
+class NativeJsonTape;
+
+/**
+ * \brief Document Traversal API node for any value within a NativeJsonDocumentContent
+ *
+ * Shares the parsed document, so remains valid after the content and navigator it came from are deleted.
+ * See IDocumentNode for details.
+ *
+ * \since 8.0.3
+ */
+class NativeJsonDocumentNode : public IDocumentNode {
+public:
+  /**
+   * \brief Wraps a value within a parsed document
+   *
+   * \param tape The parsed document. Shared.
+   * \param entry The value within tape. In, but not OWNS.
+   */
+  MLCLIENT_API NativeJsonDocumentNode(std::shared_ptr<const NativeJsonTape> tape,const void* entry);
+  MLCLIENT_API NativeJsonDocumentNode(const NativeJsonDocumentNode& other) = delete;
+  MLCLIENT_API virtual ~NativeJsonDocumentNode();
+
+  MLCLIENT_API bool isNull() const override;
+  MLCLIENT_API bool isBoolean() const override;
+  MLCLIENT_API bool isInteger() const override;
+  MLCLIENT_API bool isDouble() const override;
+  MLCLIENT_API bool isString() const override;
+  MLCLIENT_API bool isArray() const override;
+  MLCLIENT_API bool isObject() const override;
+
+  MLCLIENT_API bool asBoolean() const override;
+  MLCLIENT_API int32_t asInteger() const override;
+  MLCLIENT_API double asDouble() const override;
+  MLCLIENT_API std::string asString() const override;
+  MLCLIENT_API IDocumentNode* asArray() const override;
+  MLCLIENT_API IDocumentNode* asObject() const override;
+
+  /**
+   * \brief Returns the named property. Any prefix up to a colon is ignored, as for CppRestJsonDocumentNode.
+   *
+   * \throw InvalidFormatException if the property does not exist
+   */
+  MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
+  /**
+   * \brief Returns the array member. The first call lists the members once, so later calls are O(1).
+   *
+   * \throw InvalidFormatException if the index is out of range
+   */
+  MLCLIENT_API IDocumentNode* at(const int32_t idx) const override;
+  MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const int32_t idx) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
+  MLCLIENT_API IDocumentNode* newNode(const DocumentNodeRef& ref) const override;
+
+  MLCLIENT_API StringList keys() const override;
+  MLCLIENT_API int32_t size() const override;
+
+  /**
+   * \brief Returns a NativeJsonDocumentContent for this value, sharing the parsed document rather than copying it
+   */
+  MLCLIENT_API IDocumentContent* getChildContent() const override;
+
+private:
+  class Impl; // forward declaration
+  Impl* mImpl;
+};
+
+/**
+ * \brief Provides a navigator interface over a NativeJsonDocumentContent's root value
+ *
+ * \since 8.0.3
+ */
+class NativeJsonDocumentNavigator : public IDocumentNavigator {
+public:
+  MLCLIENT_API NativeJsonDocumentNavigator(std::shared_ptr<const NativeJsonTape> tape,const void* root);
+  MLCLIENT_API NativeJsonDocumentNavigator(const NativeJsonDocumentNavigator& other) = delete;
+  MLCLIENT_API virtual ~NativeJsonDocumentNavigator();
+
+  MLCLIENT_API IDocumentNode* firstChild() const override;
+  MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
+  MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
+  MLCLIENT_API IDocumentNode* newNode(const DocumentNodeRef& ref) const override;
+
+private:
+  class Impl; // forward declaration
+  Impl* mImpl;
+};
+
+/**
+ * \brief An ITextDocumentContent instance that parses JSON UTF-8 text directly
+ *
+ * An alternative to CppRestJsonDocumentContent for read heavy use. The text is parsed in a single non recursive
+ * pass in to one flat allocation, with strings unescaped in place in the source buffer. Nothing is converted to
+ * utility::string_t, so values are read as UTF-8 without conversion.
+ *
+ * Select this for responses with DocumentHelper::setJsonBackend(JsonBackend::NATIVE).
+ *
+ * \note Read only. The content can be replaced with setContent(), but not modified in place.
+ *
+ * \since 8.0.3
+ */
+class NativeJsonDocumentContent : public ITextDocumentContent {
+public:
+  MLCLIENT_API NativeJsonDocumentContent();
+  /**
+   * \brief Shares a value within an already parsed document. Used by NativeJsonDocumentNode::getChildContent().
+   *
+   * \param tape The parsed document. Shared.
+   * \param root The value within tape to use as this content's root. In, but not OWNS.
+   */
+  MLCLIENT_API NativeJsonDocumentContent(std::shared_ptr<const NativeJsonTape> tape,const void* root);
+  MLCLIENT_API NativeJsonDocumentContent(const NativeJsonDocumentContent& other) = delete;
+  MLCLIENT_API virtual ~NativeJsonDocumentContent();
+
+  /// \name nativejsondocumentcontent_overrides Overridden functions from base class
+  /// @{
+
+  /**
+   * \brief Returns a new stream over the serialised text, which it shares. Caller owns.
+   */
+  MLCLIENT_API std::istream* getStream() const override;
+
+  /**
+   * \brief Parses the given JSON text
+   *
+   * Pass an rvalue (E.g. std::move(str)) to parse without copying the text.
+   *
+   * \param[in] content The UTF-8 JSON text
+   *
+   * \throw InvalidFormatException if the content is not valid JSON. This content is then unchanged.
+   */
+  MLCLIENT_API void setContent(std::string content) override;
+
+  /**
+   * \brief Returns the content, serialised from the parsed document
+   *
+   * \note Insignificant whitespace in the original text is not preserved.
+   */
+  MLCLIENT_API std::string getContent() const override;
+
+  /**
+   * \brief Views the serialised text in place. Shares it, so remains valid after the content is changed or deleted.
+   */
+  MLCLIENT_API ContentView contentView() const override;
+  MLCLIENT_API size_t size() const override;
+
+  MLCLIENT_API std::string getMimeType() const override;
+  MLCLIENT_API void setMimeType(const std::string& mt) override;
+
+  MLCLIENT_API int getLength() const override;
+
+  /**
+   * \brief Returns a navigator sharing the parsed document. firstElementAsRoot is ignored, as for JSON there is no
+   * single root element.
+   */
+  MLCLIENT_API IDocumentNavigator* navigate(bool firstElementAsRoot = false) const override;
+
+  /// @}
+
+private:
+  class Impl; // forward declaration
+  Impl* mImpl;
+};
+
+} // end utilities namespace
+
+} // end mlclient namespace
+
+#endif /* INCLUDE_MLCLIENT_UTILITIES_NATIVEJSONDOCUMENTCONTENT_HPP_ */
@@ -25,6 +25,9 @@
 #include <mlclient/Response.hpp>
 #include <mlclient/DocumentContent.hpp>
 
+#include <string>
+#include <vector>
+
 namespace mlclient {
 
 namespace utilities {
@@ -52,7 +55,7 @@ public:
      *
      * \param node The top level IDocumentNavigator within which to apply the path
      * \param path The path to apply to the IDocumentNavigator
-     * \return The IDocumentNode at the end of the path. 
+     * \return The IDocumentNode at the end of the path. Caller owns. Shares the navigated content, as at() does.
      * \throws InvalidFormatException if the node does not exist
      */
     MLCLIENT_API static IDocumentNode* navigate(const IDocumentNavigator* nav,const std::string& path);
@@ -67,10 +70,141 @@ public:
      *
      * \param node The current level node within which to apply the subpath
      * \param subpath The subpath to apply to the IDocumentNode
-     * \return The IDocumentNode at the end of the subpath. 
+     * \return The IDocumentNode at the end of the subpath. Caller owns. Shares the navigated content, as at() does.
      * \throws InvalidFormatException if the node does not exist
      */
     MLCLIENT_API static IDocumentNode* at(const IDocumentNode* node,const std::string& subpath);
+
+    /**
+     * \brief Applies a slash separated path from the given node, without allocating. navigate() and at() call this.
+     * \since 8.0.3
+     *
+     * \test Tested by PathNavigatorTest::testNodeRef
+     *
+     * \param from The node within which to apply the path. E.g. IDocumentNavigator::ref() or IDocumentNode::ref().
+     * \param path The path to apply. Leading, trailing and repeated slashes are ignored.
+     * \return The node at the end of the path, or an empty DocumentNodeRef if it does not exist
+     */
+    MLCLIENT_API static DocumentNodeRef find(const DocumentNodeRef& from,const std::string& path);
+};
+
+/**
+ * \brief A path parsed once in to steps, for applying to many documents
+ *
+ * Steps are separated by slashes. Leading, trailing and repeated slashes are ignored, as for PathNavigator::find().
+ * Each step is one of:-
+ *  - name - The named property or child element (any prefix up to a colon is ignored, as for IDocumentNode::at())
+ *  - name[n] - Member n, zero based, of the named array. A node that is not an array is its own member 0, as for
+ *    DocumentNodeRef::members(), so E.g. repeated or single XML elements are read alike.
+ *  - [n] - Member n of the current node
+ *  - * - Every array member, or every property or child element value, of the current node
+ *
+ * Evaluation walks DocumentNodeRef handles with the keys held by this path, so no strings or nodes are allocated,
+ * other than to list an object's keys for a * step.
+ *
+ * \test PathNavigatorTest::testCompiledPath
+ *
+ * \since 8.0.3
+ */
+class CompiledPath {
+public:
+  /**
+   * \brief Creates an empty path, which finds the node it is applied to
+   */
+  MLCLIENT_API CompiledPath();
+  /**
+   * \brief Parses the given path
+   *
+   * \param path The slash separated path
+   * \throw InvalidFormatException if an index is not a non negative number within square brackets
+   */
+  MLCLIENT_API CompiledPath(const std::string& path);
+  MLCLIENT_API CompiledPath(const CompiledPath& other);
+  MLCLIENT_API CompiledPath& operator=(const CompiledPath& other);
+  MLCLIENT_API ~CompiledPath();
+
+  /**
+   * \brief Returns the first node the path selects, in document order
+   *
+   * \param from The node within which to apply the path. E.g. IDocumentNavigator::ref() or IDocumentNode::ref().
+   * \return The node, or an empty DocumentNodeRef if the path selects none
+   */
+  MLCLIENT_API DocumentNodeRef find(const DocumentNodeRef& from) const;
+
+  /**
+   * \brief Appends every node the path selects, in document order
+   *
+   * \param from The node within which to apply the path
+   * \param addTo The vector to append matches to
+   * \return The number of matches appended
+   */
+  MLCLIENT_API size_t findAll(const DocumentNodeRef& from,std::vector<DocumentNodeRef>& addTo) const;
+
+  /**
+   * \brief Returns the path text this was parsed from
+   */
+  MLCLIENT_API const std::string& getPath() const;
+
+  /**
+   * \brief Returns the number of steps. Each name[n] step counts as two.
+   */
+  MLCLIENT_API size_t getStepCount() const;
+
+  friend class CompiledPathSet;
+
+private:
+  class Impl; // forward declaration
+  Impl* mImpl;
+};
+
+/**
+ * \brief A set of compiled paths applied in a single traversal
+ *
+ * Paths sharing leading steps share their nodes, so E.g. a/b/c and a/b/d navigate a/b once. Use to read several
+ * fields from each of many documents.
+ *
+ * \test PathNavigatorTest::testCompiledPath
+ *
+ * \since 8.0.3
+ */
+class CompiledPathSet {
+public:
+  MLCLIENT_API CompiledPathSet();
+  MLCLIENT_API CompiledPathSet(const CompiledPathSet& other) = delete;
+  MLCLIENT_API ~CompiledPathSet();
+
+  /**
+   * \brief Adds a path to the set
+   *
+   * \param path The slash separated path. See CompiledPath for its syntax.
+   * \return The position of this path's result in the vector filled by find()
+   * \throw InvalidFormatException if the path is invalid. The set is then unchanged.
+   */
+  MLCLIENT_API size_t add(const std::string& path);
+  /**
+   * \brief Adds an already compiled path to the set
+   *
+   * \return The position of this path's result in the vector filled by find()
+   */
+  MLCLIENT_API size_t add(const CompiledPath& path);
+
+  /**
+   * \brief Returns the number of paths added
+   */
+  MLCLIENT_API size_t size() const;
+
+  /**
+   * \brief Finds the first node, in document order, selected by every path in the set
+   *
+   * \param from The node within which to apply the paths
+   * \param results Resized to size(). Each path's node, or an empty DocumentNodeRef, is set at the position add()
+   * returned for it. Reuse the same vector across documents to avoid reallocating it.
+   */
+  MLCLIENT_API void find(const DocumentNodeRef& from,std::vector<DocumentNodeRef>& results) const;
+
+private:
+  class Impl; // forward declaration
+  Impl* mImpl;
 };
 
 } // end namespace utilities
@@ -75,6 +75,10 @@ public:
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API IDocumentNode* at(const int32_t idx) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const int32_t idx) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
+  MLCLIENT_API IDocumentNode* newNode(const DocumentNodeRef& ref) const override;
 
   MLCLIENT_API StringList keys() const override;
   MLCLIENT_API int32_t size() const override;
@@ -104,6 +108,10 @@ public:
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API IDocumentNode* at(const int32_t idx) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const int32_t idx) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
+  MLCLIENT_API IDocumentNode* newNode(const DocumentNodeRef& ref) const override;
 
   MLCLIENT_API StringList keys() const override;
   MLCLIENT_API int32_t size() const override;
@@ -137,6 +145,10 @@ class PugiXmlAttributeNode : public PugiXmlContainerNode {
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API IDocumentNode* at(const int32_t idx) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const int32_t idx) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
+  MLCLIENT_API IDocumentNode* newNode(const DocumentNodeRef& ref) const override;
 
   MLCLIENT_API StringList keys() const override;
   MLCLIENT_API int32_t size() const override;
@@ -181,6 +193,10 @@ public:
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API IDocumentNode* at(const int32_t idx) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const int32_t idx) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
+  MLCLIENT_API IDocumentNode* newNode(const DocumentNodeRef& ref) const override;
 
   MLCLIENT_API StringList keys() const override;
   MLCLIENT_API int32_t size() const override;
@@ -248,6 +264,9 @@ public:
    */
   MLCLIENT_API IDocumentNode* at(const std::string& key) const override;
   MLCLIENT_API bool has(const std::string& key) const override;
+  MLCLIENT_API IDocumentNode* tryAt(const std::string& key) const override;
+  MLCLIENT_API DocumentNodeRef ref() const override;
+  MLCLIENT_API IDocumentNode* newNode(const DocumentNodeRef& ref) const override;
 
 private:
   class Impl; // forward declaration
@@ -284,6 +303,9 @@ public:
    * \brief Sets the content of this document instance from a pugixml xml_document instance.
    *
    * \param json The pugixml xml_document instance to copy
+   *
+   * \note The document is shared, not copied. Call this function again after modifying it, so the cached serialised
+   * text is refreshed.
    */
   MLCLIENT_API void setContent(std::shared_ptr<pugi::xml_document> xml);
 
@@ -292,7 +314,8 @@ public:
    *
    * This allows streaming to a HTTP request of this string content.
    *
-   * \note The stream may be read from asynchronously, so do not destroy the underlying content after returning the stream.
+   * \note The stream shares the serialised text, so may be read from asynchronously, even after this content is
+   * changed or deleted.
    *
    * \return An istream instance wrapping the content of this Text Document Content instance
    */
@@ -310,10 +333,19 @@ public:
   /**
    * \brief Returns the content as a string
    *
+   * The tree is serialised on the first call after it changes, and the text kept for getStream(), getLength() and
+   * later calls.
+   *
    * \return The string representation of the content.
    */
   MLCLIENT_API std::string getContent() const override;
 
+  /**
+   * \brief Views the serialised text in place. Shares it, so remains valid after the content is changed or deleted.
+   */
+  MLCLIENT_API ContentView contentView() const override;
+  MLCLIENT_API size_t size() const override;
+
   /**
    * \brief Returns the MIME type of this content.
    *
@@ -338,7 +370,7 @@ public:
    *
    * \note This number does not include C null characters - just std::string length
    *
-   * \return The number of characters in the string. Does not include C null character.
+   * \return The number of characters in the string. Does not include C null character. O(1) once serialised.
    */
   MLCLIENT_API int getLength() const override;
 
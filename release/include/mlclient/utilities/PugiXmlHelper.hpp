@@ -76,6 +76,23 @@ public:
    */
   MLCLIENT_API static ITextDocumentContent* toDocument(const Response& resp);
 
+  /**
+   * \brief Creates an ITextDocumentContent instance by parsing the response body in place
+   *
+   * Takes the body from the Response with Response::releaseContent() and parses it inside that buffer, so
+   * element and attribute text are not copied. The buffer is kept alive for as long as the parsed document,
+   * including by any nodes taken from the returned content.
+   *
+   * \since 8.0.3
+   *
+   * \param resp The MarkLogic C++ API Response object instance. Its content is empty after this call, unless parsing
+   * fails. Then the body is handed back, though text before the error offset may have been altered by the parse.
+   * \return The IDocumentContent instance wrapping the XML content in the response, with its mime type and content set
+   *
+   * \throw InvalidFormatException If the Response does not have the application/xml mime type, or if parsing fails.
+   */
+  MLCLIENT_API static ITextDocumentContent* toDocumentInPlace(Response& resp);
+
   /**
    * \brief Extracts a pugi::xml_document instance from a IDocumentContent object.
    *
@@ -99,6 +116,21 @@ public:
    */
   MLCLIENT_API static std::unique_ptr<pugi::xml_document> fromResponse(const Response& resp);
 
+  /**
+   * \brief Extracts a pugi::xml_document instance from the Response object, parsing its body in place.
+   *
+   * See toDocumentInPlace(). The returned pointer also owns the parsed buffer.
+   *
+   * \since 8.0.3
+   *
+   * \throw InvalidFormatException if the Response does not have a mime type of application/xml, or if a parsing error occurs.
+   *
+   * \param resp The MarkLogic C++ API Response object instance. Its content is empty after this call, unless parsing
+   * fails. Then the body is handed back, as for toDocumentInPlace().
+   * \return A pugi::xml_document instance (parsed XML tree) created from the Response.
+   */
+  MLCLIENT_API static std::shared_ptr<pugi::xml_document> fromResponseInPlace(Response& resp);
+
 };
 
 } // end utilities namespace
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file QueryBatcher.hpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ * \since 8.0.3
+ */
+
+#ifndef INCLUDE_MLCLIENT_UTILITIES_QUERYBATCHER_HPP_
+#define INCLUDE_MLCLIENT_UTILITIES_QUERYBATCHER_HPP_
+
+#include <mlclient/DocumentSet.hpp>
+#include <mlclient/Document.hpp>
+#include <mlclient/Connection.hpp>
+#include <mlclient/SearchDescription.hpp>
+#include <mlclient/utilities/DocumentBatchWriter.hpp>
+
+#include <mlclient/mlclient.hpp>
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mlclient {
+
+namespace utilities {
+
+/**
+ * \brief A batch of documents read by QueryBatcher
+ *
+ * Move only. Owns the content of the Documents it holds, which is deleted with the batch. To keep
+ * the Documents beyond the listener call, take the whole set with releaseDocuments().
+ *
+ * \since 8.0.3
+ */
+class QueryBatch {
+public:
+  /**
+   * \brief Creates a blank, successful batch
+   */
+  MLCLIENT_API QueryBatch();
+  /**
+   * \brief Creates a batch of URIs with no documents yet fetched
+   *
+   * \param sequence The zero based page number of this batch within the query results
+   * \param uris The URIs matched by this batch. Moved from.
+   */
+  MLCLIENT_API QueryBatch(long sequence,DocumentUriSet&& uris);
+  MLCLIENT_API QueryBatch(const QueryBatch& other) = delete;
+  MLCLIENT_API QueryBatch& operator=(const QueryBatch& other) = delete;
+  MLCLIENT_API QueryBatch(QueryBatch&& other);
+  MLCLIENT_API QueryBatch& operator=(QueryBatch&& other);
+  /**
+   * \brief Deletes the content of all Documents still held by this batch
+   */
+  MLCLIENT_API ~QueryBatch();
+
+  /**
+   * \brief Returns the zero based page number of this batch within the query results
+   */
+  MLCLIENT_API long getSequence() const;
+  /**
+   * \brief Returns the URIs matched by this batch
+   */
+  MLCLIENT_API const DocumentUriSet& getUris() const;
+  /**
+   * \brief Returns the Documents read for this batch. Empty if QueryBatcher::setFetchDocuments(false) was called.
+   */
+  MLCLIENT_API const DocumentSet& getDocuments() const;
+  /**
+   * \brief Takes ownership of the Documents read for this batch, leaving this batch with none
+   */
+  MLCLIENT_API DocumentSet releaseDocuments();
+  /**
+   * \brief Returns whether the documents for this batch were read successfully
+   */
+  MLCLIENT_API bool isSuccess() const;
+  /**
+   * \brief Returns the last exception raised whilst reading this batch, or an empty exception_ptr
+   */
+  MLCLIENT_API std::exception_ptr getProblem() const;
+  /**
+   * \brief Returns the message of the last exception raised whilst reading this batch, or a blank string
+   */
+  MLCLIENT_API const std::string& getMessage() const;
+  /**
+   * \brief Returns the number of attempts made to read this batch (1 if there were no retries)
+   */
+  MLCLIENT_API int getAttempts() const;
+
+  friend class QueryBatcher;
+
+private:
+  void clearDocuments();
+
+  long sequence;
+  DocumentUriSet uris;
+  DocumentSet documents;
+  bool success;
+  std::exception_ptr problem;
+  std::string message;
+  int attempts;
+};
+
+/**
+ * \brief An abstract class that receives each batch read by a QueryBatcher
+ *
+ * \note Called concurrently from the QueryBatcher's worker tasks. Implementations must be thread safe.
+ *
+ * \note Can be subclassed directly in other wrappers (E.g. C#)
+ *
+ * \since 8.0.3
+ */
+class IQueryBatchNotifiable {
+public:
+  MLCLIENT_API virtual ~IQueryBatchNotifiable();
+
+  /**
+   * \brief Receives a batch from the QueryBatcher class
+   *
+   * \param batch The batch. Call releaseDocuments() to keep its Documents beyond this call.
+   */
+  MLCLIENT_API virtual void queryBatchComplete(QueryBatch& batch) = 0;
+};
+
+/**
+ * \brief Reads, in parallel batches, every document matching a query or in a collection
+ *
+ * The bulk read counterpart of DocumentBatchWriter. Each worker task claims the next page of the query
+ * results, lists its URIs, reads those documents with a single multipart request
+ * (IConnection::getDocuments) and passes the batch to each listener. Failed pages are retried.
+ *
+ * Every page is listed at the server timestamp of the first listing, so documents ingested or deleted during
+ * the run do not shift later pages, and no URI is listed twice or skipped. See setPointInTime().
+ *
+ * \note Each Connection instance only ever executes one REST request at a time. On the batcher's connection
+ * alone only listener work and response parsing run in parallel. Pass several connections to
+ * setFetchConnections() so that worker tasks send their requests at once.
+ *
+ * \since 8.0.3
+ */
+class QueryBatcher {
+public:
+  /**
+   * \brief Constructs a QueryBatcher that wraps the provided IConnection instance
+   * \param conn The pointer to an IConnection subclass instance. In, but not OWNS.
+   */
+  MLCLIENT_API QueryBatcher(IConnection* conn);
+  /**
+   * \brief The DELETED copy constructor
+   */
+  MLCLIENT_API QueryBatcher(const QueryBatcher& other) = delete;
+  /**
+   * \brief Stops and waits for all worker tasks, then destroys this instance
+   */
+  MLCLIENT_API ~QueryBatcher();
+
+  /**
+   * \brief Reads every document matching the given search
+   *
+   * \note The start and page length of the description are ignored. If the description has no options,
+   * search results are requested without snippets as only URIs are needed.
+   *
+   * \param desc The SearchDescription to match documents with. Copied.
+   */
+  MLCLIENT_API void setQuery(const SearchDescription& desc);
+  /**
+   * \brief Reads every document in the given collection
+   *
+   * \param collection The collection URI
+   */
+  MLCLIENT_API void setCollection(const std::string& collection);
+
+  /**
+   * \brief Sets the parameters for this batch operation
+   *
+   * \note Defaults to 5 parallel tasks, each reading 100 documents per batch, with 3 retries per batch.
+   *
+   * \param parallelTasks The number of parallel worker tasks to use
+   * \param batchSize The number of URIs (and thus documents) per batch
+   * \param maxRetries The number of times a failed batch is retried before being passed on as failed
+   */
+  MLCLIENT_API void setBatchParameters(const int parallelTasks,const int batchSize,const int maxRetries);
+
+  /**
+   * \brief Sets the connections that worker tasks list URIs and read documents on, one request per connection at a time
+   *
+   * Each request waits for an idle connection in this list, so up to connections.size() requests run at once. The
+   * connections should be to the same database, with the same credentials, as the batcher's connection, E.g. one
+   * per host in the cluster. An empty list (the default) sends every request on the batcher's connection, which
+   * serializes them.
+   *
+   * \note Call before send(). The connections are not owned, and must outlive this batcher.
+   *
+   * \param connections The connections to send requests on
+   */
+  MLCLIENT_API void setFetchConnections(const std::vector<IConnection*>& connections);
+
+  /**
+   * \brief Sets whether every page of URIs is listed at the timestamp of the first listing. Defaults to true.
+   *
+   * The ML-Effective-Timestamp returned with the first listing is passed as the timestamp of every later one, so
+   * pages are offsets in to one unchanging result list. If the query's SearchDescription already has a timestamp
+   * that is used instead. When disabled, concurrent ingest may cause URIs to be listed twice or not at all.
+   *
+   * \note Call before send(). Until the first listing returns, worker tasks list pages one at a time. Documents
+   * are read at the latest state, so a document deleted since the timestamp is missing from its batch.
+   * \note The database merge timestamp must be at or before the listing timestamp for long runs, else the server
+   * may reject later listings.
+   *
+   * \param pointInTime true to pin every listing to the first listing's timestamp
+   */
+  MLCLIENT_API void setPointInTime(const bool pointInTime);
+  MLCLIENT_API const bool isPointInTime() const;
+  /**
+   * \brief Returns the server timestamp pages are listed at, or an empty string if there is none yet
+   *
+   * \note Only read once the batcher is complete, or from a listener, as it is set by the first listing.
+   */
+  MLCLIENT_API const std::string& getTimestamp() const;
+  MLCLIENT_API const int getParallelTasks() const;
+  MLCLIENT_API const int getBatchSize() const;
+  MLCLIENT_API const int getMaxRetries() const;
+
+  /**
+   * \brief Sets whether document content is read, or only the URIs listed. Defaults to true.
+   *
+   * \param fetch Whether to read document content for each batch
+   */
+  MLCLIENT_API void setFetchDocuments(const bool fetch);
+  MLCLIENT_API const bool isFetchDocuments() const;
+
+  /**
+   * \brief Adds a listener for batches
+   *
+   * \param notifiable the IQueryBatchNotifiable listener to add
+   */
+  MLCLIENT_API void addBatchListener(IQueryBatchNotifiable* notifiable);
+  /**
+   * \brief Removes a listener for batches
+   *
+   * \param notifiable the IQueryBatchNotifiable listener to remove
+   */
+  MLCLIENT_API void removeBatchListener(IQueryBatchNotifiable* notifiable);
+
+  /**
+   * \brief Begins the batch operation on parallelTasks worker tasks
+   */
+  MLCLIENT_API void send();
+  /**
+   * \brief Cancels the batch operation
+   *
+   * \note Batches already being read still run to completion and are passed to listeners.
+   */
+  MLCLIENT_API void stop();
+  /**
+   * \brief Causes the calling thread to wait for all worker tasks to finish
+   */
+  MLCLIENT_API void wait() const;
+
+  /**
+   * \brief Have all worker tasks finished?
+   *
+   * \return true if all worker tasks have finished, whether or not they were cancelled
+   */
+  MLCLIENT_API const bool isComplete() const;
+  /**
+   * \brief Has this class been cancelled?
+   */
+  MLCLIENT_API const bool isCancelled() const;
+  /**
+   * \brief Have all matching documents been passed to listeners?
+   *
+   * \return true if the results were exhausted without cancellation. false if a page of URIs could not be listed,
+   * as later pages were then never read. See isListFailed().
+   */
+  MLCLIENT_API const bool isFinished() const;
+  /**
+   * \brief Was a page of URIs still not listed after all retries?
+   *
+   * The batcher stops when this happens, as it cannot tell where the results end. The failed batch is passed to
+   * listeners with no URIs, and is counted by getFailedBatches().
+   */
+  MLCLIENT_API const bool isListFailed() const;
+  /**
+   * \brief Returns the number of batches that failed after all retries
+   */
+  MLCLIENT_API const long getFailedBatches() const;
+
+  /**
+   * \brief Returns the current progress of this operation
+   *
+   * \note total is the server's estimate of matching documents, as returned with each page of URIs.
+   */
+  MLCLIENT_API const Progress getProgress() const;
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> mImpl;
+};
+
+} // end namespace utilities
+
+} // end namespace mlclient
+
+#endif /* INCLUDE_MLCLIENT_UTILITIES_QUERYBATCHER_HPP_ */
@@ -108,6 +108,18 @@ public:
    */
   MLCLIENT_API static void getComplexAggregateResults(const Response& resp,ValuesResult& vr);
 
+  /**
+   * \brief Returns the server timestamp the request was evaluated at, from the ML-Effective-Timestamp header
+   *
+   * Pass it to SearchDescription::setTimestamp() so later searches see the same database state.
+   *
+   * \param[in] resp The response to introspect
+   * \return The timestamp, or a blank string if the server did not send one
+   *
+   * \since 8.0.3
+   */
+  MLCLIENT_API static std::string getEffectiveTimestamp(const Response& resp);
+
 
 }; // end ResponseHelper class
 
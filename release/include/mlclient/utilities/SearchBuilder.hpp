@@ -261,8 +261,11 @@ public:
    *
    * \param queryref The reference to check
    * \param op The RangeOperation to perform
-   * \param value The string value to match
+   * \param value The string value to match. Escaped as needed. Must be a JSON number for numeric types, and true
+   * or false for RangeIndexType::BOOLEAN.
    * \return The IQuery instance created. The caller OWNS this pointer. (This class does not delete the pointer.)
+   *
+   * \throw InvalidFormatException if a numeric or boolean value is not one
    */
   MLCLIENT_API IQuery* jsonRangeQuery(const std::string queryref,const RangeOperation op,const std::string value,
     const RangeIndexType& type = RangeIndexType::INT);
@@ -273,8 +276,11 @@ public:
    *
    * \param queryref The reference to check
    * \param op The RangeOperation to perform
-   * \param value The string value to match
+   * \param value The string value to match. Escaped as needed. Must be a JSON number for numeric types, and true
+   * or false for RangeIndexType::BOOLEAN.
    * \return The IQuery instance created. The caller OWNS this pointer. (This class does not delete the pointer.)
+   *
+   * \throw InvalidFormatException if a numeric or boolean value is not one
    */
   MLCLIENT_API IQuery* xmlRangeQuery(const std::string queryref,const RangeOperation op,const std::string value,
     const RangeIndexType& type = RangeIndexType::INT);
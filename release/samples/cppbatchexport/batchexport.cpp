@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *  batchexport.cpp
+ *  Created by Adam Fowler on 18 Oct 2026.
+ */
+
+#include "ConnectionFactory.hpp"
+
+#include <mlclient/utilities/DocumentBatchExporter.hpp>
+
+#include <mlclient/Connection.hpp>
+#include <mlclient/logging.hpp>
+
+#include <iostream>
+#include <string>
+
+int main(int argc, const char * argv[])
+{
+  using namespace mlclient;
+  using namespace mlclient::utilities;
+
+  mlclient::reconfigureLogging(argc,argv);
+
+  LOG(DEBUG) << "Running batchexport...";
+  if (argc < 3) {
+    std::cout << "Must specify the collection as first parameter" << std::endl;
+    std::cout << "Must specify the target folder, or archive file ending .mla, as second parameter" << std::endl;
+    std::cout << "May specify the URI prefix to strip as third parameter (default: /cppbatchupload/)" << std::endl;
+    std::cout << "Usage: " << argv[0] << " <collection> <folder|archive.mla> [uriPrefix]" << std::endl;
+    std::cout << "Example Usage: " << argv[0] << " mydocs ./some/folder" << std::endl;
+    return 1;
+  }
+
+  const std::string target(argv[2]);
+  const std::string appendBase(argc > 3 ? argv[3] : "/cppbatchupload/"); // matches cppbatchupload
+
+  IConnection* ml = ConnectionFactory::getConnection();
+
+  DocumentBatchExporter exporter(ml);
+  exporter.setCollection(argv[1]);
+  if (target.length() > 4 && 0 == target.compare(target.length() - 4,4,".mla")) {
+    exporter.setArchiveTarget(target);
+  } else {
+    exporter.setDirectoryTarget(target,appendBase);
+  }
+
+  exporter.send();
+
+  // now just wait for it to finish...
+
+  exporter.wait();
+
+  Progress p = exporter.getProgress();
+  std::cout << "Written: " << exporter.getWrittenDocuments() << ", failed: " << exporter.getFailedDocuments() << std::endl;
+  std::cout << "Progress: Complete: " << p.completed << ", total: " << p.total << ", pct: " << p.percentageComplete << std::endl;
+  std::cout << "Progress: duration: " << p.duration << ", overall rate: " << p.rate << std::endl;
+
+  std::cout << "batch export complete" << std::endl;
+  return (0 == exporter.getFailedDocuments() ? 0 : 1);
+}
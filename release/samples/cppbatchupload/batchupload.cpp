@@ -28,25 +28,22 @@
 
 class UploadObserver : public mlclient::utilities::IBatchNotifiable {
 public:
-  UploadObserver() : ex() {
+  UploadObserver() {
     ;
   }
   ~UploadObserver() {
     ;
   }
 
-  void batchOperationComplete(const std::vector<std::string> uris,bool success,std::exception exc) override {
-    std::cout << "Written files in a batch (OK?: " << success << ") :-" << std::endl;
-    for (auto& it : uris) {
+  void batchEventComplete(const mlclient::utilities::BatchEvent& event) override {
+    std::cout << "Written files in batch " << event.getSequence() << " (OK?: " << event.isSuccess() << ") :-" << std::endl;
+    for (auto& it : event.getUris()) {
       std::cout << "  " << it << std::endl;
     }
-    //if (exc) {
-      ex = exc;
-      std::cout << "  Exception: " << exc.what() << std::endl;
-    //}
+    if (!event.isSuccess()) {
+      std::cout << "  Exception: " << event.getMessage() << std::endl;
+    }
   }
-
-  std::exception ex;
 };
 
 int main(int argc, const char * argv[])
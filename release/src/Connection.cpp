@@ -17,6 +17,7 @@
 #include "mlclient/DocumentContent.hpp"
 #include "mlclient/Document.hpp"
 #include "mlclient/SearchDescription.hpp"
+#include "mlclient/HttpHeaders.hpp"
 
 #include "mlclient/internals/Credentials.hpp"
 #include "mlclient/internals/AuthenticatingProxy.hpp"
@@ -26,11 +27,41 @@
 
 #include "mlclient/logging.hpp"
 
+// We can use the following, because cpprest is an internal API dependency
+#include <cpprest/base_uri.h>
+
+#include <memory>
 #include <string>
 #include <sstream>
 
 namespace mlclient {
 
+IResponseBodyHandler::~IResponseBodyHandler() {
+  ;
+}
+
+void IResponseBodyHandler::onBodyStart(const Response& response) {
+  ;
+}
+
+Response* IConnection::searchStreamed(const SearchDescription& desc,IResponseBodyHandler& handler) {
+  Response* resp = search(desc);
+  if (nullptr == resp || ResponseCode::OK != resp->getResponseCode()) {
+    return resp;
+  }
+  const std::string body(resp->releaseContent());
+  handler.onBodyStart(*resp);
+  handler.onBodyChunk(body.data(),body.length());
+  return resp;
+}
+
+Response* IConnection::saveDocumentsToForest(const DocumentSet& documents,const long startPosInclusive,
+    const long endPosInclusive,const std::string& forestName) {
+  return saveDocuments(documents,startPosInclusive,endPosInclusive);
+}
+
+
+
 class Connection::Impl {
 public:
   Impl() : proxy(), databaseName("Documents"), serverUrl("http://localhost:8002") {
@@ -42,6 +73,18 @@ public:
     ;
   };
 
+  /**
+   * The /v1/search path and query string for the given description
+   */
+  static std::string searchPath(const SearchDescription& desc);
+
+  /**
+   * Percent encodes a value for use as a URL query string parameter
+   */
+  static std::string encode(const std::string& value) {
+    return utility::conversions::to_utf8string(web::uri::encode_data_string(utility::conversions::to_string_t(value)));
+  }
+
   std::string serverUrl;
   std::string databaseName;
   internals::AuthenticatingProxy proxy;
@@ -155,6 +198,19 @@ Response* Connection::getDocumentPermissions(Document& inout_document) {
   return resp;
 }
 
+Response* Connection::getDocuments(const DocumentUriSet& uris,const long startPosInclusive,
+    const long endPosInclusive) {
+  TIMED_FUNC(Connection_getDocuments);
+  std::ostringstream path;
+  path << "/v1/documents?category=content&format=json";
+  for (long i = startPosInclusive;i <= endPosInclusive;i++) {
+    path << "&uri=" << Impl::encode(uris.at(i));
+  }
+  HttpHeaders headers;
+  headers.setHeader("Accept","multipart/mixed");
+  return mImpl->proxy.getSync(mImpl->serverUrl, path.str(), headers);
+}
+
 Response* Connection::saveDocumentContent(const std::string& uri,const IDocumentContent& payload) {
   TIMED_FUNC(Connection_saveDocumentContent);
   return mImpl->proxy.putSync(mImpl->serverUrl,
@@ -168,6 +224,13 @@ Response* Connection::saveDocuments(const DocumentSet& documents,const long star
   return mImpl->proxy.multiPostSync(mImpl->serverUrl,"/v1/documents",documents,startPosInclusive,endPosInclusive);
 }
 
+Response* Connection::saveDocumentsToForest(const DocumentSet& documents,const long startPosInclusive,
+      const long endPosInclusive,const std::string& forestName) {
+  TIMED_FUNC(Connection_saveDocumentsToForest);
+  return mImpl->proxy.multiPostSync(mImpl->serverUrl,"/v1/documents?forest-name=" + Impl::encode(forestName),
+      documents,startPosInclusive,endPosInclusive);
+}
+
 Response* Connection::saveDocument(const Document& doc) {
   TIMED_FUNC(Connection_saveDocument__Document);
   DocumentSet set;
@@ -183,9 +246,7 @@ Response* Connection::deleteDocument(const std::string& uri) {
       );
 }
 
-Response* Connection::search(const SearchDescription& desc) {
-  TIMED_FUNC(Connection_search);
-  LOG(DEBUG) << "In Connection::search";
+std::string Connection::Impl::searchPath(const SearchDescription& desc) {
   std::ostringstream urlss;
   urlss << "/v1/search?format=";
   const std::string type = desc.getResponseMimeType();
@@ -196,11 +257,28 @@ Response* Connection::search(const SearchDescription& desc) {
   }
   urlss << "&start=" << desc.getStart();
   urlss << "&pageLength=" <<  desc.getPageLength();
+  if (!desc.getTimestamp().empty()) {
+    urlss << "&timestamp=" << desc.getTimestamp();
+  }
+  return urlss.str();
+}
+
+Response* Connection::search(const SearchDescription& desc) {
+  TIMED_FUNC(Connection_search);
+  LOG(DEBUG) << "In Connection::search";
+  const std::string path(Impl::searchPath(desc));
   LOG(DEBUG) << "  Got page length";
-  ITextDocumentContent* payload = desc.getPayload();
+  std::unique_ptr<ITextDocumentContent> payload(desc.getPayload());
   LOG(DEBUG) << "  Payload:-";
-  LOG(DEBUG) << payload->getContent();
-  return mImpl->proxy.postSync(mImpl->serverUrl,urlss.str(), *payload);
+  LOG(DEBUG) << payload->contentView();
+  return mImpl->proxy.postSync(mImpl->serverUrl,path, *payload);
+}
+
+Response* Connection::searchStreamed(const SearchDescription& desc,IResponseBodyHandler& handler) {
+  TIMED_FUNC(Connection_searchStreamed);
+  LOG(DEBUG) << "In Connection::searchStreamed";
+  std::unique_ptr<ITextDocumentContent> payload(desc.getPayload());
+  return mImpl->proxy.postStreamed(mImpl->serverUrl,Impl::searchPath(desc),*payload,handler);
 }
 
 Response* Connection::searchExtension(const std::string& extensionName,const SearchDescription& desc) {
@@ -211,9 +289,9 @@ Response* Connection::searchExtension(const std::string& extensionName,const Sea
   urlss << "&rs:start=" << desc.getStart();
   urlss << "&rs:pageLength=" <<  desc.getPageLength();
   LOG(DEBUG) << "  Got page length";
-  ITextDocumentContent* payload = desc.getPayload();
+  std::unique_ptr<ITextDocumentContent> payload(desc.getPayload());
   LOG(DEBUG) << "  Payload:-";
-  LOG(DEBUG) << payload->getContent();
+  LOG(DEBUG) << payload->contentView();
   return mImpl->proxy.postSync(mImpl->serverUrl,urlss.str(), *payload);
 }
 
@@ -7,26 +7,27 @@
 
 #include <mlclient/Document.hpp>
 
+#include <memory>
 #include <string>
 
 namespace mlclient {
 
-Document::Document() : uri(""), content(nullptr), properties(nullptr), permissions(), collections() {
+Document::Document() : uri(""), content(nullptr), properties(nullptr), permissions(), collections(), sharedContent(), sharedProperties() {
   ;
 }
-Document::Document(const std::string& uri) : uri(uri), content(nullptr), properties(nullptr), permissions(), collections() {
+Document::Document(const std::string& uri) : uri(uri), content(nullptr), properties(nullptr), permissions(), collections(), sharedContent(), sharedProperties() {
   ;
 }
 Document::Document(const std::string& uri,IDocumentContent* own_content)
-  : uri(uri), content(own_content), properties(nullptr), permissions(), collections() {
+  : uri(uri), content(own_content), properties(nullptr), permissions(), collections(), sharedContent(), sharedProperties() {
   ;
 }
 Document::Document(const std::string& uri,IDocumentContent* own_content,IDocumentContent* own_properties)
-  : uri(uri), content(own_content), properties(own_properties), permissions(), collections() {
+  : uri(uri), content(own_content), properties(own_properties), permissions(), collections(), sharedContent(), sharedProperties() {
   ;
 }
 Document::Document(const std::string& uri,IDocumentContent* own_content,IDocumentContent* own_properties,std::vector<Permission> own_permissions)
-  : uri(uri), content(own_content), properties(own_properties), permissions(own_permissions), collections() {
+  : uri(uri), content(own_content), properties(own_properties), permissions(std::move(own_permissions)), collections(), sharedContent(), sharedProperties() {
   ;
 }
 
@@ -56,6 +57,14 @@ const IDocumentContent* Document::getContent() const {
 }
 void Document::setContent(IDocumentContent* own_content) {
   content = own_content;
+  sharedContent.reset();
+}
+void Document::setContent(std::shared_ptr<const IDocumentContent> shared_content) {
+  sharedContent = std::move(shared_content);
+  content = sharedContent.get();
+}
+std::shared_ptr<const IDocumentContent> Document::getSharedContent() const {
+  return sharedContent;
 }
 const bool Document::hasContent() const {
   return nullptr != content;
@@ -69,6 +78,14 @@ const bool Document::hasProperties() const {
 }
 void Document::setProperties(IDocumentContent* own_properties) {
   properties = own_properties;
+  sharedProperties.reset();
+}
+void Document::setProperties(std::shared_ptr<const IDocumentContent> shared_properties) {
+  sharedProperties = std::move(shared_properties);
+  properties = sharedProperties.get();
+}
+std::shared_ptr<const IDocumentContent> Document::getSharedProperties() const {
+  return sharedProperties;
 }
 
 const std::vector<Permission> Document::getPermissions() const {
@@ -78,7 +95,7 @@ const bool Document::hasPermissions() const {
   return 0 != permissions.size();
 }
 void Document::setPermissions(std::vector<Permission> own_permissions) {
-  permissions = own_permissions;
+  permissions = std::move(own_permissions);
 }
 
 bool Document::operator==(const Document& other) {
@@ -20,9 +20,11 @@
 #include "mlclient/DocumentContent.hpp"
 #include "mlclient/SearchDescription.hpp"
 #include "mlclient/InvalidFormatException.hpp"
+#include <cstring>
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <streambuf>
 #include <memory>
 #include <fstream>
 #include <map>
@@ -30,6 +32,54 @@
 
 namespace mlclient {
 
+namespace {
+
+/**
+ * Reads a ContentView's bytes in place. Holds a copy of the view, so a shared buffer outlives the stream.
+ */
+class ContentViewBuffer : public std::streambuf {
+public:
+  ContentViewBuffer(const ContentView& v) : view(v) {
+    char* start = const_cast<char*>(view.data()); // never written, as there is no put area
+    setg(start,start,start + view.size());
+  }
+
+protected:
+  pos_type seekoff(off_type off,std::ios_base::seekdir dir,std::ios_base::openmode which) override {
+    off_type base = 0;
+    if (std::ios_base::cur == dir) {
+      base = gptr() - eback();
+    } else if (std::ios_base::end == dir) {
+      base = egptr() - eback();
+    }
+    const off_type target = base + off;
+    if (0 == (which & std::ios_base::in) || target < 0 || target > egptr() - eback()) {
+      return pos_type(off_type(-1));
+    }
+    setg(eback(),eback() + target,egptr());
+    return pos_type(target);
+  }
+
+  pos_type seekpos(pos_type pos,std::ios_base::openmode which) override {
+    return seekoff(off_type(pos),std::ios_base::beg,which);
+  }
+
+private:
+  ContentView view;
+};
+
+class ContentViewStream : public std::istream {
+public:
+  ContentViewStream(const ContentView& v) : std::istream(nullptr), buffer(v) {
+    rdbuf(&buffer);
+  }
+
+private:
+  ContentViewBuffer buffer;
+};
+
+} // end anonymous namespace
+
 /**
  * \brief An enumeration for use with the IDocumentContent class.
  *
@@ -50,6 +100,136 @@ const std::string IDocumentContent::MIME_DOCX("application/vnd.openxmlformats-of
 const std::string IDocumentContent::MIME_PPT("application/vnd.ms-powerpoint");
 const std::string IDocumentContent::MIME_PPTX("application/vnd.openxmlformats-officedocument.presentationml.presentation");
 
+DocumentNodeRef::DocumentNodeRef() : kind(nullptr), node(nullptr) {
+  ;
+}
+
+DocumentNodeRef::DocumentNodeRef(const IDocumentNodeKind* kind,const void* node) :
+  kind(nullptr == node ? nullptr : kind), node(nullptr == kind ? nullptr : node) {
+  ;
+}
+
+bool DocumentNodeRef::isEmpty() const {
+  return nullptr == kind;
+}
+DocumentNodeRef::operator bool() const {
+  return nullptr != kind;
+}
+
+bool DocumentNodeRef::isNull() const {
+  return nullptr != kind && kind->isNull(node);
+}
+bool DocumentNodeRef::isBoolean() const {
+  return nullptr != kind && kind->isBoolean(node);
+}
+bool DocumentNodeRef::isInteger() const {
+  return nullptr != kind && kind->isInteger(node);
+}
+bool DocumentNodeRef::isDouble() const {
+  return nullptr != kind && kind->isDouble(node);
+}
+bool DocumentNodeRef::isString() const {
+  return nullptr != kind && kind->isString(node);
+}
+bool DocumentNodeRef::isArray() const {
+  return nullptr != kind && kind->isArray(node);
+}
+bool DocumentNodeRef::isObject() const {
+  return nullptr != kind && kind->isObject(node);
+}
+
+bool DocumentNodeRef::asBoolean() const {
+  if (nullptr == kind) {
+    throw InvalidFormatException("Empty node reference is not a boolean");
+  }
+  return kind->asBoolean(node);
+}
+int32_t DocumentNodeRef::asInteger() const {
+  if (nullptr == kind) {
+    throw InvalidFormatException("Empty node reference is not an integer");
+  }
+  return kind->asInteger(node);
+}
+double DocumentNodeRef::asDouble() const {
+  if (nullptr == kind) {
+    throw InvalidFormatException("Empty node reference is not a double");
+  }
+  return kind->asDouble(node);
+}
+std::string DocumentNodeRef::asString() const {
+  if (nullptr == kind) {
+    throw InvalidFormatException("Empty node reference is not a string");
+  }
+  return kind->asString(node);
+}
+
+DocumentNodeRef DocumentNodeRef::at(const std::string& key) const {
+  return (nullptr == kind ? DocumentNodeRef() : kind->at(node,key));
+}
+DocumentNodeRef DocumentNodeRef::at(const int32_t idx) const {
+  return (nullptr == kind || idx < 0 ? DocumentNodeRef() : kind->at(node,idx));
+}
+std::vector<DocumentNodeRef> DocumentNodeRef::members() const {
+  return (nullptr == kind ? std::vector<DocumentNodeRef>() : kind->members(node));
+}
+bool DocumentNodeRef::has(const std::string& key) const {
+  return nullptr != kind && kind->has(node,key);
+}
+StringList DocumentNodeRef::keys() const {
+  return (nullptr == kind ? StringList() : kind->keys(node));
+}
+int32_t DocumentNodeRef::size() const {
+  return (nullptr == kind ? 0 : kind->size(node));
+}
+
+IDocumentNode* DocumentNodeRef::newNode() const {
+  return (nullptr == kind ? nullptr : kind->newNode(node));
+}
+
+bool DocumentNodeRef::operator==(const DocumentNodeRef& other) const {
+  return kind == other.kind && node == other.node;
+}
+bool DocumentNodeRef::operator!=(const DocumentNodeRef& other) const {
+  return !(*this == other);
+}
+
+const IDocumentNodeKind* DocumentNodeRef::getKind() const {
+  return kind;
+}
+const void* DocumentNodeRef::getNode() const {
+  return node;
+}
+
+
+
+IDocumentNodeKind::IDocumentNodeKind() {
+  return;
+}
+
+IDocumentNodeKind::~IDocumentNodeKind() {
+  return;
+}
+
+std::vector<DocumentNodeRef> IDocumentNodeKind::members(const void* node) const {
+  std::vector<DocumentNodeRef> all;
+  if (!isArray(node)) {
+    all.push_back(DocumentNodeRef(this,node));
+    return all;
+  }
+  const int32_t count = size(node);
+  all.reserve(count);
+  for (int32_t i = 0;i < count;i++) {
+    all.push_back(at(node,i));
+  }
+  return all;
+}
+
+bool IDocumentNodeKind::has(const void* node,const std::string& key) const {
+  return !at(node,key).isEmpty();
+}
+
+
+
 IDocumentNode::IDocumentNode() {
   return;
 }
@@ -58,6 +238,115 @@ IDocumentNode::~IDocumentNode() {
   return;
 }
 
+DocumentNodeRef IDocumentNode::ref() const {
+  return DocumentNodeRef();
+}
+
+IDocumentNode* IDocumentNode::newNode(const DocumentNodeRef& ref) const {
+  return ref.newNode();
+}
+
+IDocumentNode* IDocumentNode::tryAt(const std::string& key) const {
+  try {
+    return (has(key) ? at(key) : nullptr);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+IDocumentNode* IDocumentNode::tryAt(const int32_t idx) const {
+  try {
+    return ((isArray() && idx >= 0 && idx < size()) ? at(idx) : nullptr);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+/**
+ * Reads a simple value, returning the default if the node is missing, is a container, or cannot be read as the
+ * requested type
+ */
+template<typename N,typename T,typename Read>
+static T readValue(const N* child,const T& defaultValue,Read read) {
+  if (nullptr == child || child->isArray() || child->isObject()) {
+    return defaultValue;
+  }
+  try {
+    return read(*child);
+  } catch (...) {
+    return defaultValue; // wrong type, E.g. a JSON number read as a string
+  }
+}
+
+/**
+ * Reads a simple child value of a node or navigator. Uses its DocumentNodeRef where supported, to avoid allocating.
+ */
+template<typename N,typename T,typename Read>
+static T valueAt(const N& parent,const std::string& key,const T& defaultValue,Read read) {
+  const DocumentNodeRef self = parent.ref();
+  if (!self.isEmpty()) {
+    const DocumentNodeRef child = self.at(key);
+    return readValue(child.isEmpty() ? nullptr : &child,defaultValue,read);
+  }
+  std::unique_ptr<IDocumentNode> child(parent.tryAt(key));
+  return readValue(child.get(),defaultValue,read);
+}
+
+namespace {
+
+struct ReadString {
+  template<typename N> std::string operator()(const N& node) const {
+    return node.asString();
+  }
+};
+struct ReadInteger {
+  template<typename N> int32_t operator()(const N& node) const {
+    return node.asInteger();
+  }
+};
+struct ReadDouble {
+  template<typename N> double operator()(const N& node) const {
+    return node.asDouble();
+  }
+};
+struct ReadBoolean {
+  template<typename N> bool operator()(const N& node) const {
+    return node.asBoolean();
+  }
+};
+
+} // end anonymous namespace
+
+std::string DocumentNodeRef::getString(const std::string& key,const std::string& defaultValue) const {
+  const DocumentNodeRef child = at(key);
+  return readValue(child.isEmpty() ? nullptr : &child,defaultValue,ReadString());
+}
+int32_t DocumentNodeRef::getInteger(const std::string& key,const int32_t defaultValue) const {
+  const DocumentNodeRef child = at(key);
+  return readValue(child.isEmpty() ? nullptr : &child,defaultValue,ReadInteger());
+}
+double DocumentNodeRef::getDouble(const std::string& key,const double defaultValue) const {
+  const DocumentNodeRef child = at(key);
+  return readValue(child.isEmpty() ? nullptr : &child,defaultValue,ReadDouble());
+}
+bool DocumentNodeRef::getBoolean(const std::string& key,const bool defaultValue) const {
+  const DocumentNodeRef child = at(key);
+  return readValue(child.isEmpty() ? nullptr : &child,defaultValue,ReadBoolean());
+}
+
+std::string IDocumentNode::getString(const std::string& key,const std::string& defaultValue) const {
+  return valueAt(*this,key,defaultValue,ReadString());
+}
+int32_t IDocumentNode::getInteger(const std::string& key,const int32_t defaultValue) const {
+  return valueAt(*this,key,defaultValue,ReadInteger());
+}
+double IDocumentNode::getDouble(const std::string& key,const double defaultValue) const {
+  return valueAt(*this,key,defaultValue,ReadDouble());
+}
+bool IDocumentNode::getBoolean(const std::string& key,const bool defaultValue) const {
+  return valueAt(*this,key,defaultValue,ReadBoolean());
+}
+
 IDocumentNavigator::IDocumentNavigator() {
   return;
 }
@@ -66,6 +355,91 @@ IDocumentNavigator::~IDocumentNavigator() {
   return;
 }
 
+DocumentNodeRef IDocumentNavigator::ref() const {
+  return DocumentNodeRef();
+}
+
+IDocumentNode* IDocumentNavigator::newNode(const DocumentNodeRef& ref) const {
+  return ref.newNode();
+}
+
+IDocumentNode* IDocumentNavigator::tryAt(const std::string& key) const {
+  try {
+    return (has(key) ? at(key) : nullptr);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+std::string IDocumentNavigator::getString(const std::string& key,const std::string& defaultValue) const {
+  return valueAt(*this,key,defaultValue,ReadString());
+}
+int32_t IDocumentNavigator::getInteger(const std::string& key,const int32_t defaultValue) const {
+  return valueAt(*this,key,defaultValue,ReadInteger());
+}
+double IDocumentNavigator::getDouble(const std::string& key,const double defaultValue) const {
+  return valueAt(*this,key,defaultValue,ReadDouble());
+}
+bool IDocumentNavigator::getBoolean(const std::string& key,const bool defaultValue) const {
+  return valueAt(*this,key,defaultValue,ReadBoolean());
+}
+
+
+ContentView::ContentView() : mData(""), mSize(0), mShared() {
+  ;
+}
+
+ContentView::ContentView(const std::string& text) : mData(text.data()), mSize(text.size()), mShared() {
+  ;
+}
+
+ContentView::ContentView(const char* data,const size_t size) : mData(nullptr == data ? "" : data), mSize(size),
+  mShared() {
+  ;
+}
+
+ContentView::ContentView(std::shared_ptr<const std::string> shared) : mData(""), mSize(0), mShared(std::move(shared)) {
+  if (mShared) {
+    mData = mShared->data();
+    mSize = mShared->size();
+  }
+}
+
+const char* ContentView::data() const {
+  return mData;
+}
+size_t ContentView::size() const {
+  return mSize;
+}
+bool ContentView::empty() const {
+  return 0 == mSize;
+}
+const char* ContentView::begin() const {
+  return mData;
+}
+const char* ContentView::end() const {
+  return mData + mSize;
+}
+
+std::string ContentView::str() const {
+  return std::string(mData,mSize);
+}
+
+std::istream* ContentView::openStream() const {
+  return new ContentViewStream(*this);
+}
+
+bool ContentView::operator==(const std::string& other) const {
+  return mSize == other.size() && 0 == std::memcmp(mData,other.data(),mSize);
+}
+bool ContentView::operator!=(const std::string& other) const {
+  return !(*this == other);
+}
+
+std::ostream& operator<<(std::ostream& os,const ContentView& view) {
+  return os.write(view.data(),view.size());
+}
+
 
 IDocumentContent::IDocumentContent() {
   //TIMED_FUNC(IDocumentContent_defaultConstructor);
@@ -79,6 +453,14 @@ IDocumentContent::~IDocumentContent() {
   return;
 }
 
+ContentView IDocumentContent::contentView() const {
+  return ContentView(std::make_shared<const std::string>(getContent()));
+}
+
+size_t IDocumentContent::size() const {
+  return contentView().size();
+}
+
 
 
 
@@ -148,17 +530,25 @@ int BinaryDocumentContent::getLength() {
 
 class GenericTextDocumentContent::Impl {
 public:
-  Impl() {
+  Impl() : content(emptyObject()), mimeType(IDocumentContent::MIME_JSON) {
     TIMED_FUNC(GenericTextDocumentContent_Impl_defaultConstructor);
     LOG(DEBUG) << "    GenericTextDocumentContent::Impl::defaultConstructor @" << &*this;
-    this->content = std::unique_ptr<std::string>(new std::string("{}")); // MUST BE INITIALISED
-    this->mimeType = IDocumentContent::MIME_JSON;
     return;
   }
   ~Impl() {
     ;
   }
-  std::unique_ptr<std::string> content;
+
+  /**
+   * The "{}" buffer every new instance starts with, shared rather than allocated per instance
+   */
+  static const std::shared_ptr<const std::string>& emptyObject() {
+    static const std::shared_ptr<const std::string> empty(std::make_shared<const std::string>("{}"));
+    return empty;
+  }
+
+  // Never modified in place. Copies share this buffer, and setContent replaces it (copy on write).
+  std::shared_ptr<const std::string> content; // MUST BE INITIALISED
   std::string mimeType;
 };
 
@@ -171,23 +561,24 @@ GenericTextDocumentContent::GenericTextDocumentContent() : ITextDocumentContent:
 GenericTextDocumentContent::GenericTextDocumentContent(const GenericTextDocumentContent& doc) : ITextDocumentContent::ITextDocumentContent(doc), mImpl(new Impl) {
   TIMED_FUNC(GenericTextDocumentContent_copyGenericConstructor);
   LOG(DEBUG) << "    GenericTextDocumentContent::copyConstructor @ " << &*this;
-  std::ostringstream oss;
-  oss << *(doc.this->mImpl->content);
-  this->mImpl->content = std::unique_ptr<std::string>(new std::string(oss.str())); // copy constructor
+  this->mImpl->content = doc.mImpl->content; // shares the immutable buffer
   this->mImpl->mimeType = doc.getMimeType();
   return;
 }
 GenericTextDocumentContent::GenericTextDocumentContent(const ITextDocumentContent& doc) : ITextDocumentContent::ITextDocumentContent(doc), mImpl(new Impl) {
   TIMED_FUNC(GenericTextDocumentContent_copyITextConstructor);
   LOG(DEBUG) << "    GenericTextDocumentContent::copyConstructor @ " << &*this;
-  std::ostringstream oss;
-  oss << doc.getContent();
-  this->mImpl->content = std::unique_ptr<std::string>(new std::string(oss.str())); // copy constructor
+  const GenericTextDocumentContent* generic = dynamic_cast<const GenericTextDocumentContent*>(&doc);
+  if (nullptr != generic) {
+    this->mImpl->content = generic->mImpl->content; // shares the immutable buffer
+  } else {
+    this->mImpl->content = std::make_shared<const std::string>(doc.getContent()); // moves the returned copy
+  }
   this->mImpl->mimeType = doc.getMimeType();
   return;
 }
 GenericTextDocumentContent::~GenericTextDocumentContent() {
-  LOG(DEBUG) << "    GenericTextDocumentContent::destructor @ " << &*this << " : " << *(this->mImpl->content.get());
+  LOG(DEBUG) << "    GenericTextDocumentContent::destructor @ " << &*this << " : " << *(this->mImpl->content);
   delete mImpl;
   mImpl = nullptr;
   LOG(DEBUG) << "    GenericTextDocumentContent::destructor @ " << &*this << " complete.";
@@ -196,7 +587,8 @@ GenericTextDocumentContent::~GenericTextDocumentContent() {
 void GenericTextDocumentContent::setContent(std::string content) {
   TIMED_FUNC(GenericTextDocumentContent_setContent);
   LOG(DEBUG) << "GenericTextDocumentContent::setContent: " << content;
-  this->mImpl->content = std::unique_ptr<std::string>(new std::string(content)); // Force copy constructor
+  // a new buffer, so copies and views of the old content are unaffected
+  this->mImpl->content = std::make_shared<const std::string>(std::move(content)); // the caller chooses whether content was copied or moved in
   return;
 }
 std::string GenericTextDocumentContent::getContent() const {
@@ -207,12 +599,17 @@ int GenericTextDocumentContent::getLength() const {
   return this->mImpl->content->size();
 }
 
+ContentView GenericTextDocumentContent::contentView() const {
+  return ContentView(this->mImpl->content); // keeps the buffer alive for as long as the view
+}
+
+size_t GenericTextDocumentContent::size() const {
+  return this->mImpl->content->size();
+}
+
 std::istream* GenericTextDocumentContent::getStream() const {
   TIMED_FUNC(GenericTextDocumentContent_getStream);
-  std::istringstream* os = new std::istringstream(*(this->mImpl->content));
-  //std::ostringstream* os = new std::ostringstream;
-  //(*os) << this->mImpl->content.get();
-  return os;
+  return contentView().openStream();
 }
 
 std::string GenericTextDocumentContent::getMimeType() const {
@@ -318,5 +318,11 @@ void Response::setContent(std::string&& content) {
   mImpl->content = std::move(content);
 }
 
+std::string Response::releaseContent() {
+  std::string content(std::move(mImpl->content));
+  mImpl->content.clear(); // a moved from string is only valid, not necessarily empty
+  return content;
+}
+
 
 } // end namespace mlclient
@@ -31,7 +31,7 @@ namespace mlclient {
 
 class SearchDescription::Impl {
 public:
-  Impl() : start(1), pageLength(10),responseMime(IDocumentContent::MIME_JSON) {
+  Impl() : start(1), pageLength(10),responseMime(IDocumentContent::MIME_JSON), timestamp() {
     TIMED_FUNC(SearchDescription_Impl_defaultConstructor);
     LOG(DEBUG) << "    SearchDescription::Impl::defaultConstructor @" << &*this;
     GenericTextDocumentContent* qtdc = new GenericTextDocumentContent();
@@ -57,6 +57,7 @@ public:
   long start;
   long pageLength;
   std::string responseMime;
+  std::string timestamp;
 }; // end SearchDescription::Impl class
 
 
@@ -67,50 +68,25 @@ SearchDescription::SearchDescription() : mImpl(new Impl) {
 
 SearchDescription::SearchDescription(const SearchDescription& desc) : mImpl(new Impl) {
   LOG(DEBUG) << "    SearchDescription::copyConstructor @" << &*this;
-  //LOG(DEBUG) << "0";
-  ITextDocumentContent* od = new GenericTextDocumentContent();
-  LOG(DEBUG) << 1;
+  // the copies share the immutable content buffers of desc, so only the metadata is copied
   if (nullptr == desc.mImpl->options) {
-    //LOG(DEBUG) << "1.5";
+    ITextDocumentContent* od = new GenericTextDocumentContent();
     od->setContent("{}");
-    //LOG(DEBUG) << "1.6";
     od->setMimeType(mlclient::IDocumentContent::MIME_JSON);
+    mImpl->options = std::unique_ptr<ITextDocumentContent>(od);
   } else {
-    //LOG(DEBUG) << "1.997";
-    ITextDocumentContent* itdcOp = desc.mImpl->options.get();
-    //LOG(DEBUG) << "1.998";
-    //LOG(DEBUG) << " options doc is null?: " << (nullptr == itdcOp);
-    if (nullptr == itdcOp) {
-      //LOG(DEBUG) << "options ptr is null";
-    }
-    std::string ctnt = itdcOp->getContent();
-    //LOG(DEBUG) << "1.999";
-    od->setContent(ctnt); // WTF IS WRONG WITH THIS LINE??????????? BREAK IT DOWN...
-    //LOG(DEBUG) << 2;
-    od->setMimeType(desc.mImpl->options->getMimeType());
+    mImpl->options = std::unique_ptr<ITextDocumentContent>(new GenericTextDocumentContent(*(desc.mImpl->options)));
   }
-  //LOG(DEBUG) << 3;
-  mImpl->options = std::unique_ptr<ITextDocumentContent>(od);
-  //LOG(DEBUG) << 4;
   mImpl->pageLength = desc.mImpl->pageLength;
   mImpl->responseMime = desc.mImpl->responseMime;
-  //LOG(DEBUG) << 5;
-  ITextDocumentContent* qd = new GenericTextDocumentContent();
-  //LOG(DEBUG) << 6;
   if (nullptr == desc.mImpl->query) {
-    //LOG(DEBUG) << "6.5";
+    ITextDocumentContent* qd = new GenericTextDocumentContent();
     qd->setContent("{}");
-    //LOG(DEBUG) << "6.6";
     qd->setMimeType(mlclient::IDocumentContent::MIME_JSON);
+    mImpl->query = std::unique_ptr<ITextDocumentContent>(qd);
   } else {
-    //LOG(DEBUG) << "6.999";
-    qd->setContent(desc.mImpl->query->getContent());
-    //LOG(DEBUG) << 7;
-    qd->setMimeType(desc.mImpl->query->getMimeType());
+    mImpl->query = std::unique_ptr<ITextDocumentContent>(new GenericTextDocumentContent(*(desc.mImpl->query)));
   }
-  //LOG(DEBUG) << 8;
-  mImpl->query = std::unique_ptr<ITextDocumentContent>(qd);
-  //LOG(DEBUG) << 9;
   if (nullptr == desc.mImpl->queryText) {
     //LOG(DEBUG) << "9.1";
     mImpl->queryText = std::unique_ptr<std::string>(new std::string(""));
@@ -120,6 +96,7 @@ SearchDescription::SearchDescription(const SearchDescription& desc) : mImpl(new
   }
   //LOG(DEBUG) << 10;
   mImpl->start = desc.mImpl->start;
+  mImpl->timestamp = desc.mImpl->timestamp;
   LOG(DEBUG) << "    SearchDescription::copyConstructor @ " << &*this << " complete.";
 }
 
@@ -197,20 +174,31 @@ ITextDocumentContent* SearchDescription::getPayload() const {
   if (0==IDocumentContent::MIME_XML.compare(mImpl->query.get()->getMimeType())) {
     offset = 1;
   }
-  std::string qcontent = mImpl->query.get()->getContent();
-  if (""==qcontent && 0==IDocumentContent::MIME_JSON.compare(mImpl->query.get()->getMimeType())) {
-    qcontent = "{}";
+  // appended in place rather than copied out, with an empty JSON query or options sent as an empty object
+  const ContentView qcontent = mImpl->query.get()->contentView();
+  const bool qempty = qcontent.empty() && 0==IDocumentContent::MIME_JSON.compare(mImpl->query.get()->getMimeType());
+  const ContentView ocontent = mImpl->options.get()->contentView();
+  const bool oempty = ocontent.empty() && 0==IDocumentContent::MIME_JSON.compare(mImpl->options.get()->getMimeType());
+  const std::string& qtext = *(mImpl->queryText.get());
+  std::string payloadString;
+  payloadString.reserve(qcontent.size() + ocontent.size() + qtext.length() + 64);
+  payloadString += elements[0+offset];
+  if (qempty) {
+    payloadString += "{}";
+  } else {
+    payloadString.append(qcontent.data(),qcontent.size());
   }
-  std::string ocontent = mImpl->options.get()->getContent();
-  if (""==ocontent && 0==IDocumentContent::MIME_JSON.compare(mImpl->options.get()->getMimeType())) {
-    ocontent = "{}";
+  payloadString += elements[8+offset];
+  if (oempty) {
+    payloadString += "{}";
+  } else {
+    payloadString.append(ocontent.data(),ocontent.size());
   }
-  std::string payloadString =
-      elements[0+offset] +
-        mImpl->query.get()->getContent() + elements[8+offset] +
-        mImpl->options.get()->getContent() + elements[10+offset]  +
-        elements[4+offset] + *(mImpl->queryText.get()) + elements[6+offset] +
-      elements[2+offset];
+  payloadString += elements[10+offset];
+  payloadString += elements[4+offset];
+  payloadString += qtext;
+  payloadString += elements[6+offset];
+  payloadString += elements[2+offset];
   LOG(DEBUG) << "    got payload string: " << payloadString;
   GenericTextDocumentContent* payload = new GenericTextDocumentContent;
   payload->setMimeType(mImpl->query.get()->getMimeType());
@@ -244,4 +232,12 @@ const std::string SearchDescription::getResponseMimeType() const {
   return mImpl->responseMime;
 }
 
+void SearchDescription::setTimestamp(const std::string& timestamp) {
+  mImpl->timestamp = timestamp;
+}
+
+const std::string& SearchDescription::getTimestamp() const {
+  return mImpl->timestamp;
+}
+
 } // end namespace mlclient
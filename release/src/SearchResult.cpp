@@ -9,129 +9,349 @@
 #include "mlclient/DocumentContent.hpp"
 #include "mlclient/logging.hpp"
 
+// We can use the following, because cpprest is an internal API dependency
+#include "mlclient/utilities/CppRestJsonHelper.hpp"
+#include "mlclient/utilities/NativeJsonDocumentContent.hpp"
+#include "mlclient/utilities/DocumentHelper.hpp"
+#include <cpprest/json.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
 namespace mlclient {
 
+using mlclient::utilities::DocumentHelper;
+
+namespace {
+
+/**
+ * A node, and the owner of the parsed response it points in to
+ */
+struct KeptNode {
+  std::shared_ptr<const void> document;
+  std::shared_ptr<IDocumentNode> node; // declared after the document, so freed before it
+};
+
+/**
+ * A custom JSON snippet, re-parsed in to its own document
+ */
+struct ParsedSnippet {
+  std::unique_ptr<IDocumentContent> content;
+  std::unique_ptr<IDocumentNavigator> navigator;
+  std::unique_ptr<IDocumentNode> node; // declared last, so freed before the document it points in to
+};
+
+/**
+ * Returns node, sharing ownership of the document it points in to, so it remains valid whoever holds it
+ */
+std::shared_ptr<IDocumentNode> keepDocument(const std::shared_ptr<const void>& document,
+    std::shared_ptr<IDocumentNode> node) {
+  if (nullptr == node.get()) {
+    return node;
+  }
+  std::shared_ptr<KeptNode> kept(std::make_shared<KeptNode>());
+  kept->document = document;
+  kept->node = std::move(node);
+  return std::shared_ptr<IDocumentNode>(kept,kept->node.get());
+}
+
+} // end anonymous namespace
+
 class SearchResult::Impl {
 public:
-  Impl() {
+  Impl() : index(0), uri(), path(), score(0), confidence(0.0), fitness(0.0), mimeType(), format(Format::JSON),
+    detail(Detail::NONE), detailContent(), metadataDecoded(false), contentDone(false), contentDecoded(false),
+    contentMutex() {
     ;
   }
+
+  Impl(const Impl& other) : index(other.index), uri(other.uri), path(other.path), score(other.score),
+    confidence(other.confidence), fitness(other.fitness), mimeType(other.mimeType), format(other.format),
+    detail(Detail::NONE), detailContent(), metadataDecoded(other.metadataDecoded), contentDone(false),
+    contentDecoded(false), contentMutex() {
+    std::lock_guard<std::mutex> lock(other.contentMutex);
+    detail = other.detail;
+    detailContent = other.detailContent; // shares the node, which keeps its own document alive
+    contentDone = other.contentDone.load();
+    contentDecoded = other.contentDecoded.load();
+  }
+
+  /**
+   * Decodes all scalar fields from the row. A missing field is left at its default.
+   */
+  void decodeMetadata(const DocumentNodeRef& row) {
+    metadataDecoded = true;
+    index = row.getInteger("index");
+    uri = row.getString("uri");
+    path = row.getString("path");
+    score = row.getInteger("score");
+    confidence = row.getDouble("confidence");
+    fitness = row.getDouble("fitness");
+    mimeType = row.getString("mimetype");
+    std::string formatStr = row.getString("format");
+    if ("json" == formatStr) {
+      format = Format::JSON;
+    } else if ("xml" == formatStr) {
+      format = Format::XML;
+    } else if ("binary" == formatStr) {
+      format = Format::BINARY;
+    } else if ("text" == formatStr) {
+      format = Format::TEXT;
+    } else {
+      format = Format::NONE;
+    }
+  }
+
+  /**
+   * Finds the detail content for the response's snippet format, once. Custom JSON snippets are re-parsed here.
+   */
+  void decodeContent(const DocumentNodeRef& row,RowFormat rowFormat,const std::shared_ptr<const void>* document) {
+    if (contentDone) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(contentMutex);
+    if (contentDone || row.isEmpty()) {
+      contentDone = true;
+      return;
+    }
+    contentDecoded = true;
+    contentDone = true;
+    if (RowFormat::RAW == rowFormat) {
+      DocumentNodeRef content = row.at("search:content");
+      if (!content.isEmpty()) {
+        detailContent = keepDocument(*document,DocumentHelper::objectOf(content.newNode()));
+      } else {
+        // no content element, just use entire element
+        detailContent = keepDocument(*document,std::shared_ptr<IDocumentNode>(row.newNode()));
+      }
+    } else if (RowFormat::CUSTOM == rowFormat) {
+      // Assume the custom snippet information is within the <snippet> element in the search response
+      DocumentNodeRef snippet = row.at("search:snippet");
+      if (snippet.isEmpty()) {
+        // no snippet element, must be some sort of content...
+        detail = Detail::CONTENT;
+        LOG(DEBUG) << "SearchResult::Impl::decodeContent   Result has no snippet element";
+        return;
+      }
+      try {
+        // If search result format type is XML, but content is JSON, convert the search snippet to the right doc type
+        if ("json" == row.getString("format")) {
+          std::shared_ptr<ParsedSnippet> parsed(std::make_shared<ParsedSnippet>());
+          if (utilities::JsonBackend::NATIVE == DocumentHelper::getJsonBackend()) {
+            utilities::NativeJsonDocumentContent* native = new utilities::NativeJsonDocumentContent;
+            parsed->content.reset(native);
+            native->setContent(snippet.asString());
+          } else {
+            web::json::value val = mlclient::utilities::CppRestJsonHelper::fromString(snippet.asString());
+            parsed->content.reset(mlclient::utilities::CppRestJsonHelper::toDocument(val));
+          }
+          parsed->navigator.reset(((ITextDocumentContent*)parsed->content.get())->navigate(false));
+          parsed->node.reset(parsed->navigator->firstChild()); // TODO verify this is correct
+          detailContent = std::shared_ptr<IDocumentNode>(parsed,parsed->node.get());
+        } else {
+          detailContent = keepDocument(*document,DocumentHelper::objectOf(snippet.newNode()));
+        }
+        detail = Detail::SNIPPETS;
+      } catch (std::exception& ex) {
+        // custom JSON snippet that could not be parsed
+        detail = Detail::CONTENT;
+        LOG(DEBUG) << "SearchResult::Impl::decodeContent   Could not parse custom snippet: " << ex.what();
+      }
+    } else {
+      DocumentNodeRef matches = row.at("search:matches");
+      if (!matches.isEmpty()) {
+        detailContent = keepDocument(*document,DocumentHelper::objectOf(matches.newNode()));
+        detail = Detail::SNIPPETS;
+      } else {
+        // no snippet element, must be some sort of content...
+        detail = Detail::CONTENT;
+        LOG(DEBUG) << "SearchResult::Impl::decodeContent   Result has no matches element";
+      }
+    }
+  }
+
+  long index;
+  std::string uri;
+  std::string path;
+  long score;
+  double confidence;
+  double fitness;
+  std::string mimeType;
+  Format format;
+
+  Detail detail;
+  std::shared_ptr<IDocumentNode> detailContent; // shares ownership of the document it points in to
+
+  bool metadataDecoded; // only set when decoded from a row
+  std::atomic<bool> contentDone; // decoded, or released, so never decoded later
+  std::atomic<bool> contentDecoded; // only set when decoded from a row
+  mutable std::mutex contentMutex;
 };
 
-SearchResult::SearchResult() : mImpl(new Impl), index(0),uri(""),path(""),score(0),confidence(0.0),fitness(0.0),detail(Detail::NONE),detailContent(nullptr), format(Format::JSON) {
+SearchResult::SearchResult() : mRow(), mDocument(nullptr), mOwnDocument(), mRowFormat(RowFormat::MATCHES),
+  mImpl(nullptr) {
   //TIMED_FUNC(SearchResult_defaultConstructor);
   //LOG(DEBUG) << "    SearchResult::defaultConstructor @" << &*this;
 }
 
+SearchResult::SearchResult(const SearchResult& other) : mRow(other.mRow), mDocument(nullptr), mOwnDocument(),
+  mRowFormat(other.mRowFormat), mImpl(nullptr) {
+  if (nullptr != other.mDocument) {
+    mOwnDocument = *other.mDocument; // so the copy may outlive the page the row is in
+    mDocument = &mOwnDocument;
+  }
+  Impl* decoded = other.mImpl.load();
+  if (nullptr != decoded) {
+    mImpl = new Impl(*decoded);
+  }
+}
+
 SearchResult::~SearchResult() {
   //TIMED_FUNC(SearchResult_destructor);
   //LOG(DEBUG) << "    SearchResult::destructor @" << &*this;
-  //delete this->detailContent;
-  //detailContent = nullptr;
+  delete mImpl.load();
 }
 
-SearchResult::SearchResult(const long index, const std::string& uri, const std::string& path,const long score,
+SearchResult::SearchResult(const long index, std::string uri, std::string path,const long score,
     const double confidence,const double fitness,const Detail& detail,std::shared_ptr<IDocumentNode>& own_detailContent,
-    const std::string& mimeType,const Format& format) : mImpl(new Impl) {
+    std::string mimeType,const Format& format) : mRow(), mDocument(nullptr), mOwnDocument(),
+    mRowFormat(RowFormat::MATCHES), mImpl(new Impl) {
   //TIMED_FUNC(SearchResult_detailConstructor);
   //LOG(DEBUG) << "    SearchResult::detailedConstructor @" << &*this;
-  this->index = index;
-  this->uri = uri;
-  this->path = path;
-  this->score = score;
-  this->confidence = confidence;
-  this->fitness = fitness;
-  this->detail = detail;
-  this->detailContent = own_detailContent;
-  this->mimeType = mimeType;
-  this->format = format;
-}
-
-SearchResult::SearchResult(SearchResult&& other) {
+  Impl* values = mImpl.load();
+  values->index = index;
+  values->uri = std::move(uri);
+  values->path = std::move(path);
+  values->score = score;
+  values->confidence = confidence;
+  values->fitness = fitness;
+  values->detail = detail;
+  values->detailContent = own_detailContent;
+  values->mimeType = std::move(mimeType);
+  values->format = format;
+}
+
+SearchResult::SearchResult(const DocumentNodeRef& row,const std::string& snippetFormat,
+    const std::shared_ptr<const void>& document) : mRow(row), mDocument(&document), mOwnDocument(),
+    mRowFormat(RowFormat::MATCHES), mImpl(nullptr) {
+  if ("raw" == snippetFormat) {
+    mRowFormat = RowFormat::RAW;
+  } else if ("custom" == snippetFormat) {
+    mRowFormat = RowFormat::CUSTOM;
+  }
+}
+
+SearchResult::SearchResult(SearchResult&& other) noexcept : mRow(other.mRow), mDocument(other.mDocument),
+  mOwnDocument(std::move(other.mOwnDocument)), mRowFormat(other.mRowFormat), mImpl(other.mImpl.exchange(nullptr)) {
   //TIMED_FUNC(SearchResult_moveConstructor);
   //LOG(DEBUG) << "    SearchResult::moveConstructor @" << &*this;
-  mImpl = other.mImpl;
-  other.mImpl = nullptr;
-  this->index = std::move(other.index);
-  this->uri = std::move(other.uri);
-  this->path = std::move(other.path);
-  this->score = std::move(other.score);
-  this->fitness = std::move(other.fitness);
-  this->detail = std::move(other.detail);
-  this->detailContent = other.detailContent;
-  //other.detailContent = nullptr;
-  this->mimeType = std::move(other.mimeType);
-  this->format = std::move(other.format);
-  this->confidence = std::move(other.confidence);
-}
-
-SearchResult& SearchResult::operator= (const SearchResult&& other) {
-  //LOG(DEBUG) << "    SearchResult::copy assignment operator @" << &*this;
+  if (&other.mOwnDocument == mDocument) {
+    mDocument = &mOwnDocument;
+  }
+  other.mRow = DocumentNodeRef(); // leave the moved from result empty but usable
+  other.mDocument = nullptr;
+}
 
-  this->index = other.index;
-  this->uri = other.uri;
-  this->path = other.path;
-  this->score = other.score;
-  this->fitness = other.fitness;
-  this->detail = other.detail;
-  this->detailContent = other.detailContent;
-  this->mimeType = other.mimeType;
-  this->format = other.format;
-  this->confidence = other.confidence;
+SearchResult& SearchResult::operator= (const SearchResult& other) {
+  //LOG(DEBUG) << "    SearchResult::copy assignment operator @" << &*this;
+  if (this != &other) {
+    SearchResult copy(other);
+    *this = std::move(copy);
+  }
   return *this;
 }
 
-SearchResult& SearchResult::operator= (SearchResult&& other) {
+SearchResult& SearchResult::operator= (SearchResult&& other) noexcept {
   //LOG(DEBUG) << "    SearchResult::move assignment operator @" << &*this;
-  mImpl = other.mImpl;
-  other.mImpl = nullptr;
-  this->index = std::move(other.index);
-  this->uri = std::move(other.uri);
-  this->path = std::move(other.path);
-  this->score = std::move(other.score);
-  this->fitness = std::move(other.fitness);
-  this->detail = std::move(other.detail);
-  this->detailContent = other.detailContent;
-  other.detailContent = nullptr;
-  this->mimeType = std::move(other.mimeType);
-  this->format = std::move(other.format);
-  this->confidence = std::move(other.confidence);
+  if (this != &other) {
+    delete mImpl.exchange(other.mImpl.exchange(nullptr));
+    mRow = other.mRow;
+    mOwnDocument = std::move(other.mOwnDocument);
+    mDocument = (&other.mOwnDocument == other.mDocument ? &mOwnDocument : other.mDocument);
+    mRowFormat = other.mRowFormat;
+    other.mRow = DocumentNodeRef();
+    other.mDocument = nullptr;
+  }
   return *this;
 }
 
+/**
+ * Returns the decoded fields, allocating them and decoding a lazy result's metadata on first access
+ */
+SearchResult::Impl& SearchResult::impl() const {
+  Impl* decoded = mImpl.load();
+  if (nullptr != decoded) {
+    return *decoded;
+  }
+  std::unique_ptr<Impl> created(new Impl);
+  if (!mRow.isEmpty()) {
+    created->decodeMetadata(mRow);
+  }
+  if (mImpl.compare_exchange_strong(decoded,created.get())) {
+    decoded = created.release();
+  } // else decoded by another thread at the same time, which compare_exchange_strong has placed in decoded
+  return *decoded;
+}
+
 long SearchResult::getIndex() {
-  return index;
+  return impl().index;
 }
 const std::string& SearchResult::getUri() const {
-  return uri;
+  return impl().uri;
 }
 const std::string& SearchResult::getPath() const {
-  return path;
+  return impl().path;
 }
 long SearchResult::getScore() {
-  return score;
+  return impl().score;
 }
 double SearchResult::getConfidence() {
-  return confidence;
+  return impl().confidence;
 }
 double SearchResult::getFitness() {
-  return fitness;
+  return impl().fitness;
 }
 const SearchResult::Detail& SearchResult::getDetail() const {
-  return detail;
+  Impl& decoded = impl();
+  decoded.decodeContent(mRow,mRowFormat,mDocument);
+  return decoded.detail;
 }
 std::shared_ptr<IDocumentNode> SearchResult::getDetailContent() const {
   //TIMED_FUNC(SearchResult_getDetailContent);
-  return detailContent;
+  Impl& decoded = impl();
+  decoded.decodeContent(mRow,mRowFormat,mDocument);
+  std::lock_guard<std::mutex> lock(decoded.contentMutex);
+  return decoded.detailContent;
+}
+bool SearchResult::isMetadataDecoded() const {
+  Impl* decoded = mImpl.load();
+  return nullptr != decoded && decoded->metadataDecoded;
+}
+bool SearchResult::isContentDecoded() const {
+  Impl* decoded = mImpl.load();
+  return nullptr != decoded && decoded->contentDecoded;
 }
 void SearchResult::releaseContent() {
-  detailContent.reset();
+  Impl& decoded = impl(); // keeps the metadata
+  {
+    std::lock_guard<std::mutex> lock(decoded.contentMutex);
+    decoded.contentDone = true; // never decode it later
+    decoded.detailContent.reset();
+  }
+  if (&mOwnDocument == mDocument) {
+    // a copy, so nothing else needs the row
+    mRow = DocumentNodeRef();
+    mDocument = nullptr;
+    mOwnDocument.reset();
+  }
 }
 const std::string& SearchResult::getMimeType() const {
-  return mimeType;
+  return impl().mimeType;
 }
 const Format& SearchResult::getFormat() const {
-  return format;
+  return impl().format;
 }
 
 } // end namespace mlclient
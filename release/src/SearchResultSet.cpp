@@ -13,15 +13,35 @@
 #include "mlclient/NoCredentialsException.hpp"
 
 #include "mlclient/utilities/CppRestJsonDocumentContent.hpp"
+#include "mlclient/utilities/JsonEventParser.hpp"
+#include "mlclient/utilities/NativeJsonDocumentContent.hpp"
 #include "mlclient/utilities/PugiXmlHelper.hpp"
+#include "mlclient/utilities/ResponseHelper.hpp"
 #include "mlclient/utilities/DocumentHelper.hpp"
+#include "mlclient/utilities/SearchBuilder.hpp"
 
 #include "mlclient/logging.hpp"
 
 // We can use the following, because cpprest is an internal API dependency
 #include "mlclient/utilities/CppRestJsonHelper.hpp"
 #include <cpprest/json.h>
+#include <cpprest/http_client.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <locale>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace mlclient {
 
@@ -29,16 +49,90 @@ namespace mlclient {
 
 class SearchResultSet::Impl {
 public:
+  /**
+   * One page of parsed results, and the page level metadata returned with it.
+   *
+   * The network stage sets the response, which the parse stage decodes and then frees.
+   *
+   * Owns its results and the parsed response their rows point in to, so freeing the page frees everything allocated
+   * for it. The results are held by value in one block, reserved to the row count before parsing, so pointers to
+   * them stay valid for the page's lifetime and freeing them is a single deallocation. A copied result, or a detail
+   * content node, shares ownership of the parsed response, so keeps it alive once the page is freed.
+   */
+  struct Page {
+    Page() : response(), document(), rows(), results(), total(0), start(0), pageLength(0), snippetFormat(),
+      queryResolutionTime(), snippetResolutionTime(), totalTime(), timestamp(), lastKey(), hasKey(false),
+      deferRows(false), networkMillis(0), parseMillis(0), failed(false), problem() {
+      ;
+    }
+    Page(const Page& other) = delete;
+
+    std::unique_ptr<Response> response; // received, and not yet parsed
+    std::shared_ptr<const void> document; // the parsed response. See ParsedResponse
+    DocumentNodeRef rows; // deferred pages only - the result row, or array of rows, to visit
+    std::vector<SearchResult> results; // declared last, so destroyed before the documents their nodes point in to
+    long total;
+    long start;
+    long pageLength;
+    std::string snippetFormat;
+    std::string queryResolutionTime;
+    std::string snippetResolutionTime;
+    std::string totalTime;
+    std::string timestamp; // ML-Effective-Timestamp response header, if sent
+    std::string lastKey; // search after mode only - the sort key value of the last result
+    bool hasKey;
+    bool deferRows; // leave the rows for visitRows() on the consuming thread, rather than creating SearchResults
+    double networkMillis;
+    double parseMillis;
+    bool failed;
+    std::exception problem;
+  };
+
+  /**
+   * A parsed search response, shared by its page and by any result or node that outlives the page
+   */
+  struct ParsedResponse {
+    std::unique_ptr<IDocumentContent> content;
+    std::unique_ptr<IDocumentNavigator> navigator; // declared after the content, so freed before it
+  };
+
+  /**
+   * A page request that may still be running
+   */
+  struct PageFetch {
+    long index;
+    std::shared_ptr<Page> page;
+    pplx::task<void> received; // the network stage
+    pplx::task<void> task; // the parse stage, which follows it
+  };
+
   Impl(SearchResultSet* set,IConnection* conn,SearchDescription* desc) : mConn(conn), mInitialDescription(desc),
     mResults(), mFetchException(), mIter(new SearchResultSetIterator(set)), mCachedEnd(nullptr), start(0),
     pageLength(0), total(0),totalTime(""), queryResolutionTime(""),snippetResolutionTime(""),m_maxResults(0), lastFetched(-1),
-    fetchTask(nullptr) /*, fetchMtx(), resultsMtx()*/ {
+    firstStart(1), nextPage(0), prefetchPages(1), failed(false), inFlight(), streaming(false), pages(), windowStart(0),
+    pointInTime(true), timestamp(), searchAfter(false), afterProperty(), afterType(RangeIndexType::STRING),
+    afterDescending(false), baseQuery(), lastIssued(), parallelPages(0), arrived(), contiguousPages(0),
+    visitor(nullptr), parseBacklog(1), timings(), streamingParse(false), fetchConnections(), idleConnections(),
+    connectionMutex(), connectionFree() {
 
     //TIMED_FUNC(SearchResultSet_Impl_constructor);
     //LOG(DEBUG) << "In SearchResultSet::Impl ctor";
     //LOG(DEBUG) << "mInitialDescription: " << mInitialDescription->getPayload()->getContent();
   }
 
+  ~Impl() {
+    // background page tasks reference this instance
+    for (auto& fetch : inFlight) {
+      fetch.task.wait();
+    }
+    inFlight.clear();
+    mResults.clear(); // owned by pages
+    pages.clear();
+    delete mIter;
+    delete mCachedEnd;
+    delete mInitialDescription;
+  }
+
   void incrementIter(web::json::array::const_iterator iter) {
     //TIMED_FUNC(SearchResultSet_Impl_incrementIter);
     ++iter;
@@ -49,15 +143,23 @@ public:
     return (iter != jsonArrayIterEnd);
   }
 
-  bool handleFetchResults(Response * resp) {
+  /**
+   * Parses one page of search results in to page. Touches no other state, so may run on any thread.
+   */
+  bool handleFetchResults(Response * resp,Page& page) {
     //TIMED_FUNC(SearchResultSet_Impl_handleFetchResults);
     //LOG(DEBUG) << "SearchResultSet::handleFetchResults Response value: " << resp->getContent();
 
     // TODO handle request errors
 
     //const web::json::value value(utilities::CppRestJsonHelper::fromResponse(*resp));
-    ITextDocumentContent* respDoc = (ITextDocumentContent*)mlclient::utilities::DocumentHelper::contentFromResponse(*resp);
+    // the response is discarded once parsed, so let XML parse in place within its body
+    ITextDocumentContent* respDoc = (ITextDocumentContent*)mlclient::utilities::DocumentHelper::takeContentFromResponse(*resp);
+    std::shared_ptr<ParsedResponse> parsed(std::make_shared<ParsedResponse>());
+    parsed->content.reset(respDoc);
     IDocumentNavigator* nav = respDoc->navigate(true); // look below first element, if response is XML
+    parsed->navigator.reset(nav);
+    page.document = parsed;
 
     //std::unique_lock<std::mutex> lck (resultsMtx,std::defer_lock);
 
@@ -66,89 +168,46 @@ public:
 
 
     // extract top level summary information for the result set
-    IDocumentNode* snNode = nav->at("snippet-format");
-    if (nullptr == snNode) {
-      LOG(DEBUG) << "WARNING: snippet-format not found in results";
-      snippetFormat = "custom"; // should never happen unless snippeting is disabled
-    } else {
-      snippetFormat = snNode->asString();
-    }
-    LOG(DEBUG) << "Snippet format: " << snippetFormat;
-    total = nav->at("total")->asInteger();
-    if (0 == m_maxResults) {
-      //lck.lock();
-      mResults.reserve(total);
-      //lck.unlock();
-    } else {
-      //lck.lock();
-      mResults.reserve(m_maxResults);
-      //lck.unlock();
-    }
-    pageLength = nav->at("page-length")->asInteger();
-    start = nav->at("start")->asInteger();
-
-    // extract metrics, if they exist
-    // TODO better way to check for response metrics being present, without exception throwing
-    try {
-      IDocumentNode* metrics = nav->at("search:metrics");
-      queryResolutionTime = metrics->at("search:query-resolution-time")->asString();
-      snippetResolutionTime = metrics->at("search:snippet-resolution-time")->asString();
-      totalTime = metrics->at("search:total-time")->asString();
+    // should only be missing if snippeting is disabled
+    page.snippetFormat = nav->getString("snippet-format","custom");
+    LOG(DEBUG) << "Snippet format: " << page.snippetFormat;
+    page.total = nav->getInteger("total");
+    page.pageLength = nav->getInteger("page-length");
+    page.start = nav->getInteger("start");
+
+    // extract metrics, if they exist - they may be disabled by search options
+    // TODO flag this to support hasMetrics()
+    std::unique_ptr<IDocumentNode> metrics(nav->tryAt("search:metrics"));
+    if (nullptr != metrics.get()) {
+      page.queryResolutionTime = metrics->getString("search:query-resolution-time");
+      page.snippetResolutionTime = metrics->getString("search:snippet-resolution-time");
+      page.totalTime = metrics->getString("search:total-time");
       //CLOG(INFO, "performance") << "Executed [marklogic::rest::search::queryResolutionTime()] in [" << queryResolutionTime.substr(2,queryResolutionTime.length() - 3) << " ms]";
       //CLOG(INFO, "performance") << "Executed [marklogic::rest::search::snippetResolutionTime()] in [" << snippetResolutionTime.substr(2,snippetResolutionTime.length() - 3) << " ms]";
       //CLOG(INFO, "performance") << "Executed [marklogic::rest::search::totalTime()] in [" << totalTime.substr(2,totalTime.length() - 3) << " ms]";
-    } catch (std::exception& me) {
-      // no metrics element - possible due to search options
-      // silently fail - not a huge issue
-      // TODO flag this to support hasMetrics()
-      //LOG(DEBUG) << "SearchResultSet::handleFetchResults   COULD NOT PARSE RESPONSE METRICS!!!" << me.what();
     }
 
     } // end timed scope for metrics
 
     LOG(DEBUG) << "Extracted metrics";
 
-    // TODO preallocate total results (or limit, if set and lower) in mImpl->mResults vector - speeds up append operations
-
-    //SearchResult::DETAIL detail(SearchResult::DETAIL::NONE);
-    static std::string raw("raw"); // always the same
-    static std::string custom("custom"); // always the same
-    //std::string ct;
 
     {
       //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processResultSet()");
 
 
-    bool isRaw = (raw == snippetFormat);
-    bool isCustom = (custom == snippetFormat);
-    
     // take the response, and parse it
     // NOT NEEDED const web::json::value& resv = value.at(U("results"));
     //const web::json::array res(value.at(U("results")).as_array());
-    bool hasResults = nav->has("search:result");
-    IDocumentNode* res = nullptr;
-    if (hasResults) {
-      res = nav->at("search:result"); // this fails if it doesn't exist
-    
-    } else {
-      //res = res->asArray();
-      if (!hasResults || nullptr == res) {
-        hasResults = nav->has("search:results");
-        if (hasResults) {
-          res = nav->at("search:results");
-        } else {
-          if (!hasResults || nullptr != res) {
-            //res = res->asArray();
-            
-            
-            // TODO safely fail - no search results in search response (may have values, etc. instead)
-            LOG(DEBUG) << "WARNING: No search:result or search:results element in result JSON from REST API";
-
-
-          }
-        } // end second has results
-      }
-    } // end if has results
+    // XML responses have repeated search:result elements, JSON responses a results array
+    DocumentNodeRef res = nav->ref().at("search:result");
+    if (res.isEmpty()) {
+      res = nav->ref().at("search:results");
+    }
+    if (res.isEmpty()) {
+      // TODO safely fail - no search results in search response (may have values, etc. instead)
+      LOG(DEBUG) << "WARNING: No search:result or search:results element in result JSON from REST API";
+    }
     //{
     //  TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::asArray()");
 
@@ -160,190 +219,22 @@ public:
     //const web::json::array::const_iterator jsonArrayIterEnd(res.end()); // see if a single call saves us time... nope
 
     // TODO check if res is nullptr (i.e. return-results is false in search options)
-    LOG(DEBUG) << "Is result set empty?: " << (nullptr == res);
+    LOG(DEBUG) << "Is result set empty?: " << res.isEmpty();
 
-    if (nullptr != res) {
+    if (!res.isEmpty() && page.deferRows) {
+      page.rows = res; // visited on the consuming thread. See visitRows()
+    } else if (!res.isEmpty()) {
  
-    int arrayLength = res->size();
-    LOG(DEBUG) << "Search result array length: " << arrayLength;
-
-    //mlclient::IDocumentContent* ct;
-    
-    std::shared_ptr<IDocumentNode> ctValPtr;
-
-    SearchResult::Detail detail;
-    std::string mimeType;
-    Format format;
-    //web::json::object row = web::json::value::object().as_object();
-    IDocumentNode* row;
-
-    {
-      //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processResultSetLoopOnly()");
-
-    //for (; iter != jsonArrayIterEnd;++iter) {
-    for (int i = 0;i < arrayLength;i++) {
-      {
-      //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processRow()");
-      //auto& rowdata = *iter;
-      //row = iter->as_object();
-      if (res->isArray()) {
-        row = res->at(i);
-      } else {
-        row = res; // single result in response!
-      }
-
-      {
-        //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processRowObject()");
-
-
-      //LOG(DEBUG) << "Row: " << iter->as_string();
-      //const web::json::object& row = iter.as_object();
-      detail = SearchResult::Detail::NONE;
-      mimeType = "";
-      format = Format::JSON;
-      //web::json::value ctVal;
-      //IDocumentNode* ctVal = nullptr;
-      //ct = "";
-      LOG(DEBUG) << "Processing search results";
-
-      // if snippet-format = raw
-      if (isRaw) {
-          //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processContent()");
-        if (row->has("search:content")) {
-          try {
-            ctValPtr.reset(row->at("search:content")->asObject()); // at is rvalue, moved to lvalue by json's move contructor
-            LOG(DEBUG) << "SearchResultSet::handleFetchResults   Got content";
-
-          } catch (std::exception& e) {
-            LOG(DEBUG) << "SearchResultSet::handleFetchResults   Row does not have content... trying snippet..." << e.what();
-            //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processContentEXCEPTION()");
-            // element doesn't exist - no result content, or has a snippet
-          } // end content catch
-        } else {
-          // no content element, just use entire element
-          LOG(DEBUG) << "SearchResultSet::handleFetchResults   No content node but raw, so entire content is the document";
-          ctValPtr.reset(row);
-        }
-
-      } else if (isCustom) {
-        LOG(DEBUG) << "Custom snippet format result";
-        // Assume the custom snippet information is within the <snippet> element in the search response
-        try {
-          IDocumentNode* snippet = row->at("search:snippet");
-          // If search result format type is XML, but content is JSON, convert the search snippet to the right doc type
-          std::string docFormat = row->at("format")->asString();
-          if ("json" == docFormat) {
-            // get content of snippet as string 
-            std::string json = snippet->asString();
-            // parse as JSON document, and set pointer accordingly
-
-            web::json::value val = mlclient::utilities::CppRestJsonHelper::fromString(json);
-            IDocumentContent* jsonDoc = mlclient::utilities::CppRestJsonHelper::toDocument(val);
-            ctValPtr.reset(((ITextDocumentContent*)jsonDoc)->navigate(false)->firstChild()); // TODO verify this is correct
-          } else {
-            //IDocumentNode* snippetObject = snippet->asObject();
-            //ctValPtr.reset(snippetObject->at(snippetObject->keys()[0]));
-            ctValPtr.reset(snippet->asObject());
-          }
-          detail = SearchResult::Detail::SNIPPETS;
-        } catch (std::exception& ex) {
-          // no snippet element, must be some sort of content...
-          detail = SearchResult::Detail::CONTENT;
-          LOG(DEBUG) << "SearchResultSet::handleFetchResults   Result has no snippet element" << ex.what();
-          //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processMatchesEXCEPTION()");
-        }
-      } else {
-        LOG(DEBUG) << "Fetching search result content from matches element";
-
-        try {
-          //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processMatches()");
-          ctValPtr.reset(row->at("search:matches")->asObject());
-
-/*
-          mimeType = utility::conversions::to_utf8string(row.at(U("mimetype")).as_string());
-          std::string formatStr = utility::conversions::to_utf8string(row.at(U("format")).as_string());
-          //LOG(DEBUG) << "SearchResultSet::handleFetchResults   Got snippet content" << ct;
-          if ("json" == formatStr) {
-            format = Format::JSON;
-          } else if ("xml" == formatStr) {
-            format = Format::XML;
-          } else if ("binary" == formatStr) {
-            format = Format::BINARY;
-          } else if ("text" == formatStr) {
-            format = Format::TEXT;
-          } else {
-            format = Format::NONE;
-          }
-*/
-          /*
-          ct = new mlclient::utilities::CppRestJsonDocumentContent();
-          ct->setMimeType(IDocumentContent::MIME_JSON);
-          ct->setContent(ctVal);
-          */
-          //ct = divineDocumentContent(formatStr,mimeType,ctVal);
-          //ct = utility::conversions::to_utf8string(ctVal.as_string());
-
-
-          detail = SearchResult::Detail::SNIPPETS;
-        } catch (std::exception& ex) {
-          // no snippet element, must be some sort of content...
-          detail = SearchResult::Detail::CONTENT;
-          LOG(DEBUG) << "SearchResultSet::handleFetchResults   Result has no matches element" << ex.what();
-          //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::processMatchesEXCEPTION()");
-        }
-      }
-
-
-              mimeType = row->at("mimetype")->asString();
-              //LOG(DEBUG) << "SearchResultSet::handleFetchResults   Got mimetype";
-              std::string formatStr = row->at("format")->asString();
-              if ("json" == formatStr) {
-                format = Format::JSON;
-              } else if ("xml" == formatStr) {
-                format = Format::XML;
-              } else if ("binary" == formatStr) {
-                format = Format::BINARY;
-              } else if ("text" == formatStr) {
-                format = Format::TEXT;
-              } else {
-                format = Format::NONE;
-              }
-              //LOG(DEBUG) << "SearchResultSet::handleFetchResults   Got format";
-              //LOG(DEBUG) << "SearchResultSet::handleFetchResults   Row content: " << ct;
-
-              //ct = divineDocumentContent(formatStr,mimeType,ctVal);
-      LOG(DEBUG) << "Search results ctVal is null?: " << (nullptr == ctValPtr.get());
-
-      // TODO handle empty result or no search metrics in the below - at the moment they could throw!!!
-      {
-        //TIMED_SCOPE(SearchResultSet_Impl_handleFetchResult, "mlclient::SearchResultSet::Impl::handleFetchResult::appendToVector()");
-      //SearchResult sr(row.at(U("index")).as_integer(), utility::conversions::to_utf8string(row.at(U("uri")).as_string()),
-        //utility::conversions::to_utf8string(row.at(U("path")).as_string()),row.at(U("score")).as_integer(),
-        //row.at(U("confidence")).as_double(),row.at(U("fitness")).as_double(),detail,ct,mimeType,format );
-
-        //lck.lock();
-      mResults.push_back(
-        new SearchResult(
-          row->at("index")->asInteger(),
-          row->at("uri")->asString(),
-          row->at("path")->asString(),
-          row->at("score")->asInteger(),
-          row->at("confidence")->asDouble(),
-          row->at("fitness")->asDouble(),
-          detail,ctValPtr,mimeType,format
-        )
-      );
-
-      lastFetched = mResults.size() - 1;
-
-      //lck.unlock();
-    } // end timed scope
-      }
-      }
+    // a single result in the response is its own only member
+    const std::vector<DocumentNodeRef> rows = res.members(); // one pass, rather than at(i) per row
+    LOG(DEBUG) << "Search result array length: " << rows.size();
+    page.results.reserve(rows.size()); // one allocation for every result on the page
+
+    for (const DocumentNodeRef& row : rows) {
+      // fields, and the detail content or snippet, are decoded on first access. See SearchResult.
+      page.results.emplace_back(row,page.snippetFormat,page.document);
     } // end loop
 
-    } // end timed scope loop only
-
     } else { 
       LOG(DEBUG) << "Results from REST API does not contain a search:result element or results property";
     } // end res is null guard if 
@@ -380,147 +271,805 @@ public:
   }
   */
 
-  bool fetchInitial() {
-    //LOG(DEBUG) << "In fetchInitial";
-    //LOG(DEBUG) << "mInitialDescription: " << mInitialDescription->getPayload()->getContent();
-    // make this async
-    Impl& mImpl = (*this);
+  /**
+   * The number of results this set will hold, from the first requested one onwards. Only valid once the first page
+   * has been adopted.
+   */
+  long wantedResults() const {
+    long wanted = total - (firstStart - 1);
+    if (0 != m_maxResults && m_maxResults < wanted) {
+      wanted = m_maxResults;
+    }
+    return (wanted < 0 ? 0 : wanted);
+  }
+
+  /**
+   * Whether the remaining pages are fetched in parallel and slotted in to place as they arrive
+   */
+  bool isParallel() const {
+    return parallelPages > 0 && !streaming && !searchAfter && nullptr == visitor;
+  }
 
-    //std::unique_lock<std::mutex> lck (fetchMtx,std::defer_lock);
-    //lck.lock();
+  /**
+   * Copies the initial description for the given zero based page, or returns nullptr if that page is beyond the
+   * results wanted. Only valid once the first page has been adopted.
+   */
+  SearchDescription* describePage(long pageIndex) const {
+    long wanted = wantedResults();
+    long offset = pageIndex * pageLength;
+    if (pageLength < 1 || offset >= wanted) {
+      return nullptr;
+    }
+    SearchDescription* desc = new SearchDescription(*mInitialDescription); // force copy
+    desc->setStart(firstStart + offset);
+    if (wanted - offset < pageLength) {
+      desc->setPageLength(wanted - offset); // E.g. 11 max results, page length 10 => 1 result max on page 2
+    } else {
+      desc->setPageLength(pageLength);
+    }
+    if (pointInTime && !timestamp.empty()) {
+      desc->setTimestamp(timestamp); // every page sees the same database state as the first
+    }
+    return desc;
+  }
 
-    fetchTask = new pplx::task<void>([&mImpl] () {
-      //LOG(DEBUG) << "Began initial fetch task...";
+  /**
+   * Adds the search after sort order to the initial description's options, so every page is sorted on the key
+   */
+  void applySortOrder() {
+    const ITextDocumentContent& options = mInitialDescription->getOptions();
+    if (IDocumentContent::MIME_XML == options.getMimeType() ||
+        IDocumentContent::MIME_XML == mInitialDescription->getQuery().getMimeType()) {
+      throw std::runtime_error("SearchResultSet search after mode requires a JSON query and JSON options");
+    }
+    std::string content(options.getContent());
+    if (content.empty()) {
+      content = "{}";
+    }
+    web::json::value value(mlclient::utilities::CppRestJsonHelper::fromString(content));
+    // built as JSON rather than concatenated, so quotes and backslashes in the property name are escaped
+    std::ostringstream type;
+    type << afterType;
+    web::json::value order = web::json::value::object();
+    order[U("direction")] = web::json::value::string(afterDescending ? U("descending") : U("ascending"));
+    order[U("type")] = web::json::value::string(utility::conversions::to_string_t(type.str()));
+    order[U("json-property")] = web::json::value::string(utility::conversions::to_string_t(afterProperty));
+    web::json::value sort = web::json::value::array(1);
+    sort[0] = order;
+    // options may or may not be wrapped in an options property. See SearchOptionsBuilder::toDocument()
+    web::json::value& target = (value.has_field(U("options")) ? value[U("options")] : value);
+    target[U("sort-order")] = sort;
+    GenericTextDocumentContent sorted;
+    sorted.setMimeType(IDocumentContent::MIME_JSON);
+    sorted.setContent(utility::conversions::to_utf8string(value.serialize()));
+    mInitialDescription->setOptions(sorted);
+
+    baseQuery = mInitialDescription->getQuery().getContent();
+  }
 
+  /**
+   * Restricts a page description to results sorting after the given key, and asks for them from the first result
+   */
+  void applySearchAfter(SearchDescription& desc,const std::string& key) const {
+    mlclient::utilities::SearchBuilder sb; // escapes the property and key, and throws if a numeric key is not a number
+    std::unique_ptr<IQuery> after(sb.jsonRangeQuery(afterProperty,
+        (afterDescending ? mlclient::utilities::RangeOperation::LT : mlclient::utilities::RangeOperation::GT),
+        key,afterType));
+    std::ostringstream oss;
+    if (baseQuery.empty() || "{}" == baseQuery) {
+      oss << *after;
+    } else {
+      mlclient::utilities::GenericQuery base;
+      base.setQuery(baseQuery);
+      std::unique_ptr<IQuery> both(mlclient::utilities::SearchBuilder::andQuery(
+          std::vector<IQuery*>{&base,after.get()}));
+      oss << *both;
+    }
+    GenericTextDocumentContent query;
+    query.setMimeType(IDocumentContent::MIME_JSON);
+    query.setContent(oss.str());
+    desc.setQuery(query);
+    desc.setStart(1); // the range query, not an offset, skips the earlier pages
+  }
 
+  /**
+   * Reads the sort key of the page's last result from its detail content, for the next page's search after query
+   */
+  void readLastKey(Page& page) const {
+    if (page.results.empty() && page.rows.isEmpty()) {
+      return;
+    }
     try {
-      // perform the request to search in the connection
-      if (0 != mImpl.m_maxResults && mImpl.m_maxResults < mImpl.start + mImpl.pageLength - 1) { // E.g. Page 2, 11 results => 11 < 11 + 10 - 1 => 11 < 20 (i.e. max result requires limiting this page's length)
-        mImpl.mInitialDescription->setPageLength(mImpl.m_maxResults - mImpl.start + 1); // E.g. Page 2, 11 results => 11 - 11 + 1 = 1 results max on page 2
+      std::shared_ptr<IDocumentNode> detail;
+      if (page.results.empty()) {
+        // a deferred page, so decode just its last row
+        DocumentNodeRef row(page.rows);
+        if (row.isArray()) {
+          if (0 == row.size()) {
+            return;
+          }
+          row = page.rows.at(page.rows.size() - 1);
+        }
+        detail = SearchResult(row,page.snippetFormat,page.document).getDetailContent();
+      } else {
+        detail = page.results.back().getDetailContent();
       }
-      Response* resp = mImpl.mConn->search(*mImpl.mInitialDescription);
-      bool success = mImpl.handleFetchResults(resp);
-      LOG(DEBUG) << "Initial fetch task a success? : " << success;
+      std::unique_ptr<IDocumentNode> key(nullptr == detail.get() ? nullptr : detail->tryAt(afterProperty));
+      if (nullptr == key.get()) {
+        LOG(DEBUG) << "SearchResultSet search after property not in the last result's detail content: " << afterProperty;
+        return;
+      }
+      std::ostringstream oss;
+      oss.imbue(std::locale::classic()); // a JSON number, whatever the global locale
+      if (key->isString()) {
+        oss << key->asString();
+      } else if (key->isInteger()) {
+        oss << key->asInteger();
+      } else if (key->isDouble()) {
+        oss << std::setprecision(17) << key->asDouble();
+      } else if (key->isBoolean()) {
+        oss << (key->asBoolean() ? "true" : "false");
+      } else {
+        LOG(DEBUG) << "SearchResultSet search after property is not an atomic value: " << afterProperty;
+        return;
+      }
+      page.lastKey = oss.str();
+      page.hasKey = true;
+    } catch (std::exception& ex) {
+      LOG(DEBUG) << "SearchResultSet could not read search after property " << afterProperty << ": " << ex.what();
+    }
+  }
+
+  static double millisSince(const std::chrono::steady_clock::time_point& began) {
+    return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - began).count();
+  }
 
-      delete(resp); // TODO ensure this does not invalidate any of our variables in search result set or searchresult instances
+  /**
+   * The network stage. Requests one page, and keeps the response for the parse stage. Runs on a worker task, and
+   * only touches the page passed in.
+   */
+  void requestPage(const SearchDescription& desc,Page& page) {
+    const std::chrono::steady_clock::time_point began(std::chrono::steady_clock::now());
+    IConnection* conn = acquireConnection();
+    try {
+      page.response.reset(conn->search(desc));
+      page.timestamp = mlclient::utilities::ResponseHelper::getEffectiveTimestamp(*page.response);
+    } catch (std::exception& ref) {
+      page.failed = true;
+      page.problem = ref;
+    }
+    releaseConnection(conn);
+    page.networkMillis = millisSince(began);
+  }
 
-      //return success;
+  /**
+   * Takes a connection for one page request. Without fetch connections this is the set's own connection, which
+   * sends one request at a time. Otherwise waits until one of the fetch connections is idle.
+   */
+  IConnection* acquireConnection() {
+    if (fetchConnections.empty()) {
+      return mConn;
+    }
+    std::unique_lock<std::mutex> lock(connectionMutex);
+    connectionFree.wait(lock,[this] { return !idleConnections.empty(); });
+    IConnection* conn = idleConnections.back();
+    idleConnections.pop_back();
+    return conn;
+  }
+
+  void releaseConnection(IConnection* conn) {
+    if (fetchConnections.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(connectionMutex);
+      idleConnections.push_back(conn);
+    }
+    connectionFree.notify_one();
+  }
+
+  /**
+   * The parse stage. Decodes a received page, then frees its response. Runs on a worker task, and only touches the
+   * page passed in.
+   */
+  void parsePage(Page& page) {
+    if (page.failed || nullptr == page.response.get()) {
+      return;
+    }
+    const std::chrono::steady_clock::time_point began(std::chrono::steady_clock::now());
+    try {
+      handleFetchResults(page.response.get(),page);
+      if (searchAfter) {
+        readLastKey(page);
+      }
     } catch (std::exception& ref) {
-      mImpl.mFetchException = ref;
-      //LOG(DEBUG) << "Exception in initial fetch task";
-      //return false;
+      page.failed = true;
+      page.problem = ref;
+    }
+    page.response.reset();
+    page.parseMillis = millisSince(began);
+  }
+
+  /**
+   * Requests and parses one page on the calling thread
+   */
+  void fetchPage(const SearchDescription& desc,Page& page) {
+    //TIMED_FUNC(SearchResultSet_Impl_fetchPage);
+    requestPage(desc,page);
+    parsePage(page);
+  }
+
+  /**
+   * Adds a page's stage times to this set's totals. Called on the consuming thread only.
+   */
+  void recordTimings(const Page& page) {
+    if (!page.failed) {
+      ++timings.pages;
     }
-    //LOG(DEBUG) << "End initial fetch task";
+    timings.networkMillis += page.networkMillis;
+    timings.parseMillis += page.parseMillis;
+  }
 
-    });
+  /**
+   * Blocks until the page has been received and parsed. Once it has been received, more requests are sent if the
+   * request limit and parse backlog allow, so they overlap its parsing.
+   */
+  void waitFor(PageFetch& fetch) {
+    if (fetch.task.is_done()) {
+      return;
+    }
+    const std::chrono::steady_clock::time_point began(std::chrono::steady_clock::now());
+    fetch.received.wait();
+    fill();
+    fetch.task.wait();
+    timings.waitMillis += millisSince(began);
+  }
+
+  /**
+   * Takes ownership of a fetched page, and its results and metadata, for this result set. Called on the consuming thread only.
+   */
+  void adoptPage(const std::shared_ptr<Page>& page) {
+    recordTimings(*page);
+    if (page->failed) {
+      mFetchException = page->problem;
+      failed = true;
+      return;
+    }
+    if (!streaming && nullptr == visitor && mResults.empty()) {
+      mResults.reserve((0 == m_maxResults || page->total < m_maxResults) ? page->total : m_maxResults);
+    }
+    snippetFormat = page->snippetFormat;
+    if (lastFetched < 0) {
+      pageLength = page->pageLength; // later pages may be shorter, but must not change the offsets of the rest
+    }
+    if (!searchAfter) {
+      if (lastFetched < 0 || !isParallel()) {
+        total = page->total; // parallel pages are slotted by offsets computed from the first page's total
+      }
+      start = page->start;
+    } else {
+      if (lastFetched < 0) {
+        total = page->total; // later pages only count the results after their key
+      }
+      start = firstStart + lastFetched + 1;
+    }
+    queryResolutionTime = page->queryResolutionTime;
+    snippetResolutionTime = page->snippetResolutionTime;
+    totalTime = page->totalTime;
+    if (nullptr != visitor) {
+      const std::chrono::steady_clock::time_point began(std::chrono::steady_clock::now());
+      lastFetched += visitRows(*page); // then freed, as the page is not kept
+      timings.parseMillis += millisSince(began);
+      return;
+    }
+    if (!streaming) {
+      for (auto& result : page->results) {
+        mResults.push_back(&result);
+      }
+    }
+    lastFetched += page->results.size();
+    pages.push_back(page);
+  }
+
+  /**
+   * Sizes the results for every position once the first page has been adopted, so later pages can be slotted
+   * in to place in whatever order they arrive
+   */
+  void beginParallel() {
+    mResults.resize(wantedResults(),nullptr);
+    arrived.assign(1,true);
+    contiguousPages = 1;
+  }
+
+  /**
+   * Takes ownership of a page fetched in parallel, placing its results at the page's offset. Called on the
+   * consuming thread only.
+   */
+  void slotPage(long index,const std::shared_ptr<Page>& page) {
+    recordTimings(*page);
+    if (page->failed) {
+      mFetchException = page->problem;
+      failed = true;
+      return;
+    }
+    queryResolutionTime = page->queryResolutionTime;
+    snippetResolutionTime = page->snippetResolutionTime;
+    totalTime = page->totalTime;
+    size_t offset = index * pageLength;
+    for (size_t i = 0;i < page->results.size() && offset + i < mResults.size();i++) {
+      mResults[offset + i] = &page->results[i];
+    }
+    pages.push_back(page);
+    if ((long)arrived.size() <= index) {
+      arrived.resize(index + 1,false);
+    }
+    arrived[index] = true;
+    while (contiguousPages < (long)arrived.size() && arrived[contiguousPages]) {
+      ++contiguousPages;
+    }
+    long available = contiguousPages * pageLength;
+    lastFetched = (available < (long)mResults.size() ? available : (long)mResults.size()) - 1;
+  }
+
+  /**
+   * Slots every in flight page that has already arrived, in any order, then tops up the pages in flight.
+   * Never blocks.
+   */
+  void pumpParallel() {
+    for (auto fetch = inFlight.begin();!failed && fetch != inFlight.end();) {
+      if (fetch->task.is_done()) {
+        slotPage(fetch->index,fetch->page);
+        fetch = inFlight.erase(fetch);
+      } else {
+        ++fetch;
+      }
+    }
+    fill();
+  }
+
+  /**
+   * In streaming mode, frees every adopted page wholly before the zero based position
+   */
+  void releaseBefore(long position) {
+    if (!streaming) {
+      return;
+    }
+    while (!pages.empty() && windowStart + (long)pages.front()->results.size() <= position) {
+      windowStart += pages.front()->results.size();
+      pages.pop_front();
+    }
+  }
+
+  /**
+   * The number of in flight pages whose request has not yet been answered
+   */
+  size_t requesting() const {
+    size_t count = 0;
+    for (auto& fetch : inFlight) {
+      if (!fetch.received.is_done()) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  /**
+   * Starts fetching pages until prefetchPages (or in parallel mode parallelPages) requests are running, or the
+   * parse backlog is full, or all pages have been requested
+   */
+  void fill() {
+    const size_t limit = (isParallel() ? parallelPages : prefetchPages);
+    while (!failed && inFlight.size() < limit + parseBacklog && requesting() < limit) {
+      std::shared_ptr<SearchDescription> desc(describePage(nextPage));
+      if (nullptr == desc.get()) {
+        return;
+      }
+      PageFetch fetch;
+      fetch.index = nextPage++;
+      fetch.page = std::make_shared<Page>();
+      fetch.page->deferRows = (nullptr != visitor);
+      std::shared_ptr<Page> page(fetch.page);
+      Impl& mImpl(*this);
+      if (searchAfter) {
+        // each page needs the last key of the one before, so runs once that page has arrived
+        std::shared_ptr<Page> previous(lastIssued);
+        pplx::task<void> after(inFlight.empty() ? pplx::task_from_result() : inFlight.back().task);
+        fetch.received = after.then([&mImpl,desc,previous,page] () {
+          if (!previous->hasKey) {
+            page->failed = true;
+            page->problem = std::runtime_error("SearchResultSet could not read the search after key of the previous page");
+            return;
+          }
+          try {
+            mImpl.applySearchAfter(*desc,previous->lastKey);
+          } catch (std::exception& ex) {
+            page->failed = true;
+            page->problem = std::runtime_error(std::string("SearchResultSet could not build the search after query: ") +
+                ex.what());
+            return;
+          }
+          mImpl.requestPage(*desc,*page);
+        });
+      } else {
+        fetch.received = pplx::task<void>([&mImpl,desc,page] () {
+          mImpl.requestPage(*desc,*page);
+        });
+      }
+      fetch.task = fetch.received.then([&mImpl,page] () {
+        mImpl.parsePage(*page);
+      });
+      lastIssued = page;
+      inFlight.push_back(std::move(fetch));
+    }
+    const long held = (long)(pages.size() + inFlight.size());
+    if (held > timings.mostPagesHeld) {
+      timings.mostPagesHeld = held;
+    }
+  }
+
+  /**
+   * Adopts, in order, every in flight page that has already arrived, then tops up the pages in flight. Never blocks.
+   * When streaming, arrived pages are left in flight until the iterator reaches them, so they stay within the
+   * parse backlog.
+   */
+  void pump() {
+    if (isParallel()) {
+      pumpParallel();
+      return;
+    }
+    while (!failed && !streaming && !inFlight.empty() && inFlight.front().task.is_done()) {
+      adoptPage(inFlight.front().page);
+      inFlight.pop_front();
+    }
+    fill();
+  }
+
+  /**
+   * Blocks until the result at the zero based position has been adopted, or no more pages can be fetched
+   *
+   * \return true if the result is available
+   */
+  bool ensureFetched(long position) {
+    if (isParallel()) {
+      // pages are requested in order, so the first in flight is the first gap in the results
+      while (!failed && lastFetched < position && !inFlight.empty()) {
+        waitFor(inFlight.front());
+        pumpParallel();
+      }
+      return lastFetched >= position;
+    }
+    releaseBefore(position); // the pages iterated past are freed before the next is adopted
+    while (!failed && lastFetched < position && !inFlight.empty()) {
+      waitFor(inFlight.front());
+      adoptPage(inFlight.front().page);
+      inFlight.pop_front();
+      fill();
+    }
+    return lastFetched >= position;
+  }
+
+  /**
+   * Limits the first page to the max results, and records where, and at what timestamp, the results start
+   */
+  void prepareInitial() {
+    if (0 != m_maxResults && m_maxResults < mInitialDescription->getPageLength()) {
+      mInitialDescription->setPageLength(m_maxResults);
+    }
+    firstStart = mInitialDescription->getStart();
+    if (firstStart < 1) {
+      firstStart = 1;
+    }
+    timestamp = mInitialDescription->getTimestamp();
+  }
+
+  bool fetchInitial() {
+    //LOG(DEBUG) << "In fetchInitial";
     // BLOCK for first result set to ensure all variables for the result set (E.g. total) are set up before next function calls
     // No way to avoid this blocking really.
-    fetchTask->wait();
+    prepareInitial();
+    if (searchAfter) {
+      try {
+        applySortOrder();
+      } catch (std::exception& ex) {
+        LOG(DEBUG) << "SearchResultSet could not enable search after mode: " << ex.what();
+        mFetchException = ex;
+        failed = true;
+        return false;
+      }
+    }
+    std::shared_ptr<Page> page(std::make_shared<Page>());
+    page->deferRows = (nullptr != visitor);
+    fetchPage(*mInitialDescription,*page);
+    LOG(DEBUG) << "Initial fetch a success? : " << !page->failed;
+    adoptPage(page);
+    nextPage = 1;
+    lastIssued = page;
+    if (!failed && isParallel()) {
+      beginParallel();
+    }
+    if (pointInTime && timestamp.empty()) {
+      timestamp = page->timestamp; // pin the following pages to the state the first page saw
+      LOG(DEBUG) << "SearchResultSet point in time timestamp: " << timestamp;
+    }
 
-    //lck.unlock();
+    // start prefetching the following pages asynchronously
+    fill();
 
-    return true;
+    return !failed;
   };
 
-  // Returning false means no fetchTask is running or created, return true means we can safely call wait()
-  bool fetchNext() {
-    //TIMED_FUNC(SearchResultSet_Impl_fetchNext);
-    //LOG(DEBUG) << "In fetchNext";
-
-    // TODO check if we need to wait for the last thread
-    if (nullptr == fetchTask) {
-      //LOG(DEBUG) << "  Returning: fetchTask is null";
-      return false;
-    }
-    if (!fetchTask->is_done()) {
-      //LOG(DEBUG) << "  Returning: fetchTask is still in progress";
-      return true; // rely on caller in iterator checking and calling wait() on mImpl;
-    }
-    //LOG(DEBUG) << "Previous fetch complete";
-
-    // lastfetched is 0 based - E.g. 0-499
-    // m_maxResults is 1 based - E.g. 1-500 - COULD BE 0 IF NOT SET!
-    if ((0 != m_maxResults && lastFetched >= m_maxResults - 1) || (lastFetched >= total - 1)) {
-      // No need to fetch any more
-      //LOG(DEBUG) << "lastFetched has reached maxResults - not fetching";
-      return false;
-    }
-
-    //LOG(DEBUG) << "Creating new fetch task...";
-
-    //std::unique_lock<std::mutex> lck (fetchMtx,std::defer_lock);
-    //lck.lock();
-
-    // TODO make this async
-    Impl& mImpl(*this);
-
-    fetchTask = new pplx::task<void>([&mImpl] () {
-      //LOG(DEBUG) << "Started another fetchTask";
-
-    // private method - called internally only
-    // use start and pageLength to determine next start value
-    // if total <= start + pageLenth - 1, then we are already at the end! So don't fetch.
-    //LOG(DEBUG) << "In fetchNext()";
-    if (mImpl.total > mImpl.start + mImpl.pageLength - 1) {
-      //LOG(DEBUG) << "Fetching next page...";
-      // fetch more results
-      // TODO support point in time query, so totals are always consistent
-      SearchDescription newDescription = *(mImpl.mInitialDescription); // force copy
-      //LOG(DEBUG) << "  Got new description";
-      // override settings in search options for start value
-      newDescription.setStart(mImpl.start + mImpl.pageLength);
-      if (0 != mImpl.m_maxResults && mImpl.m_maxResults < mImpl.start + mImpl.pageLength - 1) { // E.g. Page 2, 11 results => 11 < 11 + 10 - 1 => 11 < 20 (i.e. max result requires limiting this page's length)
-        newDescription.setPageLength(mImpl.m_maxResults - mImpl.start + 1); // E.g. Page 2, 11 results => 11 - 11 + 1 = 1 results max on page 2
+  /**
+   * Finds a row's detail content as SearchResult does, without re-parsing custom JSON snippets
+   *
+   * \return The node, or an empty handle if the row has none
+   */
+  static DocumentNodeRef contentOf(const DocumentNodeRef& row,const std::string& snippetFormat) {
+    const char* name = "search:matches";
+    if ("raw" == snippetFormat) {
+      name = "search:content";
+    } else if ("custom" == snippetFormat) {
+      name = "search:snippet";
+    }
+    return row.at(name);
+  }
+
+  /**
+   * Passes every row of a deferred page to the visitor, in order. Called on the consuming thread only.
+   *
+   * Rows are walked with DocumentNodeRef handles, so only the content passed to the visitor is allocated.
+   *
+   * \return The number of rows visited
+   */
+  long visitRows(const Page& page) {
+    if (page.rows.isEmpty()) {
+      return 0;
+    }
+    const std::vector<DocumentNodeRef> rows = page.rows.members(); // one pass, rather than at(i) per row
+    for (const DocumentNodeRef& row : rows) {
+      visitRow(row,page.snippetFormat);
+    }
+    return rows.size();
+  }
+
+  /**
+   * Passes one row to the visitor
+   */
+  void visitRow(const DocumentNodeRef& row,const std::string& snippetFormat) {
+    DocumentNodeRef view = contentOf(row,snippetFormat);
+    if (view.isEmpty() && "raw" == snippetFormat) {
+      view = row; // no content element, so the entire row, as SearchResult does
+    }
+    std::unique_ptr<IDocumentNode> content(view.newNode());
+    visitor->onResult(row.getString("uri"),row.getInteger("score"),content.get());
+  }
+
+  /**
+   * Parses a JSON search response as it is received, passing each result row to the visitor as soon as its text
+   * is complete. Only the row being received is held. The page's metadata is recorded in the page.
+   *
+   * Rows are visited with the snippet format sent before the results array, as MarkLogic Server does, else "custom".
+   */
+  class StreamedPage : public IResponseBodyHandler, public utilities::IJsonEventHandler {
+  public:
+    StreamedPage(Impl& set,Page& p) : impl(set), page(p), parser(*this), depth(0), key(), inResults(false),
+      inMetrics(false), rows(0), problem(), visitorProblem() {
+      page.snippetFormat = "custom";
+    }
+
+    void onBodyChunk(const char* data,const size_t length) override {
+      if (nullptr != problem) {
+        return; // the rest of the body is read, but not parsed
+      }
+      try {
+        parser.feed(data,length);
+      } catch (...) {
+        problem = std::current_exception();
       }
-      //LOG(DEBUG) << "  set start on new description";
-      //LOG(DEBUG) << "Validating search payload: " << newDescription.getPayload()->getContent();
-      //LOG(DEBUG) << " mConn is nullptr?: " << (nullptr == mImpl.mConn);
-      //LOG(DEBUG) << " mConn address: " << mImpl.mConn;
+    }
 
-      Response* resp = mImpl.mConn->search(newDescription);
-      //LOG(DEBUG) << "  Completed search... calling handleFetchResults()";
-      mImpl.handleFetchResults(resp);
+    /**
+     * Throws the first problem parsing the body, or an InvalidFormatException if the body was incomplete
+     */
+    void finish() {
+      if (nullptr != problem) {
+        std::rethrow_exception(problem);
+      }
+      parser.finish();
+    }
 
-      // TODO delete resp???
-    } else {
-      //LOG(DEBUG) << "No more pages to fetch";
+    void onStartObject() override {
+      ++depth;
+      if (2 == depth && "metrics" == key) {
+        inMetrics = true;
+      } else if (inResults && 3 == depth) {
+        parser.captureValue(); // a result row. See onCapture()
+      }
+    }
+    void onEndObject() override {
+      if (2 == depth) {
+        inMetrics = false;
+      }
+      --depth;
+    }
+    void onStartArray() override {
+      ++depth;
+      if (2 == depth && "results" == key) {
+        inResults = true;
+      }
+    }
+    void onEndArray() override {
+      if (2 == depth) {
+        inResults = false;
+      }
+      --depth;
+    }
+    void onKey(const std::string& k) override {
+      const size_t colon = k.find(':');
+      key = (std::string::npos == colon ? k : k.substr(colon + 1)); // as the JSON navigators do
+    }
+    void onString(const std::string& value) override {
+      if (1 == depth && "snippet-format" == key) {
+        page.snippetFormat = value;
+      } else if (inMetrics && 2 == depth) {
+        if ("query-resolution-time" == key) {
+          page.queryResolutionTime = value;
+        } else if ("snippet-resolution-time" == key) {
+          page.snippetResolutionTime = value;
+        } else if ("total-time" == key) {
+          page.totalTime = value;
+        }
+      }
+    }
+    void onNumber(const std::string& text) override {
+      if (1 != depth) {
+        return;
+      }
+      if ("total" == key) {
+        page.total = std::stol(text);
+      } else if ("start" == key) {
+        page.start = std::stol(text);
+      } else if ("page-length" == key) {
+        page.pageLength = std::stol(text);
+      }
+    }
+    void onBoolean(const bool value) override {
+      ;
+    }
+    void onNull() override {
       ;
     }
-    //return true;
-    //LOG(DEBUG) << "Ended another fetchTask";
-
 
-    }); // end task block
-    //lck.unlock();
+    /**
+     * Parses a complete result row on its own, and visits it
+     */
+    void onCapture(std::string& text) override {
+      --depth; // no end event follows a captured row
+      utilities::NativeJsonDocumentContent row;
+      row.setContent(std::move(text));
+      std::unique_ptr<IDocumentNavigator> nav(row.navigate());
+      try {
+        impl.visitRow(nav->ref(),page.snippetFormat);
+      } catch (...) {
+        visitorProblem = std::current_exception();
+        throw; // stops parsing
+      }
+      ++rows;
+    }
 
-    return true;
+    Impl& impl;
+    Page& page;
+    utilities::JsonEventParser parser;
+    int depth; // 1 within the response object, 3 within a result row
+    std::string key; // the last key read, without any prefix
+    bool inResults;
+    bool inMetrics;
+    long rows; // visited so far
+    std::exception_ptr problem;
+    std::exception_ptr visitorProblem; // passed on to the caller of visit(), rather than failing the page
   };
 
+  /**
+   * Requests one page, parsing it and visiting its rows as it is received
+   *
+   * \return The number of rows visited
+   */
+  long streamPage(const SearchDescription& desc,Page& page) {
+    const std::chrono::steady_clock::time_point began(std::chrono::steady_clock::now());
+    StreamedPage handler(*this,page);
+    try {
+      std::unique_ptr<Response> resp(mConn->searchStreamed(desc,handler));
+      if (nullptr == resp.get()) {
+        throw std::runtime_error("SearchResultSet received no response for a page");
+      }
+      page.timestamp = mlclient::utilities::ResponseHelper::getEffectiveTimestamp(*resp);
+      if (ResponseCode::OK != resp->getResponseCode()) {
+        throw std::runtime_error("SearchResultSet page request failed with response code " +
+            std::to_string((int)resp->getResponseCode()));
+      }
+      handler.finish();
+    } catch (std::exception& ref) {
+      page.failed = true;
+      page.problem = ref;
+    }
+    if (nullptr != handler.visitorProblem) {
+      std::rethrow_exception(handler.visitorProblem);
+    }
+    page.networkMillis = millisSince(began); // includes parsing and visiting, as they overlap the network
+    return handler.rows;
+  }
+
+  /**
+   * Fetches every page, in order, on the calling thread, visiting each row as soon as it has been received
+   */
+  bool visitStreamed(ISearchResultVisitor& v) {
+    visitor = &v;
+    try {
+      prepareInitial();
+      std::unique_ptr<SearchDescription> desc(new SearchDescription(*mInitialDescription));
+      for (long index = 1;!failed && nullptr != desc.get();index++) {
+        std::shared_ptr<Page> page(std::make_shared<Page>());
+        const long visited = streamPage(*desc,*page);
+        adoptPage(page); // metadata only, as the page has no rows left to visit
+        lastFetched += visited;
+        if (pointInTime && timestamp.empty()) {
+          timestamp = page->timestamp; // pin the following pages to the state the first page saw
+        }
+        desc.reset(describePage(index));
+      }
+    } catch (...) {
+      visitor = nullptr;
+      throw;
+    }
+    visitor = nullptr;
+    return !failed;
+  }
+
+  /**
+   * Fetches every page, in order, passing each row to the visitor as its page is adopted
+   */
+  bool visitAll(ISearchResultVisitor& v) {
+    visitor = &v;
+    try {
+      fetchInitial();
+      while (!failed && !inFlight.empty()) {
+        waitFor(inFlight.front());
+        adoptPage(inFlight.front().page);
+        inFlight.pop_front();
+        fill();
+      }
+    } catch (...) {
+      visitor = nullptr; // pages still in flight were requested deferred, and are never adopted
+      throw;
+    }
+    visitor = nullptr;
+    return !failed;
+  }
+
   SearchResult* getResult(long position) {
-    //std::unique_lock<std::mutex> lck (resultsMtx,std::defer_lock);
-    //lck.lock();
-    SearchResult* res = mResults.at(position);
-    //lck.unlock();
-    return res;
+    if (!streaming) {
+      SearchResult* result = mResults.at(position);
+      if (nullptr == result) {
+        throw std::out_of_range("SearchResultSet result position was not returned by its page");
+      }
+      return result;
+    }
+    if (position < windowStart) {
+      throw std::out_of_range("SearchResultSet is streaming and this result's page has already been released");
+    }
+    long offset = position - windowStart;
+    for (auto& page : pages) {
+      if (offset < (long)page->results.size()) {
+        return &page->results[offset];
+      }
+      offset -= page->results.size();
+    }
+    throw std::out_of_range("SearchResultSet result position has not been fetched");
   }
 
   const long getLastFetched() const {
     return lastFetched;
   };
 
-  void wait() {
-    //LOG(DEBUG) << "In wait()";
-    //std::unique_lock<std::mutex> lck (fetchMtx,std::defer_lock);
-    //lck.lock();
-    if (fetchTask->is_done()) {
-      //LOG(DEBUG) << "  Returning: Task is complete";
-      return;
-    }
-    //LOG(DEBUG) << "  Waiting for completion";
-    fetchTask->wait();
-    //lck.unlock();
-  };
-
   IConnection* mConn;
   SearchDescription* mInitialDescription;
   std::vector<SearchResult*> mResults;
@@ -542,9 +1091,40 @@ public:
 
   // 0 based - i.e. for 500 results, at start it would be -1, at end it would 499
   long lastFetched;
-  pplx::task<void>* fetchTask;
-  //std::mutex fetchMtx;
-  //std::mutex resultsMtx;
+
+  long firstStart; // 1 based start of the first page requested
+  long nextPage; // 0 based index of the next page to request
+  int prefetchPages; // maximum pages in flight at once
+  bool failed;
+  std::deque<PageFetch> inFlight; // in page order
+
+  bool streaming; // forward only, freeing pages once iterated past
+  std::deque<std::shared_ptr<Page>> pages; // all adopted pages, or in streaming mode just the unreleased window
+  long windowStart; // 0 based position of the first result in pages.front()
+
+  bool pointInTime; // pass the first page's timestamp on every later page request
+  std::string timestamp; // empty if the server did not send one
+  bool searchAfter; // page with a range query on the last key rather than a start offset
+  std::string afterProperty;
+  RangeIndexType afterType;
+  bool afterDescending;
+  std::string baseQuery; // the caller's query, which each search after range query is and-ed with
+  std::shared_ptr<Page> lastIssued; // most recently requested page, whose last key the next page needs
+
+  int parallelPages; // 0, or the maximum pages requested at once when fetching all remaining pages in parallel
+  std::vector<bool> arrived; // parallel mode only - which zero based pages have been slotted
+  long contiguousPages; // parallel mode only - pages slotted without a gap from the first
+
+  ISearchResultVisitor* visitor; // set during visit() only
+
+  int parseBacklog; // received pages allowed in flight beyond the request limit
+  PipelineTimings timings;
+  bool streamingParse; // visit() parses JSON pages as they are received. See visitStreamed()
+
+  std::vector<IConnection*> fetchConnections; // not owned. Empty to send every page request on mConn
+  std::vector<IConnection*> idleConnections; // fetch connections not sending a page request
+  std::mutex connectionMutex;
+  std::condition_variable connectionFree;
 };
 
 
@@ -552,6 +1132,12 @@ public:
 
 
 
+ISearchResultVisitor::~ISearchResultVisitor() {
+  ;
+}
+
+
+
 SearchResultSet::SearchResultSet(IConnection* conn,SearchDescription* desc) : mImpl(new Impl(this,conn,desc)) {
   //TIMED_FUNC(SearchResultSet_SearchResultSet);
   //LOG(DEBUG) << "SearchResultSet ctor";
@@ -559,12 +1145,26 @@ SearchResultSet::SearchResultSet(IConnection* conn,SearchDescription* desc) : mI
   //mImpl = new SearchResultSet::Impl(this,conn,desc);
 }
 
+SearchResultSet::~SearchResultSet() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
 bool SearchResultSet::fetch() {
   //TIMED_FUNC(SearchResultSet_fetch);
   //LOG(DEBUG) << "SearchResultSet::fetch";
   return mImpl->fetchInitial();
 }
 
+bool SearchResultSet::visit(ISearchResultVisitor& visitor) {
+  TIMED_FUNC(SearchResultSet_visit);
+  if (mImpl->streamingParse && !mImpl->searchAfter &&
+      IDocumentContent::MIME_JSON == mImpl->mInitialDescription->getResponseMimeType()) {
+    return mImpl->visitStreamed(visitor);
+  }
+  return mImpl->visitAll(visitor);
+}
+
 std::exception SearchResultSet::getFetchException() {
   //TIMED_FUNC(SearchResultSet_getFetchException);
   return mImpl->mFetchException;
@@ -576,6 +1176,79 @@ void SearchResultSet::setMaxResults(long maxResults) {
   // preallocate this size in mImpl->mResults vector (done in initial fetch function, NOT here)
 }
 
+void SearchResultSet::setStreaming(bool streaming) {
+  mImpl->streaming = streaming;
+}
+
+const bool SearchResultSet::isStreaming() const {
+  return mImpl->streaming;
+}
+
+void SearchResultSet::setPrefetchPages(int pages) {
+  mImpl->prefetchPages = (pages < 1 ? 1 : pages);
+}
+
+const int SearchResultSet::getPrefetchPages() const {
+  return mImpl->prefetchPages;
+}
+
+void SearchResultSet::setFetchConnections(const std::vector<IConnection*>& connections) {
+  std::lock_guard<std::mutex> lock(mImpl->connectionMutex);
+  mImpl->fetchConnections = connections;
+  mImpl->idleConnections = connections;
+}
+
+void SearchResultSet::setPointInTime(bool pointInTime) {
+  mImpl->pointInTime = pointInTime;
+}
+
+const bool SearchResultSet::isPointInTime() const {
+  return mImpl->pointInTime;
+}
+
+const std::string& SearchResultSet::getTimestamp() const {
+  return mImpl->timestamp;
+}
+
+void SearchResultSet::setSearchAfter(const std::string& jsonProperty,const RangeIndexType type,const bool descending) {
+  mImpl->searchAfter = !jsonProperty.empty();
+  mImpl->afterProperty = jsonProperty;
+  mImpl->afterType = type;
+  mImpl->afterDescending = descending;
+}
+
+const bool SearchResultSet::isSearchAfter() const {
+  return mImpl->searchAfter;
+}
+
+void SearchResultSet::setParallelPages(int maxConcurrent) {
+  mImpl->parallelPages = (maxConcurrent < 0 ? 0 : maxConcurrent);
+}
+
+const int SearchResultSet::getParallelPages() const {
+  return mImpl->parallelPages;
+}
+
+void SearchResultSet::setParseBacklog(int pages) {
+  mImpl->parseBacklog = (pages < 0 ? 0 : pages);
+}
+
+const int SearchResultSet::getParseBacklog() const {
+  return mImpl->parseBacklog;
+}
+
+void SearchResultSet::setStreamingParse(bool streamingParse) {
+  mImpl->streamingParse = streamingParse;
+}
+
+const bool SearchResultSet::isStreamingParse() const {
+  return mImpl->streamingParse;
+}
+
+const PipelineTimings SearchResultSet::getPipelineTimings() const {
+  return mImpl->timings;
+}
+
 SearchResultSetIterator* SearchResultSet::begin() const {
   //TIMED_FUNC(SearchResultSet_begin);
   //return mImpl->mResults.begin();
@@ -589,6 +1262,23 @@ SearchResultSetIterator* SearchResultSet::end() const {
   return mImpl->mCachedEnd;
 }
 
+SearchResultSet::const_iterator SearchResultSet::cbegin() const {
+  // as SearchResultSetIterator::begin() - an empty set starts at its end, position 0
+  SearchResultSet* self = const_cast<SearchResultSet*>(this);
+  return SearchResultSetIterator(self,(0 == self->getTotal() ? 0 : 1));
+}
+
+SearchResultSet::const_iterator SearchResultSet::cend() const {
+  // as SearchResultSetIterator::end() - positions are 1 based, so end is one past the total
+  SearchResultSet* self = const_cast<SearchResultSet*>(this);
+  const long total = self->getTotal();
+  return SearchResultSetIterator(self,(0 == total ? 0 : total + 1));
+}
+
+IteratorRange<SearchResultSet::const_iterator> SearchResultSet::items() const {
+  return IteratorRange<const_iterator>(cbegin(),cend());
+}
+
 
 const long SearchResultSet::getStart() {
   //TIMED_FUNC(SearchResultSet_getStart);
@@ -669,71 +1359,57 @@ SearchResultSetIterator* SearchResultSetIterator::end() {
   return iter;
 }
 
-bool SearchResultSetIterator::operator==(const SearchResultSetIterator& other) {
+bool SearchResultSetIterator::operator==(const SearchResultSetIterator& other) const {
   //TIMED_FUNC(SearchResultSetIterator_operatorEquals);
   //LOG(DEBUG) << "operator== position: " << position << ", other.position: " << other.position;
   return position == other.position;
 }
 
-bool SearchResultSetIterator::operator!=(const SearchResultSetIterator& other) {
+bool SearchResultSetIterator::operator!=(const SearchResultSetIterator& other) const {
   //TIMED_FUNC(SearchResultSetIterator_operatorInequals);
   //LOG(DEBUG) << "operator!= position: " << position << ", other.position: " << other.position;
   return position != other.position;
 }
 
-void SearchResultSetIterator::operator++() {
+SearchResultSetIterator& SearchResultSetIterator::operator++() {
   //TIMED_FUNC(SearchResultSetIterator_operatorPlusPlus);
   // see if we're at the very end. If so, do nothing
   // check to see if we're at the end of the current result set, and need to fetch more
   // otherwise, just increment position
   //LOG(DEBUG) << " incrementing, currently: " << position;
 
-  long lastFetched = mResultSet->mImpl->getLastFetched();
-  if (-1 == lastFetched) {
-    // wait for initial fetch
-    //LOG(DEBUG) << "No initial fetch happened (IMPOSSIBLE), waiting...";
-    mResultSet->mImpl->wait();
-    //LOG(DEBUG) << "Awake!";
-  }
+  // hand over any prefetched pages that have already arrived, and keep prefetchPages requests in flight
+  mResultSet->mImpl->pump();
 
   if (position >= mResultSet->getTotal()) {
     // at end. No nothing
     //LOG(DEBUG) << "in final position of result set (total)";
   } else {
     // check if we've just started the next result set
-    if (position > lastFetched) { // this is not lastFetched + 1 as we haven't incremented position yet!!! That gets done at the END of the function
-      // need next result set NOW
-      //LOG(DEBUG) << "At end of result set - calling fetchNext...";
-      if (mResultSet->mImpl->fetchNext()) {
-        mResultSet->mImpl->wait();
-      }
+    if (position > mResultSet->mImpl->getLastFetched()) { // this is not lastFetched + 1 as we haven't incremented position yet!!! That gets done at the END of the function
+      // need next result set NOW - blocks only if the consumer has overtaken the prefetched pages
+      //LOG(DEBUG) << "At end of result set - waiting for next page...";
+      mResultSet->mImpl->ensureFetched(position);
     }
-    if (position > lastFetched + 1 - mResultSet->mImpl->pageLength) {
-      // within 1 page of the end - go fetch more results
-      //LOG(DEBUG) << "On last page of result set - calling fetchNext (lastFetched currently: " << lastFetched << ", position currently: " << position << ", maxResults currently: " << mResultSet->mImpl->m_maxResults << ")...";
-      mResultSet->mImpl->fetchNext();
-    }
-
-    /*
-    // OLD fetch code - fetched and blocked at end of result set
-    if ((mResultSet->getStart() + mResultSet->getPageLength() - 1) == position) {
-      //LOG(DEBUG) << " fetching next set of results";
-      // fetch next page
-      bool ok = mResultSet->mImpl->fetchNext();
-      // TODO do something if ok == false
-    }
-    //LOG(DEBUG) << "incrementing by 1";
-    */
   }
   ++position;
   // sanity check position, and set to end if beyond it - ODBC layer in particular does this a lot.
   if (position > mResultSet->mImpl->total + 1) {
     position = mResultSet->mImpl->total + 1;
   }
+  // free pages we have moved past, if streaming
+  mResultSet->mImpl->releaseBefore(position - 1);
   //LOG(DEBUG) << " position now: " << position;
+  return *this;
+}
+
+SearchResultSetIterator SearchResultSetIterator::operator++(int) {
+  SearchResultSetIterator previous(*this);
+  ++(*this);
+  return previous;
 }
 
-const SearchResult SearchResultSetIterator::operator*() {
+const SearchResult& SearchResultSetIterator::operator*() const {
   //TIMED_FUNC(SearchResultSetIterator_operatorDereference);
   //try {
     return *(mResultSet->mImpl->getResult(position - 1)); // MarkLogic Server is 1 based, not 0
@@ -745,12 +1421,15 @@ const SearchResult SearchResultSetIterator::operator*() {
   }*/
 }
 
+const SearchResult* SearchResultSetIterator::operator->() const {
+  return mResultSet->mImpl->getResult(position - 1);
+}
 
-SearchResultSetIterator SearchResultSetIterator::operator=(const SearchResultSetIterator& other) {
+SearchResultSetIterator& SearchResultSetIterator::operator=(const SearchResultSetIterator& other) {
   //TIMED_FUNC(SearchResultSetIterator_operatorAssignment);
   mResultSet = other.mResultSet;
   position = other.position;
-  return other;
+  return *this;
 }
 
 const SearchResult& SearchResultSetIterator::first() const {
@@ -83,6 +83,20 @@ ValuesIterator* ValuesResultSet::end() {
   return mImpl->mCachedEnd;
 }
 
+ValuesResultSet::const_iterator ValuesResultSet::cbegin() const {
+  wait();
+  return ValuesIterator(const_cast<ValuesResultSet*>(this),(0 == getTotal() ? 0 : 1)); // as ValuesIterator::begin()
+}
+
+ValuesResultSet::const_iterator ValuesResultSet::cend() const {
+  const long total = getTotal();
+  return ValuesIterator(const_cast<ValuesResultSet*>(this),(0 == total ? 0 : total + 1)); // as ValuesIterator::end()
+}
+
+IteratorRange<ValuesResultSet::const_iterator> ValuesResultSet::items() const {
+  return IteratorRange<const_iterator>(cbegin(),cend());
+}
+
 bool ValuesResultSet::fetch() {
   // fire off parallel tasks to go fetch the results
 
@@ -184,13 +198,13 @@ ValuesIterator* ValuesIterator::end() {
   return iter;
 }
 
-bool ValuesIterator::operator==(const ValuesIterator& other) {
+bool ValuesIterator::operator==(const ValuesIterator& other) const {
   return position == other.position;
 }
-bool ValuesIterator::operator!=(const ValuesIterator& other) {
+bool ValuesIterator::operator!=(const ValuesIterator& other) const {
   return position != other.position;
 }
-void ValuesIterator::operator++() {
+ValuesIterator& ValuesIterator::operator++() {
   LOG(DEBUG) << " ValuesResultIterator @" << &*this << " operator++() position: " << position;
   mResultSet->wait();
   // Wait for completion - No need, done within begin()
@@ -202,16 +216,25 @@ void ValuesIterator::operator++() {
   //  mResultSet->mImpl->tasks.at(position)->wait(); // should always be complete anyway...
   }
   LOG(DEBUG) << " ValuesResultIterator @" << &*this << " operator++() position now: " << position;
+  return *this;
 }
-const ValuesResult ValuesIterator::operator*() {
+ValuesIterator ValuesIterator::operator++(int) {
+  ValuesIterator previous(*this);
+  ++(*this);
+  return previous;
+}
+const ValuesResult& ValuesIterator::operator*() const {
   mResultSet->wait();
   return mResultSet->mImpl->values.at(position - 1); // position is 1 based
 }
+const ValuesResult* ValuesIterator::operator->() const {
+  return &(**this);
+}
 
-ValuesIterator ValuesIterator::operator=(const ValuesIterator& other) {
+ValuesIterator& ValuesIterator::operator=(const ValuesIterator& other) {
   mResultSet = other.mResultSet;
   position = other.position;
-  return other;
+  return *this;
 }
 
 const ValuesResult& ValuesIterator::first() const {
@@ -25,6 +25,7 @@
 #include "mlclient/Response.hpp"
 #include "mlclient/HttpHeaders.hpp"
 #include "mlclient/DocumentSet.hpp"
+#include "mlclient/Connection.hpp"
 
 #include "mlclient/logging.hpp"
 
@@ -35,6 +36,7 @@
 #include <cpprest/http_headers.h>
 #include <cpprest/base_uri.h>
 #include <cpprest/interopstream.h>
+#include <cpprest/containerstream.h>
 
 // XML includes
 #include "mlclient/ext/pugixml/pugixml.hpp"
@@ -42,6 +44,8 @@
 #include <string>
 #include <iostream>
 #include <istream>
+#include <sstream>
+#include <vector>
 
 
 namespace mlclient {
@@ -55,6 +59,8 @@ const std::string WWW_AUTHENTICATE_HEADER_INT = "WWW-Authenticate";
 
 const std::string DEFAULT_KEY = "__DEFAULT";
 
+const size_t BODY_CHUNK_BYTES = 64 * 1024;
+
 using namespace utility;                    // Common utilities like string conversions
 using namespace utility::conversions;       // String conversions
 using namespace web;                        // Common features like URIs.
@@ -86,7 +92,31 @@ const Credentials& AuthenticatingProxy::getCredentials() const {
   return credentials;
 }
 
-Response* AuthenticatingProxy::doRequest(const std::string& method,const std::string& host,const std::string& path,const HttpHeaders& headers, const IDocumentContent* body) {
+void AuthenticatingProxy::readBody(http_response& from, Response& to, IResponseBodyHandler* handler) {
+  if (nullptr == handler || ResponseCode::OK != to.getResponseCode()) {
+    std::vector<unsigned char> vec = from.extract_vector().get();
+    std::string str;
+    str.reserve(vec.size());
+    str.assign(vec.begin(),vec.end());
+    to.setContent(str);
+    return;
+  }
+  handler->onBodyStart(to);
+  concurrency::streams::istream body = from.body();
+  size_t total = 0;
+  while (true) {
+    concurrency::streams::container_buffer<std::string> chunk;
+    const size_t bytes = body.read(chunk,BODY_CHUNK_BYTES).get();
+    if (0 == bytes) {
+      break;
+    }
+    total += bytes;
+    handler->onBodyChunk(chunk.collection().data(),chunk.collection().size());
+  }
+  LOG(DEBUG) << "Streamed response body of " << total << " bytes";
+}
+
+Response* AuthenticatingProxy::doRequest(const std::string& method,const std::string& host,const std::string& path,const HttpHeaders& headers, const IDocumentContent* body, IResponseBodyHandler* handler) {
 
   TIMED_FUNC(AuthenticatingProxy_doRequest);
   LOG(DEBUG) << "doRequest: method: " << method << " host: " << host << " path: " << path;
@@ -101,8 +131,7 @@ Response* AuthenticatingProxy::doRequest(const std::string& method,const std::st
 
   bool authorised = true;
 
-  utility::string_t bodyString;
-  utility::string_t mimeString;
+  std::string mimeString; // UTF-8, as is the body, so neither is converted to utility::string_t and back
 
 
   try {
@@ -129,17 +158,16 @@ Response* AuthenticatingProxy::doRequest(const std::string& method,const std::st
     }
 
     if (nullptr != body) {
-      bodyString = utility::conversions::to_string_t(body->getContent());
-      mimeString = utility::conversions::to_string_t(body->getMimeType());
+      mimeString = body->getMimeType();
       // GOD AWFUL HACK
-      if (utility::conversions::to_string_t("multipart/mime") == mimeString) {
-        mimeString = utility::conversions::to_string_t("multipart/mime; boundary=BOUNDARY");
+      if ("multipart/mime" == mimeString) {
+        mimeString = "multipart/mime; boundary=BOUNDARY";
       }
       LOG(DEBUG) << "Body is not null on FIRST try";
-      LOG(DEBUG) << "  mimeString: " << utility::conversions::to_utf8string(mimeString);
-      LOG(DEBUG) << "  bodyString: " << utility::conversions::to_utf8string(bodyString);
-      // TODO Any way to stream the below rather than convert in memory?
-      req.set_body(bodyString,mimeString);
+      LOG(DEBUG) << "  mimeString: " << mimeString;
+      LOG(DEBUG) << "  bodyString: " << body->contentView();
+      // the request takes ownership of its body, so one copy is made from the view and moved in
+      req.set_body(body->contentView().str(),mimeString);
       //req.set_body(*(body->getStream()),utility::conversions::to_string_t(body->getMimeType()));
     }
 
@@ -176,11 +204,7 @@ Response* AuthenticatingProxy::doRequest(const std::string& method,const std::st
       AuthenticatingProxy::copyHeaders(raw_response.headers(),h);
       response->setResponseHeaders(h); // also sets response type via Content-type header
 
-      std::vector<unsigned char> vec = raw_response.extract_vector().get();
-      std::string str;
-      str.reserve(vec.size());
-      str.assign(vec.begin(),vec.end());
-      response->setContent(str);
+      AuthenticatingProxy::readBody(raw_response,*response,handler);
       /*
       if (response->getResponseType() == ResponseType::BINARY) {
         LOG(DEBUG) << "AuthenticatingProxy - Got binary response";
@@ -298,9 +322,9 @@ Response* AuthenticatingProxy::doRequest(const std::string& method,const std::st
 
       if (nullptr != body) {
         LOG(DEBUG) << "Request body is not null on retry";
-        LOG(DEBUG) << "  mimeString: " << utility::conversions::to_utf8string(mimeString);
-        LOG(DEBUG) << "  bodyString: " << utility::conversions::to_utf8string(bodyString);
-        req.set_body(bodyString,mimeString);
+        LOG(DEBUG) << "  mimeString: " << mimeString;
+        LOG(DEBUG) << "  bodyString: " << body->contentView();
+        req.set_body(body->contentView().str(),mimeString);
         //req.set_body(utility::conversions::to_string_t(body->getContent()), utility::conversions::to_string_t(body->getMimeType()));
         //concurrency::streams::stdio_istream
         //std::istream* isp = body->getStream();
@@ -345,11 +369,7 @@ Response* AuthenticatingProxy::doRequest(const std::string& method,const std::st
         AuthenticatingProxy::copyHeaders(raw_response.headers(),h);
         response->setResponseHeaders(h); // also sets response type via Content-type header
 
-        std::vector<unsigned char> vec = raw_response.extract_vector().get();
-        std::string str;
-        str.reserve(vec.size());
-        str.assign(vec.begin(),vec.end());
-        response->setContent(str);
+        AuthenticatingProxy::readBody(raw_response,*response,handler);
         /*
         if (response->getResponseType() == ResponseType::BINARY) {
           LOG(DEBUG) << "AuthenticatingProxy - Got binary response";
@@ -405,7 +425,7 @@ Response* AuthenticatingProxy::postSync(const std::string& host,
 {
   TIMED_FUNC(AuthenticatingProxy_postSync);
   LOG(DEBUG) << "    Entering postSync";
-  LOG(DEBUG) << "    Post content: " << body.getContent();
+  LOG(DEBUG) << "    Post content: " << body.contentView();
   Response* response = doRequest(utility::conversions::to_utf8string(http::methods::POST),host,path,headers,&body);
   LOG(DEBUG) << "    Response content: " << response->getContent();
   LOG(DEBUG) << "    Leaving postSync";
@@ -413,15 +433,39 @@ Response* AuthenticatingProxy::postSync(const std::string& host,
   return response;
 }
 
-void AuthenticatingProxy::buildBulkPayload(const DocumentSet& set,const long startIdx,const long endIdx, std::ostringstream& sout) {
+Response* AuthenticatingProxy::postStreamed(const std::string& host,
+    const std::string& path,
+    const IDocumentContent& body,
+    IResponseBodyHandler& handler,
+    const mlclient::HttpHeaders& headers)
+{
+  TIMED_FUNC(AuthenticatingProxy_postStreamed);
+  LOG(DEBUG) << "    Entering postStreamed";
+  LOG(DEBUG) << "    Post content: " << body.contentView();
+  Response* response = doRequest(utility::conversions::to_utf8string(http::methods::POST),host,path,headers,&body,&handler);
+  LOG(DEBUG) << "    Leaving postStreamed";
+
+  return response;
+}
+
+void AuthenticatingProxy::buildBulkPayload(const DocumentSet& set,const long startIdx,const long endIdx, std::string& out) {
+  // view every document first, so the payload is allocated once, with a little room for each part's headers
+  std::vector<ContentView> contents;
+  contents.reserve(endIdx - startIdx + 1);
+  size_t estimate = 16;
+  for (long i = startIdx;i <= endIdx;i++) {
+    contents.push_back(set.at(i).getContent()->contentView()); // written in place. TODO support binary objects
+    estimate += 1024 + contents.back().size();
+  }
+  out.reserve(out.size() + estimate);
+
   //for (list<Document>::iterator it=set.begin(); it!=set.end(); ++it) {
   for (long i = startIdx;i <= endIdx;i++) {
     const Document& it = set.at(i);
-    sout << "--BOUNDARY\r\n";
+    out += "--BOUNDARY\r\n";
 
     // send properties, collections and permissions too
 
-    GenericTextDocumentContent* tdc = new GenericTextDocumentContent;
     std::ostringstream pos;
     // TODO specify MIME type based on MIME type of properties document (could be JSON or XML)
     pos << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
@@ -447,32 +491,32 @@ void AuthenticatingProxy::buildBulkPayload(const DocumentSet& set,const long sta
     }
     pos << "  </rapi:permissions>";
     pos << "</rapi:metadata>";
-    tdc->setContent(pos.str());
-    tdc->setMimeType(mlclient::IDocumentContent::MIME_XML);
+    const std::string metadata = pos.str();
 
     // metadata FIRST
-    sout << "Content-Type: " << tdc->getMimeType() << "\r\n";
-    sout << "Content-Disposition: attachment; filename=\"" << it.getUri() << "\"; category=metadata\r\n";
-    sout << "Content-Length: " << tdc->getLength() << "\r\n";
-    sout << "\r\n";
-    sout << tdc->getContent();
-    sout << "\r\n";
+    out += "Content-Type: " + mlclient::IDocumentContent::MIME_XML + "\r\n";
+    out += "Content-Disposition: attachment; filename=\"" + it.getUri() + "\"; category=metadata\r\n";
+    out += "Content-Length: " + std::to_string(metadata.length()) + "\r\n";
+    out += "\r\n";
+    out += metadata;
+    out += "\r\n";
 
-    sout << "--BOUNDARY\r\n";
+    out += "--BOUNDARY\r\n";
 
     const IDocumentContent* idc = it.getContent();
-    std::string content = idc->getContent(); // TODO support binary objects
+    const ContentView& content = contents[i - startIdx];
 
-    sout << "Content-Type: " << idc->getMimeType() << "\r\n";
-    sout << "Content-Disposition: attachment;filename=\"" << it.getUri() << "\"\r\n";
-    sout << "Content-Length: " << content.size() << "\r\n";
+    out += "Content-Type: " + idc->getMimeType() + "\r\n";
+    out += "Content-Disposition: attachment;filename=\"" + it.getUri() + "\"\r\n";
+    out += "Content-Length: " + std::to_string(content.size()) + "\r\n";
 
-    sout << "\r\n";
+    out += "\r\n";
 
-    sout << content << "\r\n";
+    out.append(content.data(),content.size());
+    out += "\r\n";
   }
 
-  sout << "--BOUNDARY--\r\n" << std::endl;
+  out += "--BOUNDARY--\r\n\n";
 
   //cout << "DUMP BULK PAYLOAD - START" << endl;
   //cout << bulkPayload << endl;
@@ -488,17 +532,14 @@ Response* AuthenticatingProxy::multiPostSync(const std::string& host,const std::
 
   GenericTextDocumentContent body;
   body.setMimeType("multipart/mixed");
-  std::ostringstream content;
-  buildBulkPayload(allContent,startPosInclusive,endPosInclusive,content);
-  std::string ct = content.str();
-  body.setContent(ct);
+  std::string payload;
+  buildBulkPayload(allContent,startPosInclusive,endPosInclusive,payload);
+  body.setContent(std::move(payload)); // not copied until the request copies it in to its own body
 
   HttpHeaders headers = commonHeaders; // copy assignment operator
   headers.setHeader("Content-type","multipart/mixed; boundary=BOUNDARY");
   headers.setHeader("Accept",IDocumentContent::MIME_JSON);
-  std::ostringstream os;
-  os << ct.length();
-  headers.setHeader("Content-Length",os.str());
+  headers.setHeader("Content-Length",std::to_string(body.size()));
 
   //LOG(DEBUG) << "    Multi Post content: " << body.getContent();
   Response* response = doRequest(utility::conversions::to_utf8string(http::methods::POST),host,path,headers,&body);
@@ -43,6 +43,37 @@
 %feature("director") IDocumentContent;
 
 %ignore mlclient::reconfigureLogging(int argc,const char *argv[]);
+
+// value iterators are for C++ range based for loops. The bindings use the pointer begin() and end() functions.
+%ignore mlclient::IteratorRange;
+%ignore mlclient::SearchResultSet::cbegin;
+%ignore mlclient::SearchResultSet::cend;
+%ignore mlclient::SearchResultSet::items;
+%ignore mlclient::ValuesResultSet::cbegin;
+%ignore mlclient::ValuesResultSet::cend;
+%ignore mlclient::ValuesResultSet::items;
+
+// node kinds are for document implementations. Bindings navigate DocumentNodeRef with its typed functions only.
+%ignore mlclient::IDocumentNodeKind;
+%ignore mlclient::DocumentNodeRef::DocumentNodeRef(const IDocumentNodeKind*,const void*);
+%ignore mlclient::DocumentNodeRef::operator bool;
+%ignore mlclient::DocumentNodeRef::getKind;
+%ignore mlclient::DocumentNodeRef::getNode;
+%ignore mlclient::DocumentNodeRef::members;
+
+// bindings read content with ContentView::str() and size(). Raw pointers and streams are for C++ callers only.
+%ignore mlclient::ContentView::ContentView(const char*,const size_t);
+%ignore mlclient::ContentView::ContentView(std::shared_ptr<const std::string>);
+%ignore mlclient::ContentView::data;
+%ignore mlclient::ContentView::begin;
+%ignore mlclient::ContentView::end;
+%ignore mlclient::ContentView::openStream;
+
+// shared fragments are for C++ callers only. Bindings set content through the raw pointer overloads.
+%ignore mlclient::Document::setContent(std::shared_ptr<const IDocumentContent>);
+%ignore mlclient::Document::getSharedContent;
+%ignore mlclient::Document::setProperties(std::shared_ptr<const IDocumentContent>);
+%ignore mlclient::Document::getSharedProperties;
 //%rename(FacetOptionMap) SWIGTYPE_p_FacetOptionMap;
 //%rename(FacetOptionMap) SWIGTYPE_p_std__mapT_mlclient__utilities__FacetOption_std__string_std__lessT_mlclient__utilities__FacetOption_t_t;
 //%rename(FacetOption) SWIGTYPE_p_std__mapT_mlclient__utilities__FacetOption_std__string_std__lessT_mlclient__utilities__FacetOption_t_t__key_type;
@@ -119,6 +150,9 @@ SWIG_STD_VECTOR_ENHANCED(mlclient::ValuesResultValue)
 
 
 %feature("director") IBatchNotifiable;
+%feature("director") IHostConnectionProvider;
+%feature("director") IQueryBatchNotifiable;
+%feature("director") ISearchResultVisitor;
 //%feature("director") ILexiconRef; // throws ostream private constructor error
 //%feature("director") IQuery; // throws ostream private constructor error
 
@@ -161,9 +195,13 @@ SWIG_STD_VECTOR_ENHANCED(mlclient::ValuesResultValue)
 
 
 %{
+#include "mlclient/utilities/NativeJsonDocumentContent.hpp"
 #include "mlclient/utilities/DocumentHelper.hpp"
 #include "mlclient/utilities/ResponseHelper.hpp"
+#include "mlclient/utilities/ForestTopology.hpp"
 #include "mlclient/utilities/DocumentBatchWriter.hpp"
+#include "mlclient/utilities/QueryBatcher.hpp"
+#include "mlclient/utilities/DocumentBatchExporter.hpp"
 // #include "mlclient/utilities/PugiXmlDocumentContent.hpp"
 // #include "mlclient/utilities/PugiXmlHelper.hpp"
 #include "mlclient/utilities/SearchBuilder.hpp"
@@ -217,9 +255,13 @@ SWIG_STD_VECTOR_ENHANCED(mlclient::utilities::IQuery*)
 // %include "mlclient/utilities/PugiXmlHelper.hpp"
 // %include "mlclient/utilities/CppRestJsonDocumentContent.hpp"
 // %include "mlclient/utilities/CppRestJsonHelper.hpp"
+%include "mlclient/utilities/NativeJsonDocumentContent.hpp"
 //%include "mlclient/utilities/ResponseHelper.hpp"
 %include "mlclient/utilities/DocumentHelper.hpp"
+%include "mlclient/utilities/ForestTopology.hpp"
 %include "mlclient/utilities/DocumentBatchWriter.hpp"
+%include "mlclient/utilities/QueryBatcher.hpp"
+%include "mlclient/utilities/DocumentBatchExporter.hpp"
 %include "mlclient/utilities/DocumentBatchHelper.hpp"
 %include "mlclient/utilities/SearchBuilder.hpp"
 %include "mlclient/utilities/SearchOptionsBuilder.hpp"
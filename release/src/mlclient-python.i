@@ -14,6 +14,37 @@
 %ignore operator>>;
 %ignore *::operator>>;
 
+// value iterators are for C++ range based for loops. The bindings use the pointer begin() and end() functions.
+%ignore mlclient::IteratorRange;
+%ignore mlclient::SearchResultSet::cbegin;
+%ignore mlclient::SearchResultSet::cend;
+%ignore mlclient::SearchResultSet::items;
+%ignore mlclient::ValuesResultSet::cbegin;
+%ignore mlclient::ValuesResultSet::cend;
+%ignore mlclient::ValuesResultSet::items;
+
+// node kinds are for document implementations. Bindings navigate DocumentNodeRef with its typed functions only.
+%ignore mlclient::IDocumentNodeKind;
+%ignore mlclient::DocumentNodeRef::DocumentNodeRef(const IDocumentNodeKind*,const void*);
+%ignore mlclient::DocumentNodeRef::operator bool;
+%ignore mlclient::DocumentNodeRef::getKind;
+%ignore mlclient::DocumentNodeRef::getNode;
+%ignore mlclient::DocumentNodeRef::members;
+
+// bindings read content with ContentView::str() and size(). Raw pointers and streams are for C++ callers only.
+%ignore mlclient::ContentView::ContentView(const char*,const size_t);
+%ignore mlclient::ContentView::ContentView(std::shared_ptr<const std::string>);
+%ignore mlclient::ContentView::data;
+%ignore mlclient::ContentView::begin;
+%ignore mlclient::ContentView::end;
+%ignore mlclient::ContentView::openStream;
+
+// shared fragments are for C++ callers only. Bindings set content through the raw pointer overloads.
+%ignore mlclient::Document::setContent(std::shared_ptr<const IDocumentContent>);
+%ignore mlclient::Document::getSharedContent;
+%ignore mlclient::Document::setProperties(std::shared_ptr<const IDocumentContent>);
+%ignore mlclient::Document::getSharedProperties;
+
 %feature("director:except") {
   throw Swig::DirectorMethodException($error);
 }
@@ -64,6 +95,7 @@
 #include "mlclient/ValuesResultSet.hpp"
 #include "mlclient/utilities/CppRestJsonDocumentContent.hpp"
 #include "mlclient/utilities/CppRestJsonHelper.hpp"
+#include "mlclient/utilities/NativeJsonDocumentContent.hpp"
 #include "mlclient/utilities/DocumentBatchHelper.hpp"
 #include "mlclient/utilities/DocumentHelper.hpp"
 #include "mlclient/utilities/ResponseHelper.hpp"
@@ -94,6 +126,7 @@
 %include "mlclient/utilities/PugiXmlHelper.hpp"
 %include "mlclient/utilities/CppRestJsonDocumentContent.hpp"
 %include "mlclient/utilities/CppRestJsonHelper.hpp"
+%include "mlclient/utilities/NativeJsonDocumentContent.hpp"
 %include "mlclient/utilities/ResponseHelper.hpp"
 %include "mlclient/utilities/DocumentHelper.hpp"
 %include "mlclient/utilities/DocumentBatchWriter.hpp"
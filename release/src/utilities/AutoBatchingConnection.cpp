@@ -0,0 +1,524 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file AutoBatchingConnection.cpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ */
+
+#include <mlclient/utilities/AutoBatchingConnection.hpp>
+#include <mlclient/utilities/CppRestJsonHelper.hpp>
+#include <mlclient/HttpHeaders.hpp>
+#include <mlclient/SearchDescription.hpp>
+#include <mlclient/logging.hpp>
+#include <mlclient/mlclient.hpp>
+
+// We can use the following, because cpprest is an internal API dependency
+#include <cpprest/json.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mlclient {
+
+namespace utilities {
+
+class AutoBatchingConnection::Impl {
+public:
+  /**
+   * A buffered save. Holds its own copies of the caller's content and properties, which the caller may change.
+   */
+  struct PendingSave {
+    PendingSave(const Document& original) : doc(original), bytes(0), promise() {
+      if (original.hasContent()) {
+        doc.setContent(copyContent(*original.getContent()));
+        bytes = doc.getContent()->size();
+      }
+      if (original.hasProperties()) {
+        doc.setProperties(copyContent(*original.getProperties()));
+      }
+    }
+
+    Document doc;
+    size_t bytes;
+    std::promise<std::unique_ptr<Response>> promise;
+  };
+
+  Impl(IConnection* conn) : wrapped(conn), maxDocuments(100), maxBytes(1024 * 1024), lingerMillis(10),
+      writeBehind(false), buffer(), bufferBytes(0), oldest(), flushRequested(false), inFlight(false),
+      shutdown(false), mtx(), wakeCv(), spaceCv(), idleCv(), connMtx(), failedSaves(0), batchesSent(0), flusher() {
+    flusher = std::thread(&Impl::run,this);
+  }
+
+  ~Impl() {
+    {
+      std::unique_lock<std::mutex> lck(mtx);
+      shutdown = true;
+      wakeCv.notify_all();
+    }
+    if (flusher.joinable()) {
+      flusher.join();
+    }
+  }
+
+  /**
+   * Copies content for the flusher thread. A shared fragment is still copied, as the caller may hold a non const
+   * reference to it. Only GenericTextDocumentContent is copy on write, so only its buffer is shared.
+   */
+  static std::shared_ptr<const IDocumentContent> copyContent(const IDocumentContent& from) {
+    const GenericTextDocumentContent* generic = dynamic_cast<const GenericTextDocumentContent*>(&from);
+    if (nullptr != generic) {
+      return std::make_shared<GenericTextDocumentContent>(*generic); // shares the content buffer
+    }
+    std::shared_ptr<GenericTextDocumentContent> copy = std::make_shared<GenericTextDocumentContent>();
+    copy->setMimeType(from.getMimeType());
+    copy->setContent(from.getContent());
+    return copy;
+  }
+
+  static Response* copyResponse(const Response& from) {
+    Response* copy = new Response;
+    copy->setResponseCode(from.getResponseCode());
+    copy->setResponseType(from.getResponseType());
+    copy->setResponseHeaders(from.getResponseHeaders());
+    copy->setContent(from.getContent());
+    return copy;
+  }
+
+  static bool isSuccess(const Response* resp) {
+    const int code = (nullptr == resp ? 0 : (int)resp->getResponseCode());
+    return code >= 200 && code <= 299;
+  }
+
+  /**
+   * A copy of a successful batch Response, holding only the given document's entry in the response body
+   */
+  static Response* documentResponse(const Response& from,const std::string& uri) {
+    Response* copy = new Response;
+    copy->setResponseCode(from.getResponseCode());
+    copy->setResponseType(from.getResponseType());
+    copy->setResponseHeaders(from.getResponseHeaders());
+    try {
+      const web::json::value json(CppRestJsonHelper::fromResponse(from));
+      if (json.has_field(U("documents"))) {
+        for (auto& entry : json.at(U("documents")).as_array()) {
+          if (entry.has_field(U("uri")) && uri == utility::conversions::to_utf8string(entry.at(U("uri")).as_string())) {
+            web::json::value documents = web::json::value::array(1);
+            documents[0] = entry;
+            web::json::value result = web::json::value::object();
+            result[U("documents")] = documents;
+            copy->setContent(utility::conversions::to_utf8string(result.serialize()));
+            return copy;
+          }
+        }
+      }
+    } catch (std::exception& ex) {
+      LOG(DEBUG) << "AutoBatchingConnection: could not read the batch response body: " << ex.what();
+    }
+    copy->setContent(from.getContent());
+    return copy;
+  }
+
+  std::future<std::unique_ptr<Response>> enqueue(const Document& doc) {
+    std::unique_ptr<PendingSave> save(new PendingSave(doc));
+    std::future<std::unique_ptr<Response>> result(save->promise.get_future());
+    std::unique_lock<std::mutex> lck(mtx);
+    spaceCv.wait(lck,[this] { return shutdown || buffer.size() < (size_t)maxDocuments; });
+    if (buffer.empty()) {
+      oldest = std::chrono::steady_clock::now();
+    }
+    bufferBytes += save->bytes;
+    buffer.push_back(std::move(save));
+    wakeCv.notify_one();
+    return result;
+  }
+
+  Response* save(const Document& doc) {
+    std::future<std::unique_ptr<Response>> result(enqueue(doc));
+    if (writeBehind) {
+      Response* accepted = new Response;
+      accepted->setResponseCode(ResponseCode::ACCEPTED);
+      return accepted;
+    }
+    return result.get().release();
+  }
+
+  void flush() {
+    std::unique_lock<std::mutex> lck(mtx);
+    if (buffer.empty() && !inFlight) {
+      return;
+    }
+    flushRequested = true;
+    wakeCv.notify_one();
+    idleCv.wait(lck,[this] { return buffer.empty() && !inFlight; });
+  }
+
+  bool isDue() const {
+    return shutdown || flushRequested || buffer.size() >= (size_t)maxDocuments || bufferBytes >= (size_t)maxBytes;
+  }
+
+  /**
+   * The background flusher thread
+   */
+  void run() {
+    LOG(DEBUG) << "AutoBatchingConnection: flusher thread started";
+    std::unique_lock<std::mutex> lck(mtx);
+    while (true) {
+      if (buffer.empty()) {
+        flushRequested = false;
+        idleCv.notify_all();
+        if (shutdown) {
+          break;
+        }
+        wakeCv.wait(lck,[this] { return shutdown || !buffer.empty(); });
+        continue;
+      }
+      wakeCv.wait_until(lck,oldest + std::chrono::milliseconds(lingerMillis),[this] { return isDue(); });
+
+      std::vector<std::unique_ptr<PendingSave>> batch;
+      batch.swap(buffer);
+      bufferBytes = 0;
+      inFlight = true;
+      spaceCv.notify_all();
+
+      lck.unlock();
+      send(batch);
+      lck.lock();
+
+      inFlight = false;
+    }
+    LOG(DEBUG) << "AutoBatchingConnection: flusher thread finished";
+  }
+
+  void send(std::vector<std::unique_ptr<PendingSave>>& batch) {
+    TIMED_FUNC(AutoBatchingConnection_send);
+
+    // A later save of a URI supersedes an earlier one in the same batch. Sending both would make the server
+    // reject the whole request as a conflicting update.
+    DocumentSet set;
+    set.reserve(batch.size());
+    std::vector<size_t> sentAs(batch.size());
+    std::map<std::string,size_t> byUri;
+    for (size_t i = 0;i < batch.size();i++) {
+      const Document& doc = batch[i]->doc;
+      auto found = byUri.find(doc.getUri());
+      if (byUri.end() == found) {
+        byUri.insert(std::make_pair(doc.getUri(),set.size()));
+        sentAs[i] = set.size();
+        set.push_back(doc);
+      } else {
+        set[found->second] = doc;
+        sentAs[i] = found->second;
+      }
+    }
+    LOG(DEBUG) << "AutoBatchingConnection: sending batch of " << set.size() << " documents for " << batch.size() << " saves";
+
+    std::unique_ptr<Response> resp;
+    try {
+      std::unique_lock<std::mutex> lck(connMtx);
+      resp.reset(wrapped->saveDocuments(set,0,set.size() - 1));
+      ++batchesSent;
+    } catch (...) {
+      LOG(DEBUG) << "AutoBatchingConnection: batch of " << set.size() << " documents failed with an exception";
+      failedSaves += batch.size();
+      for (auto& save : batch) {
+        save->promise.set_exception(std::current_exception());
+      }
+      return;
+    }
+
+    if (!isSuccess(resp.get()) && set.size() > 1) {
+      // One bad document fails the whole request, so resend each on its own to give every caller its own result
+      LOG(DEBUG) << "AutoBatchingConnection: batch of " << set.size() << " documents failed, resending individually";
+      std::vector<std::unique_ptr<Response>> results(set.size());
+      std::vector<std::exception_ptr> problems(set.size());
+      for (size_t j = 0;j < set.size();j++) {
+        try {
+          std::unique_lock<std::mutex> lck(connMtx);
+          results[j].reset(wrapped->saveDocument(set[j]));
+        } catch (...) {
+          problems[j] = std::current_exception();
+        }
+      }
+      for (size_t i = 0;i < batch.size();i++) {
+        const size_t j = sentAs[i];
+        if (problems[j]) {
+          ++failedSaves;
+          batch[i]->promise.set_exception(problems[j]);
+          continue;
+        }
+        if (!isSuccess(results[j].get())) {
+          ++failedSaves;
+        }
+        batch[i]->promise.set_value(std::unique_ptr<Response>(nullptr == results[j].get() ? nullptr : copyResponse(*results[j])));
+      }
+      return;
+    }
+
+    if (!isSuccess(resp.get())) {
+      LOG(DEBUG) << "AutoBatchingConnection: batch failed with response code "
+                 << (nullptr == resp.get() ? 0 : (int)resp->getResponseCode());
+      failedSaves += batch.size();
+      for (auto& save : batch) {
+        save->promise.set_value(std::unique_ptr<Response>(nullptr == resp.get() ? nullptr : copyResponse(*resp)));
+      }
+      return;
+    }
+    for (size_t i = 0;i < batch.size();i++) {
+      batch[i]->promise.set_value(std::unique_ptr<Response>(documentResponse(*resp,set[sentAs[i]].getUri())));
+    }
+  }
+
+  IConnection* wrapped;
+  long maxDocuments;
+  long maxBytes;
+  long lingerMillis;
+  std::atomic<bool> writeBehind;
+
+  std::vector<std::unique_ptr<PendingSave>> buffer;
+  size_t bufferBytes;
+  std::chrono::steady_clock::time_point oldest;
+  bool flushRequested;
+  bool inFlight;
+  bool shutdown;
+  std::mutex mtx;
+  std::condition_variable wakeCv;
+  std::condition_variable spaceCv;
+  std::condition_variable idleCv;
+
+  std::mutex connMtx; // serialises use of the wrapped connection between the flusher and delegated calls
+
+  std::atomic<long> failedSaves;
+  std::atomic<long> batchesSent;
+
+  std::thread flusher;
+};
+
+
+
+AutoBatchingConnection::AutoBatchingConnection(IConnection* wrapped) : IConnection(),
+    mImpl(mlclient::make_unique<Impl>(wrapped)) {
+  ;
+}
+
+AutoBatchingConnection::~AutoBatchingConnection() {
+  mImpl->flush();
+}
+
+void AutoBatchingConnection::setFlushParameters(const long maxDocuments,const long maxBytes,const long lingerMillis) {
+  std::unique_lock<std::mutex> lck(mImpl->mtx);
+  mImpl->maxDocuments = (maxDocuments < 1 ? 1 : maxDocuments);
+  mImpl->maxBytes = (maxBytes < 1 ? 1 : maxBytes);
+  mImpl->lingerMillis = (lingerMillis < 0 ? 0 : lingerMillis);
+  mImpl->wakeCv.notify_one();
+}
+const long AutoBatchingConnection::getMaxDocuments() const {
+  return mImpl->maxDocuments;
+}
+const long AutoBatchingConnection::getMaxBytes() const {
+  return mImpl->maxBytes;
+}
+const long AutoBatchingConnection::getLingerMillis() const {
+  return mImpl->lingerMillis;
+}
+
+void AutoBatchingConnection::setWriteBehind(const bool writeBehind) {
+  mImpl->writeBehind = writeBehind;
+}
+const bool AutoBatchingConnection::isWriteBehind() const {
+  return mImpl->writeBehind;
+}
+
+std::future<std::unique_ptr<Response>> AutoBatchingConnection::saveDocumentAsync(const Document& doc) {
+  return mImpl->enqueue(doc);
+}
+
+std::future<std::unique_ptr<Response>> AutoBatchingConnection::saveDocumentContentAsync(const std::string& uri,
+    const IDocumentContent& payload) {
+  Document doc(uri);
+  doc.setContent(const_cast<IDocumentContent*>(&payload)); // copied by enqueue, never deleted by Document
+  return mImpl->enqueue(doc);
+}
+
+void AutoBatchingConnection::flush() {
+  mImpl->flush();
+}
+
+const long AutoBatchingConnection::getFailedSaves() const {
+  return mImpl->failedSaves;
+}
+const long AutoBatchingConnection::getBatchesSent() const {
+  return mImpl->batchesSent;
+}
+
+Response* AutoBatchingConnection::saveDocument(const Document& doc) {
+  TIMED_FUNC(AutoBatchingConnection_saveDocument);
+  return mImpl->save(doc);
+}
+
+Response* AutoBatchingConnection::saveDocumentContent(const std::string& uri,const IDocumentContent& payload) {
+  TIMED_FUNC(AutoBatchingConnection_saveDocumentContent);
+  Document doc(uri);
+  doc.setContent(const_cast<IDocumentContent*>(&payload)); // copied by save, never deleted by Document
+  return mImpl->save(doc);
+}
+
+
+
+void AutoBatchingConnection::configure(const std::string& hostname, const std::string& port, const std::string& username,
+    const std::string& password, const bool usessl) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  mImpl->wrapped->configure(hostname,port,username,password,usessl);
+}
+bool AutoBatchingConnection::connect() {
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->connect();
+}
+void AutoBatchingConnection::disconnect() {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  mImpl->wrapped->disconnect();
+}
+void AutoBatchingConnection::setDatabaseName(const std::string& db) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  mImpl->wrapped->setDatabaseName(db);
+}
+std::string AutoBatchingConnection::getDatabaseName() {
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->getDatabaseName();
+}
+
+Response* AutoBatchingConnection::doGet(const std::string& pathAndQuerystring) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->doGet(pathAndQuerystring);
+}
+Response* AutoBatchingConnection::doPut(const std::string& pathAndQuerystring,const IDocumentContent& payload) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->doPut(pathAndQuerystring,payload);
+}
+Response* AutoBatchingConnection::doPost(const std::string& pathAndQuerystring,const IDocumentContent& payload) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->doPost(pathAndQuerystring,payload);
+}
+Response* AutoBatchingConnection::doDelete(const std::string& pathAndQueryString) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->doDelete(pathAndQueryString);
+}
+
+Response* AutoBatchingConnection::getDocument(const std::string& uri) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->getDocument(uri);
+}
+Response* AutoBatchingConnection::getDocument(Document& inout_document) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->getDocument(inout_document);
+}
+Response* AutoBatchingConnection::getDocumentContent(Document& inout_document) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->getDocumentContent(inout_document);
+}
+Response* AutoBatchingConnection::getDocumentProperties(Document& inout_document) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->getDocumentProperties(inout_document);
+}
+Response* AutoBatchingConnection::getDocumentPermissions(Document& inout_document) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->getDocumentPermissions(inout_document);
+}
+Response* AutoBatchingConnection::getDocuments(const DocumentUriSet& uris,const long startPosInclusive,
+    const long endPosInclusive) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->getDocuments(uris,startPosInclusive,endPosInclusive);
+}
+Response* AutoBatchingConnection::saveDocuments(const DocumentSet& documents,const long startPosInclusive,
+    const long endPosInclusive) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->saveDocuments(documents,startPosInclusive,endPosInclusive);
+}
+Response* AutoBatchingConnection::saveDocumentsToForest(const DocumentSet& documents,const long startPosInclusive,
+    const long endPosInclusive,const std::string& forestName) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->saveDocumentsToForest(documents,startPosInclusive,endPosInclusive,forestName);
+}
+Response* AutoBatchingConnection::deleteDocument(const std::string& uri) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->deleteDocument(uri);
+}
+
+Response* AutoBatchingConnection::search(const SearchDescription& desc) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->search(desc);
+}
+Response* AutoBatchingConnection::searchStreamed(const SearchDescription& desc,IResponseBodyHandler& handler) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->searchStreamed(desc,handler);
+}
+Response* AutoBatchingConnection::searchExtension(const std::string& extensionName,const SearchDescription& desc) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->searchExtension(extensionName,desc);
+}
+Response* AutoBatchingConnection::saveSearchOptions(const std::string& optionsName,const IDocumentContent* optionsDoc) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->saveSearchOptions(optionsName,optionsDoc);
+}
+Response* AutoBatchingConnection::values(const std::string& valuesName,const std::string& optionsName) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->values(valuesName,optionsName);
+}
+Response* AutoBatchingConnection::valuesExtension(const std::string& extensionName,const std::string& valuesName,
+    const std::string& optionsName,const SearchDescription& desc) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->valuesExtension(extensionName,valuesName,optionsName,desc);
+}
+Response* AutoBatchingConnection::listRootCollections() {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->listRootCollections();
+}
+Response* AutoBatchingConnection::listCollections(const std::string& parentCollection) {
+  mImpl->flush();
+  std::unique_lock<std::mutex> lck(mImpl->connMtx);
+  return mImpl->wrapped->listCollections(parentCollection);
+}
+
+} // end namespace utilities
+
+} // end namespace mlclient
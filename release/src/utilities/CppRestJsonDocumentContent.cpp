@@ -23,6 +23,7 @@
 #include <mlclient/logging.hpp>
 #include <mlclient/InvalidFormatException.hpp>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <sstream>
 
@@ -30,6 +31,243 @@ namespace mlclient {
 
 namespace utilities {
 
+std::string trimKey(std::string key); // forward declaration
+
+namespace {
+
+web::json::value& valueOf(const void* node) {
+  return *const_cast<web::json::value*>(static_cast<const web::json::value*>(node));
+}
+
+bool isTrueString(const web::json::value& value) {
+  if (!value.is_string()) {
+    return false;
+  }
+  std::string val(utility::conversions::to_utf8string(value.as_string()));
+  return ("true" == val) || ("TRUE" == val) || ("True" == val);
+}
+
+/**
+ * A web::json::value, as held in a CppRestJsonDocumentNode or CppRestJsonDocumentNavigator
+ */
+class JsonValueKind : public IDocumentNodeKind {
+public:
+  bool isNull(const void* node) const override {
+    return valueOf(node).is_null();
+  }
+  bool isBoolean(const void* node) const override {
+    return valueOf(node).is_boolean() || isTrueString(valueOf(node));
+  }
+  bool isInteger(const void* node) const override {
+    return valueOf(node).is_integer();
+  }
+  bool isDouble(const void* node) const override {
+    return valueOf(node).is_double();
+  }
+  bool isString(const void* node) const override {
+    return valueOf(node).is_string() && !isTrueString(valueOf(node));
+  }
+  bool isArray(const void* node) const override {
+    return valueOf(node).is_array();
+  }
+  bool isObject(const void* node) const override {
+    return valueOf(node).is_object();
+  }
+
+  bool asBoolean(const void* node) const override {
+    const web::json::value& value = valueOf(node);
+    if (value.is_boolean()) {
+      return value.as_bool();
+    }
+    if (!value.is_string()) {
+      throw mlclient::InvalidFormatException("JSON value is not a boolean");
+    }
+    return isTrueString(value);
+  }
+  int32_t asInteger(const void* node) const override {
+    if (!valueOf(node).is_number()) {
+      throw mlclient::InvalidFormatException("JSON value is not an integer");
+    }
+    return valueOf(node).as_integer();
+  }
+  double asDouble(const void* node) const override {
+    if (!valueOf(node).is_number()) {
+      throw mlclient::InvalidFormatException("JSON value is not a double");
+    }
+    return valueOf(node).as_double();
+  }
+  std::string asString(const void* node) const override {
+    if (!valueOf(node).is_string()) {
+      throw mlclient::InvalidFormatException("JSON value is not a string");
+    }
+    return utility::conversions::to_utf8string(valueOf(node).as_string());
+  }
+
+  DocumentNodeRef at(const void* node,const std::string& key) const override;
+  DocumentNodeRef at(const void* node,const int32_t idx) const override;
+  StringList keys(const void* node) const override;
+  int32_t size(const void* node) const override {
+    return (valueOf(node).is_array() ? (int32_t)valueOf(node).size() : 1);
+  }
+
+  IDocumentNode* newNode(const void* node) const override {
+    return new CppRestJsonDocumentNode(valueOf(node));
+  }
+};
+
+/**
+ * A web::json::array, as held in a CppRestJsonArrayNode
+ */
+class JsonArrayKind : public IDocumentNodeKind {
+public:
+  static web::json::array& arrayOf(const void* node) {
+    return *const_cast<web::json::array*>(static_cast<const web::json::array*>(node));
+  }
+
+  bool isNull(const void* node) const override {
+    return false;
+  }
+  bool isBoolean(const void* node) const override {
+    return false;
+  }
+  bool isInteger(const void* node) const override {
+    return false;
+  }
+  bool isDouble(const void* node) const override {
+    return false;
+  }
+  bool isString(const void* node) const override {
+    return false;
+  }
+  bool isArray(const void* node) const override {
+    return true;
+  }
+  bool isObject(const void* node) const override {
+    return false;
+  }
+
+  bool asBoolean(const void* node) const override {
+    throw mlclient::InvalidFormatException("JSON Container is not a boolean");
+  }
+  int32_t asInteger(const void* node) const override {
+    throw mlclient::InvalidFormatException("JSON Container is not a integer");
+  }
+  double asDouble(const void* node) const override {
+    throw mlclient::InvalidFormatException("JSON Container is not a double");
+  }
+  std::string asString(const void* node) const override {
+    throw mlclient::InvalidFormatException("JSON Container is not a string");
+  }
+
+  DocumentNodeRef at(const void* node,const std::string& key) const override {
+    return DocumentNodeRef();
+  }
+  DocumentNodeRef at(const void* node,const int32_t idx) const override;
+  StringList keys(const void* node) const override {
+    return StringList();
+  }
+  int32_t size(const void* node) const override {
+    return arrayOf(node).size();
+  }
+
+  IDocumentNode* newNode(const void* node) const override {
+    return new CppRestJsonArrayNode(arrayOf(node));
+  }
+};
+
+/**
+ * A web::json::object, as held in a CppRestJsonObjectNode
+ */
+class JsonObjectKind : public JsonArrayKind {
+public:
+  static web::json::object& objectOf(const void* node) {
+    return *const_cast<web::json::object*>(static_cast<const web::json::object*>(node));
+  }
+
+  bool isArray(const void* node) const override {
+    return false;
+  }
+  bool isObject(const void* node) const override {
+    return true;
+  }
+
+  DocumentNodeRef at(const void* node,const std::string& key) const override;
+  DocumentNodeRef at(const void* node,const int32_t idx) const override {
+    return DocumentNodeRef();
+  }
+  StringList keys(const void* node) const override;
+  int32_t size(const void* node) const override {
+    return 1;
+  }
+
+  IDocumentNode* newNode(const void* node) const override {
+    return new CppRestJsonObjectNode(objectOf(node));
+  }
+};
+
+const JsonValueKind VALUE_KIND;
+const JsonArrayKind ARRAY_KIND;
+const JsonObjectKind OBJECT_KIND;
+
+DocumentNodeRef propertyOf(const web::json::object& obj,const std::string& key) {
+  auto found = obj.find(utility::conversions::to_string_t(trimKey(key)));
+  if (obj.end() == found) {
+    return DocumentNodeRef();
+  }
+  return DocumentNodeRef(&VALUE_KIND,&found->second);
+}
+
+StringList keysOf(const web::json::object& obj) {
+  StringList keys;
+  for (auto iter = obj.begin();iter != obj.end();++iter) {
+    keys.push_back(utility::conversions::to_utf8string(iter->first));
+  }
+  return keys;
+}
+
+DocumentNodeRef memberOf(const web::json::array& arr,const int32_t idx) {
+  if (idx < 0 || (size_t)idx >= arr.size()) {
+    return DocumentNodeRef();
+  }
+  return DocumentNodeRef(&VALUE_KIND,&arr.at(idx));
+}
+
+DocumentNodeRef JsonValueKind::at(const void* node,const std::string& key) const {
+  const web::json::value& value = valueOf(node);
+  return (value.is_object() ? propertyOf(value.as_object(),key) : DocumentNodeRef());
+}
+DocumentNodeRef JsonValueKind::at(const void* node,const int32_t idx) const {
+  const web::json::value& value = valueOf(node);
+  return (value.is_array() ? memberOf(value.as_array(),idx) : DocumentNodeRef());
+}
+StringList JsonValueKind::keys(const void* node) const {
+  const web::json::value& value = valueOf(node);
+  return (value.is_object() ? keysOf(value.as_object()) : StringList());
+}
+
+DocumentNodeRef JsonArrayKind::at(const void* node,const int32_t idx) const {
+  return memberOf(arrayOf(node),idx);
+}
+
+DocumentNodeRef JsonObjectKind::at(const void* node,const std::string& key) const {
+  return propertyOf(objectOf(node),key);
+}
+StringList JsonObjectKind::keys(const void* node) const {
+  return keysOf(objectOf(node));
+}
+
+/**
+ * Returns a heap node for at(), which throws rather than returning nullptr for a missing child
+ */
+IDocumentNode* requireNode(const DocumentNodeRef& child,const std::string& key) {
+  if (child.isEmpty()) {
+    throw mlclient::InvalidFormatException("JSON property or array member does not exist: " + key);
+  }
+  return child.newNode();
+}
+
+} // end anonymous namespace
+
 CppRestJsonContainerNode::CppRestJsonContainerNode() {
   ;
 }
@@ -54,20 +292,20 @@ bool CppRestJsonContainerNode::isString() const {
 }
 
 bool CppRestJsonContainerNode::asBoolean() const {
-  throw new mlclient::InvalidFormatException("JSON Container is not a boolean");
+  throw mlclient::InvalidFormatException("JSON Container is not a boolean");
 }
 int32_t CppRestJsonContainerNode::asInteger() const {
-  throw new mlclient::InvalidFormatException("JSON Container is not a integer");
+  throw mlclient::InvalidFormatException("JSON Container is not a integer");
 }
 double CppRestJsonContainerNode::asDouble() const {
-  throw new mlclient::InvalidFormatException("JSON Container is not a double");
+  throw mlclient::InvalidFormatException("JSON Container is not a double");
 }
 std::string CppRestJsonContainerNode::asString() const {
-  throw new mlclient::InvalidFormatException("JSON Container is not a string");
+  throw mlclient::InvalidFormatException("JSON Container is not a string");
 }
 
 IDocumentContent* CppRestJsonContainerNode::getChildContent() const {
-  throw new mlclient::InvalidFormatException("JSON Container is not a string");
+  throw mlclient::InvalidFormatException("JSON Container is not a string");
 }
 
 
@@ -107,11 +345,20 @@ IDocumentNode* CppRestJsonArrayNode::at(const std::string& key) const {
   throw mlclient::InvalidFormatException("JSON Container Array does not support string key subscripts");
 }
 IDocumentNode* CppRestJsonArrayNode::at(const int32_t idx) const {
-  return new CppRestJsonDocumentNode(mImpl->array.at(idx));
+  return requireNode(ref().at(idx),std::to_string(idx));
 }
 bool CppRestJsonArrayNode::has(const std::string& key) const {
   throw mlclient::InvalidFormatException("JSON Container Array does not support string key subscripts");
 }
+IDocumentNode* CppRestJsonArrayNode::tryAt(const std::string& key) const {
+  return nullptr;
+}
+IDocumentNode* CppRestJsonArrayNode::tryAt(const int32_t idx) const {
+  return ref().at(idx).newNode();
+}
+DocumentNodeRef CppRestJsonArrayNode::ref() const {
+  return DocumentNodeRef(&ARRAY_KIND,&mImpl->array);
+}
 
 StringList CppRestJsonArrayNode::keys() const {
   throw mlclient::InvalidFormatException("JSON Container Array does not support string key subscripts");
@@ -165,24 +412,23 @@ IDocumentNode* CppRestJsonObjectNode::asObject() const {
 }
 
 IDocumentNode* CppRestJsonObjectNode::at(const std::string& key) const {
-  return new CppRestJsonDocumentNode(mImpl->obj.at(utility::conversions::to_string_t(trimKey(key))));
+  return requireNode(ref().at(key),key);
 }
 IDocumentNode* CppRestJsonObjectNode::at(const int32_t idx) const {
   throw mlclient::InvalidFormatException("JSON Container Object does not support integer subscripts");
 }
 
 bool CppRestJsonObjectNode::has(const std::string& key) const {
-  std::string actualKey = trimKey(key);
-  auto foundIter = mImpl->obj.find(utility::conversions::to_string_t(actualKey));
-  return (mImpl->obj.end() != foundIter);
-  /*
-  for (auto iter = mImpl->obj.begin();iter != mImpl->obj.end();++iter) {
-    if (*iter == actualKey) {
-      return true;
-    }
-  }
-  return false;
-  */
+  return ref().has(key);
+}
+IDocumentNode* CppRestJsonObjectNode::tryAt(const std::string& key) const {
+  return ref().at(key).newNode();
+}
+IDocumentNode* CppRestJsonObjectNode::tryAt(const int32_t idx) const {
+  return nullptr;
+}
+DocumentNodeRef CppRestJsonObjectNode::ref() const {
+  return DocumentNodeRef(&OBJECT_KIND,&mImpl->obj);
 }
 
 StringList CppRestJsonObjectNode::keys() const {
@@ -319,15 +565,23 @@ IDocumentNode* CppRestJsonDocumentNode::asObject() const {
 }
 
 IDocumentNode* CppRestJsonDocumentNode::at(const std::string& key) const {
-  return new CppRestJsonDocumentNode(mImpl->root.at(utility::conversions::to_string_t(trimKey(key))));
+  return requireNode(ref().at(key),key);
 }
 IDocumentNode* CppRestJsonDocumentNode::at(const int32_t idx) const {
-  return new CppRestJsonDocumentNode(mImpl->root.at(idx));
+  return requireNode(ref().at(idx),std::to_string(idx));
 }
 
 bool CppRestJsonDocumentNode::has(const std::string& key) const {
-  std::string actualKey = trimKey(key);
-  return mImpl->root.has_field(utility::conversions::to_string_t(actualKey));
+  return ref().has(key);
+}
+IDocumentNode* CppRestJsonDocumentNode::tryAt(const std::string& key) const {
+  return ref().at(key).newNode();
+}
+IDocumentNode* CppRestJsonDocumentNode::tryAt(const int32_t idx) const {
+  return ref().at(idx).newNode();
+}
+DocumentNodeRef CppRestJsonDocumentNode::ref() const {
+  return DocumentNodeRef(&VALUE_KIND,&mImpl->root);
 }
 
 StringList CppRestJsonDocumentNode::keys() const {
@@ -410,12 +664,19 @@ IDocumentNode* CppRestJsonDocumentNavigator::firstChild() const {
 
 IDocumentNode* CppRestJsonDocumentNavigator::at(const std::string& key) const {
   //LOG(DEBUG) << "CppRestJsonDocumentNavigator::at key: " << key;
-  return new CppRestJsonDocumentNode(mImpl->root.at(utility::conversions::to_string_t(trimKey(key)))); // uses move constructor
+  return requireNode(ref().at(key),key);
 }
 
 bool CppRestJsonDocumentNavigator::has(const std::string& key) const {
-  std::string actualKey = trimKey(key);
-  return mImpl->root.has_field(utility::conversions::to_string_t(actualKey));
+  return ref().has(key);
+}
+
+IDocumentNode* CppRestJsonDocumentNavigator::tryAt(const std::string& key) const {
+  return ref().at(key).newNode();
+}
+
+DocumentNodeRef CppRestJsonDocumentNavigator::ref() const {
+  return DocumentNodeRef(&VALUE_KIND,&mImpl->root);
 }
 
 
@@ -427,14 +688,42 @@ bool CppRestJsonDocumentNavigator::has(const std::string& key) const {
 
 class CppRestJsonDocumentContent::Impl {
 public:
-  Impl() : value(web::json::value()), mimeType("") {
+  Impl() : value(web::json::value()), mimeType(""), serializedMutex(), serialized(), dirty(true) {
     TIMED_FUNC(CppRestJsonDocumentContent_Impl_defaultConstructor);
   };
   ~Impl() {
     TIMED_FUNC(CppRestJsonDocumentContent_Impl_destructor);
   };
+
+  /**
+   * Returns the serialised value, serialising it only if it has changed since it was last serialised
+   */
+  std::shared_ptr<const std::string> getSerialized() {
+    std::lock_guard<std::mutex> lock(serializedMutex);
+    if (dirty) {
+      std::ostringstream os;
+      value.serialize(os);
+      serialized = std::make_shared<const std::string>(os.str());
+      dirty = false;
+    }
+    return serialized;
+  }
+
+  /**
+   * Called on every change to value
+   */
+  void changed() {
+    std::lock_guard<std::mutex> lock(serializedMutex);
+    dirty = true;
+    serialized.reset(); // frees the stale text now, unless a view or stream still shares it
+  }
+
   web::json::value value;
   std::string mimeType;
+
+  std::mutex serializedMutex; // const functions may be called from several threads
+  std::shared_ptr<const std::string> serialized; // replaced, never modified, as views and streams share it
+  bool dirty;
 };
 
 CppRestJsonDocumentContent::CppRestJsonDocumentContent() : mImpl(new Impl) {
@@ -449,12 +738,7 @@ CppRestJsonDocumentContent::~CppRestJsonDocumentContent() {
 
 std::istream* CppRestJsonDocumentContent::getStream() const {
   TIMED_FUNC(CppRestJsonDocumentContent_getStream);
-  std::ostringstream* os = new std::ostringstream;
-  //(*os) << mImpl->value;
-  mImpl->value.serialize(*os);
-  std::istringstream* is = new std::istringstream(os->str());
-  delete os;
-  return is;
+  return contentView().openStream();
 }
 
 const web::json::value& CppRestJsonDocumentContent::getJson() const {
@@ -466,6 +750,15 @@ void CppRestJsonDocumentContent::setContent(web::json::value& json) {
   //LOG(DEBUG) << "CppRestJsonDocumentContent::setContent(web::json::value&)";
   TIMED_FUNC(CppRestJsonDocumentContent_setContent);
   mImpl->value = std::move(json); // move constructor
+  mImpl->changed();
+}
+
+ContentView CppRestJsonDocumentContent::contentView() const {
+  return ContentView(mImpl->getSerialized());
+}
+
+size_t CppRestJsonDocumentContent::size() const {
+  return mImpl->getSerialized()->size();
 }
 
 std::string CppRestJsonDocumentContent::getMimeType() const {
@@ -478,7 +771,7 @@ void CppRestJsonDocumentContent::setMimeType(const std::string& mt) {
 }
 
 int CppRestJsonDocumentContent::getLength() const {
-  return getContent().size();
+  return mImpl->getSerialized()->size();
 }
 
 void CppRestJsonDocumentContent::setContent(std::string content) {
@@ -487,22 +780,18 @@ void CppRestJsonDocumentContent::setContent(std::string content) {
   std::ostringstream os;
   os << content;
   mImpl-> value = web::json::value::parse(utility::conversions::to_string_t(os.str()));
+  mImpl->changed();
 }
 
 std::string CppRestJsonDocumentContent::getContent() const {
   //LOG(DEBUG) << "CppRestJsonDocumentContent::getContent";
   TIMED_FUNC(CppRestJsonDocumentContent_getContent);
-  std::ostringstream os;
-  //os << mImpl->value;
-  mImpl->value.serialize(os);
-  return os.str();
+  return *mImpl->getSerialized();
 }
 
 IDocumentNavigator* CppRestJsonDocumentContent::navigate(bool firstElementAsRoot) const {
   //LOG(DEBUG) << "CppRestJsonDocumentContent::navigate";
   //LOG(DEBUG) << "CppRestJsonDocumentContent::navigate : mImpl is null?: " << (nullptr == mImpl);
-  std::ostringstream os;
-  mImpl->value.serialize(os);
   //LOG(DEBUG) << "CppRestJsonDocumentContent::navigate : value: " << os.str();
   return new CppRestJsonDocumentNavigator(mImpl->value,firstElementAsRoot);
 }
@@ -56,9 +56,7 @@ const web::json::value CppRestJsonHelper::fromDocument(const CppRestJsonDocument
 
 const web::json::value CppRestJsonHelper::fromDocument(const IDocumentContent& dc) {
   TIMED_FUNC(CppRestJsonHelper_fromDocument_IDocumentContent);
-  std::ostringstream os;
-  os << dc.getStream()->get();
-  return web::json::value::parse(utility::conversions::to_string_t(os.str()));
+  return web::json::value::parse(utility::conversions::to_string_t(dc.contentView().str()));
 }
 
 // Response conversion
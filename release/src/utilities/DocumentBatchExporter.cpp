@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file DocumentBatchExporter.cpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ */
+
+#include <mlclient/utilities/DocumentBatchExporter.hpp>
+#include <mlclient/utilities/DocumentBatchHelper.hpp>
+#include <mlclient/DocumentContent.hpp>
+#include <mlclient/Document.hpp>
+#include <mlclient/logging.hpp>
+#include <mlclient/mlclient.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace mlclient {
+
+namespace utilities {
+
+namespace {
+
+void writeLength(std::ostream& os,uint64_t len,int bytes) {
+  char buf[8];
+  for (int i = 0;i < bytes;i++) {
+    buf[i] = (char)((len >> (8 * i)) & 0xff);
+  }
+  os.write(buf,bytes);
+}
+
+bool readLength(std::istream& is,uint64_t& len,int bytes) {
+  unsigned char buf[8];
+  is.read((char*)buf,bytes);
+  if (is.gcount() != bytes) {
+    return false;
+  }
+  len = 0;
+  for (int i = 0;i < bytes;i++) {
+    len |= ((uint64_t)buf[i]) << (8 * i);
+  }
+  return true;
+}
+
+bool readBytes(std::istream& is,uint64_t len,std::string& out) {
+  out.resize((size_t)len);
+  if (0 == len) {
+    return true;
+  }
+  is.read(&out[0],(std::streamsize)len);
+  return is.gcount() == (std::streamsize)len;
+}
+
+} // end anonymous namespace
+
+
+
+class DocumentBatchExporter::Impl : public IQueryBatchNotifiable {
+public:
+  Impl(IConnection* conn) : batcher(conn), format(ExportFormat::DIRECTORY), folder(), appendBase(), archivePath(),
+      archive(), maxPending(4), pending(), mtx(), pendingCv(), spaceCv(), writer(), readersDone(false),
+      started(false), written(0), failed(0) {
+    batcher.addBatchListener(this);
+  }
+
+  ~Impl() {
+    batcher.stop();
+    finish();
+  }
+
+  /**
+   * Called on the QueryBatcher's worker tasks. Blocks whilst the write queue is full.
+   */
+  void queryBatchComplete(QueryBatch& batch) override {
+    if (!batch.isSuccess()) {
+      LOG(DEBUG) << "DocumentBatchExporter: batch " << batch.getSequence() << " could not be read: " << batch.getMessage();
+      failed += batch.getUris().size();
+      return;
+    }
+    DocumentSet docs(batch.releaseDocuments());
+    if (docs.size() < batch.getUris().size()) {
+      failed += batch.getUris().size() - docs.size();
+    }
+    std::unique_lock<std::mutex> lck(mtx);
+    spaceCv.wait(lck,[this] { return pending.size() < (size_t)maxPending; });
+    pending.push_back(std::move(docs));
+    pendingCv.notify_one();
+  }
+
+  void start() {
+    if (started) {
+      return;
+    }
+    if (ExportFormat::ARCHIVE == format) {
+      archive.open(archivePath.c_str(),std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!archive.is_open()) {
+        throw std::runtime_error("Could not open archive file for writing: " + archivePath);
+      }
+    } else if (folder.empty()) {
+      throw std::runtime_error("No export target set. Call setDirectoryTarget or setArchiveTarget first.");
+    }
+    started = true;
+    readersDone = false;
+    writer = std::thread(&Impl::writeLoop,this);
+    batcher.send();
+  }
+
+  /**
+   * Waits for all reads, then for the writer to drain the queue
+   */
+  void finish() {
+    if (!started) {
+      return;
+    }
+    batcher.wait();
+    {
+      std::unique_lock<std::mutex> lck(mtx);
+      readersDone = true;
+      pendingCv.notify_all();
+    }
+    if (writer.joinable()) {
+      writer.join();
+    }
+    if (archive.is_open()) {
+      archive.close();
+    }
+    started = false;
+  }
+
+  void writeLoop() {
+    LOG(DEBUG) << "DocumentBatchExporter: writer thread started";
+    while (true) {
+      DocumentSet docs;
+      {
+        std::unique_lock<std::mutex> lck(mtx);
+        pendingCv.wait(lck,[this] { return !pending.empty() || readersDone; });
+        if (pending.empty()) {
+          break;
+        }
+        docs = std::move(pending.front());
+        pending.pop_front();
+        spaceCv.notify_one();
+      }
+      for (auto& doc : docs) {
+        if (writeDocument(doc)) {
+          ++written;
+        } else {
+          ++failed;
+        }
+        delete doc.getContent(); // released from the QueryBatch, so we own it
+      }
+    }
+    LOG(DEBUG) << "DocumentBatchExporter: writer thread finished";
+  }
+
+  bool writeDocument(const Document& doc) {
+    const IDocumentContent* content = doc.getContent();
+    if (nullptr == content) {
+      return false;
+    }
+    const ContentView data(content->contentView());
+    if (ExportFormat::ARCHIVE == format) {
+      const std::string mime(content->getMimeType());
+      writeLength(archive,doc.getUri().length(),4);
+      archive.write(doc.getUri().data(),doc.getUri().length());
+      writeLength(archive,mime.length(),4);
+      archive.write(mime.data(),mime.length());
+      writeLength(archive,data.size(),8);
+      archive.write(data.data(),data.size());
+      return archive.good();
+    }
+
+    const std::string path(DocumentBatchHelper::uriToFilePath(doc.getUri(),folder,appendBase));
+    if (path.empty()) {
+      return false;
+    }
+    try {
+      boost::filesystem::path parent = boost::filesystem::path(path).parent_path();
+      if (!parent.empty()) {
+        boost::filesystem::create_directories(parent);
+      }
+    } catch (std::exception& ex) {
+      LOG(DEBUG) << "DocumentBatchExporter: could not create folder for " << path << ": " << ex.what();
+      return false;
+    }
+    std::ofstream out(path.c_str(),std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(data.data(),data.size());
+    if (!out.good()) {
+      LOG(DEBUG) << "DocumentBatchExporter: could not write file: " << path;
+      return false;
+    }
+    return true;
+  }
+
+  QueryBatcher batcher;
+  ExportFormat format;
+  std::string folder;
+  std::string appendBase;
+  std::string archivePath;
+  std::ofstream archive;
+
+  int maxPending;
+  std::deque<DocumentSet> pending;
+  std::mutex mtx;
+  std::condition_variable pendingCv;
+  std::condition_variable spaceCv;
+  std::thread writer;
+  bool readersDone;
+  std::atomic<bool> started;
+
+  std::atomic<long> written;
+  std::atomic<long> failed;
+};
+
+
+
+DocumentBatchExporter::DocumentBatchExporter(IConnection* conn) : mImpl(mlclient::make_unique<Impl>(conn)) {
+  ;
+}
+
+DocumentBatchExporter::~DocumentBatchExporter() {
+  ;
+}
+
+void DocumentBatchExporter::setQuery(const SearchDescription& desc) {
+  mImpl->batcher.setQuery(desc);
+}
+
+void DocumentBatchExporter::setCollection(const std::string& collection) {
+  mImpl->batcher.setCollection(collection);
+}
+
+void DocumentBatchExporter::setDirectoryTarget(const std::string& folder,const std::string& appendBase) {
+  mImpl->format = ExportFormat::DIRECTORY;
+  mImpl->folder = folder;
+  mImpl->appendBase = appendBase;
+}
+
+void DocumentBatchExporter::setArchiveTarget(const std::string& archive) {
+  mImpl->format = ExportFormat::ARCHIVE;
+  mImpl->archivePath = archive;
+}
+
+const ExportFormat DocumentBatchExporter::getFormat() const {
+  return mImpl->format;
+}
+
+void DocumentBatchExporter::setBatchParameters(const int parallelTasks,const int batchSize,const int maxRetries) {
+  mImpl->batcher.setBatchParameters(parallelTasks,batchSize,maxRetries);
+}
+
+void DocumentBatchExporter::setMaxPendingBatches(const int maxPending) {
+  mImpl->maxPending = (maxPending < 1 ? 1 : maxPending);
+}
+
+const int DocumentBatchExporter::getMaxPendingBatches() const {
+  return mImpl->maxPending;
+}
+
+void DocumentBatchExporter::send() {
+  TIMED_FUNC(DocumentBatchExporter_send);
+  mImpl->start();
+}
+
+void DocumentBatchExporter::stop() {
+  mImpl->batcher.stop();
+}
+
+void DocumentBatchExporter::wait() {
+  mImpl->finish();
+}
+
+const bool DocumentBatchExporter::isFinished() const {
+  return !mImpl->started && mImpl->batcher.isFinished();
+}
+
+const long DocumentBatchExporter::getWrittenDocuments() const {
+  return mImpl->written;
+}
+
+const long DocumentBatchExporter::getFailedDocuments() const {
+  return mImpl->failed;
+}
+
+const Progress DocumentBatchExporter::getProgress() const {
+  return mImpl->batcher.getProgress();
+}
+
+long DocumentBatchExporter::readArchive(const std::string& archive,DocumentSet& addTo) {
+  TIMED_FUNC(DocumentBatchExporter_readArchive);
+  std::ifstream in(archive.c_str(),std::ios::in | std::ios::binary);
+  if (!in.is_open()) {
+    throw std::runtime_error("Could not open archive file for reading: " + archive);
+  }
+  long count = 0;
+  uint64_t len = 0;
+  while (std::char_traits<char>::eof() != in.peek()) {
+    std::string uri;
+    std::string mime;
+    std::string data;
+    bool ok = readLength(in,len,4) && readBytes(in,len,uri);
+    ok = ok && readLength(in,len,4) && readBytes(in,len,mime);
+    ok = ok && readLength(in,len,8) && readBytes(in,len,data);
+    if (!ok) {
+      throw std::runtime_error("Truncated record in archive file: " + archive);
+    }
+    GenericTextDocumentContent* content = new GenericTextDocumentContent;
+    content->setMimeType(mime);
+    content->setContent(std::move(data));
+    addTo.push_back(Document(uri,content));
+    ++count;
+  }
+  return count;
+}
+
+} // end namespace utilities
+
+} // end namespace mlclient
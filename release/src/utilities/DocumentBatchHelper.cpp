@@ -144,5 +144,31 @@ void DocumentBatchHelper::addFilesToDocumentSet(const std::string& folder,const
   }
 }
 
+std::string DocumentBatchHelper::uriToFilePath(const std::string& uri,const std::string& folder,const std::string& appendBase) {
+  std::string rel(uri);
+  if (!appendBase.empty() && 0 == uri.compare(0,appendBase.length(),appendBase)) {
+    rel = uri.substr(appendBase.length());
+  }
+  // addFilesToDocumentSet always adds a '/' after the relative folder, even when that folder is blank
+  std::string path(folder);
+  std::string::size_type pos = 0;
+  while (pos <= rel.length()) {
+    std::string::size_type next = rel.find('/',pos);
+    if (std::string::npos == next) {
+      next = rel.length();
+    }
+    std::string segment(rel.substr(pos,next - pos));
+    if (".." == segment) {
+      LOG(DEBUG) << "Refusing to map URI with a '..' segment to a file path: " << uri;
+      return "";
+    }
+    if (!segment.empty() && "." != segment) {
+      path += "/" + segment; // TODO platform independent file separator
+    }
+    pos = next + 1;
+  }
+  return path;
+}
+
 } // end namespace utilities
 } // end namespace mlclient
@@ -22,6 +22,10 @@
 #include <map>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace mlclient {
 
@@ -31,16 +35,257 @@ IBatchNotifiable::~IBatchNotifiable() {
   ;
 }
 
-static DocumentSet emptyDocumentSet;
+void IBatchNotifiable::batchOperationComplete(const DocumentUriSet out_uris,bool success,std::exception problem) {
+  ;
+}
+
+void IBatchNotifiable::batchEventComplete(const BatchEvent& event) {
+  if (event.isSuccess() || !event.getProblem()) {
+    batchOperationComplete(event.getUris(),event.isSuccess(),std::exception());
+    return;
+  }
+  try {
+    std::rethrow_exception(event.getProblem());
+  } catch (std::exception& ex) {
+    batchOperationComplete(event.getUris(),false,ex);
+  } catch (...) {
+    batchOperationComplete(event.getUris(),false,std::exception());
+  }
+}
+
+
+
+BatchEvent::BatchEvent() : sequence(0), uris(), success(true), problem(), message() {
+  ;
+}
+
+BatchEvent::BatchEvent(long seq,DocumentUriSet&& u,bool ok,std::exception_ptr prob) : sequence(seq), uris(std::move(u)),
+    success(ok), problem(prob), message() {
+  if (problem) {
+    try {
+      std::rethrow_exception(problem);
+    } catch (std::exception& ex) {
+      message = ex.what();
+    } catch (...) {
+      message = "Unknown exception";
+    }
+  }
+}
+
+BatchEvent::BatchEvent(BatchEvent&& other) : sequence(other.sequence), uris(std::move(other.uris)),
+    success(other.success), problem(std::move(other.problem)), message(std::move(other.message)) {
+  ;
+}
+
+BatchEvent& BatchEvent::operator=(BatchEvent&& other) {
+  sequence = other.sequence;
+  uris = std::move(other.uris);
+  success = other.success;
+  problem = std::move(other.problem);
+  message = std::move(other.message);
+  return *this;
+}
+
+long BatchEvent::getSequence() const {
+  return sequence;
+}
+
+const DocumentUriSet& BatchEvent::getUris() const {
+  return uris;
+}
+
+bool BatchEvent::isSuccess() const {
+  return success;
+}
+
+std::exception_ptr BatchEvent::getProblem() const {
+  return problem;
+}
+
+const std::string& BatchEvent::getMessage() const {
+  return message;
+}
+
+
+
+/**
+ * \brief Internal class. Delivers BatchEvents to listeners on its own thread, from a bounded queue.
+ *
+ * Pending events are keyed by batch sequence in ORDERED mode, and by arrival in UNORDERED mode. In ORDERED
+ * mode the next expected batch is always admitted even if the queue is full, so a full queue of later
+ * batches can never stall delivery.
+ */
+class BatchNotifier {
+public:
+  BatchNotifier(std::vector<IBatchNotifiable*>& listeners,std::mutex& listenersMtx) : toNotify(listeners),
+      toNotifyMtx(listenersMtx), capacity(64), mode(NotificationMode::UNORDERED), pending(), nextSequence(0),
+      arrivals(0), pushed(0), delivered(0), stopping(false), worker() {
+    ;
+  }
+
+  ~BatchNotifier() {
+    shutdown();
+  }
+
+  void configure(long queueSize,NotificationMode newMode) {
+    std::unique_lock<std::mutex> lck(mtx);
+    capacity = (queueSize < 1 ? 1 : queueSize);
+    mode = newMode;
+  }
+
+  void start() {
+    std::unique_lock<std::mutex> lck(mtx);
+    if (worker.joinable()) {
+      return;
+    }
+    pending.clear();
+    nextSequence = 0;
+    arrivals = 0;
+    pushed = 0;
+    delivered = 0;
+    stopping = false;
+    worker = std::thread(&BatchNotifier::run,this);
+  }
+
+  /**
+   * Called by upload tasks. Only waits for queue space, never for a listener call.
+   */
+  void push(BatchEvent&& event) {
+    std::unique_lock<std::mutex> lck(mtx);
+    long seq = event.getSequence();
+    notFull.wait(lck,[this,seq] () {
+      return stopping || pending.size() < (size_t)capacity ||
+          (NotificationMode::ORDERED == mode && seq == nextSequence);
+    });
+    long key = (NotificationMode::ORDERED == mode ? seq : arrivals++);
+    pending.insert(std::make_pair(key,std::move(event)));
+    ++pushed;
+    notEmpty.notify_one();
+  }
+
+  /**
+   * Waits until every event pushed so far has been delivered
+   */
+  void drain() {
+    std::unique_lock<std::mutex> lck(mtx);
+    if (!worker.joinable()) {
+      return;
+    }
+    allDelivered.wait(lck,[this] () {
+      return delivered == pushed;
+    });
+  }
+
+  /**
+   * Delivers all remaining events, in key order, then stops the thread
+   */
+  void shutdown() {
+    {
+      std::unique_lock<std::mutex> lck(mtx);
+      if (!worker.joinable()) {
+        return;
+      }
+      stopping = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+    worker.join();
+  }
+
+private:
+  bool deliverable() const {
+    if (pending.empty()) {
+      return false;
+    }
+    return stopping || NotificationMode::UNORDERED == mode || pending.begin()->first == nextSequence;
+  }
+
+  void run() {
+    LOG(DEBUG) << "Batch notifier thread started";
+    std::unique_lock<std::mutex> lck(mtx);
+    while (true) {
+      notEmpty.wait(lck,[this] () {
+        return stopping || deliverable();
+      });
+      if (!deliverable()) {
+        break; // stopping and nothing left
+      }
+      BatchEvent event(std::move(pending.begin()->second));
+      pending.erase(pending.begin());
+      if (NotificationMode::ORDERED == mode) {
+        nextSequence = event.getSequence() + 1;
+      }
+      notFull.notify_all();
+      lck.unlock();
+
+      std::vector<IBatchNotifiable*> listeners;
+      {
+        std::unique_lock<std::mutex> listenersLck(toNotifyMtx);
+        listeners = toNotify; // pointers only
+      }
+      for (auto& tell: listeners) {
+        try {
+          tell->batchEventComplete(event);
+        } catch (std::exception& ex) {
+          LOG(DEBUG) << "Exception thrown by batch listener: " << ex.what();
+        } catch (...) {
+          LOG(DEBUG) << "Unknown exception thrown by batch listener";
+        }
+      }
+
+      lck.lock();
+      ++delivered;
+      allDelivered.notify_all();
+    }
+    LOG(DEBUG) << "Batch notifier thread stopped";
+  }
+
+  std::vector<IBatchNotifiable*>& toNotify;
+  std::mutex& toNotifyMtx;
+
+  long capacity;
+  NotificationMode mode;
+  std::map<long,BatchEvent> pending;
+  long nextSequence;
+  long arrivals;
+  long pushed;
+  long delivered;
+  bool stopping;
+
+  std::mutex mtx;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+  std::condition_variable allDelivered;
+  std::thread worker;
+};
+
+
+
+/**
+ * \brief Internal struct. A contiguous range of the DocumentSet, the connection it is written through,
+ * and the forest it is written to (empty to let the server choose)
+ */
+struct Batch {
+  long startIdx;
+  long endIdx;
+  IConnection* conn;
+  std::string forest;
+};
 
 class DocumentBatchWriter::Impl {
 public:
-  Impl(IConnection* conn) : mConn(conn), set(emptyDocumentSet), parallelTasks(5),batchSize(10),
-      mode(TransactionMode::PER_BATCH),toNotify(),complete(false),cancelled(false),finished(true),
-      overall(),latest(), completeUris(), tasks(), startTime(1) {
+  Impl(IConnection* conn) : mConn(conn), set(), parallelTasks(5),batchSize(10),
+      mode(TransactionMode::PER_BATCH),assignmentMode(AssignmentMode::SINGLE_HOST),topology(nullptr),
+      hostProvider(nullptr),batches(),toNotify(),toNotifyMtx(),notifier(toNotify,toNotifyMtx),
+      notificationQueueSize(64),notificationMode(NotificationMode::UNORDERED),complete(false),
+      cancelled(false),finished(true),overall(),latest(), completeUris(), progressMtx(), tasks(), startTime(1) {
     ;
   }
 
+  ~Impl() {
+    notifier.shutdown();
+  }
+
   // TODO destructor that destroys all task pointers (delete) in vector
 
   long now() {
@@ -111,69 +356,68 @@ public:
     startTime = now();
     calculateProgress(); // initialises correct values for 'complete' in 'overall' progress struct
 
+    notifier.start();
+
+    planBatches();
+
     // start parallelTasks
 
     Impl& refImpl(*this);
 
-    long maxIterations = (long)ceil(set.size() / parallelTasks) + 1; // horrible hack for 0 being returned
+    long maxIterations = (batches.size() + parallelTasks - 1) / parallelTasks;
     LOG(DEBUG) << "Max iterations: " << maxIterations;
 
-    LOG(DEBUG) << "Creating tasks to write " << set.size() << " Documents";
+    LOG(DEBUG) << "Creating tasks to write " << set.size() << " Documents in " << batches.size() << " batches";
 
     //pplx::task<void>* fetchTask;
     for (long i = 0;i < parallelTasks;i++) {
       LOG(DEBUG) << "parallelTasks index: " << i;
-      pplx::task<void>* fetchTask = new pplx::task<void>([&refImpl,i,&maxIterations] () {
+      pplx::task<void>* fetchTask = new pplx::task<void>([&refImpl,i,maxIterations] () {
         long myi = i;
 
         LOG(DEBUG) << "Began document batch writer task... " << myi;
         for (long j = 0;j < maxIterations;j++) {
-          // calculate segment start and finish
-          long startIdx = ((j * refImpl.parallelTasks) + myi) * refImpl.batchSize;
-          long endIdx = startIdx + refImpl.batchSize - 1;
+          long sequence = (j * refImpl.parallelTasks) + myi;
 
-          if (startIdx >= refImpl.set.size()) {
-            LOG(DEBUG) << "Start index is out of range: " << startIdx;
+          if (sequence >= (long)refImpl.batches.size()) {
+            LOG(DEBUG) << "Batch is out of range: " << sequence;
             j = maxIterations;
           } else {
-            LOG(DEBUG) << "Start index is in range: " << startIdx;
-            if (endIdx >= refImpl.set.size()) {
-              LOG(DEBUG) << "End index is out of range: " << endIdx;
-              // must be on last part of set
-              endIdx = refImpl.set.size() - 1;
-              LOG(DEBUG) << "End index now: " << endIdx;
-            }
+            const Batch& batch = refImpl.batches.at(sequence);
+            long startIdx = batch.startIdx;
+            long endIdx = batch.endIdx;
             LOG(DEBUG) << "Batch writer thread " << myi << " writing documents from index " << startIdx << " to " << endIdx;
 
             try {
               LOG(DEBUG) << "In try";
 
-
-              // sanity check values for this set
-
-              Response* resp = refImpl.mConn->saveDocuments(refImpl.set,startIdx,endIdx);
+              Response* resp;
+              if (batch.forest.empty()) {
+                resp = batch.conn->saveDocuments(refImpl.set,startIdx,endIdx);
+              } else {
+                resp = batch.conn->saveDocumentsToForest(refImpl.set,startIdx,endIdx,batch.forest);
+              }
               LOG(DEBUG) << "Got response";
 
               // update complete
               DocumentUriSet myUris;
-              for (long idx = startIdx; idx <= endIdx;idx++) {
-                std::string uri = refImpl.set.at(idx).getUri();
-                refImpl.completeUris.push_back(uri);
-                myUris.push_back(uri);
+              {
+                std::unique_lock<std::mutex> lck(refImpl.progressMtx);
+                for (long idx = startIdx; idx <= endIdx;idx++) {
+                  std::string uri = refImpl.set.at(idx).getUri();
+                  refImpl.completeUris.push_back(uri);
+                  myUris.push_back(uri);
+                }
+                refImpl.checkComplete();
               }
-              refImpl.checkComplete();
 
-              // check ok and notify
+              // check ok and queue notification (listeners are called on the notifier thread)
               if (ResponseHelper::isInError(*resp)) {
-                InvalidFormatException exc(ResponseHelper::getErrorDetailAsString(*resp)); // TODO better exception wrapper
-                for (auto& tell: refImpl.toNotify) {
-                  tell->batchOperationComplete(myUris,false,exc);
-                }
+                // TODO better exception wrapper
+                refImpl.notifier.push(BatchEvent(sequence,std::move(myUris),false,
+                    std::make_exception_ptr(InvalidFormatException(ResponseHelper::getErrorDetailAsString(*resp)))));
               } else {
-                for (auto& tell: refImpl.toNotify) {
-                  std::exception blank;
-                  tell->batchOperationComplete(myUris,true,blank);
-                }
+                refImpl.notifier.push(BatchEvent(sequence,std::move(myUris),true,std::exception_ptr()));
               }
 
               LOG(DEBUG) << "Deleting response";
@@ -182,14 +426,11 @@ public:
             } catch (std::exception& ref) {
               LOG(DEBUG) << "Exception in batch document upload task: " << ref.what();
 
-              std::vector<std::string> myUris;
+              DocumentUriSet myUris;
               for (long idx = startIdx; idx <= endIdx;idx++) {
-                std::string uri = refImpl.set.at(idx).getUri();
-                myUris.push_back(uri);
-              }
-              for (auto& tell: refImpl.toNotify) {
-                tell->batchOperationComplete(myUris,false,ref);
+                myUris.push_back(refImpl.set.at(idx).getUri());
               }
+              refImpl.notifier.push(BatchEvent(sequence,std::move(myUris),false,std::current_exception()));
             }
 
           } // end if out of bounds
@@ -201,24 +442,105 @@ public:
       LOG(DEBUG) << "adding task";
       refImpl.tasks.insert(std::make_pair(i,fetchTask)); // end task initialisation
 
-      //if (0 == i) {
-      //  fetchTask->wait(); // WAIT for the first one...
-      //}
-
     } // end loop
     LOG(DEBUG) << "Tasks initialised";
   }
 
+  /**
+   * Splits the DocumentSet in to batches, each with the connection it is sent through
+   */
+  void planBatches() {
+    batches.clear();
+    if (AssignmentMode::HOST_AFFINITY == assignmentMode && nullptr != topology && nullptr != hostProvider) {
+      try {
+        planHostBatches();
+        return;
+      } catch (std::exception& ex) {
+        LOG(DEBUG) << "Could not read forest topology, sending all batches to the default host: " << ex.what();
+        batches.clear();
+      }
+    }
+    for (long startIdx = 0;startIdx < (long)set.size();startIdx += batchSize) {
+      long endIdx = startIdx + batchSize - 1;
+      if (endIdx >= (long)set.size()) {
+        endIdx = set.size() - 1;
+      }
+      batches.push_back(Batch{startIdx,endIdx,mConn,std::string()});
+    }
+  }
+
+  void planHostBatches() {
+    const ForestList& forests = topology->getForests(); // fetched once by the topology
+    if (forests.empty()) {
+      throw InvalidFormatException("Forest topology lists no forests");
+    }
+
+    // group document positions by their assigned forest
+    std::vector<std::vector<size_t>> byForest(forests.size());
+    for (size_t idx = 0;idx < set.size();idx++) {
+      byForest.at(topology->assignForest(set[idx].getUri()) % forests.size()).push_back(idx);
+    }
+
+    // make each forest's documents contiguous in the set, moving rather than copying them
+    std::vector<long> forestStart(forests.size());
+    DocumentSet ordered;
+    ordered.reserve(set.size());
+    for (size_t f = 0;f < forests.size();f++) {
+      forestStart[f] = ordered.size();
+      for (auto idx : byForest[f]) {
+        ordered.push_back(std::move(set[idx]));
+      }
+    }
+    set = std::move(ordered);
+
+    // one connection per host, shared by all of that host's forests
+    std::map<std::string,IConnection*> hostConns;
+    for (auto& forest : forests) {
+      if (hostConns.end() == hostConns.find(forest.host)) {
+        IConnection* conn = hostProvider->getConnection(forest.host);
+        hostConns.insert(std::make_pair(forest.host,nullptr == conn ? mConn : conn));
+      }
+    }
+
+    // interleave batches across forests, so parallel tasks spread load over the cluster
+    bool more = true;
+    for (long round = 0;more;round++) {
+      more = false;
+      for (size_t f = 0;f < forests.size();f++) {
+        long startIdx = forestStart[f] + (round * batchSize);
+        long forestEnd = forestStart[f] + byForest[f].size() - 1;
+        if (startIdx <= forestEnd) {
+          long endIdx = startIdx + batchSize - 1;
+          if (endIdx > forestEnd) {
+            endIdx = forestEnd;
+          }
+          batches.push_back(Batch{startIdx,endIdx,hostConns[forests[f].host],forests[f].name});
+          more = true;
+        }
+      }
+    }
+    LOG(DEBUG) << "Planned " << batches.size() << " batches over " << forests.size() << " forests on "
+               << hostConns.size() << " hosts";
+  }
+
   void stop() {
     cancelled = true;
   }
 
   IConnection* mConn;
-  DocumentSet& set;
+  DocumentSet set;
   int parallelTasks;
   int batchSize;
   TransactionMode mode;
+  AssignmentMode assignmentMode;
+  IForestTopology* topology;
+  IHostConnectionProvider* hostProvider;
+  std::vector<Batch> batches;
   std::vector<IBatchNotifiable*> toNotify;
+  std::mutex toNotifyMtx;
+  BatchNotifier notifier;
+  long notificationQueueSize;
+  NotificationMode notificationMode;
 
   bool complete;
   bool cancelled;
@@ -228,6 +550,7 @@ public:
   Progress latest;
 
   std::vector<std::string> completeUris; // includes failed URIs
+  std::mutex progressMtx;
 
   std::map<long,pplx::task<void>*> tasks;
 
@@ -266,11 +589,36 @@ const TransactionMode DocumentBatchWriter::getMode() const {
   return mImpl->mode;
 }
 
+void DocumentBatchWriter::setAssignmentParameters(const AssignmentMode& mode,IForestTopology* topology,
+    IHostConnectionProvider* provider) {
+  mImpl->assignmentMode = mode;
+  mImpl->topology = topology;
+  mImpl->hostProvider = provider;
+}
+const AssignmentMode DocumentBatchWriter::getAssignmentMode() const {
+  return mImpl->assignmentMode;
+}
+
 void DocumentBatchWriter::addBatchListener(IBatchNotifiable* notifiable) {
+  std::unique_lock<std::mutex> lck(mImpl->toNotifyMtx);
   mImpl->toNotify.push_back(notifiable);
 }
 void DocumentBatchWriter::removeBatchListener(IBatchNotifiable* notifiable) {
-  //mImpl->toNotify.erase(notifiable);
+  // NB an event being delivered at the time of this call may still reach notifiable
+  std::unique_lock<std::mutex> lck(mImpl->toNotifyMtx);
+  mImpl->toNotify.erase(std::remove(mImpl->toNotify.begin(),mImpl->toNotify.end(),notifiable),mImpl->toNotify.end());
+}
+
+void DocumentBatchWriter::setNotificationParameters(const long queueSize,const NotificationMode& mode) {
+  mImpl->notificationQueueSize = queueSize;
+  mImpl->notificationMode = mode;
+  mImpl->notifier.configure(queueSize,mode);
+}
+const long DocumentBatchWriter::getNotificationQueueSize() const {
+  return mImpl->notificationQueueSize;
+}
+const NotificationMode DocumentBatchWriter::getNotificationMode() const {
+  return mImpl->notificationMode;
 }
 
 void DocumentBatchWriter::send() {
@@ -286,9 +634,11 @@ void DocumentBatchWriter::wait() const {
       taskIter->second->wait();
     }
   }
+  mImpl->notifier.drain();
 }
 
 const bool DocumentBatchWriter::isComplete() const {
+  std::unique_lock<std::mutex> lck(mImpl->progressMtx);
   mImpl->checkComplete();
   return mImpl->complete;
 }
@@ -12,14 +12,44 @@
 #include <mlclient/DocumentContent.hpp>
 #include <mlclient/InvalidFormatException.hpp>
 #include <mlclient/utilities/CppRestJsonHelper.hpp>
+#include <mlclient/utilities/NativeJsonDocumentContent.hpp>
 #include <mlclient/utilities/PugiXmlHelper.hpp>
 #include <mlclient/logging.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <memory>
+
 namespace mlclient {
 
 namespace utilities {
 
-// TODO handle multi-part mixed responses
+static std::atomic<int> jsonBackend((int)JsonBackend::CPPREST);
+
+/**
+ * Parses JSON with the native backend, taking ownership of the text
+ */
+static IDocumentContent* nativeJsonFrom(std::string&& text) {
+  NativeJsonDocumentContent* dc = new NativeJsonDocumentContent;
+  dc->setMimeType(IDocumentContent::MIME_JSON);
+  try {
+    dc->setContent(std::move(text));
+  } catch (...) {
+    delete dc;
+    throw;
+  }
+  return dc;
+}
+
+void DocumentHelper::setJsonBackend(const JsonBackend backend) {
+  jsonBackend = (int)backend;
+}
+
+JsonBackend DocumentHelper::getJsonBackend() {
+  return (JsonBackend)jsonBackend.load();
+}
 
 Document* DocumentHelper::fromResponse(const Response& resp) {
   LOG(DEBUG) << "DocumentHelper::fromResponse(Response&)";
@@ -45,6 +75,9 @@ IDocumentContent* DocumentHelper::contentFromResponse(const Response& resp) {
     return PugiXmlHelper::toDocument(resp);
   } else if (resp.getResponseType() == ResponseType::JSON) {
     LOG(DEBUG) << "DocumentHelper::contentFromResponse: JSON";
+    if (JsonBackend::NATIVE == getJsonBackend()) {
+      return nativeJsonFrom(std::string(resp.getContent()));
+    }
     return CppRestJsonHelper::toDocument(resp);
   } else if (resp.getResponseType() == ResponseType::TEXT) {
     LOG(DEBUG) << "DocumentHelper::contentFromResponse: Text";
@@ -59,6 +92,141 @@ IDocumentContent* DocumentHelper::contentFromResponse(const Response& resp) {
   }
 }
 
+IDocumentContent* DocumentHelper::takeContentFromResponse(Response& resp) {
+  LOG(DEBUG) << "DocumentHelper::takeContentFromResponse";
+  if (resp.getResponseType() == ResponseType::XML) {
+    return PugiXmlHelper::toDocumentInPlace(resp);
+  } else if (resp.getResponseType() == ResponseType::TEXT) {
+    GenericTextDocumentContent* dc = new GenericTextDocumentContent();
+    dc->setMimeType(resp.getResponseHeaders().getHeader("Content-type"));
+    dc->setContent(resp.releaseContent());
+    return dc;
+  } else if (resp.getResponseType() == ResponseType::JSON && JsonBackend::NATIVE == getJsonBackend()) {
+    return nativeJsonFrom(resp.releaseContent()); // strings are unescaped in place within the body
+  }
+  return contentFromResponse(resp); // cpprest JSON is parsed in to its own values, so gains nothing
+}
+
+/**
+ * Case insensitive comparison of a header name
+ */
+static bool headerNameIs(const std::string& line,const size_t nameEnd,const std::string& name) {
+  if (nameEnd != name.size()) {
+    return false;
+  }
+  for (size_t i = 0;i < nameEnd;i++) {
+    if (std::tolower((unsigned char)line[i]) != std::tolower((unsigned char)name[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns the value of a parameter (E.g. boundary or filename) within a header value, without quotes
+ */
+static std::string headerParameter(const std::string& value,const std::string& param) {
+  size_t pos = value.find(param + "=");
+  if (std::string::npos == pos) {
+    return "";
+  }
+  pos += param.size() + 1;
+  if (pos < value.size() && '"' == value[pos]) {
+    size_t end = value.find('"',pos + 1);
+    return value.substr(pos + 1,(std::string::npos == end ? value.size() : end) - pos - 1);
+  }
+  size_t end = value.find_first_of("; \r\n",pos);
+  return value.substr(pos,(std::string::npos == end ? value.size() : end) - pos);
+}
+
+long DocumentHelper::fromMultipartResponse(const Response& resp,DocumentSet& out) {
+  TIMED_FUNC(DocumentHelper_fromMultipartResponse);
+  HttpHeaders headers(resp.getResponseHeaders());
+  std::string contentType = headers.getHeader("Content-Type");
+  if (contentType.empty()) {
+    contentType = headers.getHeader("Content-type");
+  }
+  const std::string boundaryName = headerParameter(contentType,"boundary");
+  if (boundaryName.empty()) {
+    throw InvalidFormatException("Response is not multipart, or has no boundary: " + contentType);
+  }
+  const std::string boundary = "--" + boundaryName;
+  const std::string& body = resp.getContent();
+
+  long count = 0;
+  size_t pos = body.find(boundary);
+  while (std::string::npos != pos) {
+    pos += boundary.size();
+    if (0 == body.compare(pos,2,"--")) {
+      break; // closing boundary
+    }
+    pos = body.find("\r\n",pos);
+    if (std::string::npos == pos) {
+      break;
+    }
+    pos += 2;
+
+    // part headers
+    size_t headersEnd = body.find("\r\n\r\n",pos);
+    if (std::string::npos == headersEnd) {
+      throw InvalidFormatException("Multipart response part has no header terminator");
+    }
+    std::string uri;
+    std::string mimeType;
+    long length = -1;
+    while (pos < headersEnd) {
+      size_t lineEnd = body.find("\r\n",pos);
+      if (lineEnd > headersEnd) {
+        lineEnd = headersEnd;
+      }
+      const std::string line = body.substr(pos,lineEnd - pos);
+      size_t colon = line.find(':');
+      if (std::string::npos != colon) {
+        size_t valueStart = line.find_first_not_of(' ',colon + 1);
+        const std::string value = (std::string::npos == valueStart ? "" : line.substr(valueStart));
+        if (headerNameIs(line,colon,"Content-Type")) {
+          mimeType = value.substr(0,value.find(';'));
+        } else if (headerNameIs(line,colon,"Content-Disposition")) {
+          uri = headerParameter(value,"filename");
+        } else if (headerNameIs(line,colon,"Content-Length")) {
+          length = std::atol(value.c_str());
+        }
+      }
+      pos = lineEnd + 2;
+    }
+
+    // part body
+    size_t contentStart = headersEnd + 4;
+    size_t next;
+    size_t contentEnd;
+    if (length >= 0 && contentStart + length <= body.size()) {
+      contentEnd = contentStart + length;
+      next = body.find(boundary,contentEnd);
+    } else {
+      next = body.find("\r\n" + boundary,contentStart);
+      contentEnd = (std::string::npos == next ? body.size() : next);
+    }
+
+    GenericTextDocumentContent* content = new GenericTextDocumentContent;
+    content->setMimeType(mimeType);
+    content->setContent(body.substr(contentStart,contentEnd - contentStart));
+    out.push_back(Document(uri,content));
+    ++count;
+
+    pos = next;
+  }
+  LOG(DEBUG) << "DocumentHelper::fromMultipartResponse: parts: " << count;
+  return count;
+}
+
+std::shared_ptr<IDocumentNode> DocumentHelper::objectOf(IDocumentNode* own_node) {
+  std::unique_ptr<IDocumentNode> owned(own_node);
+  IDocumentNode* object = owned->asObject();
+  if (object == owned.get()) {
+    owned.release();
+  }
+  return std::shared_ptr<IDocumentNode>(object);
+}
 
 } // end utilities namespace
 
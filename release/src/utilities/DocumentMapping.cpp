@@ -0,0 +1,514 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file DocumentMapping.cpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ */
+
+#include <mlclient/utilities/DocumentMapping.hpp>
+#include <mlclient/utilities/JsonEventParser.hpp>
+#include <mlclient/InvalidFormatException.hpp>
+#include <mlclient/logging.hpp>
+#include "mlclient/ext/pugixml/pugixml.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mlclient {
+
+namespace utilities {
+
+namespace {
+
+const size_t NO_FIELD = (size_t)-1;
+const size_t NO_STEP = (size_t)-1;
+
+/**
+ * One step of the tree of field paths. Step 0 is the JSON root object or XML root element.
+ */
+struct Step {
+  Step(const std::string& n) : name(n), field(NO_FIELD), children() {
+    ;
+  }
+
+  std::string name;
+  size_t field;
+  std::vector<size_t> children;
+};
+
+/**
+ * Returns whether a document's name matches a step's name, ignoring any prefix up to a colon
+ */
+bool nameMatches(const char* name,const size_t length,const std::string& stepName) {
+  const char* colon = (const char*)std::memchr(name,':',length);
+  if (nullptr != colon) {
+    return stepName.length() == (size_t)(name + length - colon - 1) &&
+        0 == std::memcmp(colon + 1,stepName.data(),stepName.length());
+  }
+  return stepName.length() == length && 0 == std::memcmp(name,stepName.data(),length);
+}
+
+size_t childStep(const std::vector<Step>& steps,const size_t parent,const char* name,const size_t length) {
+  for (size_t child : steps[parent].children) {
+    if (nameMatches(name,length,steps[child].name)) {
+      return child;
+    }
+  }
+  return NO_STEP;
+}
+
+/**
+ * Follows the tree of steps through the parser's events, passing scalars at a field's path to the fields.
+ * Containers that no field's path passes through are skipped by the parser, without reporting or copying their contents.
+ */
+class JsonReader : public IJsonEventHandler {
+public:
+  JsonReader(const std::vector<Step>& s,IMappedFields& f) : steps(s), fields(f), parser(nullptr), stack(),
+    inArray(), pending(NO_STEP) {
+    ;
+  }
+
+  void setParser(JsonEventParser& p) {
+    parser = &p;
+  }
+
+  void onStartObject() override {
+    const size_t step = valueStep();
+    if (NO_STEP == step || steps[step].children.empty()) {
+      parser->skipValue();
+      return;
+    }
+    stack.push_back(step);
+    inArray.push_back(false);
+  }
+
+  void onEndObject() override {
+    stack.pop_back();
+    inArray.pop_back();
+  }
+
+  void onStartArray() override {
+    const size_t step = valueStep();
+    if (NO_STEP == step || (steps[step].children.empty() && NO_FIELD == steps[step].field)) {
+      parser->skipValue();
+      return;
+    }
+    // members are at the array's own step, so E.g. each object of an array of objects is read alike
+    stack.push_back(step);
+    inArray.push_back(true);
+  }
+
+  void onEndArray() override {
+    stack.pop_back();
+    inArray.pop_back();
+  }
+
+  void onKey(const std::string& key) override {
+    pending = childStep(steps,stack.back(),key.c_str(),key.length());
+  }
+
+  void onString(const std::string& value) override {
+    scalar(MappedValueType::STRING,value);
+  }
+
+  void onNumber(const std::string& text) override {
+    scalar(MappedValueType::NUMBER,text);
+  }
+
+  void onBoolean(const bool value) override {
+    static const std::string TRUE_TEXT("true");
+    static const std::string FALSE_TEXT("false");
+    scalar(MappedValueType::BOOLEAN,value ? TRUE_TEXT : FALSE_TEXT);
+  }
+
+  void onNull() override {
+    static const std::string EMPTY;
+    scalar(MappedValueType::NUL,EMPTY);
+  }
+
+private:
+  /**
+   * Returns the step of the value just started, consuming the key it follows if any
+   */
+  size_t valueStep() {
+    if (stack.empty()) {
+      return 0;
+    }
+    if (inArray.back()) {
+      return stack.back();
+    }
+    const size_t step = pending;
+    pending = NO_STEP;
+    return step;
+  }
+
+  void scalar(const MappedValueType type,const std::string& text) {
+    const size_t step = valueStep();
+    if (NO_STEP != step && NO_FIELD != steps[step].field) {
+      fields.read(steps[step].field,type,text);
+    }
+  }
+
+  const std::vector<Step>& steps;
+  IMappedFields& fields;
+  JsonEventParser* parser;
+  std::vector<size_t> stack;
+  std::vector<bool> inArray;
+  size_t pending;
+};
+
+void readXmlElement(const std::vector<Step>& steps,const size_t step,const pugi::xml_node& element,
+    IMappedFields& fields,std::string& text) {
+  for (pugi::xml_attribute attr = element.first_attribute();attr;attr = attr.next_attribute()) {
+    const size_t child = childStep(steps,step,attr.name(),std::strlen(attr.name()));
+    if (NO_STEP != child && NO_FIELD != steps[child].field) {
+      text.assign(attr.value());
+      fields.read(steps[child].field,MappedValueType::STRING,text);
+    }
+  }
+  for (pugi::xml_node node = element.first_child();node;node = node.next_sibling()) {
+    if (pugi::node_element != node.type()) {
+      continue;
+    }
+    const size_t child = childStep(steps,step,node.name(),std::strlen(node.name()));
+    if (NO_STEP == child) {
+      continue;
+    }
+    if (NO_FIELD != steps[child].field) {
+      text.assign(node.text().get());
+      fields.read(steps[child].field,MappedValueType::STRING,text);
+    }
+    if (!steps[child].children.empty()) {
+      readXmlElement(steps,child,node,fields,text);
+    }
+  }
+}
+
+void writeJsonObject(const std::vector<Step>& steps,const size_t step,std::string& out,const IMappedFields& fields) {
+  out += '{';
+  bool first = true;
+  for (size_t child : steps[step].children) {
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    writeMappedJson(out,steps[child].name);
+    out += ':';
+    if (NO_FIELD != steps[child].field) {
+      fields.writeJson(steps[child].field,out);
+    } else {
+      writeJsonObject(steps,child,out,fields);
+    }
+  }
+  out += '}';
+}
+
+void writeXmlChildren(const std::vector<Step>& steps,const size_t step,std::string& out,const IMappedFields& fields) {
+  for (size_t child : steps[step].children) {
+    const std::string& name = steps[child].name;
+    if (NO_FIELD != steps[child].field) {
+      fields.writeXml(steps[child].field,out,name);
+    } else {
+      out += '<';
+      out += name;
+      out += '>';
+      writeXmlChildren(steps,child,out,fields);
+      out += "</";
+      out += name;
+      out += '>';
+    }
+  }
+}
+
+void appendXmlText(std::string& out,const std::string& text) {
+  for (char c : text) {
+    switch (c) {
+    case '&': out += "&amp;"; break;
+    case '<': out += "&lt;"; break;
+    case '>': out += "&gt;"; break;
+    default: out += c;
+    }
+  }
+}
+
+void appendXmlElement(std::string& out,const std::string& name,const std::string& text) {
+  out += '<';
+  out += name;
+  out += '>';
+  appendXmlText(out,text);
+  out += "</";
+  out += name;
+  out += '>';
+}
+
+long long readInteger(const MappedValueType type,const std::string& text,const long long min,const long long max) {
+  if (MappedValueType::NUL == type) {
+    return 0;
+  }
+  if (MappedValueType::BOOLEAN != type && !text.empty()) {
+    const char* start = text.c_str();
+    char* end = nullptr;
+    errno = 0;
+    const long long value = std::strtoll(start,&end,10);
+    if (0 == errno && end == start + text.length() && value >= min && value <= max) {
+      return value;
+    }
+  }
+  throw mlclient::InvalidFormatException("Mapped value '" + text + "' is not an integer in range");
+}
+
+/**
+ * Writes a double in the classic locale, so with a '.' decimal point and no grouping whatever the global locale, and
+ * with enough precision to read back the same value
+ */
+std::string formatDouble(const double value) {
+  std::ostringstream os;
+  os.imbue(std::locale::classic());
+  os << std::setprecision(17) << value;
+  return os.str();
+}
+
+} // end anonymous namespace
+
+
+
+void readMappedValue(std::string& to,const MappedValueType type,const std::string& text) {
+  to.assign(text);
+}
+
+void readMappedValue(bool& to,const MappedValueType type,const std::string& text) {
+  if (MappedValueType::NUL == type) {
+    to = false;
+  } else if ("true" == text || "1" == text) {
+    to = true;
+  } else if ("false" == text || "0" == text) {
+    to = false;
+  } else {
+    throw mlclient::InvalidFormatException("Mapped value '" + text + "' is not a boolean");
+  }
+}
+
+void readMappedValue(int32_t& to,const MappedValueType type,const std::string& text) {
+  to = (int32_t)readInteger(type,text,std::numeric_limits<int32_t>::min(),std::numeric_limits<int32_t>::max());
+}
+
+void readMappedValue(int64_t& to,const MappedValueType type,const std::string& text) {
+  to = (int64_t)readInteger(type,text,std::numeric_limits<int64_t>::min(),std::numeric_limits<int64_t>::max());
+}
+
+void readMappedValue(double& to,const MappedValueType type,const std::string& text) {
+  if (MappedValueType::NUL == type) {
+    to = 0.0;
+    return;
+  }
+  if (MappedValueType::BOOLEAN != type && !text.empty()) {
+    std::istringstream is(text);
+    is.imbue(std::locale::classic()); // a '.' decimal point, whatever the global locale
+    double value = 0.0;
+    if (is >> value && std::char_traits<char>::eof() == is.peek()) {
+      to = value;
+      return;
+    }
+  }
+  throw mlclient::InvalidFormatException("Mapped value '" + text + "' is not a number");
+}
+
+void writeMappedJson(std::string& out,const std::string& value) {
+  out += '"';
+  for (char c : value) {
+    const unsigned char uc = (unsigned char)c;
+    switch (uc) {
+    case '"': out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\b': out += "\\b"; break;
+    case '\f': out += "\\f"; break;
+    case '\n': out += "\\n"; break;
+    case '\r': out += "\\r"; break;
+    case '\t': out += "\\t"; break;
+    default:
+      if (uc < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped,sizeof(escaped),"\\u%04x",uc);
+        out += escaped;
+      } else {
+        out += c;
+      }
+    }
+  }
+  out += '"';
+}
+
+void writeMappedJson(std::string& out,const bool value) {
+  out += (value ? "true" : "false");
+}
+
+void writeMappedJson(std::string& out,const int32_t value) {
+  out += std::to_string(value);
+}
+
+void writeMappedJson(std::string& out,const int64_t value) {
+  out += std::to_string(value);
+}
+
+void writeMappedJson(std::string& out,const double value) {
+  // JSON has no representation of NaN or infinity
+  if (std::isfinite(value)) {
+    out += formatDouble(value);
+  } else {
+    out += "null";
+  }
+}
+
+void writeMappedXml(std::string& out,const std::string& name,const std::string& value) {
+  appendXmlElement(out,name,value);
+}
+
+void writeMappedXml(std::string& out,const std::string& name,const bool value) {
+  appendXmlElement(out,name,value ? "true" : "false");
+}
+
+void writeMappedXml(std::string& out,const std::string& name,const int32_t value) {
+  appendXmlElement(out,name,std::to_string(value));
+}
+
+void writeMappedXml(std::string& out,const std::string& name,const int64_t value) {
+  appendXmlElement(out,name,std::to_string(value));
+}
+
+void writeMappedXml(std::string& out,const std::string& name,const double value) {
+  appendXmlElement(out,name,formatDouble(value));
+}
+
+
+
+IMappedFields::~IMappedFields() {
+  ;
+}
+
+
+
+class MappingPlan::Impl {
+public:
+  Impl() : steps(1,Step("")), fieldCount(0) {
+    ;
+  }
+
+  std::vector<Step> steps;
+  size_t fieldCount;
+};
+
+MappingPlan::MappingPlan() : mImpl(new Impl) {
+  ;
+}
+
+MappingPlan::MappingPlan(const MappingPlan& other) : mImpl(new Impl(*other.mImpl)) {
+  ;
+}
+
+MappingPlan& MappingPlan::operator=(const MappingPlan& other) {
+  *mImpl = *other.mImpl;
+  return *this;
+}
+
+MappingPlan::~MappingPlan() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
+void MappingPlan::addPath(const std::string& path) {
+  std::vector<Step>& steps = mImpl->steps;
+  size_t step = 0;
+  size_t start = 0;
+  while (start <= path.length()) {
+    size_t location = path.find('/',start);
+    if (std::string::npos == location) {
+      location = path.length();
+    }
+    if (location > start) {
+      const std::string name = path.substr(start,location - start);
+      size_t child = NO_STEP;
+      for (size_t existing : steps[step].children) {
+        if (steps[existing].name == name) {
+          child = existing;
+          break;
+        }
+      }
+      if (NO_STEP == child) {
+        child = steps.size();
+        steps.emplace_back(name);
+        steps[step].children.push_back(child);
+      }
+      step = child;
+    }
+    start = location + 1;
+  }
+  if (0 == step || NO_FIELD != steps[step].field) {
+    throw mlclient::InvalidFormatException("Mapping path '" + path + "' is empty or already mapped");
+  }
+  steps[step].field = mImpl->fieldCount++;
+}
+
+void MappingPlan::readJson(const char* data,const size_t length,IMappedFields& fields) const {
+  TIMED_FUNC(MappingPlan_readJson);
+  JsonReader reader(mImpl->steps,fields);
+  JsonEventParser parser(reader);
+  reader.setParser(parser);
+  parser.feed(data,length);
+  parser.finish();
+}
+
+void MappingPlan::readXml(const char* data,const size_t length,IMappedFields& fields) const {
+  TIMED_FUNC(MappingPlan_readXml);
+  pugi::xml_document doc;
+  pugi::xml_parse_result result = doc.load_buffer(data,length);
+  if (!result) {
+    throw mlclient::InvalidFormatException(std::string("XML parse error at offset ") + std::to_string(result.offset) +
+        ": " + result.description());
+  }
+  const pugi::xml_node root = doc.document_element();
+  if (root) {
+    std::string text;
+    readXmlElement(mImpl->steps,0,root,fields,text);
+  }
+}
+
+void MappingPlan::writeJson(std::string& out,const IMappedFields& fields) const {
+  TIMED_FUNC(MappingPlan_writeJson);
+  writeJsonObject(mImpl->steps,0,out,fields);
+}
+
+void MappingPlan::writeXml(std::string& out,const std::string& rootElement,const IMappedFields& fields) const {
+  TIMED_FUNC(MappingPlan_writeXml);
+  out += '<';
+  out += rootElement;
+  out += '>';
+  writeXmlChildren(mImpl->steps,0,out,fields);
+  out += "</";
+  out += rootElement;
+  out += '>';
+}
+
+} // end utilities namespace
+
+} // end mlclient namespace
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file ForestTopology.cpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ */
+
+#include <mlclient/utilities/ForestTopology.hpp>
+#include <mlclient/utilities/CppRestJsonHelper.hpp>
+#include <mlclient/utilities/ResponseHelper.hpp>
+#include <mlclient/InvalidFormatException.hpp>
+#include <mlclient/Response.hpp>
+#include <mlclient/logging.hpp>
+
+// We can use the following, because cpprest is an internal API dependency
+#include <cpprest/base_uri.h>
+#include <cpprest/json.h>
+
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+namespace mlclient {
+
+namespace utilities {
+
+IForestTopology::~IForestTopology() {
+  ;
+}
+
+long IForestTopology::assignForest(const std::string& uri) {
+  const ForestList& forests = getForests();
+  if (forests.empty()) {
+    return 0;
+  }
+  // FNV-1a - stable across platforms and runs, unlike std::hash
+  uint64_t hash = 14695981039346656037ULL;
+  for (auto& c : uri) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ULL;
+  }
+  return (long)(hash % forests.size());
+}
+
+
+
+StaticForestTopology::StaticForestTopology(const ForestList& forests) : mForests(forests) {
+  ;
+}
+
+StaticForestTopology::~StaticForestTopology() {
+  ;
+}
+
+const ForestList& StaticForestTopology::getForests() {
+  return mForests;
+}
+
+
+
+class ManagementForestTopology::Impl {
+public:
+  Impl(IConnection* conn,const std::string& db) : mConn(conn), database(db), forests(), fetched(false), mtx() {
+    ;
+  }
+
+  /**
+   * Percent encodes a database or forest name for use as a Management API path step
+   */
+  static std::string encode(const std::string& name) {
+    return utility::conversions::to_utf8string(web::uri::encode_data_string(utility::conversions::to_string_t(name)));
+  }
+
+  web::json::value getJson(const std::string& path) {
+    std::unique_ptr<Response> resp(mConn->doGet(path));
+    if (ResponseCode::OK != resp->getResponseCode()) {
+      throw InvalidFormatException("Management API request failed: " + path);
+    }
+    return CppRestJsonHelper::fromResponse(*resp);
+  }
+
+  void fetch() {
+    TIMED_FUNC(ManagementForestTopology_fetch);
+    LOG(DEBUG) << "Fetching forest topology for database: " << database;
+    ForestList result;
+
+    const web::json::value db(getJson("/manage/v2/databases/" + encode(database) + "/properties?format=json"));
+    if (!db.has_field(U("forest"))) {
+      throw InvalidFormatException("Database properties do not list any forests: " + database);
+    }
+    for (auto& forestName : db.at(U("forest")).as_array()) {
+      ForestInfo info;
+      info.name = utility::conversions::to_utf8string(forestName.as_string());
+      const web::json::value forest(getJson("/manage/v2/forests/" + encode(info.name) + "/properties?format=json"));
+      info.host = utility::conversions::to_utf8string(forest.at(U("host")).as_string());
+      LOG(DEBUG) << "  Forest: " << info.name << " on host: " << info.host;
+      result.push_back(info);
+    }
+
+    forests = std::move(result);
+    fetched = true;
+  }
+
+  IConnection* mConn;
+  std::string database;
+  ForestList forests;
+  bool fetched;
+  std::mutex mtx;
+};
+
+ManagementForestTopology::ManagementForestTopology(IConnection* manageConn,const std::string& database) :
+    mImpl(new Impl(manageConn,database)) {
+  ;
+}
+
+ManagementForestTopology::~ManagementForestTopology() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
+const ForestList& ManagementForestTopology::getForests() {
+  std::unique_lock<std::mutex> lck(mImpl->mtx);
+  if (!mImpl->fetched) {
+    mImpl->fetch();
+  }
+  return mImpl->forests;
+}
+
+void ManagementForestTopology::refresh() {
+  std::unique_lock<std::mutex> lck(mImpl->mtx);
+  mImpl->fetched = false;
+}
+
+
+
+IHostConnectionProvider::~IHostConnectionProvider() {
+  ;
+}
+
+} // end namespace utilities
+
+} // end namespace mlclient
@@ -0,0 +1,509 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file JsonEventParser.cpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ */
+
+#include <mlclient/utilities/JsonEventParser.hpp>
+#include <mlclient/InvalidFormatException.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mlclient {
+
+namespace utilities {
+
+IJsonEventHandler::~IJsonEventHandler() {
+  ;
+}
+
+void IJsonEventHandler::onCapture(std::string& text) {
+  ;
+}
+
+
+
+class JsonEventParser::Impl {
+public:
+  /**
+   * What the parser accepts next, between tokens
+   */
+  enum class State {
+    VALUE, FIRST_VALUE, FIRST_KEY, KEY, COLON, NEXT, DONE
+  };
+
+  /**
+   * The token being read, which may continue in the next chunk
+   */
+  enum class Token {
+    NONE, STRING, NUMBER, LITERAL, CAPTURE
+  };
+
+  Impl(IJsonEventHandler& h) : handler(h), stack(), state(State::VALUE), token(Token::NONE), text(), isKey(false),
+    escaped(false), inString(false), depth(0), captureRequested(false), skipRequested(false), skipping(false),
+    offset(0), position(0) {
+    ;
+  }
+
+  [[noreturn]] void fail(const char* message) {
+    throw mlclient::InvalidFormatException(std::string("JSON parse error at offset ") + std::to_string(position) +
+        ": " + message);
+  }
+
+  void feed(const char* data,const size_t length) {
+    const char* p = data;
+    const char* end = data + length;
+    while (p < end) {
+      position = offset + (p - data);
+      switch (token) {
+      case Token::STRING:
+        p = continueString(p,end);
+        continue;
+      case Token::NUMBER:
+      case Token::LITERAL:
+        p = continueWord(p,end);
+        continue;
+      case Token::CAPTURE:
+        p = continueCapture(p,end);
+        continue;
+      case Token::NONE:
+        break;
+      }
+      const char c = *p;
+      if (' ' == c || '\n' == c || '\r' == c || '\t' == c) {
+        ++p;
+        continue;
+      }
+      if (State::DONE == state) {
+        fail("unexpected text after the document");
+      }
+      switch (c) {
+      case '{':
+        requireValue();
+        ++p;
+        stack.push_back('{');
+        state = State::FIRST_KEY;
+        captureRequested = false;
+        skipRequested = false;
+        handler.onStartObject();
+        beginCapture('{');
+        break;
+      case '[':
+        requireValue();
+        ++p;
+        stack.push_back('[');
+        state = State::FIRST_VALUE;
+        captureRequested = false;
+        skipRequested = false;
+        handler.onStartArray();
+        beginCapture('[');
+        break;
+      case '}':
+        if (!(State::FIRST_KEY == state || (State::NEXT == state && '{' == stack.back()))) {
+          fail("unexpected '}'");
+        }
+        ++p;
+        stack.pop_back();
+        handler.onEndObject();
+        afterValue();
+        break;
+      case ']':
+        if (!(State::FIRST_VALUE == state || (State::NEXT == state && '[' == stack.back()))) {
+          fail("unexpected ']'");
+        }
+        ++p;
+        stack.pop_back();
+        handler.onEndArray();
+        afterValue();
+        break;
+      case ',':
+        if (State::NEXT != state) {
+          fail("unexpected ','");
+        }
+        ++p;
+        state = ('{' == stack.back() ? State::KEY : State::VALUE);
+        break;
+      case ':':
+        if (State::COLON != state) {
+          fail("unexpected ':'");
+        }
+        ++p;
+        state = State::VALUE;
+        break;
+      case '"':
+        isKey = (State::KEY == state || State::FIRST_KEY == state);
+        if (!isKey) {
+          requireValue();
+        }
+        ++p;
+        token = Token::STRING;
+        text.clear();
+        escaped = false;
+        break;
+      case 't':
+      case 'f':
+      case 'n':
+        requireValue();
+        token = Token::LITERAL;
+        text.clear();
+        break; // the word is read from this character on
+      default:
+        if ('-' == c || ('0' <= c && c <= '9')) {
+          requireValue();
+          token = Token::NUMBER;
+          text.clear();
+          break;
+        }
+        fail("unexpected character");
+      }
+    }
+    offset += length;
+    position = offset;
+  }
+
+  void finish() {
+    if (Token::NUMBER == token) {
+      completeWord(); // a number is only ended by the character after it
+    }
+    if (Token::NONE != token || State::DONE != state) {
+      fail("unexpected end of the document");
+    }
+  }
+
+  void requireValue() {
+    if (State::VALUE != state && State::FIRST_VALUE != state) {
+      fail(State::NEXT == state ? "expected ',' or the end of the object or array" : "expected an object key");
+    }
+  }
+
+  void afterValue() {
+    state = (stack.empty() ? State::DONE : State::NEXT);
+  }
+
+  /**
+   * Reads up to the closing quote, keeping the text escaped until the string is complete
+   */
+  const char* continueString(const char* p,const char* end) {
+    const char* from = p;
+    for (;p < end;++p) {
+      if (escaped) {
+        escaped = false;
+      } else if ('\\' == *p) {
+        escaped = true;
+      } else if ('"' == *p) {
+        text.append(from,p - from);
+        token = Token::NONE;
+        completeString();
+        return p + 1;
+      }
+    }
+    text.append(from,p - from);
+    return p;
+  }
+
+  void completeString() {
+    unescape();
+    if (isKey) {
+      state = State::COLON;
+      handler.onKey(text);
+      return;
+    }
+    afterValue();
+    handler.onString(text);
+  }
+
+  /**
+   * Reads a number or literal, which ends at the first character that cannot be part of it
+   */
+  const char* continueWord(const char* p,const char* end) {
+    const char* from = p;
+    if (Token::NUMBER == token) {
+      while (p < end && (('0' <= *p && *p <= '9') || '-' == *p || '+' == *p || '.' == *p || 'e' == *p || 'E' == *p)) {
+        ++p;
+      }
+    } else {
+      while (p < end && 'a' <= *p && *p <= 'z') {
+        ++p;
+      }
+    }
+    text.append(from,p - from);
+    if (p < end) {
+      completeWord();
+    }
+    return p;
+  }
+
+  void completeWord() {
+    const Token was = token;
+    token = Token::NONE;
+    if (Token::NUMBER == was) {
+      if (!isNumber()) {
+        fail("invalid number");
+      }
+      afterValue();
+      handler.onNumber(text);
+    } else if ("true" == text) {
+      afterValue();
+      handler.onBoolean(true);
+    } else if ("false" == text) {
+      afterValue();
+      handler.onBoolean(false);
+    } else if ("null" == text) {
+      afterValue();
+      handler.onNull();
+    } else {
+      fail("invalid literal");
+    }
+  }
+
+  /**
+   * Checks the number text against the JSON grammar, -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+   */
+  bool isNumber() const {
+    size_t i = 0;
+    const size_t len = text.length();
+    auto digits = [this,&i,len] () {
+      const size_t from = i;
+      while (i < len && '0' <= text[i] && text[i] <= '9') {
+        ++i;
+      }
+      return i > from;
+    };
+    if (i < len && '-' == text[i]) {
+      ++i;
+    }
+    if (i < len && '0' == text[i]) {
+      ++i;
+    } else if (!digits()) {
+      return false;
+    }
+    if (i < len && '.' == text[i]) {
+      ++i;
+      if (!digits()) {
+        return false;
+      }
+    }
+    if (i < len && ('e' == text[i] || 'E' == text[i])) {
+      ++i;
+      if (i < len && ('+' == text[i] || '-' == text[i])) {
+        ++i;
+      }
+      if (!digits()) {
+        return false;
+      }
+    }
+    return i == len;
+  }
+
+  void beginCapture(const char open) {
+    if (!captureRequested && !skipRequested) {
+      return;
+    }
+    skipping = skipRequested;
+    captureRequested = false;
+    skipRequested = false;
+    token = Token::CAPTURE;
+    if (skipping) {
+      text.clear();
+    } else {
+      text.assign(1,open);
+    }
+    depth = 1;
+    inString = false;
+    escaped = false;
+  }
+
+  /**
+   * Copies a captured value's text, tracking only strings and bracket depth. A skipped value's text is not kept.
+   */
+  const char* continueCapture(const char* p,const char* end) {
+    const char* from = p;
+    while (p < end) {
+      const char c = *p++;
+      if (inString) {
+        if (escaped) {
+          escaped = false;
+        } else if ('\\' == c) {
+          escaped = true;
+        } else if ('"' == c) {
+          inString = false;
+        }
+      } else if ('"' == c) {
+        inString = true;
+      } else if ('{' == c || '[' == c) {
+        ++depth;
+      } else if (('}' == c || ']' == c) && 0 == --depth) {
+        token = Token::NONE;
+        stack.pop_back();
+        afterValue();
+        if (!skipping) {
+          text.append(from,p - from);
+          handler.onCapture(text);
+        }
+        return p;
+      }
+    }
+    if (!skipping) {
+      text.append(from,p - from);
+    }
+    return p;
+  }
+
+  /**
+   * Replaces escapes in the complete string text with the characters they stand for
+   */
+  void unescape() {
+    size_t to = 0;
+    const size_t len = text.length();
+    for (size_t from = 0;from < len;) {
+      const unsigned char c = (unsigned char)text[from];
+      if (c < 0x20) {
+        fail("unescaped control character in string");
+      }
+      if ('\\' != c) {
+        text[to++] = text[from++];
+        continue;
+      }
+      if (from + 1 >= len) {
+        fail("invalid escape in string");
+      }
+      const char e = text[from + 1];
+      from += 2;
+      switch (e) {
+      case '"': text[to++] = '"'; break;
+      case '\\': text[to++] = '\\'; break;
+      case '/': text[to++] = '/'; break;
+      case 'b': text[to++] = '\b'; break;
+      case 'f': text[to++] = '\f'; break;
+      case 'n': text[to++] = '\n'; break;
+      case 'r': text[to++] = '\r'; break;
+      case 't': text[to++] = '\t'; break;
+      case 'u': {
+        uint32_t cp = hex4(from);
+        from += 4;
+        if (0xD800 <= cp && cp <= 0xDBFF && from + 1 < len && '\\' == text[from] && 'u' == text[from + 1]) {
+          const uint32_t low = hex4(from + 2);
+          if (low < 0xDC00 || low > 0xDFFF) {
+            fail("invalid surrogate pair in string");
+          }
+          from += 6;
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+        to = codepoint(cp,to); // UTF-8 is never longer than the escape it replaces
+        break;
+      }
+      default:
+        fail("invalid escape in string");
+      }
+    }
+    text.resize(to);
+  }
+
+  uint32_t hex4(const size_t at) {
+    if (at + 4 > text.length()) {
+      fail("invalid \\u escape in string");
+    }
+    uint32_t value = 0;
+    for (size_t i = at;i < at + 4;i++) {
+      const char c = text[i];
+      value <<= 4;
+      if ('0' <= c && c <= '9') {
+        value |= (uint32_t)(c - '0');
+      } else if ('a' <= c && c <= 'f') {
+        value |= (uint32_t)(c - 'a' + 10);
+      } else if ('A' <= c && c <= 'F') {
+        value |= (uint32_t)(c - 'A' + 10);
+      } else {
+        fail("invalid \\u escape in string");
+      }
+    }
+    return value;
+  }
+
+  /**
+   * Writes a code point as UTF-8 at the given position in text
+   */
+  size_t codepoint(const uint32_t cp,size_t to) {
+    if (cp < 0x80) {
+      text[to++] = (char)cp;
+    } else if (cp < 0x800) {
+      text[to++] = (char)(0xC0 | (cp >> 6));
+      text[to++] = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      text[to++] = (char)(0xE0 | (cp >> 12));
+      text[to++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+      text[to++] = (char)(0x80 | (cp & 0x3F));
+    } else {
+      text[to++] = (char)(0xF0 | (cp >> 18));
+      text[to++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+      text[to++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+      text[to++] = (char)(0x80 | (cp & 0x3F));
+    }
+    return to;
+  }
+
+  IJsonEventHandler& handler;
+  std::vector<char> stack; // '{' or '[' for each open container
+  State state;
+  Token token;
+  std::string text; // the token read so far
+  bool isKey;
+  bool escaped;
+  bool inString; // capture only
+  long depth; // capture only
+  bool captureRequested;
+  bool skipRequested;
+  bool skipping; // capture only. Whether the value's text is discarded
+  size_t offset; // bytes fed before the current chunk
+  size_t position; // for error messages
+};
+
+
+
+JsonEventParser::JsonEventParser(IJsonEventHandler& handler) : mImpl(new Impl(handler)) {
+  ;
+}
+
+JsonEventParser::~JsonEventParser() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
+void JsonEventParser::feed(const char* data,const size_t length) {
+  mImpl->feed(data,length);
+}
+
+void JsonEventParser::finish() {
+  mImpl->finish();
+}
+
+void JsonEventParser::captureValue() {
+  mImpl->captureRequested = true;
+}
+
+void JsonEventParser::skipValue() {
+  mImpl->skipRequested = true;
+}
+
+size_t JsonEventParser::getOffset() const {
+  return mImpl->offset;
+}
+
+} // end utilities namespace
+
+} // end mlclient namespace
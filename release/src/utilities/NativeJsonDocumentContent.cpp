@@ -0,0 +1,940 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file NativeJsonDocumentContent.cpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ * \brief Implements a JSON document content instance that parses UTF-8 directly
+ */
+
+#include <mlclient/utilities/NativeJsonDocumentContent.hpp>
+#include <mlclient/InvalidFormatException.hpp>
+#include <mlclient/logging.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <locale>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mlclient {
+
+namespace utilities {
+
+/**
+ * The parsed form of a JSON document
+ */
+class NativeJsonTape {
+public:
+  enum class Type : uint8_t {
+    NUL = 0, BOOLEAN, INTEGER, DOUBLE, STRING, ARRAY, OBJECT
+  };
+
+  /**
+   * One value. An object's members are stored as a STRING key entry followed by the value's entries.
+   */
+  struct Entry {
+    Type type;
+    bool boolean;
+    uint32_t span; // entries in this value, including itself. Its next sibling is at this + span.
+    uint32_t count; // members, for ARRAY and OBJECT
+    uint32_t length; // bytes, for STRING
+    const char* text; // for STRING, within buffer. Not null terminated.
+    int64_t integer;
+    double number;
+  };
+
+  NativeJsonTape(std::string&& text) : buffer(std::move(text)), entries() {
+    ;
+  }
+
+  std::string buffer;
+  std::vector<Entry> entries;
+};
+
+namespace {
+
+typedef NativeJsonTape::Entry Entry;
+typedef NativeJsonTape::Type Type;
+
+const Entry* entryOf(const void* node) {
+  return static_cast<const Entry*>(node);
+}
+
+/**
+ * Parses JSON text in a single pass, using an explicit stack rather than recursion
+ */
+class JsonParser {
+public:
+  JsonParser(NativeJsonTape& tape) : tape(tape), start(&tape.buffer[0]), p(&tape.buffer[0]), open(), numbers() {
+    numbers.imbue(std::locale::classic()); // a '.' decimal point, whatever the global locale
+  }
+
+  void parse() {
+    tape.entries.reserve(tape.buffer.size() / 8 + 1); // a rough guess, avoiding most reallocations
+    skip();
+    bool expectValue = true;
+    while (true) {
+      if (expectValue) {
+        if (inObject()) {
+          if ('"' != *p) {
+            fail("expected a property name");
+          }
+          string();
+          skip();
+          expect(':');
+          skip();
+        }
+        if ('{' == *p || '[' == *p) {
+          const char closing = ('{' == *p ? '}' : ']');
+          push('{' == *p ? Type::OBJECT : Type::ARRAY);
+          open.push_back(tape.entries.size() - 1);
+          ++p;
+          skip();
+          if (closing != *p) {
+            continue; // its first member is next
+          }
+          ++p;
+          close();
+        } else {
+          scalar();
+        }
+      }
+
+      // a value has just ended
+      skip();
+      if (open.empty()) {
+        if (p != start + tape.buffer.size()) {
+          fail("unexpected text after the document");
+        }
+        return;
+      }
+      Entry& parent = tape.entries[open.back()];
+      ++parent.count;
+      if (',' == *p) {
+        ++p;
+        skip();
+        expectValue = true;
+      } else if ((Type::OBJECT == parent.type ? '}' : ']') == *p) {
+        ++p;
+        close();
+        expectValue = false; // the container has ended, so its parent's value has too
+      } else {
+        fail("expected ',' or the end of a container");
+      }
+    }
+  }
+
+private:
+  [[noreturn]] void fail(const char* message) {
+    throw mlclient::InvalidFormatException(std::string("JSON parse error at offset ") + std::to_string(p - start) +
+        ": " + message);
+  }
+
+  bool inObject() const {
+    return !open.empty() && Type::OBJECT == tape.entries[open.back()].type;
+  }
+
+  Entry& push(const Type type) {
+    Entry entry;
+    std::memset(&entry,0,sizeof(entry));
+    entry.type = type;
+    entry.span = 1;
+    tape.entries.push_back(entry);
+    return tape.entries.back();
+  }
+
+  void close() {
+    const size_t idx = open.back();
+    open.pop_back();
+    tape.entries[idx].span = (uint32_t)(tape.entries.size() - idx);
+  }
+
+  void skip() {
+    while (' ' == *p || '\n' == *p || '\r' == *p || '\t' == *p) {
+      ++p;
+    }
+  }
+
+  void expect(const char c) {
+    if (c != *p) {
+      fail((std::string("expected '") + c + "'").c_str());
+    }
+    ++p;
+  }
+
+  void scalar() {
+    switch (*p) {
+    case '"':
+      string();
+      return;
+    case 't':
+      literal("true",4);
+      push(Type::BOOLEAN).boolean = true;
+      return;
+    case 'f':
+      literal("false",5);
+      push(Type::BOOLEAN).boolean = false;
+      return;
+    case 'n':
+      literal("null",4);
+      push(Type::NUL);
+      return;
+    default:
+      if ('-' == *p || ('0' <= *p && *p <= '9')) {
+        number();
+        return;
+      }
+      fail("expected a value");
+    }
+  }
+
+  void literal(const char* word,const size_t len) {
+    if (0 != std::strncmp(p,word,len)) {
+      fail("invalid literal");
+    }
+    p += len;
+  }
+
+  /**
+   * Unescapes in place. The result is never longer than the escaped text, so it cannot overrun it.
+   */
+  void string() {
+    ++p; // opening quote
+    char* from = p;
+    while ('"' != *p && '\\' != *p && (unsigned char)*p >= 0x20) {
+      ++p; // the common case, with nothing to copy
+    }
+    char* to = p;
+    while ('"' != *p) {
+      const unsigned char c = (unsigned char)*p;
+      if ('\0' == c && p == start + tape.buffer.size()) {
+        fail("unterminated string");
+      }
+      if (c < 0x20) {
+        fail("unescaped control character in string");
+      }
+      if ('\\' != c) {
+        *to++ = *p++;
+        continue;
+      }
+      ++p;
+      switch (*p++) {
+      case '"': *to++ = '"'; break;
+      case '\\': *to++ = '\\'; break;
+      case '/': *to++ = '/'; break;
+      case 'b': *to++ = '\b'; break;
+      case 'f': *to++ = '\f'; break;
+      case 'n': *to++ = '\n'; break;
+      case 'r': *to++ = '\r'; break;
+      case 't': *to++ = '\t'; break;
+      case 'u': to = codepoint(to); break;
+      default:
+        fail("invalid escape in string");
+      }
+    }
+    ++p; // closing quote
+    Entry& entry = push(Type::STRING);
+    entry.text = from;
+    entry.length = (uint32_t)(to - from);
+  }
+
+  uint32_t hex4() {
+    uint32_t value = 0;
+    for (int i = 0;i < 4;i++) {
+      const char c = *p++;
+      value <<= 4;
+      if ('0' <= c && c <= '9') {
+        value |= (uint32_t)(c - '0');
+      } else if ('a' <= c && c <= 'f') {
+        value |= (uint32_t)(c - 'a' + 10);
+      } else if ('A' <= c && c <= 'F') {
+        value |= (uint32_t)(c - 'A' + 10);
+      } else {
+        fail("invalid \\u escape in string");
+      }
+    }
+    return value;
+  }
+
+  /**
+   * Writes a \\u escape, and its low surrogate if any, as UTF-8
+   */
+  char* codepoint(char* to) {
+    uint32_t cp = hex4();
+    if (0xD800 <= cp && cp <= 0xDBFF && '\\' == p[0] && 'u' == p[1]) {
+      p += 2;
+      const uint32_t low = hex4();
+      if (low < 0xDC00 || low > 0xDFFF) {
+        fail("invalid surrogate pair in string");
+      }
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+    }
+    if (cp < 0x80) {
+      *to++ = (char)cp;
+    } else if (cp < 0x800) {
+      *to++ = (char)(0xC0 | (cp >> 6));
+      *to++ = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      *to++ = (char)(0xE0 | (cp >> 12));
+      *to++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+      *to++ = (char)(0x80 | (cp & 0x3F));
+    } else {
+      *to++ = (char)(0xF0 | (cp >> 18));
+      *to++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+      *to++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+      *to++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return to;
+  }
+
+  void number() {
+    const char* from = p;
+    bool negative = ('-' == *p);
+    if (negative) {
+      ++p;
+    }
+    if (*p < '0' || *p > '9') {
+      fail("invalid number");
+    }
+    uint64_t magnitude = 0;
+    bool fitsInteger = true;
+    while ('0' <= *p && *p <= '9') {
+      const uint64_t digit = (uint64_t)(*p - '0');
+      if (magnitude > (UINT64_MAX - digit) / 10) {
+        fitsInteger = false;
+      } else {
+        magnitude = magnitude * 10 + digit;
+      }
+      ++p;
+    }
+    bool isDouble = false;
+    if ('.' == *p) {
+      isDouble = true;
+      ++p;
+      if (*p < '0' || *p > '9') {
+        fail("invalid number");
+      }
+      while ('0' <= *p && *p <= '9') {
+        ++p;
+      }
+    }
+    if ('e' == *p || 'E' == *p) {
+      isDouble = true;
+      ++p;
+      if ('+' == *p || '-' == *p) {
+        ++p;
+      }
+      if (*p < '0' || *p > '9') {
+        fail("invalid number");
+      }
+      while ('0' <= *p && *p <= '9') {
+        ++p;
+      }
+    }
+    const uint64_t limit = (negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX);
+    if (!isDouble && fitsInteger && magnitude <= limit) {
+      Entry& entry = push(Type::INTEGER);
+      entry.integer = (negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude);
+      entry.number = (double)entry.integer;
+      return;
+    }
+    Entry& entry = push(Type::DOUBLE);
+    numbers.clear();
+    numbers.str(std::string(from,p - from));
+    numbers >> entry.number; // out of range values give the largest double of that sign
+    // converting a double outside the int64_t range is undefined, so clamp it first
+    if (entry.number >= 9223372036854775808.0) {
+      entry.integer = INT64_MAX;
+    } else if (entry.number < -9223372036854775808.0) {
+      entry.integer = INT64_MIN;
+    } else {
+      entry.integer = (int64_t)entry.number;
+    }
+  }
+
+  NativeJsonTape& tape;
+  const char* start;
+  char* p;
+  std::vector<size_t> open; // indexes of the containers being parsed
+  std::istringstream numbers; // reused for every non integer number
+};
+
+std::shared_ptr<NativeJsonTape> parseTape(std::string&& text) {
+  TIMED_FUNC(NativeJsonDocumentContent_parse);
+  std::shared_ptr<NativeJsonTape> tape = std::make_shared<NativeJsonTape>(std::move(text));
+  if (tape->buffer.empty()) {
+    throw mlclient::InvalidFormatException("JSON parse error: empty content");
+  }
+  JsonParser(*tape).parse();
+  return tape;
+}
+
+std::string textOf(const Entry* entry) {
+  return std::string(entry->text,entry->length);
+}
+
+bool isTrueString(const Entry* entry) {
+  if (Type::STRING != entry->type) {
+    return false;
+  }
+  return (4 == entry->length) && (0 == std::strncmp(entry->text,"true",4) || 0 == std::strncmp(entry->text,"TRUE",4) ||
+      0 == std::strncmp(entry->text,"True",4));
+}
+
+/**
+ * Finds a property, ignoring any prefix up to a colon in the key, as CppRestJsonDocumentNode does
+ */
+const Entry* propertyOf(const Entry* obj,const std::string& key) {
+  if (Type::OBJECT != obj->type) {
+    return nullptr;
+  }
+  const std::string::size_type colon = key.find(':');
+  const char* name = key.c_str() + (std::string::npos == colon ? 0 : colon + 1);
+  const size_t length = key.size() - (size_t)(name - key.c_str());
+  const Entry* member = obj + 1;
+  for (uint32_t i = 0;i < obj->count;i++) {
+    const Entry* value = member + 1;
+    if (member->length == length && 0 == std::memcmp(member->text,name,length)) {
+      return value;
+    }
+    member = value + value->span;
+  }
+  return nullptr;
+}
+
+const Entry* memberOf(const Entry* arr,const int32_t idx) {
+  if (Type::ARRAY != arr->type || idx < 0 || (uint32_t)idx >= arr->count) {
+    return nullptr;
+  }
+  const Entry* member = arr + 1;
+  for (int32_t i = 0;i < idx;i++) {
+    member += member->span;
+  }
+  return member;
+}
+
+StringList keysOf(const Entry* obj) {
+  StringList keys;
+  if (Type::OBJECT != obj->type) {
+    return keys;
+  }
+  const Entry* member = obj + 1;
+  for (uint32_t i = 0;i < obj->count;i++) {
+    keys.push_back(textOf(member));
+    member = member + 1 + (member + 1)->span;
+  }
+  return keys;
+}
+
+void writeString(std::ostream& os,const char* text,const uint32_t length) {
+  os << '"';
+  const char* run = text;
+  const char* end = text + length;
+  for (const char* c = text;c != end;++c) {
+    const unsigned char uc = (unsigned char)*c;
+    if ('"' != uc && '\\' != uc && uc >= 0x20) {
+      continue;
+    }
+    os.write(run,c - run);
+    run = c + 1;
+    switch (uc) {
+    case '"': os << "\\\""; break;
+    case '\\': os << "\\\\"; break;
+    case '\b': os << "\\b"; break;
+    case '\f': os << "\\f"; break;
+    case '\n': os << "\\n"; break;
+    case '\r': os << "\\r"; break;
+    case '\t': os << "\\t"; break;
+    default: {
+      char escaped[8];
+      std::snprintf(escaped,sizeof(escaped),"\\u%04x",uc);
+      os << escaped;
+    }
+    }
+  }
+  os.write(run,end - run);
+  os << '"';
+}
+
+/**
+ * Writes a value as JSON text, returning the entry after it
+ */
+const Entry* writeValue(std::ostream& os,const Entry* entry) {
+  switch (entry->type) {
+  case Type::NUL:
+    os << "null";
+    return entry + 1;
+  case Type::BOOLEAN:
+    os << (entry->boolean ? "true" : "false");
+    return entry + 1;
+  case Type::INTEGER:
+    os << entry->integer;
+    return entry + 1;
+  case Type::DOUBLE:
+    os << entry->number; // see toJson() for the precision and locale
+    return entry + 1;
+  case Type::STRING:
+    writeString(os,entry->text,entry->length);
+    return entry + 1;
+  case Type::ARRAY: {
+    os << '[';
+    const Entry* member = entry + 1;
+    for (uint32_t i = 0;i < entry->count;i++) {
+      if (0 != i) {
+        os << ',';
+      }
+      member = writeValue(os,member);
+    }
+    os << ']';
+    return entry + entry->span;
+  }
+  case Type::OBJECT: {
+    os << '{';
+    const Entry* member = entry + 1;
+    for (uint32_t i = 0;i < entry->count;i++) {
+      if (0 != i) {
+        os << ',';
+      }
+      writeString(os,member->text,member->length);
+      os << ':';
+      member = writeValue(os,member + 1);
+    }
+    os << '}';
+    return entry + entry->span;
+  }
+  }
+  return entry + 1;
+}
+
+/**
+ * Returns a value as JSON text. Numbers are written in the classic locale, so with a '.' decimal point and no
+ * digit grouping whatever the global locale, and doubles with the 17 significant digits that round trip.
+ */
+std::string toJson(const Entry* entry) {
+  std::ostringstream os;
+  os.imbue(std::locale::classic());
+  os << std::setprecision(17);
+  writeValue(os,entry);
+  return os.str();
+}
+
+/**
+ * An entry within a NativeJsonTape. Handles hold no reference to the tape, so must not outlive the node or
+ * content they came from.
+ */
+class TapeKind : public IDocumentNodeKind {
+public:
+  bool isNull(const void* node) const override {
+    return Type::NUL == entryOf(node)->type;
+  }
+  bool isBoolean(const void* node) const override {
+    return Type::BOOLEAN == entryOf(node)->type || isTrueString(entryOf(node));
+  }
+  bool isInteger(const void* node) const override {
+    return Type::INTEGER == entryOf(node)->type;
+  }
+  bool isDouble(const void* node) const override {
+    return Type::DOUBLE == entryOf(node)->type;
+  }
+  bool isString(const void* node) const override {
+    return Type::STRING == entryOf(node)->type && !isTrueString(entryOf(node));
+  }
+  bool isArray(const void* node) const override {
+    return Type::ARRAY == entryOf(node)->type;
+  }
+  bool isObject(const void* node) const override {
+    return Type::OBJECT == entryOf(node)->type;
+  }
+
+  bool asBoolean(const void* node) const override {
+    const Entry* entry = entryOf(node);
+    if (Type::BOOLEAN == entry->type) {
+      return entry->boolean;
+    }
+    if (Type::STRING != entry->type) {
+      throw mlclient::InvalidFormatException("JSON value is not a boolean");
+    }
+    return isTrueString(entry);
+  }
+  int32_t asInteger(const void* node) const override {
+    const Entry* entry = entryOf(node);
+    if (Type::INTEGER != entry->type && Type::DOUBLE != entry->type) {
+      throw mlclient::InvalidFormatException("JSON value is not an integer");
+    }
+    return (int32_t)entry->integer;
+  }
+  double asDouble(const void* node) const override {
+    const Entry* entry = entryOf(node);
+    if (Type::INTEGER != entry->type && Type::DOUBLE != entry->type) {
+      throw mlclient::InvalidFormatException("JSON value is not a double");
+    }
+    return entry->number;
+  }
+  std::string asString(const void* node) const override {
+    if (Type::STRING != entryOf(node)->type) {
+      throw mlclient::InvalidFormatException("JSON value is not a string");
+    }
+    return textOf(entryOf(node));
+  }
+
+  DocumentNodeRef at(const void* node,const std::string& key) const override {
+    const Entry* value = propertyOf(entryOf(node),key);
+    return (nullptr == value ? DocumentNodeRef() : DocumentNodeRef(this,value));
+  }
+  DocumentNodeRef at(const void* node,const int32_t idx) const override {
+    const Entry* value = memberOf(entryOf(node),idx);
+    return (nullptr == value ? DocumentNodeRef() : DocumentNodeRef(this,value));
+  }
+  std::vector<DocumentNodeRef> members(const void* node) const override {
+    const Entry* entry = entryOf(node);
+    if (Type::ARRAY != entry->type) {
+      return IDocumentNodeKind::members(node);
+    }
+    std::vector<DocumentNodeRef> all;
+    all.reserve(entry->count);
+    const Entry* member = entry + 1;
+    for (uint32_t i = 0;i < entry->count;i++) {
+      all.push_back(DocumentNodeRef(this,member));
+      member += member->span;
+    }
+    return all;
+  }
+  StringList keys(const void* node) const override {
+    return keysOf(entryOf(node));
+  }
+  int32_t size(const void* node) const override {
+    return (Type::ARRAY == entryOf(node)->type ? (int32_t)entryOf(node)->count : 1);
+  }
+
+  /**
+   * \note Handles carry no tape, so the new node does not keep the document alive. Use the node or navigator
+   * newNode(ref), at() and tryAt() functions for nodes that must outlive their content.
+   */
+  IDocumentNode* newNode(const void* node) const override {
+    return new NativeJsonDocumentNode(std::shared_ptr<const NativeJsonTape>(),node);
+  }
+};
+
+const TapeKind TAPE_KIND;
+
+} // end anonymous namespace
+
+
+
+
+class NativeJsonDocumentNode::Impl {
+public:
+  Impl(std::shared_ptr<const NativeJsonTape> tape,const Entry* entry) : tape(tape), entry(entry), indexOnce(),
+    members() {
+    ;
+  }
+
+  /**
+   * Lists an array's members in one pass on first use, so at(idx) is O(1) rather than skipping over each earlier member
+   */
+  const std::vector<const Entry*>& index() {
+    std::call_once(indexOnce,[this] () {
+      if (Type::ARRAY != entry->type) {
+        return;
+      }
+      members.reserve(entry->count);
+      const Entry* member = entry + 1;
+      for (uint32_t i = 0;i < entry->count;i++) {
+        members.push_back(member);
+        member += member->span;
+      }
+    });
+    return members;
+  }
+
+  IDocumentNode* wrap(const Entry* value) const {
+    return (nullptr == value ? nullptr : new NativeJsonDocumentNode(tape,value));
+  }
+
+  std::shared_ptr<const NativeJsonTape> tape; // may be empty for a node created from a DocumentNodeRef
+  const Entry* entry;
+
+  std::once_flag indexOnce;
+  std::vector<const Entry*> members;
+};
+
+NativeJsonDocumentNode::NativeJsonDocumentNode(std::shared_ptr<const NativeJsonTape> tape,const void* entry) :
+    mImpl(new Impl(tape,entryOf(entry))) {
+  ;
+}
+
+NativeJsonDocumentNode::~NativeJsonDocumentNode() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
+bool NativeJsonDocumentNode::isNull() const {
+  return TAPE_KIND.isNull(mImpl->entry);
+}
+bool NativeJsonDocumentNode::isBoolean() const {
+  return TAPE_KIND.isBoolean(mImpl->entry);
+}
+bool NativeJsonDocumentNode::isInteger() const {
+  return TAPE_KIND.isInteger(mImpl->entry);
+}
+bool NativeJsonDocumentNode::isDouble() const {
+  return TAPE_KIND.isDouble(mImpl->entry);
+}
+bool NativeJsonDocumentNode::isString() const {
+  return TAPE_KIND.isString(mImpl->entry);
+}
+bool NativeJsonDocumentNode::isArray() const {
+  return TAPE_KIND.isArray(mImpl->entry);
+}
+bool NativeJsonDocumentNode::isObject() const {
+  return TAPE_KIND.isObject(mImpl->entry);
+}
+
+bool NativeJsonDocumentNode::asBoolean() const {
+  return TAPE_KIND.asBoolean(mImpl->entry);
+}
+int32_t NativeJsonDocumentNode::asInteger() const {
+  return TAPE_KIND.asInteger(mImpl->entry);
+}
+double NativeJsonDocumentNode::asDouble() const {
+  return TAPE_KIND.asDouble(mImpl->entry);
+}
+std::string NativeJsonDocumentNode::asString() const {
+  return TAPE_KIND.asString(mImpl->entry);
+}
+IDocumentNode* NativeJsonDocumentNode::asArray() const {
+  if (Type::ARRAY != mImpl->entry->type) {
+    throw mlclient::InvalidFormatException("JSON value is not an array");
+  }
+  return mImpl->wrap(mImpl->entry);
+}
+IDocumentNode* NativeJsonDocumentNode::asObject() const {
+  if (Type::OBJECT != mImpl->entry->type) {
+    throw mlclient::InvalidFormatException("JSON value is not an object");
+  }
+  return mImpl->wrap(mImpl->entry);
+}
+
+IDocumentNode* NativeJsonDocumentNode::at(const std::string& key) const {
+  IDocumentNode* child = tryAt(key);
+  if (nullptr == child) {
+    throw mlclient::InvalidFormatException("JSON property does not exist: " + key);
+  }
+  return child;
+}
+IDocumentNode* NativeJsonDocumentNode::at(const int32_t idx) const {
+  IDocumentNode* child = tryAt(idx);
+  if (nullptr == child) {
+    throw mlclient::InvalidFormatException("JSON array member does not exist: " + std::to_string(idx));
+  }
+  return child;
+}
+bool NativeJsonDocumentNode::has(const std::string& key) const {
+  return nullptr != propertyOf(mImpl->entry,key);
+}
+IDocumentNode* NativeJsonDocumentNode::tryAt(const std::string& key) const {
+  return mImpl->wrap(propertyOf(mImpl->entry,key));
+}
+IDocumentNode* NativeJsonDocumentNode::tryAt(const int32_t idx) const {
+  const std::vector<const Entry*>& members = mImpl->index();
+  if (idx < 0 || (size_t)idx >= members.size()) {
+    return nullptr;
+  }
+  return mImpl->wrap(members[idx]);
+}
+DocumentNodeRef NativeJsonDocumentNode::ref() const {
+  return DocumentNodeRef(&TAPE_KIND,mImpl->entry);
+}
+
+IDocumentNode* NativeJsonDocumentNode::newNode(const DocumentNodeRef& ref) const {
+  if (&TAPE_KIND != ref.getKind()) {
+    return ref.newNode();
+  }
+  return new NativeJsonDocumentNode(mImpl->tape,ref.getNode());
+}
+
+StringList NativeJsonDocumentNode::keys() const {
+  return keysOf(mImpl->entry);
+}
+int32_t NativeJsonDocumentNode::size() const {
+  return TAPE_KIND.size(mImpl->entry);
+}
+
+IDocumentContent* NativeJsonDocumentNode::getChildContent() const {
+  if (nullptr == mImpl->tape.get()) {
+    // created from a handle, so copy rather than share
+    NativeJsonDocumentContent* ct = new NativeJsonDocumentContent;
+    ct->setContent(toJson(mImpl->entry));
+    return ct;
+  }
+  return new NativeJsonDocumentContent(mImpl->tape,mImpl->entry);
+}
+
+
+
+
+class NativeJsonDocumentNavigator::Impl {
+public:
+  Impl(std::shared_ptr<const NativeJsonTape> tape,const Entry* root) : tape(tape), root(root) {
+    ;
+  }
+
+  std::shared_ptr<const NativeJsonTape> tape;
+  const Entry* root;
+};
+
+NativeJsonDocumentNavigator::NativeJsonDocumentNavigator(std::shared_ptr<const NativeJsonTape> tape,const void* root) :
+    mImpl(new Impl(tape,entryOf(root))) {
+  ;
+}
+
+NativeJsonDocumentNavigator::~NativeJsonDocumentNavigator() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
+IDocumentNode* NativeJsonDocumentNavigator::firstChild() const {
+  return new NativeJsonDocumentNode(mImpl->tape,mImpl->root);
+}
+
+IDocumentNode* NativeJsonDocumentNavigator::at(const std::string& key) const {
+  IDocumentNode* child = tryAt(key);
+  if (nullptr == child) {
+    throw mlclient::InvalidFormatException("JSON property does not exist: " + key);
+  }
+  return child;
+}
+
+bool NativeJsonDocumentNavigator::has(const std::string& key) const {
+  return nullptr != propertyOf(mImpl->root,key);
+}
+
+IDocumentNode* NativeJsonDocumentNavigator::tryAt(const std::string& key) const {
+  const Entry* value = propertyOf(mImpl->root,key);
+  return (nullptr == value ? nullptr : new NativeJsonDocumentNode(mImpl->tape,value));
+}
+
+DocumentNodeRef NativeJsonDocumentNavigator::ref() const {
+  return DocumentNodeRef(&TAPE_KIND,mImpl->root);
+}
+
+IDocumentNode* NativeJsonDocumentNavigator::newNode(const DocumentNodeRef& ref) const {
+  if (&TAPE_KIND != ref.getKind()) {
+    return ref.newNode();
+  }
+  return new NativeJsonDocumentNode(mImpl->tape,ref.getNode());
+}
+
+
+
+
+class NativeJsonDocumentContent::Impl {
+public:
+  Impl() : tape(parseTape(std::string("null"))), root(&tape->entries.front()), mimeType(""), serializedMutex(),
+    serialized(), dirty(true) {
+    ;
+  }
+  Impl(std::shared_ptr<const NativeJsonTape> tape,const Entry* root) : tape(tape), root(root), mimeType(""),
+    serializedMutex(), serialized(), dirty(true) {
+    ;
+  }
+
+  /**
+   * Returns the serialised value, serialising it only if it has changed since it was last serialised
+   */
+  std::shared_ptr<const std::string> getSerialized() {
+    std::lock_guard<std::mutex> lock(serializedMutex);
+    if (dirty) {
+      serialized = std::make_shared<const std::string>(toJson(root));
+      dirty = false;
+    }
+    return serialized;
+  }
+
+  std::shared_ptr<const NativeJsonTape> tape;
+  const Entry* root;
+  std::string mimeType;
+
+  std::mutex serializedMutex; // const functions may be called from several threads
+  std::shared_ptr<const std::string> serialized; // replaced, never modified, as views and streams share it
+  bool dirty;
+};
+
+NativeJsonDocumentContent::NativeJsonDocumentContent() : mImpl(new Impl) {
+  ;
+}
+
+NativeJsonDocumentContent::NativeJsonDocumentContent(std::shared_ptr<const NativeJsonTape> tape,const void* root) :
+    mImpl(new Impl(tape,entryOf(root))) {
+  mImpl->mimeType = IDocumentContent::MIME_JSON;
+}
+
+NativeJsonDocumentContent::~NativeJsonDocumentContent() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
+std::istream* NativeJsonDocumentContent::getStream() const {
+  TIMED_FUNC(NativeJsonDocumentContent_getStream);
+  return contentView().openStream();
+}
+
+void NativeJsonDocumentContent::setContent(std::string content) {
+  TIMED_FUNC(NativeJsonDocumentContent_setContent);
+  std::shared_ptr<NativeJsonTape> tape = parseTape(std::move(content));
+  mImpl->root = &tape->entries.front();
+  mImpl->tape = std::move(tape);
+  std::lock_guard<std::mutex> lock(mImpl->serializedMutex);
+  mImpl->dirty = true;
+  mImpl->serialized.reset(); // frees the stale text now, unless a view or stream still shares it
+}
+
+std::string NativeJsonDocumentContent::getContent() const {
+  TIMED_FUNC(NativeJsonDocumentContent_getContent);
+  return *mImpl->getSerialized();
+}
+
+ContentView NativeJsonDocumentContent::contentView() const {
+  return ContentView(mImpl->getSerialized());
+}
+
+size_t NativeJsonDocumentContent::size() const {
+  return mImpl->getSerialized()->size();
+}
+
+std::string NativeJsonDocumentContent::getMimeType() const {
+  return mImpl->mimeType;
+}
+
+void NativeJsonDocumentContent::setMimeType(const std::string& mt) {
+  mImpl->mimeType = mt;
+}
+
+int NativeJsonDocumentContent::getLength() const {
+  return mImpl->getSerialized()->size();
+}
+
+IDocumentNavigator* NativeJsonDocumentContent::navigate(bool firstElementAsRoot) const {
+  return new NativeJsonDocumentNavigator(mImpl->tape,mImpl->root);
+}
+
+} // end utilities namespace
+
+} // end mlclient namespace
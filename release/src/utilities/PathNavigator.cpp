@@ -22,62 +22,398 @@
 #include <mlclient/InvalidFormatException.hpp>
 #include <mlclient/DocumentContent.hpp>
 
-// TODO replace the below with templates and the at() pattern
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace mlclient {
 namespace utilities {
 
+namespace {
+
+/**
+ * Reads the next non empty step of a path from start, and moves start past it
+ *
+ * \return false if no steps remain
+ */
+bool nextStep(const std::string& path,size_t& start,std::string& key) {
+  while (start < path.size()) {
+    size_t location = path.find('/',start);
+    if (std::string::npos == location) {
+      location = path.size();
+    }
+    const size_t from = start;
+    start = location + 1;
+    if (location > from) {
+      key.assign(path,from,location - from);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Walks the rest of a path with each node's virtual at(), for implementations whose ref() returns an empty handle.
+ * Takes ownership of the first node, and deletes each node once the walk has moved past it.
+ */
+IDocumentNode* walk(IDocumentNode* first,const std::string& path,size_t start) {
+  std::unique_ptr<IDocumentNode> current(first);
+  std::string key;
+  while (nullptr != current.get() && nextStep(path,start,key)) {
+    current.reset(current->at(key));
+  }
+  if (nullptr == current.get()) {
+    throw mlclient::InvalidFormatException("No element or property at path: " + path);
+  }
+  return current.release();
+}
+
+} // end anonymous namespace
+
 IDocumentNode* PathNavigator::navigate(const IDocumentNavigator* nav,const std::string& path) {
-  size_t location = path.find('/');
-  size_t start = 0;
-  if (std::string::npos == location) {
+  DocumentNodeRef root = nav->ref();
+  if (root.isEmpty()) {
+    size_t start = 0;
+    std::string key;
+    if (!nextStep(path,start,key)) {
       throw mlclient::InvalidFormatException("No element or property at top level of path");
+    }
+    return walk(nav->at(key),path,start);
+  }
+  IDocumentNode* node = nav->newNode(find(root,path)); // shares the navigator's content, as at() does
+  if (nullptr == node) {
+    throw mlclient::InvalidFormatException("No element or property at path: " + path);
   }
-  if (0 == location) {
-      start = 1;
-      location = path.find('/',start);
+  return node;
+}
+
+IDocumentNode* PathNavigator::at(const IDocumentNode* node,const std::string& subpath) {
+  DocumentNodeRef from = node->ref();
+  if (from.isEmpty()) {
+    size_t start = 0;
+    std::string key;
+    if (!nextStep(subpath,start,key)) {
+      throw mlclient::InvalidFormatException("No element or property at lower level of path");
+    }
+    return walk(node->at(key),subpath,start);
   }
-  std::string curLevel = path.substr(start,location);
-  std::string lower = "";
-  if (location != path.size()) {
-    lower = path.substr(location + 1);
+  IDocumentNode* child = node->newNode(find(from,subpath)); // shares the node's content, as at() does
+  if (nullptr == child) {
+    throw mlclient::InvalidFormatException("No element or property at path: " + subpath);
   }
+  return child;
+}
 
-  IDocumentNode* child = nav->at(curLevel);
-  if (lower.size() == 0) {
-      // at end of path
-      return child;
-  } else {
-      return at(child,lower);
+DocumentNodeRef PathNavigator::find(const DocumentNodeRef& from,const std::string& path) {
+  DocumentNodeRef current = from;
+  std::string key; // reused for every step
+  size_t start = 0;
+  while (start < path.size() && !current.isEmpty()) {
+    size_t location = path.find('/',start);
+    if (std::string::npos == location) {
+      location = path.size();
+    }
+    if (location > start) {
+      key.assign(path,start,location - start);
+      current = current.at(key);
+    }
+    start = location + 1;
   }
+  return current;
 }
 
-IDocumentNode* PathNavigator::at(const IDocumentNode* node,const std::string& subpath) {
-  size_t location = subpath.find('/');
+
+
+namespace {
+
+/**
+ * One step of a compiled path
+ */
+struct Step {
+  enum class Type {
+    KEY, INDEX, WILDCARD
+  };
+
+  Step(Type t,const std::string& k,const int32_t i) : type(t), key(k), index(i) {
+    ;
+  }
+
+  bool operator==(const Step& other) const {
+    return type == other.type && index == other.index && key == other.key;
+  }
+
+  Type type;
+  std::string key; // KEY only
+  int32_t index; // INDEX only
+};
+
+/**
+ * Splits a path in to steps
+ *
+ * \throw InvalidFormatException if an index is invalid
+ */
+void parse(const std::string& path,std::vector<Step>& steps) {
   size_t start = 0;
-  if (std::string::npos == location) {
-    if (subpath.size() == 0) {
-      throw mlclient::InvalidFormatException("No element or property at lower level of path");
+  while (start < path.size()) {
+    size_t location = path.find('/',start);
+    if (std::string::npos == location) {
+      location = path.size();
+    }
+    const std::string part(path,start,location - start);
+    start = location + 1;
+    if (part.empty()) {
+      continue;
+    }
+    if ("*" == part) {
+      steps.emplace_back(Step::Type::WILDCARD,"",0);
+      continue;
+    }
+    const size_t open = part.find('[');
+    if (std::string::npos == open) {
+      steps.emplace_back(Step::Type::KEY,part,0);
+      continue;
+    }
+    if (open > 0) {
+      steps.emplace_back(Step::Type::KEY,part.substr(0,open),0);
+    }
+    const size_t close = part.size() - 1;
+    if (']' != part[close] || close == open + 1 || close - open > 10) {
+      throw mlclient::InvalidFormatException("Invalid index in path: " + path);
     }
-    location = subpath.size();
-  } else {
-    if (0 == location) { // should never happen, but could be double slash - TODO support double slash not absolute paths
-      start = 1;
-      location = subpath.find('/',start);
+    int64_t index = 0;
+    for (size_t i = open + 1;i < close;i++) {
+      if (part[i] < '0' || part[i] > '9') {
+        throw mlclient::InvalidFormatException("Invalid index in path: " + path);
+      }
+      index = index * 10 + (part[i] - '0');
     }
+    if (index > INT32_MAX) {
+      throw mlclient::InvalidFormatException("Invalid index in path: " + path);
+    }
+    steps.emplace_back(Step::Type::INDEX,"",(int32_t)index);
+  }
+}
+
+/**
+ * Applies a KEY or INDEX step
+ */
+DocumentNodeRef single(const Step& step,const DocumentNodeRef& node) {
+  if (Step::Type::KEY == step.type) {
+    return node.at(step.key);
   }
-  std::string curLevel = subpath.substr(start,location);
-  std::string lower = "";
-  if (location != subpath.size()) {
-    lower = subpath.substr(location + 1);
+  if (node.isArray()) {
+    return node.at(step.index);
   }
+  return (0 == step.index ? node : DocumentNodeRef()); // a single value is its own first member
+}
+
+/**
+ * Passes each node the step selects from node to visit, in document order, until visit returns false
+ *
+ * \return false if visit returned false
+ */
+template <typename Visit>
+bool each(const Step& step,const DocumentNodeRef& node,Visit visit) {
+  if (Step::Type::WILDCARD != step.type) {
+    const DocumentNodeRef child = single(step,node);
+    return child.isEmpty() || visit(child);
+  }
+  if (node.isArray()) {
+    // members() rather than at(i), which walks XML siblings from the first for every index
+    for (const DocumentNodeRef& child : node.members()) {
+      if (!child.isEmpty() && !visit(child)) {
+        return false;
+      }
+    }
+  } else if (node.isObject()) {
+    for (const std::string& key : node.keys()) {
+      const DocumentNodeRef child = node.at(key);
+      if (!child.isEmpty() && !visit(child)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Appends the nodes selected by the steps from pos onwards, stopping after the first unless all is true
+ *
+ * \return false once the search should stop
+ */
+bool collect(const std::vector<Step>& steps,const size_t pos,const DocumentNodeRef& node,
+    std::vector<DocumentNodeRef>& addTo,const bool all) {
+  if (pos == steps.size()) {
+    addTo.push_back(node);
+    return all;
+  }
+  return each(steps[pos],node,[&steps,pos,&addTo,all] (const DocumentNodeRef& child) {
+    return collect(steps,pos + 1,child,addTo,all);
+  });
+}
+
+} // end anonymous namespace
+
+
+
+class CompiledPath::Impl {
+public:
+  Impl(const std::string& p) : path(p), steps(), hasWildcard(false) {
+    parse(path,steps);
+    for (auto& step : steps) {
+      hasWildcard = hasWildcard || Step::Type::WILDCARD == step.type;
+    }
+  }
+
+  std::string path;
+  std::vector<Step> steps;
+  bool hasWildcard;
+};
+
+CompiledPath::CompiledPath() : mImpl(new Impl("")) {
+  ;
+}
+
+CompiledPath::CompiledPath(const std::string& path) : mImpl(new Impl(path)) {
+  ;
+}
+
+CompiledPath::CompiledPath(const CompiledPath& other) : mImpl(new Impl(*other.mImpl)) {
+  ;
+}
+
+CompiledPath& CompiledPath::operator=(const CompiledPath& other) {
+  if (this != &other) {
+    *mImpl = *other.mImpl;
+  }
+  return *this;
+}
+
+CompiledPath::~CompiledPath() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
+DocumentNodeRef CompiledPath::find(const DocumentNodeRef& from) const {
+  if (!mImpl->hasWildcard) {
+    DocumentNodeRef current = from;
+    for (auto step = mImpl->steps.begin();step != mImpl->steps.end() && !current.isEmpty();++step) {
+      current = single(*step,current);
+    }
+    return current;
+  }
+  std::vector<DocumentNodeRef> first;
+  if (!from.isEmpty()) {
+    collect(mImpl->steps,0,from,first,false);
+  }
+  return (first.empty() ? DocumentNodeRef() : first.front());
+}
+
+size_t CompiledPath::findAll(const DocumentNodeRef& from,std::vector<DocumentNodeRef>& addTo) const {
+  const size_t before = addTo.size();
+  if (!from.isEmpty()) {
+    collect(mImpl->steps,0,from,addTo,true);
+  }
+  return addTo.size() - before;
+}
+
+const std::string& CompiledPath::getPath() const {
+  return mImpl->path;
+}
+
+size_t CompiledPath::getStepCount() const {
+  return mImpl->steps.size();
+}
+
+
+
+class CompiledPathSet::Impl {
+public:
+  /**
+   * A step shared by every path with the same steps up to it. Node 0 is the root, and has no step.
+   */
+  struct TrieNode {
+    TrieNode(const Step& s) : step(s), children(), paths() {
+      ;
+    }
+
+    Step step;
+    std::vector<size_t> children;
+    std::vector<size_t> paths; // the paths that end here
+  };
+
+  Impl() : nodes(), count(0) {
+    nodes.emplace_back(Step(Step::Type::KEY,"",0));
+  }
+
+  size_t add(const std::vector<Step>& steps) {
+    size_t current = 0;
+    for (auto& step : steps) {
+      size_t next = 0;
+      for (size_t child : nodes[current].children) {
+        if (nodes[child].step == step) {
+          next = child;
+          break;
+        }
+      }
+      if (0 == next) {
+        next = nodes.size();
+        nodes.emplace_back(step);
+        nodes[current].children.push_back(next);
+      }
+      current = next;
+    }
+    nodes[current].paths.push_back(count);
+    return count++;
+  }
+
+  void visit(const size_t index,const DocumentNodeRef& node,std::vector<DocumentNodeRef>& results) const {
+    const TrieNode& trie = nodes[index];
+    for (size_t path : trie.paths) {
+      if (results[path].isEmpty()) {
+        results[path] = node; // the first match, in document order
+      }
+    }
+    for (size_t child : trie.children) {
+      each(nodes[child].step,node,[this,child,&results] (const DocumentNodeRef& selected) {
+        visit(child,selected,results);
+        return true;
+      });
+    }
+  }
+
+  std::vector<TrieNode> nodes;
+  size_t count;
+};
+
+CompiledPathSet::CompiledPathSet() : mImpl(new Impl) {
+  ;
+}
+
+CompiledPathSet::~CompiledPathSet() {
+  delete mImpl;
+  mImpl = nullptr;
+}
+
+size_t CompiledPathSet::add(const std::string& path) {
+  std::vector<Step> steps;
+  parse(path,steps);
+  return mImpl->add(steps);
+}
+
+size_t CompiledPathSet::add(const CompiledPath& path) {
+  return mImpl->add(path.mImpl->steps);
+}
+
+size_t CompiledPathSet::size() const {
+  return mImpl->count;
+}
 
-  IDocumentNode* child = node->at(curLevel);
-  if (lower.size() == 0) {
-      // at end of path
-      return child;
-  } else {
-      return at(child,lower);
+void CompiledPathSet::find(const DocumentNodeRef& from,std::vector<DocumentNodeRef>& results) const {
+  results.assign(mImpl->count,DocumentNodeRef());
+  if (!from.isEmpty()) {
+    mImpl->visit(0,from,results);
   }
 }
 
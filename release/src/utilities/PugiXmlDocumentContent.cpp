@@ -14,6 +14,9 @@
 #include <cstring>
 #include <sstream>
 #include <regex>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace mlclient {
 
@@ -23,6 +26,293 @@ namespace utilities {
 const std::regex RE_INTEGER("^[0-9]+$");
 const std::regex RE_DOUBLE("^[0-9]+\\.[0-9]+$");
 
+namespace {
+
+pugi::xml_node elementOf(const void* node) {
+  return pugi::xml_node(static_cast<pugi::xml_node_struct*>(const_cast<void*>(node)));
+}
+
+pugi::xml_attribute attributeOf(const void* node) {
+  return pugi::xml_attribute(static_cast<pugi::xml_attribute_struct*>(const_cast<void*>(node)));
+}
+
+bool hasElementChild(const pugi::xml_node& node) {
+  for (pugi::xml_node child: node.children()) {
+    if (pugi::xml_node_type::node_element == child.type()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isTrueText(const char* text) {
+  return strcmp(text,"true") == 0 || strcmp(text,"True") == 0 || strcmp(text,"TRUE") == 0;
+}
+
+bool matchesText(const char* text,const std::regex& re) {
+  std::smatch matches;
+  std::string str(text);
+  return std::regex_search(str,matches,re);
+}
+
+/**
+ * An element, or the document node itself, as held in a PugiXmlDocumentNode or PugiXmlObjectNode
+ */
+class XmlElementKind : public IDocumentNodeKind {
+public:
+  bool isNull(const void* node) const override {
+    return !hasElementChild(elementOf(node)) && strcmp(elementOf(node).text().get(),"") == 0;
+  }
+  bool isBoolean(const void* node) const override {
+    return isTrueText(elementOf(node).text().get());
+  }
+  bool isInteger(const void* node) const override {
+    return matchesText(elementOf(node).text().get(),RE_INTEGER);
+  }
+  bool isDouble(const void* node) const override {
+    return matchesText(elementOf(node).text().get(),RE_DOUBLE);
+  }
+  bool isString(const void* node) const override {
+    return !isInteger(node) && !isDouble(node) && !isBoolean(node) && strcmp(elementOf(node).text().get(),"") != 0;
+  }
+  bool isArray(const void* node) const override {
+    return false;
+  }
+  bool isObject(const void* node) const override {
+    return hasElementChild(elementOf(node));
+  }
+
+  bool asBoolean(const void* node) const override {
+    return elementOf(node).text().as_bool();
+  }
+  int32_t asInteger(const void* node) const override {
+    return elementOf(node).text().as_int();
+  }
+  double asDouble(const void* node) const override {
+    return elementOf(node).text().as_double();
+  }
+  std::string asString(const void* node) const override {
+    return elementOf(node).text().get();
+  }
+
+  DocumentNodeRef at(const void* node,const std::string& key) const override;
+  DocumentNodeRef at(const void* node,const int32_t idx) const override {
+    return DocumentNodeRef();
+  }
+  bool has(const void* node,const std::string& key) const override {
+    return !elementOf(node).child(key.c_str()).empty() || !elementOf(node).attribute(key.c_str()).empty();
+  }
+  StringList keys(const void* node) const override {
+    StringList names;
+    for (pugi::xml_node child: elementOf(node).children()) {
+      names.push_back(child.name());
+    }
+    for (pugi::xml_attribute attr: elementOf(node).attributes()) {
+      names.push_back(attr.name());
+    }
+    return names;
+  }
+  int32_t size(const void* node) const override {
+    return 1;
+  }
+
+  IDocumentNode* newNode(const void* node) const override;
+};
+
+/**
+ * Two or more sibling elements with the same name, held as the first of them, as in a PugiXmlArrayNode
+ */
+class XmlArrayKind : public IDocumentNodeKind {
+public:
+  bool isNull(const void* node) const override {
+    return false;
+  }
+  bool isBoolean(const void* node) const override {
+    return false;
+  }
+  bool isInteger(const void* node) const override {
+    return false;
+  }
+  bool isDouble(const void* node) const override {
+    return false;
+  }
+  bool isString(const void* node) const override {
+    return false;
+  }
+  bool isArray(const void* node) const override {
+    return true;
+  }
+  bool isObject(const void* node) const override {
+    return false;
+  }
+
+  bool asBoolean(const void* node) const override {
+    throw mlclient::InvalidFormatException("XML Array is not a boolean");
+  }
+  int32_t asInteger(const void* node) const override {
+    throw mlclient::InvalidFormatException("XML Array is not a integer");
+  }
+  double asDouble(const void* node) const override {
+    throw mlclient::InvalidFormatException("XML Array is not a double");
+  }
+  std::string asString(const void* node) const override {
+    throw mlclient::InvalidFormatException("XML Array is not a string");
+  }
+
+  DocumentNodeRef at(const void* node,const std::string& key) const override {
+    return DocumentNodeRef();
+  }
+  DocumentNodeRef at(const void* node,const int32_t idx) const override;
+  std::vector<DocumentNodeRef> members(const void* node) const override;
+  StringList keys(const void* node) const override {
+    return StringList();
+  }
+  int32_t size(const void* node) const override {
+    pugi::xml_node member = elementOf(node);
+    const char* name = member.name();
+    int32_t count = 0;
+    for (;!member.empty();member = member.next_sibling(name)) {
+      ++count;
+    }
+    return count;
+  }
+
+  IDocumentNode* newNode(const void* node) const override;
+};
+
+/**
+ * An attribute, as held in a PugiXmlAttributeNode
+ */
+class XmlAttributeKind : public IDocumentNodeKind {
+public:
+  bool isNull(const void* node) const override {
+    return strcmp(attributeOf(node).as_string(),"") == 0;
+  }
+  bool isBoolean(const void* node) const override {
+    return isTrueText(attributeOf(node).as_string());
+  }
+  bool isInteger(const void* node) const override {
+    return matchesText(attributeOf(node).as_string(),RE_INTEGER);
+  }
+  bool isDouble(const void* node) const override {
+    return matchesText(attributeOf(node).as_string(),RE_DOUBLE);
+  }
+  bool isString(const void* node) const override {
+    return !isInteger(node) && !isDouble(node) && !isBoolean(node) && strcmp(attributeOf(node).as_string(),"") != 0;
+  }
+  bool isArray(const void* node) const override {
+    return false;
+  }
+  bool isObject(const void* node) const override {
+    return false;
+  }
+
+  bool asBoolean(const void* node) const override {
+    return attributeOf(node).as_bool();
+  }
+  int32_t asInteger(const void* node) const override {
+    return attributeOf(node).as_int();
+  }
+  double asDouble(const void* node) const override {
+    return attributeOf(node).as_double();
+  }
+  std::string asString(const void* node) const override {
+    return attributeOf(node).as_string();
+  }
+
+  DocumentNodeRef at(const void* node,const std::string& key) const override {
+    return DocumentNodeRef();
+  }
+  DocumentNodeRef at(const void* node,const int32_t idx) const override {
+    return DocumentNodeRef();
+  }
+  StringList keys(const void* node) const override {
+    return StringList();
+  }
+  int32_t size(const void* node) const override {
+    return 1;
+  }
+
+  IDocumentNode* newNode(const void* node) const override;
+};
+
+const XmlElementKind ELEMENT_KIND;
+const XmlArrayKind ARRAY_KIND;
+const XmlAttributeKind ATTRIBUTE_KIND;
+
+DocumentNodeRef elementRef(const pugi::xml_node& node) {
+  return DocumentNodeRef(&ELEMENT_KIND,node.internal_object());
+}
+
+/**
+ * Finds a child as createNode() always has: a single element, else an array of same named elements, else an attribute
+ */
+DocumentNodeRef childOf(const pugi::xml_node& parent,const std::string& key) {
+  pugi::xml_node first = parent.child(key.c_str());
+  if (!first.empty()) {
+    if (first.next_sibling(key.c_str()).empty()) {
+      return DocumentNodeRef(&ELEMENT_KIND,first.internal_object());
+    }
+    return DocumentNodeRef(&ARRAY_KIND,first.internal_object());
+  }
+  return DocumentNodeRef(&ATTRIBUTE_KIND,parent.attribute(key.c_str()).internal_object());
+}
+
+DocumentNodeRef XmlElementKind::at(const void* node,const std::string& key) const {
+  return childOf(elementOf(node),key);
+}
+
+DocumentNodeRef XmlArrayKind::at(const void* node,const int32_t idx) const {
+  pugi::xml_node member = elementOf(node);
+  const char* name = member.name();
+  for (int32_t i = 0;i < idx && !member.empty();i++) {
+    member = member.next_sibling(name);
+  }
+  return DocumentNodeRef(&ELEMENT_KIND,member.internal_object());
+}
+
+std::vector<DocumentNodeRef> XmlArrayKind::members(const void* node) const {
+  std::vector<DocumentNodeRef> all;
+  pugi::xml_node member = elementOf(node);
+  const char* name = member.name();
+  for (;!member.empty();member = member.next_sibling(name)) {
+    all.push_back(DocumentNodeRef(&ELEMENT_KIND,member.internal_object()));
+  }
+  return all;
+}
+
+/**
+ * Creates the heap node for a handle, sharing ownership of doc. Returns nullptr for an empty handle.
+ * A handle from another implementation is left to that implementation.
+ */
+IDocumentNode* wrapNode(std::shared_ptr<pugi::xml_document> doc,const DocumentNodeRef& ref) {
+  if (&ELEMENT_KIND == ref.getKind()) {
+    pugi::xml_node element = elementOf(ref.getNode());
+    if (hasElementChild(element)) {
+      return new PugiXmlObjectNode(doc,element);
+    }
+    return new PugiXmlDocumentNode(doc,element);
+  } else if (&ARRAY_KIND == ref.getKind()) {
+    pugi::xml_node first = elementOf(ref.getNode());
+    return new PugiXmlArrayNode(doc,first.parent(),first.name());
+  } else if (&ATTRIBUTE_KIND == ref.getKind()) {
+    return new PugiXmlAttributeNode(doc,attributeOf(ref.getNode()));
+  }
+  return ref.newNode();
+}
+
+IDocumentNode* XmlElementKind::newNode(const void* node) const {
+  return wrapNode(std::shared_ptr<pugi::xml_document>(),DocumentNodeRef(this,node));
+}
+IDocumentNode* XmlArrayKind::newNode(const void* node) const {
+  return wrapNode(std::shared_ptr<pugi::xml_document>(),DocumentNodeRef(this,node));
+}
+IDocumentNode* XmlAttributeKind::newNode(const void* node) const {
+  return wrapNode(std::shared_ptr<pugi::xml_document>(),DocumentNodeRef(this,node));
+}
+
+} // end anonymous namespace
+
 PugiXmlContainerNode::PugiXmlContainerNode() {
   ;
 }
@@ -47,20 +337,20 @@ bool PugiXmlContainerNode::isString() const {
 }
 
 bool PugiXmlContainerNode::asBoolean() const {
-  throw new mlclient::InvalidFormatException("XML Container is not a boolean");
+  throw mlclient::InvalidFormatException("XML Container is not a boolean");
 }
 int32_t PugiXmlContainerNode::asInteger() const {
-  throw new mlclient::InvalidFormatException("XML Container is not a integer");
+  throw mlclient::InvalidFormatException("XML Container is not a integer");
 }
 double PugiXmlContainerNode::asDouble() const {
-  throw new mlclient::InvalidFormatException("XML Container is not a double");
+  throw mlclient::InvalidFormatException("XML Container is not a double");
 }
 std::string PugiXmlContainerNode::asString() const {
-  throw new mlclient::InvalidFormatException("XML Container is not a string");
+  throw mlclient::InvalidFormatException("XML Container is not a string");
 }
 
 IDocumentContent* PugiXmlContainerNode::getChildContent() const {
-  throw new mlclient::InvalidFormatException("XML Container is not a string");
+  throw mlclient::InvalidFormatException("XML Container is not a string");
 }
 
 
@@ -70,12 +360,29 @@ IDocumentContent* PugiXmlContainerNode::getChildContent() const {
 
 class PugiXmlArrayNode::Impl {
 public:
-  Impl(std::shared_ptr<pugi::xml_document> doc,const pugi::xml_node& parent,const std::string& key) : doc(doc),parent(parent), key(key) {
+  Impl(std::shared_ptr<pugi::xml_document> doc,const pugi::xml_node& parent,const std::string& key) : doc(doc),parent(parent), key(key),
+    indexOnce(), members() {
     ;
   };
+
+  /**
+   * Lists the members in one pass on first use, so at() and size() are O(1) rather than walking the siblings each call
+   */
+  const std::vector<pugi::xml_node>& index() {
+    std::call_once(indexOnce,[this] () {
+      for (pugi::xml_node member = parent.child(key.c_str());!member.empty();member = member.next_sibling(key.c_str())) {
+        members.push_back(member);
+      }
+    });
+    return members;
+  }
+
   std::shared_ptr<pugi::xml_document> doc;
   pugi::xml_node parent;
   std::string key;
+
+  std::once_flag indexOnce;
+  std::vector<pugi::xml_node> members;
 };
 
 
@@ -106,48 +413,79 @@ IDocumentNode* PugiXmlArrayNode::at(const std::string& key) const {
   throw mlclient::InvalidFormatException("XML Array does not support string key subscripts");
 }
 IDocumentNode* PugiXmlArrayNode::at(const int32_t idx) const {
-  const auto& children = mImpl->parent.children(mImpl->key.c_str());
-  pugi::xml_named_node_iterator iter = children.begin();
-  const auto& end = children.end();
-  int32_t i = 0;
-  for (;i <= idx && iter != end;++iter) {
-    if (i == idx) {
-      return new PugiXmlDocumentNode(mImpl->doc,*iter);
-    }
-    i++;
+  const std::vector<pugi::xml_node>& members = mImpl->index();
+  if (idx < 0 || (size_t)idx >= members.size()) {
+    return nullptr;
   }
-  return nullptr;
+  return new PugiXmlDocumentNode(mImpl->doc,members[idx]);
 }
 
 bool PugiXmlArrayNode::has(const std::string& key) const {
   throw mlclient::InvalidFormatException("XML Array does not support string key subscripts");
 }
+IDocumentNode* PugiXmlArrayNode::tryAt(const std::string& key) const {
+  return nullptr;
+}
+IDocumentNode* PugiXmlArrayNode::tryAt(const int32_t idx) const {
+  return (idx < 0 ? nullptr : at(idx)); // at() returns nullptr beyond the last member
+}
+DocumentNodeRef PugiXmlArrayNode::ref() const {
+  const std::vector<pugi::xml_node>& members = mImpl->index();
+  return (members.empty() ? DocumentNodeRef() : DocumentNodeRef(&ARRAY_KIND,members.front().internal_object()));
+}
+
+IDocumentNode* PugiXmlArrayNode::newNode(const DocumentNodeRef& ref) const {
+  return wrapNode(mImpl->doc,ref);
+}
 
 StringList PugiXmlArrayNode::keys() const {
   throw mlclient::InvalidFormatException("XML Array does not support string key subscripts");
 }
 
 int32_t PugiXmlArrayNode::size() const {
-  const auto& children = mImpl->parent.children(mImpl->key.c_str());
-  pugi::xml_named_node_iterator iter = children.begin();
-  const auto& end = children.end();
-  int32_t i = 0;
-  for (;iter != end;++iter) {
-    i++;
-  }
-  return i;
+  return mImpl->index().size();
 }
 
 
 
 class PugiXmlObjectNode::Impl {
 public:
-  Impl(std::shared_ptr<pugi::xml_document> doc,const pugi::xml_node& obj) : doc(doc),obj(obj) {
+  Impl(std::shared_ptr<pugi::xml_document> doc,const pugi::xml_node& obj) : doc(doc),obj(obj), indexOnce(), children() {
     ;
   };
 
+  /**
+   * Groups the child elements by name in one pass on first use, so has() and at() do not scan every child each call
+   */
+  const std::unordered_map<std::string,std::vector<pugi::xml_node>>& index() {
+    std::call_once(indexOnce,[this] () {
+      for (pugi::xml_node child: obj.children()) {
+        if (pugi::xml_node_type::node_element == child.type()) {
+          children[child.name()].push_back(child);
+        }
+      }
+    });
+    return children;
+  }
+
+  /**
+   * Finds a child as createNode() does, using the index
+   */
+  DocumentNodeRef childRef(const std::string& key) {
+    const auto& byName = index();
+    auto found = byName.find(key);
+    if (byName.end() == found) {
+      return DocumentNodeRef(&ATTRIBUTE_KIND,obj.attribute(key.c_str()).internal_object());
+    }
+    return DocumentNodeRef(1 == found->second.size() ? (const IDocumentNodeKind*)&ELEMENT_KIND : &ARRAY_KIND,
+        found->second.front().internal_object());
+  }
+
   std::shared_ptr<pugi::xml_document> doc;
   pugi::xml_node obj;
+
+  std::once_flag indexOnce;
+  std::unordered_map<std::string,std::vector<pugi::xml_node>> children;
 };
 
 PugiXmlObjectNode::PugiXmlObjectNode(std::shared_ptr<pugi::xml_document> doc,const pugi::xml_node& obj) : mImpl(new Impl(doc,obj)) {
@@ -173,19 +511,31 @@ IDocumentNode* PugiXmlObjectNode::asObject() const {
 
 IDocumentNode* PugiXmlObjectNode::at(const std::string& key) const {
   LOG(DEBUG) << "at(" << key << ") called on '" << mImpl->obj.name() << "' of type: " << mImpl->obj.type();
-  return mlclient::utilities::createNode(mImpl->doc,mImpl->obj,key); // TODO ensure this returns attributes and not just elements
+  DocumentNodeRef child = mImpl->childRef(key);
+  if (child.isEmpty()) {
+    return new PugiXmlArrayNode(mImpl->doc,mImpl->obj,key); // empty, as createNode() returns
+  }
+  return wrapNode(mImpl->doc,child);
 }
 IDocumentNode* PugiXmlObjectNode::at(const int32_t idx) const {
   throw mlclient::InvalidFormatException("XML Container Object does not support integer subscripts");
 }
 
 bool PugiXmlObjectNode::has(const std::string& key) const {
-  for (pugi::xml_node child: mImpl->obj.children()) {
-    if (child.name() == key) {
-      return true;
-    }
-  }
-  return false;
+  return mImpl->index().count(key) > 0;
+}
+IDocumentNode* PugiXmlObjectNode::tryAt(const std::string& key) const {
+  return wrapNode(mImpl->doc,mImpl->childRef(key));
+}
+IDocumentNode* PugiXmlObjectNode::tryAt(const int32_t idx) const {
+  return nullptr;
+}
+DocumentNodeRef PugiXmlObjectNode::ref() const {
+  return elementRef(mImpl->obj);
+}
+
+IDocumentNode* PugiXmlObjectNode::newNode(const DocumentNodeRef& ref) const {
+  return wrapNode(mImpl->doc,ref);
 }
 
 StringList PugiXmlObjectNode::keys() const {
@@ -306,6 +656,22 @@ IDocumentNode* PugiXmlAttributeNode::at(const int32_t idx) const {
   throw mlclient::InvalidFormatException("XML attribute Object does not support integer subscripts");
 }
 
+IDocumentNode* PugiXmlAttributeNode::tryAt(const std::string& key) const {
+  return nullptr;
+}
+
+IDocumentNode* PugiXmlAttributeNode::tryAt(const int32_t idx) const {
+  return nullptr;
+}
+
+DocumentNodeRef PugiXmlAttributeNode::ref() const {
+  return DocumentNodeRef(&ATTRIBUTE_KIND,mImpl->attr.internal_object());
+}
+
+IDocumentNode* PugiXmlAttributeNode::newNode(const DocumentNodeRef& ref) const {
+  return wrapNode(mImpl->doc,ref);
+}
+
 StringList PugiXmlAttributeNode::keys() const {
   StringList names;
   return names;
@@ -424,6 +790,22 @@ bool PugiXmlDocumentNode::has(const std::string& key) const {
   return false;
 }
 
+IDocumentNode* PugiXmlDocumentNode::tryAt(const std::string& key) const {
+  return wrapNode(mImpl->doc,ref().at(key));
+}
+
+IDocumentNode* PugiXmlDocumentNode::tryAt(const int32_t idx) const {
+  return nullptr; // not an array
+}
+
+DocumentNodeRef PugiXmlDocumentNode::ref() const {
+  return elementRef(mImpl->root);
+}
+
+IDocumentNode* PugiXmlDocumentNode::newNode(const DocumentNodeRef& ref) const {
+  return wrapNode(mImpl->doc,ref);
+}
+
 IDocumentNode* PugiXmlDocumentNode::at(const int32_t idx) const {
   const auto& iter = mImpl->root.children().begin();
   const auto& end = mImpl->root.children().end();
@@ -475,39 +857,12 @@ IDocumentContent* PugiXmlDocumentNode::getChildContent() const {
 
 IDocumentNode* createNode(std::shared_ptr<pugi::xml_document> doc,pugi::xml_node& parent,const std::string& key) {
   LOG(DEBUG) << "Trying to find child node or element named: " << key;
-  const auto& range = parent.children(key.c_str());
-  if (range.begin() == range.end() || (++(range.begin())) == range.end()) {
-    // Could be an Object or a String
-    bool isObject = false;
-    pugi::xml_node child = parent.child(key.c_str());
-    if (nullptr != child) {
-      const auto& childRange = child.children();
-      for (pugi::xml_node_iterator iter = childRange.begin();iter != childRange.end();++iter) {
-        isObject = isObject || iter->type() == pugi::xml_node_type::node_element;
-      }
-      if (isObject) {
-        LOG(DEBUG) << " This node is a Pugi XML object node (has one or more element children)";
-        return new PugiXmlObjectNode(doc,child);
-      }
-      LOG(DEBUG) << "Found an element with a single child of '" << key << "', creating PugiXmlDocumentNode...";
-      return new PugiXmlDocumentNode(doc,child);
-    } else {
-      LOG(DEBUG) << "No child with name '" << key << "'";
-    }
+  DocumentNodeRef child = childOf(parent,key);
+  if (child.isEmpty()) {
+    LOG(DEBUG) << "No child or attribute with name '" << key << "', creating an empty PugiXmlArrayNode...";
+    return new PugiXmlArrayNode(doc,parent,key);
   }
-  // May not have been found - check attributes
-  const auto& attr = parent.attribute(key.c_str());
-  if (nullptr != attr) {
-    LOG(DEBUG) << "Found an XML attribute";
-    return new PugiXmlAttributeNode(doc,attr);
-  }
-  // is an object if one or more children are themselves nodes
-  LOG(DEBUG) << "Found an element with multiple children of '" << key << "', creating PugiXmlArrayNode...";
-  //for (pugi::xml_named_node_iterator iter = range.begin();iter != range.end();++iter) {
-  //  LOG(DEBUG) << "  Child type: " << iter->type() << " name: " << iter->name();
-  //}
-  // is array
-  return new PugiXmlArrayNode(doc,parent,key);
+  return wrapNode(doc,child);
 }
 
 
@@ -562,38 +917,27 @@ bool PugiXmlDocumentNavigator::has(const std::string& key) const {
   return false;
 }
 
-IDocumentNode* PugiXmlDocumentNavigator::at(const std::string& key) const {
-  if (!mImpl->firstElementAsRoot) {
-    return new PugiXmlDocumentNode(mImpl->root,mImpl->root->root().child(key.c_str()));
-  }
-  // else call child on the top level element
-  const auto& range = mImpl->root->children();
-  int childCount = 0;
-  for (pugi::xml_node_iterator iter = range.begin();iter != range.end();++(iter)) {
-    if (pugi::xml_node_type::node_element == iter->type()) {
-      const pugi::xml_node& chNode = iter->child(key.c_str());
-      if (nullptr != chNode) {
-        childCount++;
-        while (nullptr != (const_cast<pugi::xml_node&>(chNode) = chNode.next_sibling(key.c_str()))) {
-          childCount++;
-        }
-      }
-    }
-  }
-  LOG(DEBUG) << "Child element count for " << key << " is " << childCount;
-  if (1 == childCount) {
-    return new PugiXmlDocumentNode(mImpl->root,range.begin()->child(key.c_str()));
-  } else if (childCount > 1) {
-    return new PugiXmlArrayNode(mImpl->root,mImpl->root->first_child(),key);
-  }
-  const pugi::xml_attribute& attr = mImpl->root->first_child().attribute(key.c_str());
-  if (nullptr != attr) {
-    LOG(DEBUG) << "Found attribute under root document element";
-    return new PugiXmlAttributeNode(mImpl->root,attr);
+IDocumentNode* PugiXmlDocumentNavigator::tryAt(const std::string& key) const {
+  return wrapNode(mImpl->root,ref().at(key));
+}
+
+DocumentNodeRef PugiXmlDocumentNavigator::ref() const {
+  if (mImpl->firstElementAsRoot) {
+    return elementRef(mImpl->root->document_element());
   }
-  return nullptr; // empty XML document
+  return elementRef(*mImpl->root);
+}
 
-  //return new PugiXmlDocumentNode(mImpl->root.root(),key);
+IDocumentNode* PugiXmlDocumentNavigator::newNode(const DocumentNodeRef& ref) const {
+  return wrapNode(mImpl->root,ref);
+}
+
+IDocumentNode* PugiXmlDocumentNavigator::at(const std::string& key) const {
+  DocumentNodeRef child = ref().at(key);
+  if (child.isEmpty() && !mImpl->firstElementAsRoot) {
+    return new PugiXmlDocumentNode(mImpl->root,pugi::xml_node()); // a null node, as before
+  }
+  return wrapNode(mImpl->root,child); // nullptr if not found below the first element
 }
 
 
@@ -605,14 +949,43 @@ IDocumentNode* PugiXmlDocumentNavigator::at(const std::string& key) const {
 
 class PugiXmlDocumentContent::Impl {
 public:
-  Impl() : value(std::make_shared<pugi::xml_document>()), mimeType(IDocumentContent::MIME_XML) {
+  Impl() : value(std::make_shared<pugi::xml_document>()), mimeType(IDocumentContent::MIME_XML), serializedMutex(),
+    serialized(), dirty(true) {
     TIMED_FUNC(PugiXmlDocumentContent_Impl_defaultConstructor);
   };
   ~Impl() {
     TIMED_FUNC(PugiXmlDocumentContent_Impl_destructor);
   };
+
+  /**
+   * Returns the serialised tree, serialising it only if it has changed since it was last serialised
+   */
+  std::shared_ptr<const std::string> getSerialized() {
+    std::lock_guard<std::mutex> lock(serializedMutex);
+    if (dirty) {
+      std::ostringstream os;
+      value->print(os,""); // serialises the tree, as an in place parsed buffer no longer holds the text
+      serialized = std::make_shared<const std::string>(os.str());
+      dirty = false;
+    }
+    return serialized;
+  }
+
+  /**
+   * Called on every change to value
+   */
+  void changed() {
+    std::lock_guard<std::mutex> lock(serializedMutex);
+    dirty = true;
+    serialized.reset(); // frees the stale text now, unless a view or stream still shares it
+  }
+
   std::shared_ptr<pugi::xml_document> value;
   std::string mimeType;
+
+  std::mutex serializedMutex; // const functions may be called from several threads
+  std::shared_ptr<const std::string> serialized; // replaced, never modified, as views and streams share it
+  bool dirty;
 };
 
 PugiXmlDocumentContent::PugiXmlDocumentContent() : mImpl(new Impl) {
@@ -626,12 +999,7 @@ PugiXmlDocumentContent::~PugiXmlDocumentContent() {
 
 std::istream* PugiXmlDocumentContent::getStream() const {
   TIMED_FUNC(PugiXmlDocumentContent_getStream);
-  std::ostringstream* os = new std::ostringstream;
-  //(*os) << mImpl->value;
-  mImpl->value->save(*os);
-  std::istringstream* is = new std::istringstream(os->str());
-  delete os;
-  return is;
+  return contentView().openStream();
 }
 
 const pugi::xml_document& PugiXmlDocumentContent::getXml() const {
@@ -642,6 +1010,15 @@ const pugi::xml_document& PugiXmlDocumentContent::getXml() const {
 void PugiXmlDocumentContent::setContent(std::shared_ptr<pugi::xml_document> xml) {
   TIMED_FUNC(PugiXmlDocumentContent_setContent);
   mImpl->value = xml; // move constructor
+  mImpl->changed();
+}
+
+ContentView PugiXmlDocumentContent::contentView() const {
+  return ContentView(mImpl->getSerialized());
+}
+
+size_t PugiXmlDocumentContent::size() const {
+  return mImpl->getSerialized()->size();
 }
 
 std::string PugiXmlDocumentContent::getMimeType() const {
@@ -653,7 +1030,7 @@ void PugiXmlDocumentContent::setMimeType(const std::string& mt) {
 }
 
 int PugiXmlDocumentContent::getLength() const {
-  return getContent().size();
+  return mImpl->getSerialized()->size();
 }
 
 void PugiXmlDocumentContent::setContent(std::string content) {
@@ -663,28 +1040,17 @@ void PugiXmlDocumentContent::setContent(std::string content) {
   std::shared_ptr<pugi::xml_document> doc = std::make_shared<pugi::xml_document>();
   doc->load_string(os.str().c_str());
   mImpl->value = std::move(doc);
+  mImpl->changed();
 }
 
 std::string PugiXmlDocumentContent::getContent() const {
   TIMED_FUNC(PugiXmlDocumentContent_getContent);
-  std::ostringstream os;
-  //os << mImpl->value;
-  os << *(mImpl->value);
-  return os.str();
+  return *mImpl->getSerialized();
 }
 
 IDocumentNavigator* PugiXmlDocumentContent::navigate(bool firstElementAsRoot) const {
-  std::shared_ptr<pugi::xml_document> doc = std::make_shared<pugi::xml_document>();
-  //doc.append_copy(mImpl->value);
-  /*
-  for (pugi::xml_node child = mImpl->value.first_child(); child; child = child.next_sibling()) {
-    doc.append_copy(child);
-  }
-  */
-  std::ostringstream oss;
-  mImpl->value->print(oss);
-  doc->load_string(oss.str().c_str());
-  return new PugiXmlDocumentNavigator(doc,firstElementAsRoot);
+  // shares the parsed tree (and any in place buffer it owns) rather than printing and reparsing it
+  return new PugiXmlDocumentNavigator(mImpl->value,firstElementAsRoot);
 }
 
 
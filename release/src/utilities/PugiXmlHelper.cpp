@@ -22,9 +22,9 @@
 #include "mlclient/DocumentContent.hpp"
 #include "mlclient/Response.hpp"
 #include "mlclient/InvalidFormatException.hpp"
+#include <memory>
 #include <string>
 #include <sstream>
-#include <iostream>
 #include "mlclient/ext/pugixml/pugixml.hpp"
 
 #include "mlclient/logging.hpp"
@@ -33,6 +33,31 @@ namespace mlclient {
 
 namespace utilities {
 
+namespace {
+
+/**
+ * A parsed document and the buffer it was parsed in, which its node names and text point in to
+ */
+struct InPlaceXml {
+  InPlaceXml(std::string&& buffer) : buffer(std::move(buffer)), doc() {
+    ;
+  }
+  std::string buffer;
+  pugi::xml_document doc; // destroyed before buffer
+};
+
+/**
+ * Logs a pugixml parse failure, and describes it as an exception to throw
+ */
+InvalidFormatException parseError(const pugi::xml_parse_result& result) {
+  LOG(DEBUG) << "XML parsed with errors. Description: " << result.description() << ", offset: " << result.offset;
+  std::ostringstream msg;
+  msg << "XML parse error at offset " << result.offset << ": " << result.description();
+  return InvalidFormatException(msg.str());
+}
+
+} // end anonymous namespace
+
 // DocumentContent conversion
 ITextDocumentContent* PugiXmlHelper::toDocument(std::unique_ptr<pugi::xml_document> dc) {
   TIMED_FUNC(PugiXmlHelper_toDocument_xmldocument);
@@ -54,25 +79,29 @@ ITextDocumentContent* PugiXmlHelper::toDocument(const Response& resp) {
   return toDocument(std::move(fromResponse(resp)));
 }
 
+ITextDocumentContent* PugiXmlHelper::toDocumentInPlace(Response& resp) {
+  TIMED_FUNC(PugiXmlHelper_toDocumentInPlace);
+  std::shared_ptr<pugi::xml_document> doc(fromResponseInPlace(resp)); // parsed first, so a failure leaks nothing
+  PugiXmlDocumentContent* tdc = new PugiXmlDocumentContent;
+  tdc->setContent(doc);
+  tdc->setMimeType(IDocumentContent::MIME_XML);
+  return tdc;
+}
+
 std::unique_ptr<pugi::xml_document> PugiXmlHelper::fromDocument(const IDocumentContent& dc) {
   TIMED_FUNC(PugiXmlHelper_fromDocument);
   // TODO handle invalid cast exception
 
-  std::ostringstream os;
-  os << dc.getStream()->get();
+  const ContentView text = dc.contentView(); // kept whilst parsing, as a shared default view owns its copy
 
   //pugi::xml_document* doc = new pugi::xml_document;
   std::unique_ptr<pugi::xml_document> doc = mlclient::make_unique<pugi::xml_document>();
-  pugi::xml_parse_result result = doc->load_string(os.str().c_str());
+  pugi::xml_parse_result result = doc->load_buffer(text.data(),text.size());
 
-  if (result) {
-    return doc;
-  } else {
-    std::cout << "XML [" << os.str() << "] parsed with errors]\n";
-    std::cout << "Error description: " << result.description() << "\n";
-    std::cout << "Error offset: " << result.offset << " (error at [..." << os.str() << "]\n\n";
-    throw new InvalidFormatException;
+  if (!result) {
+    throw parseError(result);
   }
+  return doc;
 }
 
 // Response conversion
@@ -83,17 +112,31 @@ std::unique_ptr<pugi::xml_document> PugiXmlHelper::fromResponse(const Response&
     std::unique_ptr<pugi::xml_document> doc = mlclient::make_unique<pugi::xml_document>();
     pugi::xml_parse_result result = doc->load_string(resp.getContent().c_str());
 
-    if (result) {
-      return doc;
-    } else {
-      std::cout << "XML [" << resp.getContent() << "] parsed with errors]\n";
-      std::cout << "Error description: " << result.description() << "\n";
-      std::cout << "Error offset: " << result.offset << " (error at [..." << resp.getContent() << "]\n\n";
-      throw new InvalidFormatException;
+    if (!result) {
+      throw parseError(result);
     }
+    return doc;
   } else {
-    throw new InvalidFormatException;
+    throw InvalidFormatException("Response is not XML");
+  }
+}
+
+std::shared_ptr<pugi::xml_document> PugiXmlHelper::fromResponseInPlace(Response& resp) {
+  TIMED_FUNC(PugiXmlHelper_fromResponseInPlace);
+  if (resp.getResponseType() != ResponseType::XML) {
+    throw InvalidFormatException("Response is not XML");
+  }
+  std::shared_ptr<InPlaceXml> holder = std::make_shared<InPlaceXml>(resp.releaseContent());
+  // load_buffer_inplace needs a mutable buffer, and leaves it unusable as text afterwards
+  pugi::xml_parse_result result = holder->doc.load_buffer_inplace(
+      holder->buffer.empty() ? nullptr : &holder->buffer[0],holder->buffer.size());
+  if (!result) {
+    holder->doc.reset(); // drops pointers in to the buffer before it is handed back
+    resp.setContent(std::move(holder->buffer));
+    throw parseError(result);
   }
+  // shares ownership of holder, so the buffer lives as long as the document
+  return std::shared_ptr<pugi::xml_document>(holder,&holder->doc);
 }
 
 } // end namespace utilities
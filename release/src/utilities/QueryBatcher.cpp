@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) MarkLogic Corporation. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * \file QueryBatcher.cpp
+ *
+ * \date 2026-10-18
+ * \author adamfowler
+ */
+
+#include <mlclient/utilities/QueryBatcher.hpp>
+#include <mlclient/utilities/DocumentHelper.hpp>
+#include <mlclient/utilities/CppRestJsonHelper.hpp>
+#include <mlclient/utilities/ResponseHelper.hpp>
+#include <mlclient/DocumentContent.hpp>
+#include <mlclient/Response.hpp>
+#include <mlclient/logging.hpp>
+#include <mlclient/InvalidFormatException.hpp>
+#include <mlclient/mlclient.hpp>
+
+// We can use the following, because cpprest is an internal API dependency
+#include <cpprest/http_client.h>
+#include <cpprest/json.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace mlclient {
+
+namespace utilities {
+
+QueryBatch::QueryBatch() : sequence(0), uris(), documents(), success(true), problem(), message(), attempts(0) {
+  ;
+}
+
+QueryBatch::QueryBatch(long seq,DocumentUriSet&& u) : sequence(seq), uris(std::move(u)), documents(), success(true),
+    problem(), message(), attempts(0) {
+  ;
+}
+
+QueryBatch::QueryBatch(QueryBatch&& other) : sequence(other.sequence), uris(std::move(other.uris)),
+    documents(std::move(other.documents)), success(other.success), problem(std::move(other.problem)),
+    message(std::move(other.message)), attempts(other.attempts) {
+  other.documents.clear();
+}
+
+QueryBatch& QueryBatch::operator=(QueryBatch&& other) {
+  clearDocuments();
+  sequence = other.sequence;
+  uris = std::move(other.uris);
+  documents = std::move(other.documents);
+  other.documents.clear();
+  success = other.success;
+  problem = std::move(other.problem);
+  message = std::move(other.message);
+  attempts = other.attempts;
+  return *this;
+}
+
+QueryBatch::~QueryBatch() {
+  clearDocuments();
+}
+
+void QueryBatch::clearDocuments() {
+  for (auto& doc : documents) {
+    delete doc.getContent();
+  }
+  documents.clear();
+}
+
+long QueryBatch::getSequence() const {
+  return sequence;
+}
+
+const DocumentUriSet& QueryBatch::getUris() const {
+  return uris;
+}
+
+const DocumentSet& QueryBatch::getDocuments() const {
+  return documents;
+}
+
+DocumentSet QueryBatch::releaseDocuments() {
+  DocumentSet released(std::move(documents));
+  documents.clear();
+  return released;
+}
+
+bool QueryBatch::isSuccess() const {
+  return success;
+}
+
+std::exception_ptr QueryBatch::getProblem() const {
+  return problem;
+}
+
+const std::string& QueryBatch::getMessage() const {
+  return message;
+}
+
+int QueryBatch::getAttempts() const {
+  return attempts;
+}
+
+
+
+IQueryBatchNotifiable::~IQueryBatchNotifiable() {
+  ;
+}
+
+
+
+class QueryBatcher::Impl {
+public:
+  Impl(IConnection* conn) : mConn(conn), desc(new SearchDescription), parallelTasks(5), batchSize(100),
+      maxRetries(3), fetchDocuments(true), toNotify(), toNotifyMtx(), fetchConnections(), idleConnections(),
+      connectionMutex(), connectionFree(), pointInTime(true), timestamp(), pinMutex(), pinned(false), tasks(),
+      nextPage(0), lastPage(-1), total(0), completed(0), failedBatches(0), cancelled(false), exhausted(false),
+      listFailed(false), startTime(1) {
+    ;
+  }
+
+  ~Impl() {
+    cancelled = true;
+    waitAll();
+  }
+
+  long now() const {
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+    return millis.count();
+  }
+
+  void waitAll() const {
+    for (auto& task : tasks) {
+      task.wait();
+    }
+  }
+
+  /**
+   * Takes a connection for one request. Without fetch connections this is the batcher's own connection, which
+   * sends one request at a time. Otherwise waits until one of the fetch connections is idle.
+   */
+  IConnection* acquireConnection() {
+    if (fetchConnections.empty()) {
+      return mConn;
+    }
+    std::unique_lock<std::mutex> lock(connectionMutex);
+    connectionFree.wait(lock,[this] { return !idleConnections.empty(); });
+    IConnection* conn = idleConnections.back();
+    idleConnections.pop_back();
+    return conn;
+  }
+
+  void releaseConnection(IConnection* conn) {
+    if (fetchConnections.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(connectionMutex);
+      idleConnections.push_back(conn);
+    }
+    connectionFree.notify_one();
+  }
+
+  /**
+   * Sends one request on an idle connection, releasing it whether or not the request throws
+   */
+  Response* withConnection(std::function<Response*(IConnection*)> request) {
+    IConnection* conn = acquireConnection();
+    try {
+      Response* resp = request(conn);
+      releaseConnection(conn);
+      return resp;
+    } catch (...) {
+      releaseConnection(conn);
+      throw;
+    }
+  }
+
+  /**
+   * Lists the URIs on the given zero based page of the query results
+   */
+  DocumentUriSet listUris(long page) {
+    TIMED_FUNC(QueryBatcher_listUris);
+    // until a listing has returned the timestamp, list one page at a time, so every page is read at that timestamp
+    std::unique_lock<std::mutex> pinLock(pinMutex,std::defer_lock);
+    if (!pinned) {
+      pinLock.lock();
+    }
+    SearchDescription pageDesc(*desc);
+    pageDesc.setStart((page * batchSize) + 1);
+    pageDesc.setPageLength(batchSize);
+    pageDesc.setResponseMimeType(IDocumentContent::MIME_JSON);
+    if (pinned && !timestamp.empty()) {
+      pageDesc.setTimestamp(timestamp);
+    }
+
+    std::unique_ptr<Response> resp(withConnection([&pageDesc] (IConnection* conn) { return conn->search(pageDesc); }));
+    if (nullptr == resp.get() || ResponseCode::OK != resp->getResponseCode()) {
+      std::ostringstream os;
+      os << "Could not list URIs for page " << page;
+      if (nullptr != resp.get()) {
+        os << ", response code: " << resp->getResponseCode();
+      }
+      throw InvalidFormatException(os.str());
+    }
+
+    if (!pinned) {
+      timestamp = ResponseHelper::getEffectiveTimestamp(*resp); // blank if not sent, so the latest state is read
+      pinned = true;
+      LOG(DEBUG) << "QueryBatcher: listing pages at timestamp " << timestamp;
+    }
+
+    const web::json::value json(CppRestJsonHelper::fromResponse(*resp));
+    if (json.has_field(U("total"))) {
+      long newTotal = json.at(U("total")).as_integer();
+      if (newTotal > total) {
+        total = newTotal;
+      }
+    }
+    DocumentUriSet uris;
+    if (json.has_field(U("results"))) {
+      for (auto& result : json.at(U("results")).as_array()) {
+        uris.push_back(utility::conversions::to_utf8string(result.at(U("uri")).as_string()));
+      }
+    }
+    return uris;
+  }
+
+  /**
+   * Reads the documents for the batch's URIs in to the batch
+   */
+  void readDocuments(QueryBatch& batch) {
+    TIMED_FUNC(QueryBatcher_readDocuments);
+    batch.clearDocuments();
+    std::unique_ptr<Response> resp(withConnection([&batch] (IConnection* conn) {
+      return conn->getDocuments(batch.uris,0,batch.uris.size() - 1);
+    }));
+    if (nullptr == resp.get() || ResponseCode::OK != resp->getResponseCode()) {
+      std::ostringstream os;
+      os << "Could not read documents for batch " << batch.sequence;
+      if (nullptr != resp.get()) {
+        os << ", response code: " << resp->getResponseCode();
+      }
+      throw InvalidFormatException(os.str());
+    }
+    DocumentHelper::fromMultipartResponse(*resp,batch.documents);
+  }
+
+  void backoff(int attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100 * attempt));
+  }
+
+  /**
+   * Lists, reads and notifies one page. Returns false when there are no more pages to claim.
+   */
+  bool processNextPage() {
+    long page = nextPage++;
+    long knownLast = lastPage;
+    if (-1 != knownLast && page > knownLast) {
+      return false;
+    }
+
+    // list URIs, with retries. If a page cannot be listed we cannot tell where the results end, so stop
+    DocumentUriSet uris;
+    std::exception_ptr listProblem;
+    int attempt = 0;
+    for (attempt = 1;attempt <= maxRetries + 1;attempt++) {
+      try {
+        uris = listUris(page);
+        listProblem = std::exception_ptr();
+        break;
+      } catch (std::exception& ex) {
+        LOG(DEBUG) << "QueryBatcher: failed to list page " << page << " on attempt " << attempt << ": " << ex.what();
+        listProblem = std::current_exception();
+        if (attempt <= maxRetries) {
+          backoff(attempt);
+        }
+      }
+    }
+    if (listProblem) {
+      ++failedBatches;
+      listFailed = true;
+      exhausted = true;
+      QueryBatch failed(page,DocumentUriSet());
+      failed.success = false;
+      failed.problem = listProblem;
+      failed.attempts = attempt - 1;
+      setMessage(failed);
+      notify(failed);
+      return false;
+    }
+    if (uris.size() < (size_t)batchSize) {
+      markLastPage(page);
+    }
+    if (uris.empty()) {
+      return false;
+    }
+
+    QueryBatch batch(page,std::move(uris));
+    batch.attempts = 1;
+    if (fetchDocuments) {
+      for (attempt = 1;attempt <= maxRetries + 1;attempt++) {
+        batch.attempts = attempt;
+        try {
+          readDocuments(batch);
+          batch.success = true;
+          batch.problem = std::exception_ptr();
+          break;
+        } catch (std::exception& ex) {
+          LOG(DEBUG) << "QueryBatcher: failed to read batch " << page << " on attempt " << attempt << ": " << ex.what();
+          batch.success = false;
+          batch.problem = std::current_exception();
+          if (attempt <= maxRetries) {
+            backoff(attempt);
+          }
+        }
+      }
+    }
+    if (!batch.success) {
+      ++failedBatches;
+      setMessage(batch);
+    }
+    completed += batch.uris.size();
+    notify(batch);
+    return true;
+  }
+
+  void markLastPage(long page) {
+    std::unique_lock<std::mutex> lck(toNotifyMtx);
+    if (-1 == lastPage || page < lastPage) {
+      lastPage = page;
+    }
+    exhausted = true;
+  }
+
+  void setMessage(QueryBatch& batch) {
+    try {
+      std::rethrow_exception(batch.problem);
+    } catch (std::exception& ex) {
+      batch.message = ex.what();
+    } catch (...) {
+      batch.message = "Unknown exception";
+    }
+  }
+
+  void notify(QueryBatch& batch) {
+    std::vector<IQueryBatchNotifiable*> listeners;
+    {
+      std::unique_lock<std::mutex> lck(toNotifyMtx);
+      listeners = toNotify; // pointers only
+    }
+    for (auto& tell : listeners) {
+      try {
+        tell->queryBatchComplete(batch);
+      } catch (std::exception& ex) {
+        LOG(DEBUG) << "Exception thrown by query batch listener: " << ex.what();
+      } catch (...) {
+        LOG(DEBUG) << "Unknown exception thrown by query batch listener";
+      }
+    }
+  }
+
+  void begin() {
+    if (!tasks.empty()) {
+      return; // stop starting the work twice
+    }
+    startTime = now();
+    timestamp = desc->getTimestamp();
+    pinned = !pointInTime || !timestamp.empty();
+    LOG(DEBUG) << "QueryBatcher: starting " << parallelTasks << " tasks with batch size " << batchSize;
+    Impl& refImpl(*this);
+    for (long i = 0;i < parallelTasks;i++) {
+      tasks.push_back(pplx::task<void>([&refImpl,i] () {
+        LOG(DEBUG) << "Began query batcher task... " << i;
+        while (!refImpl.cancelled && refImpl.processNextPage()) {
+          ;
+        }
+        LOG(DEBUG) << "End query batcher task: " << i;
+      }));
+    }
+  }
+
+  Progress progress() const {
+    Progress p;
+    p.completed = completed;
+    p.total = (total > p.completed ? (long)total : p.completed);
+    p.percentageComplete = (0 == p.total ? 100.0 : (100.0 * p.completed / p.total));
+    p.duration = now() - startTime;
+    if (0 == p.duration) {
+      p.duration = 1;
+    }
+    p.durationEstimateRemaining = 1;
+    if (0 != p.completed) {
+      p.durationEstimateRemaining = ((p.total - p.completed) * p.duration) / p.completed;
+    }
+    p.rate = ((double)p.completed * 1000.0) / ((double)p.duration);
+    return p;
+  }
+
+  IConnection* mConn;
+  std::unique_ptr<SearchDescription> desc;
+  int parallelTasks;
+  int batchSize;
+  int maxRetries;
+  bool fetchDocuments;
+  std::vector<IQueryBatchNotifiable*> toNotify;
+  std::mutex toNotifyMtx;
+
+  std::vector<IConnection*> fetchConnections; // not owned. Empty to send every request on mConn
+  std::vector<IConnection*> idleConnections; // fetch connections not sending a request
+  std::mutex connectionMutex;
+  std::condition_variable connectionFree;
+
+  bool pointInTime; // list every page at the first listing's timestamp
+  std::string timestamp; // written under pinMutex, and only before pinned is set
+  std::mutex pinMutex;
+  std::atomic<bool> pinned; // whether timestamp is final
+
+  std::vector<pplx::task<void>> tasks;
+
+  std::atomic<long> nextPage;
+  std::atomic<long> lastPage;
+  std::atomic<long> total;
+  std::atomic<long> completed;
+  std::atomic<long> failedBatches;
+  std::atomic<bool> cancelled;
+  std::atomic<bool> exhausted;
+  std::atomic<bool> listFailed;
+
+  long startTime;
+};
+
+
+
+QueryBatcher::QueryBatcher(IConnection* conn) : mImpl(mlclient::make_unique<Impl>(conn)) {
+  ;
+}
+
+QueryBatcher::~QueryBatcher() {
+  ;
+}
+
+void QueryBatcher::setQuery(const SearchDescription& desc) {
+  std::unique_ptr<SearchDescription> copy(new SearchDescription(desc));
+  if ("{}" == copy->getOptions().getContent()) {
+    // we only need URIs - don't generate snippets
+    GenericTextDocumentContent options;
+    options.setMimeType(IDocumentContent::MIME_JSON);
+    options.setContent("{\"transform-results\": {\"apply\": \"empty-snippet\"}}");
+    if (IDocumentContent::MIME_JSON == copy->getQuery().getMimeType()) {
+      copy->setOptions(options);
+    }
+  }
+  mImpl->desc = std::move(copy);
+}
+
+void QueryBatcher::setCollection(const std::string& collection) {
+  // built as JSON rather than concatenated, so quotes and backslashes in the collection name are escaped
+  web::json::value uris = web::json::value::array(1);
+  uris[0] = web::json::value::string(utility::conversions::to_string_t(collection));
+  web::json::value collectionQuery = web::json::value::object();
+  collectionQuery[U("uri")] = uris;
+  web::json::value json = web::json::value::object();
+  json[U("collection-query")] = collectionQuery;
+
+  SearchDescription desc;
+  GenericTextDocumentContent query;
+  query.setMimeType(IDocumentContent::MIME_JSON);
+  query.setContent(utility::conversions::to_utf8string(json.serialize()));
+  desc.setQuery(query);
+  setQuery(desc);
+}
+
+void QueryBatcher::setBatchParameters(const int parallelTasks,const int batchSize,const int maxRetries) {
+  mImpl->parallelTasks = (parallelTasks < 1 ? 1 : parallelTasks);
+  mImpl->batchSize = (batchSize < 1 ? 1 : batchSize);
+  mImpl->maxRetries = (maxRetries < 0 ? 0 : maxRetries);
+}
+const int QueryBatcher::getParallelTasks() const {
+  return mImpl->parallelTasks;
+}
+const int QueryBatcher::getBatchSize() const {
+  return mImpl->batchSize;
+}
+const int QueryBatcher::getMaxRetries() const {
+  return mImpl->maxRetries;
+}
+
+void QueryBatcher::setFetchConnections(const std::vector<IConnection*>& connections) {
+  std::lock_guard<std::mutex> lock(mImpl->connectionMutex);
+  mImpl->fetchConnections = connections;
+  mImpl->idleConnections = connections;
+}
+
+void QueryBatcher::setPointInTime(const bool pointInTime) {
+  mImpl->pointInTime = pointInTime;
+}
+const bool QueryBatcher::isPointInTime() const {
+  return mImpl->pointInTime;
+}
+const std::string& QueryBatcher::getTimestamp() const {
+  return mImpl->timestamp;
+}
+
+void QueryBatcher::setFetchDocuments(const bool fetch) {
+  mImpl->fetchDocuments = fetch;
+}
+const bool QueryBatcher::isFetchDocuments() const {
+  return mImpl->fetchDocuments;
+}
+
+void QueryBatcher::addBatchListener(IQueryBatchNotifiable* notifiable) {
+  std::unique_lock<std::mutex> lck(mImpl->toNotifyMtx);
+  mImpl->toNotify.push_back(notifiable);
+}
+void QueryBatcher::removeBatchListener(IQueryBatchNotifiable* notifiable) {
+  std::unique_lock<std::mutex> lck(mImpl->toNotifyMtx);
+  mImpl->toNotify.erase(std::remove(mImpl->toNotify.begin(),mImpl->toNotify.end(),notifiable),mImpl->toNotify.end());
+}
+
+void QueryBatcher::send() {
+  mImpl->begin();
+}
+void QueryBatcher::stop() {
+  mImpl->cancelled = true;
+}
+void QueryBatcher::wait() const {
+  mImpl->waitAll();
+}
+
+const bool QueryBatcher::isComplete() const {
+  for (auto& task : mImpl->tasks) {
+    if (!task.is_done()) {
+      return false;
+    }
+  }
+  return !mImpl->tasks.empty();
+}
+
+const bool QueryBatcher::isCancelled() const {
+  return mImpl->cancelled;
+}
+
+const bool QueryBatcher::isFinished() const {
+  return isComplete() && mImpl->exhausted && !mImpl->cancelled && !mImpl->listFailed;
+}
+
+const bool QueryBatcher::isListFailed() const {
+  return mImpl->listFailed;
+}
+
+const long QueryBatcher::getFailedBatches() const {
+  return mImpl->failedBatches;
+}
+
+const Progress QueryBatcher::getProgress() const {
+  return mImpl->progress();
+}
+
+} // end namespace utilities
+
+} // end namespace mlclient
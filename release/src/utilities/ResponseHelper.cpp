@@ -26,6 +26,8 @@
 
 #include <cpprest/http_client.h>
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -189,6 +191,18 @@ double ResponseHelper::getAggregateResult(const Response& resp,const std::string
   return -1; // TODO return negative infinity, or some other such error result
 }
 
+std::string ResponseHelper::getEffectiveTimestamp(const Response& resp) {
+  static const std::string name("ml-effective-timestamp");
+  for (auto& header : resp.getResponseHeaders().getHeaders()) {
+    std::string lower(header.first);
+    std::transform(lower.begin(),lower.end(),lower.begin(),::tolower);
+    if (name == lower) {
+      return header.second;
+    }
+  }
+  return "";
+}
+
 } // end namespace utilities
 
 } // end namespace mlclient
@@ -24,6 +24,7 @@
 #include "mlclient/DocumentContent.hpp"
 #include "mlclient/utilities/CppRestJsonHelper.hpp"
 #include "mlclient/utilities/CppRestJsonDocumentContent.hpp"
+#include "mlclient/InvalidFormatException.hpp"
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -35,6 +36,82 @@ namespace mlclient {
 
 namespace utilities {
 
+namespace {
+
+/**
+ * Returns text as a quoted JSON string, with quotes, backslashes and control characters escaped
+ */
+std::string jsonString(const std::string& text) {
+  return utility::conversions::to_utf8string(
+      web::json::value::string(utility::conversions::to_string_t(text)).serialize());
+}
+
+/**
+ * Whether text is a JSON number. Checked by hand rather than parsed, so decimals keep all their digits.
+ */
+bool isJsonNumber(const std::string& text) {
+  size_t i = 0;
+  const size_t len = text.length();
+  auto digits = [&text,&i,len] () {
+    const size_t from = i;
+    while (i < len && text[i] >= '0' && text[i] <= '9') {
+      ++i;
+    }
+    return i > from;
+  };
+  if (i < len && '-' == text[i]) {
+    ++i;
+  }
+  if (i < len && '0' == text[i]) {
+    ++i;
+  } else if (!digits()) {
+    return false;
+  }
+  if (i < len && '.' == text[i]) {
+    ++i;
+    if (!digits()) {
+      return false;
+    }
+  }
+  if (i < len && ('e' == text[i] || 'E' == text[i])) {
+    ++i;
+    if (i < len && ('+' == text[i] || '-' == text[i])) {
+      ++i;
+    }
+    if (!digits()) {
+      return false;
+    }
+  }
+  return i == len;
+}
+
+/**
+ * Returns the JSON text of a range query value. Numbers and booleans are written unquoted, so are checked first.
+ *
+ * \throw InvalidFormatException if a numeric or boolean value is not one
+ */
+std::string rangeValue(const std::string& value,const RangeIndexType& type) {
+  if (RangeIndexType::BOOLEAN == type) {
+    if ("true" != value && "false" != value) {
+      throw InvalidFormatException("Range query value is not a boolean: " + value);
+    }
+    return value;
+  }
+  bool isNumeric = (type == RangeIndexType::INT) || (type == RangeIndexType::UNSIGNED_INT) ||
+    (type == RangeIndexType::LONG) || (type == RangeIndexType::UNSIGNED_LONG) ||
+    (type == RangeIndexType::FLOAT) || (type == RangeIndexType::DOUBLE) || (type == RangeIndexType::DECIMAL);
+  if (!isNumeric) {
+    return jsonString(value);
+  }
+  if (!isJsonNumber(value)) {
+    throw InvalidFormatException("Range query value for type " + translate_rangeindextype(type) + " is not a number: " +
+        value);
+  }
+  return value;
+}
+
+} // end anonymous namespace
+
 // RANGE OPERATION FUNCTIONS
 std::ostream& operator << (std::ostream& os, const RangeOperation& rt) {
   os << translate_rangeoperation(rt);
@@ -329,18 +406,8 @@ IQuery* SearchBuilder::jsonRangeQuery(const std::string ref, const RangeOperatio
   TIMED_FUNC(SearchBuilder_rangeQuery);
   std::ostringstream oss;
   oss << "{\"range-query\":{";
-  oss << "\"type\": \"" << type << "\",\"json-property\": \"" << ref << "\",\"value\": ";
-  bool isNumeric = (type == RangeIndexType::INT) || (type == RangeIndexType::UNSIGNED_INT) || 
-    (type == RangeIndexType::LONG) || (type == RangeIndexType::UNSIGNED_LONG) || 
-    (type == RangeIndexType::FLOAT) || (type == RangeIndexType::DOUBLE) || (type == RangeIndexType::DECIMAL) ||
-    (type == RangeIndexType::BOOLEAN);
-  if (!isNumeric) {
-    oss << "\"";
-  }
-  oss << value;
-  if (!isNumeric) {
-    oss << "\"";
-  }
+  oss << "\"type\": \"" << type << "\",\"json-property\": " << jsonString(ref) << ",\"value\": ";
+  oss << rangeValue(value,type);
   oss << ",\"range-operator\":\"" << op << "\"";
   // TODO support other types here too, multiple values, with options, and so on
   oss << "}}";
@@ -354,19 +421,10 @@ IQuery* SearchBuilder::xmlRangeQuery(const std::string ref, const RangeOperation
   TIMED_FUNC(SearchBuilder_rangeQuery);
   std::ostringstream oss;
   oss << "{\"range-query\":{";
-  oss << "\"type\": \"" << type << "\",\"element\": {\"name\":\"" << ref << "\",\"ns\":\"" << mImpl->defaultXmlNamespace << "\"}";
+  oss << "\"type\": \"" << type << "\",\"element\": {\"name\":" << jsonString(ref) << ",\"ns\":" <<
+      jsonString(mImpl->defaultXmlNamespace) << "}";
   oss << ",\"value\": ";
-  bool isNumeric = (type == RangeIndexType::INT) || (type == RangeIndexType::UNSIGNED_INT) || 
-    (type == RangeIndexType::LONG) || (type == RangeIndexType::UNSIGNED_LONG) || 
-    (type == RangeIndexType::FLOAT) || (type == RangeIndexType::DOUBLE) || (type == RangeIndexType::DECIMAL) ||
-    (type == RangeIndexType::BOOLEAN);
-  if (!isNumeric) {
-    oss << "\"";
-  }
-  oss << value;
-  if (!isNumeric) {
-    oss << "\"";
-  }
+  oss << rangeValue(value,type);
   oss << ",\"range-operator\":\"" << op << "\"";
   // TODO support other types here too, multiple values, with options, and so on
   oss << "}}";
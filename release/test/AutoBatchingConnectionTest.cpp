@@ -0,0 +1,193 @@
+/**
+ * \file AutoBatchingConnectionTest.cpp
+ *
+ * \date 18 Oct 2026
+ * \author adamfowler
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "AutoBatchingConnectionTest.hpp"
+#include "ConnectionFactory.hpp"
+#include "mlclient/Connection.hpp"
+#include "mlclient/Document.hpp"
+#include "mlclient/DocumentContent.hpp"
+#include "mlclient/Response.hpp"
+#include "mlclient/utilities/AutoBatchingConnection.hpp"
+#include "mlclient/utilities/NativeJsonDocumentContent.hpp"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mlclient/logging.hpp"
+
+using namespace mlclient;
+using namespace mlclient::utilities;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AutoBatchingConnectionTest);
+
+namespace {
+
+std::string testUri(int thread,int doc) {
+  std::ostringstream os;
+  os << "/autobatch/" << thread << "-" << doc << ".json";
+  return os.str();
+}
+
+}
+
+void AutoBatchingConnectionTest::setUp(void) {
+  LOG(DEBUG) << "ENTERING TEST SUITE AutoBatchingConnectionTest::setUp";
+  ml = ConnectionFactory::getConnection();
+}
+
+void AutoBatchingConnectionTest::tearDown(void) {
+  LOG(DEBUG) << "LEAVING TEST SUITE AutoBatchingConnectionTest::tearDown";
+  ConnectionFactory::releaseConnection(ml);
+  ml = nullptr;
+}
+
+void AutoBatchingConnectionTest::testConcurrentSaves(void) {
+  TIMED_FUNC(testConcurrentSaves);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering AutoBatchingConnectionTest::testConcurrentSaves";
+
+  const int threads = 4;
+  const int perThread = 5;
+  std::atomic<long> ok(0);
+  {
+    AutoBatchingConnection batching(ml);
+    batching.setFlushParameters(threads * perThread,1024 * 1024,50);
+
+    std::vector<std::thread> workers;
+    for (int t = 0;t < threads;t++) {
+      workers.push_back(std::thread([&batching,&ok,t,perThread] () {
+        for (int d = 0;d < perThread;d++) {
+          GenericTextDocumentContent content;
+          content.setMimeType(IDocumentContent::MIME_JSON);
+          content.setContent("{\"thread\": " + std::to_string(t) + ", \"doc\": " + std::to_string(d) + "}");
+          std::unique_ptr<Response> resp(batching.saveDocumentContent(testUri(t,d),content));
+          if (nullptr != resp.get() && ResponseCode::OK == resp->getResponseCode()) {
+            ++ok;
+          }
+        }
+      }));
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    LOG(DEBUG) << "Batches sent: " << batching.getBatchesSent() << ", failed saves: " << batching.getFailedSaves();
+    CPPUNIT_ASSERT_MESSAGE("A save failed",0 == batching.getFailedSaves());
+    CPPUNIT_ASSERT_MESSAGE("Saves were not combined in to batches",batching.getBatchesSent() < threads * perThread);
+
+    // read through the wrapper, so any buffered saves must be flushed first
+    std::unique_ptr<Response> read(batching.getDocument(testUri(threads - 1,perThread - 1)));
+    CPPUNIT_ASSERT_MESSAGE("Saved document could not be read",ResponseCode::OK == read->getResponseCode());
+  }
+  CPPUNIT_ASSERT_MESSAGE("Not every save returned HTTP 200 OK",threads * perThread == ok);
+
+  for (int t = 0;t < threads;t++) {
+    for (int d = 0;d < perThread;d++) {
+      delete ml->deleteDocument(testUri(t,d));
+    }
+  }
+}
+
+void AutoBatchingConnectionTest::testAsyncSaves(void) {
+  TIMED_FUNC(testAsyncSaves);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering AutoBatchingConnectionTest::testAsyncSaves";
+
+  const int count = 10;
+  AutoBatchingConnection batching(ml);
+  batching.setFlushParameters(count,1024 * 1024,1000);
+
+  std::vector<std::future<std::unique_ptr<Response>>> results;
+  for (int d = 0;d < count;d++) {
+    GenericTextDocumentContent content;
+    content.setMimeType(IDocumentContent::MIME_JSON);
+    content.setContent("{\"doc\": " + std::to_string(d) + "}");
+    results.push_back(batching.saveDocumentContentAsync(testUri(0,d),content));
+  }
+  batching.flush();
+
+  for (auto& result : results) {
+    std::unique_ptr<Response> resp(result.get());
+    CPPUNIT_ASSERT_MESSAGE("Async save did not return HTTP 200 OK",ResponseCode::OK == resp->getResponseCode());
+  }
+  CPPUNIT_ASSERT_MESSAGE("Async saves were not sent as one batch",1 == batching.getBatchesSent());
+
+  for (int d = 0;d < count;d++) {
+    delete batching.deleteDocument(testUri(0,d));
+  }
+}
+
+void AutoBatchingConnectionTest::testDuplicateUri(void) {
+  TIMED_FUNC(testDuplicateUri);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering AutoBatchingConnectionTest::testDuplicateUri";
+
+  const std::string uri(testUri(1,0));
+  const std::string other(testUri(1,1));
+  AutoBatchingConnection batching(ml);
+  batching.setFlushParameters(10,1024 * 1024,1000);
+
+  GenericTextDocumentContent first;
+  first.setContent("{\"version\": 1}");
+  GenericTextDocumentContent second;
+  second.setContent("{\"version\": 2}");
+  GenericTextDocumentContent unrelated;
+  unrelated.setContent("{\"version\": 0}");
+  std::future<std::unique_ptr<Response>> firstResult(batching.saveDocumentContentAsync(uri,first));
+  std::future<std::unique_ptr<Response>> otherResult(batching.saveDocumentContentAsync(other,unrelated));
+  std::future<std::unique_ptr<Response>> secondResult(batching.saveDocumentContentAsync(uri,second));
+  batching.flush();
+
+  std::unique_ptr<Response> firstResp(firstResult.get());
+  std::unique_ptr<Response> otherResp(otherResult.get());
+  std::unique_ptr<Response> secondResp(secondResult.get());
+  CPPUNIT_ASSERT_MESSAGE("Superseded save did not return HTTP 200 OK",ResponseCode::OK == firstResp->getResponseCode());
+  CPPUNIT_ASSERT_MESSAGE("Unrelated save did not return HTTP 200 OK",ResponseCode::OK == otherResp->getResponseCode());
+  CPPUNIT_ASSERT_MESSAGE("Last save did not return HTTP 200 OK",ResponseCode::OK == secondResp->getResponseCode());
+  CPPUNIT_ASSERT_MESSAGE("Saves were not sent as one batch",1 == batching.getBatchesSent());
+  CPPUNIT_ASSERT_MESSAGE("A save failed",0 == batching.getFailedSaves());
+  CPPUNIT_ASSERT_MESSAGE("A response should only describe its own document",
+      std::string::npos != otherResp->getContent().find(other) && std::string::npos == otherResp->getContent().find(uri));
+
+  std::unique_ptr<Response> read(batching.getDocument(uri));
+  CPPUNIT_ASSERT_MESSAGE("The last save of a URI should win",std::string::npos != read->getContent().find("2"));
+
+  delete batching.deleteDocument(uri);
+  delete batching.deleteDocument(other);
+}
+
+void AutoBatchingConnectionTest::testChangedContent(void) {
+  TIMED_FUNC(testChangedContent);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering AutoBatchingConnectionTest::testChangedContent";
+
+  const std::string uri(testUri(2,0));
+  AutoBatchingConnection batching(ml);
+  batching.setFlushParameters(10,1024 * 1024,1000);
+
+  // a shared fragment the caller can still change, as it holds a non const pointer to it
+  std::shared_ptr<NativeJsonDocumentContent> content(std::make_shared<NativeJsonDocumentContent>());
+  content->setContent("{\"version\": 1}");
+  Document doc(uri);
+  doc.setContent(std::shared_ptr<const IDocumentContent>(content));
+  std::future<std::unique_ptr<Response>> result(batching.saveDocumentAsync(doc));
+  content->setContent("{\"version\": 2}");
+  batching.flush();
+
+  std::unique_ptr<Response> resp(result.get());
+  CPPUNIT_ASSERT_MESSAGE("Save did not return HTTP 200 OK",ResponseCode::OK == resp->getResponseCode());
+  std::unique_ptr<Response> read(batching.getDocument(uri));
+  CPPUNIT_ASSERT_MESSAGE("A change after buffering should not be saved",std::string::npos != read->getContent().find("1"));
+
+  delete batching.deleteDocument(uri);
+}
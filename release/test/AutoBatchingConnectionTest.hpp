@@ -0,0 +1,39 @@
+/**
+ * \file AutoBatchingConnectionTest.hpp
+ *
+ * \date 18 Oct 2026
+ * \author adamfowler
+ */
+
+#ifndef TEST_AUTOBATCHINGCONNECTIONTEST_HPP_
+#define TEST_AUTOBATCHINGCONNECTIONTEST_HPP_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ConnectionFactory.hpp"
+#include "mlclient/Connection.hpp"
+
+using namespace mlclient;
+
+class AutoBatchingConnectionTest : public CppUnit::TestCase {
+  CPPUNIT_TEST_SUITE(AutoBatchingConnectionTest);
+    CPPUNIT_TEST(testConcurrentSaves);
+    CPPUNIT_TEST(testAsyncSaves);
+    CPPUNIT_TEST(testDuplicateUri);
+    CPPUNIT_TEST(testChangedContent);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  void setUp();
+  void tearDown();
+
+  void testConcurrentSaves(void);
+  void testAsyncSaves(void);
+  void testDuplicateUri(void);
+  void testChangedContent(void);
+private:
+  IConnection* ml;
+};
+
+#endif /* TEST_AUTOBATCHINGCONNECTIONTEST_HPP_ */
@@ -0,0 +1,71 @@
+/**
+ * \file DocumentBatchExporterTest.cpp
+ *
+ * \date 18 Oct 2026
+ * \author adamfowler
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "DocumentBatchExporterTest.hpp"
+#include "ConnectionFactory.hpp"
+#include "mlclient/Connection.hpp"
+#include "mlclient/Document.hpp"
+#include "mlclient/DocumentSet.hpp"
+#include "mlclient/DocumentContent.hpp"
+#include "mlclient/utilities/DocumentBatchExporter.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+
+#include "mlclient/logging.hpp"
+
+using namespace mlclient;
+using namespace mlclient::utilities;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DocumentBatchExporterTest);
+
+void DocumentBatchExporterTest::setUp(void) {
+  LOG(DEBUG) << "ENTERING TEST SUITE DocumentBatchExporterTest::setUp";
+  ml = ConnectionFactory::getConnection();
+}
+
+void DocumentBatchExporterTest::tearDown(void) {
+  LOG(DEBUG) << "LEAVING TEST SUITE DocumentBatchExporterTest::tearDown";
+  ConnectionFactory::releaseConnection(ml);
+  ml = nullptr;
+}
+
+void DocumentBatchExporterTest::testArchiveExport(void) {
+  TIMED_FUNC(testArchiveExport);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering DocumentBatchExporterTest::testArchiveExport";
+
+  boost::filesystem::path archive = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("zoo-%%%%%%.mla");
+
+  DocumentBatchExporter exporter(ml);
+  exporter.setCollection("zoo");
+  exporter.setBatchParameters(2,2,1);
+  exporter.setMaxPendingBatches(1);
+  exporter.setArchiveTarget(archive.string());
+
+  exporter.send();
+  exporter.wait();
+
+  LOG(DEBUG) << "Written: " << exporter.getWrittenDocuments() << ", failed: " << exporter.getFailedDocuments();
+
+  DocumentSet set;
+  long read = DocumentBatchExporter::readArchive(archive.string(),set);
+  bool allHaveContent = true;
+  for (auto& doc : set) {
+    allHaveContent = allHaveContent && !doc.getUri().empty() && !doc.getContent()->getContent().empty();
+    delete doc.getContent();
+  }
+  boost::filesystem::remove(archive);
+
+  CPPUNIT_ASSERT_MESSAGE("No documents were exported",exporter.getWrittenDocuments() > 0);
+  CPPUNIT_ASSERT_MESSAGE("A document failed to export",0 == exporter.getFailedDocuments());
+  CPPUNIT_ASSERT_MESSAGE("Archive does not hold every written document",read == exporter.getWrittenDocuments());
+  CPPUNIT_ASSERT_MESSAGE("An archived document has no URI or content",allHaveContent);
+  CPPUNIT_ASSERT_MESSAGE("Exporter not set to finished",exporter.isFinished());
+}
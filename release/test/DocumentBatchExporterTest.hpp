@@ -0,0 +1,33 @@
+/**
+ * \file DocumentBatchExporterTest.hpp
+ *
+ * \date 18 Oct 2026
+ * \author adamfowler
+ */
+
+#ifndef TEST_DOCUMENTBATCHEXPORTERTEST_HPP_
+#define TEST_DOCUMENTBATCHEXPORTERTEST_HPP_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ConnectionFactory.hpp"
+#include "mlclient/Connection.hpp"
+
+using namespace mlclient;
+
+class DocumentBatchExporterTest : public CppUnit::TestCase {
+  CPPUNIT_TEST_SUITE(DocumentBatchExporterTest);
+    CPPUNIT_TEST(testArchiveExport);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  void setUp();
+  void tearDown();
+
+  void testArchiveExport(void);
+private:
+  IConnection* ml;
+};
+
+#endif /* TEST_DOCUMENTBATCHEXPORTERTEST_HPP_ */
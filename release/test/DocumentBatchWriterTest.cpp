@@ -17,12 +17,18 @@
 #include "mlclient/Document.hpp"
 #include "mlclient/DocumentSet.hpp"
 #include "mlclient/Permission.hpp"
+#include "mlclient/utilities/AutoBatchingConnection.hpp"
 #include "mlclient/utilities/DocumentBatchWriter.hpp"
 #include "mlclient/utilities/DocumentBatchHelper.hpp"
+#include "mlclient/utilities/ForestTopology.hpp"
 #include "mlclient/NoCredentialsException.hpp"
 #include "mlclient/utilities/ResponseHelper.hpp"
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "mlclient/logging.hpp"
 
@@ -52,6 +58,95 @@ public:
   std::exception ex;
 };
 
+class OrderedObserver : public mlclient::utilities::IBatchNotifiable {
+public:
+  OrderedObserver() : next(0), inOrder(true), uriCount(0) {
+    ;
+  }
+
+  void batchEventComplete(const BatchEvent& event) override {
+    LOG(DEBUG) << "Received batch event: " << event.getSequence() << " (OK?: " << event.isSuccess() << ")";
+    inOrder = inOrder && (next == event.getSequence()) && event.isSuccess();
+    next = event.getSequence() + 1;
+    uriCount += event.getUris().size();
+  }
+
+  long next;
+  bool inOrder;
+  long uriCount;
+};
+
+/**
+ * Pretends every host in the topology is reachable through the single test connection
+ */
+class CountingHostProvider : public mlclient::utilities::IHostConnectionProvider {
+public:
+  CountingHostProvider(IConnection* conn) : mConn(conn), requested() {
+    ;
+  }
+
+  IConnection* getConnection(const std::string& hostname) override {
+    requested.push_back(hostname);
+    return mConn;
+  }
+
+  IConnection* mConn;
+  std::vector<std::string> requested;
+};
+
+
+/**
+ * Records the forest writes sent to one host, rather than sending them. Only the constructor touches the wrapped
+ * connection.
+ */
+class RecordingHostConnection : public mlclient::utilities::AutoBatchingConnection {
+public:
+  RecordingHostConnection(IConnection* conn,const std::string& hostname) : AutoBatchingConnection(conn),
+    host(hostname), mtx(), forests(), uris() {
+    ;
+  }
+
+  Response* saveDocumentsToForest(const DocumentSet& documents,const long startPosInclusive,
+      const long endPosInclusive,const std::string& forestName) override {
+    std::vector<std::string> batch;
+    for (long idx = startPosInclusive;idx <= endPosInclusive;idx++) {
+      batch.push_back(documents.at(idx).getUri());
+    }
+    std::unique_lock<std::mutex> lck(mtx);
+    forests.push_back(forestName);
+    uris.push_back(std::move(batch));
+    Response* resp = new Response;
+    resp->setResponseCode(ResponseCode::OK);
+    return resp;
+  }
+
+  std::string host;
+  std::mutex mtx;
+  std::vector<std::string> forests; // per batch
+  std::vector<std::vector<std::string>> uris; // per batch
+};
+
+/**
+ * Gives each host its own RecordingHostConnection
+ */
+class RecordingHostProvider : public mlclient::utilities::IHostConnectionProvider {
+public:
+  RecordingHostProvider(IConnection* conn) : mConn(conn), hosts() {
+    ;
+  }
+
+  IConnection* getConnection(const std::string& hostname) override {
+    std::unique_ptr<RecordingHostConnection>& host = hosts[hostname];
+    if (nullptr == host) {
+      host.reset(new RecordingHostConnection(mConn,hostname));
+    }
+    return host.get();
+  }
+
+  IConnection* mConn;
+  std::map<std::string,std::unique_ptr<RecordingHostConnection>> hosts;
+};
+
 
 void DocumentBatchWriterTest::setUp(void) {
   LOG(DEBUG) << "ENTERING TEST SUITE DocumentBatchWriterTest::setUp";
@@ -111,4 +206,134 @@ void DocumentBatchWriterTest::testFolder(void) {
   CPPUNIT_ASSERT_MESSAGE("Writer not set to complete",writer.isComplete());
 }
 
+void DocumentBatchWriterTest::testOrderedNotification(void) {
+  TIMED_FUNC(testOrderedNotification);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering DocumentBatchWriterTest::testOrderedNotification";
+
+  OrderedObserver obs;
+
+  DocumentBatchWriter writer(ml);
+  writer.setBatchParameters(3,2,TransactionMode::PER_BATCH);
+  writer.setNotificationParameters(2,NotificationMode::ORDERED);
+  writer.addBatchListener(&obs);
+  CollectionSet collections;
+  collections.emplace_back("mlcpptest");
+  PermissionSet perms;
+
+  DocumentSet set;
 
+  DocumentBatchHelper::addFilesToDocumentSet("testdata/documents/recursive","testdata/documents/recursive",true,"/mlcpptest/",
+      collections,perms,nullptr,set);
+
+  long setSize = set.size();
+
+  writer.assignDocuments(std::move(set));
+
+  writer.send();
+  writer.wait(); // also waits for all events to be delivered
+
+  CPPUNIT_ASSERT_MESSAGE("Batch events not delivered in order, or a batch failed",obs.inOrder);
+  CPPUNIT_ASSERT_MESSAGE("Not every URI was notified",(setSize == obs.uriCount));
+}
+
+void DocumentBatchWriterTest::testHostAffinity(void) {
+  TIMED_FUNC(testHostAffinity);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering DocumentBatchWriterTest::testHostAffinity";
+
+  // the forest is named on each write, so must exist in the test database
+  ForestList forests;
+  forests.push_back(ForestInfo{"Documents","host-a"});
+  StaticForestTopology topology(forests);
+  CountingHostProvider provider(ml);
+
+  OrderedObserver obs;
+
+  DocumentBatchWriter writer(ml);
+  writer.setBatchParameters(2,2,TransactionMode::PER_BATCH);
+  writer.setNotificationParameters(4,NotificationMode::ORDERED);
+  writer.setAssignmentParameters(AssignmentMode::HOST_AFFINITY,&topology,&provider);
+  writer.addBatchListener(&obs);
+  CollectionSet collections;
+  collections.emplace_back("mlcpptest");
+  PermissionSet perms;
+
+  DocumentSet set;
+
+  DocumentBatchHelper::addFilesToDocumentSet("testdata/documents/recursive","testdata/documents/recursive",true,"/mlcpptest/",
+      collections,perms,nullptr,set);
+
+  long setSize = set.size();
+
+  writer.assignDocuments(std::move(set));
+
+  writer.send();
+  writer.wait();
+
+  CPPUNIT_ASSERT_MESSAGE("Host connections not requested once per host",(1 == provider.requested.size()));
+  CPPUNIT_ASSERT_MESSAGE("A batch failed",obs.inOrder);
+  CPPUNIT_ASSERT_MESSAGE("Not every URI was written",(setSize == obs.uriCount));
+  CPPUNIT_ASSERT_MESSAGE("Writer not set to complete",writer.isComplete());
+}
+
+void DocumentBatchWriterTest::testForestAssignment(void) {
+  TIMED_FUNC(testForestAssignment);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering DocumentBatchWriterTest::testForestAssignment";
+
+  // no request reaches the server, so the forests need not exist
+  ForestList forests;
+  forests.push_back(ForestInfo{"forest-1","host-a"});
+  forests.push_back(ForestInfo{"forest-2","host-b"});
+  forests.push_back(ForestInfo{"forest-3","host-c"});
+  forests.push_back(ForestInfo{"forest-4","host-a"});
+  forests.push_back(ForestInfo{"forest-5","host-b"});
+  StaticForestTopology topology(forests);
+  StaticForestTopology sameTopology(forests);
+  RecordingHostProvider provider(ml);
+
+  DocumentSet set;
+  std::map<std::string,long> expectedForest;
+  bool deterministic = true;
+  for (int d = 0;d < 100;d++) {
+    const std::string uri("/mlcpptest/forests/" + std::to_string(d) + ".json");
+    const long forest = topology.assignForest(uri);
+    deterministic = deterministic && forest == topology.assignForest(uri) && forest == sameTopology.assignForest(uri);
+    expectedForest[uri] = forest;
+    set.emplace_back(uri);
+  }
+  CPPUNIT_ASSERT_MESSAGE("Forest assignment should depend only on the URI",deterministic);
+
+  DocumentBatchWriter writer(ml);
+  writer.setBatchParameters(7,3,TransactionMode::PER_BATCH);
+  writer.setAssignmentParameters(AssignmentMode::HOST_AFFINITY,&topology,&provider);
+  writer.assignDocuments(std::move(set));
+  writer.send();
+  writer.wait();
+
+  CPPUNIT_ASSERT_MESSAGE("Every host should be asked for one connection",3 == provider.hosts.size());
+  std::map<std::string,long> seen;
+  bool ownHost = true;
+  bool ownForest = true;
+  for (auto& entry : provider.hosts) {
+    RecordingHostConnection& host = *entry.second;
+    CPPUNIT_ASSERT_MESSAGE("Every host should receive a batch",!host.forests.empty());
+    for (size_t b = 0;b < host.forests.size();b++) {
+      for (auto& uri : host.uris[b]) {
+        const ForestInfo& expected = forests[expectedForest[uri] % forests.size()];
+        ownHost = ownHost && expected.host == host.host;
+        ownForest = ownForest && expected.name == host.forests[b];
+        seen[uri]++;
+      }
+    }
+  }
+  CPPUNIT_ASSERT_MESSAGE("A batch should only hold its host's documents",ownHost);
+  CPPUNIT_ASSERT_MESSAGE("A batch should only hold its forest's documents",ownForest);
+  bool once = (expectedForest.size() == seen.size());
+  for (auto& entry : seen) {
+    once = once && 1 == entry.second;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Every document should be in exactly one batch",once);
+  CPPUNIT_ASSERT_MESSAGE("Writer not set to complete",writer.isComplete());
+}
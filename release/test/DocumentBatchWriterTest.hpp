@@ -28,12 +28,18 @@ using namespace mlclient;
 class DocumentBatchWriterTest : public CppUnit::TestCase {
   CPPUNIT_TEST_SUITE(DocumentBatchWriterTest);
     CPPUNIT_TEST(testFolder);
+    CPPUNIT_TEST(testOrderedNotification);
+    CPPUNIT_TEST(testHostAffinity);
+    CPPUNIT_TEST(testForestAssignment);
   CPPUNIT_TEST_SUITE_END();
 public:
   void setUp();
   void tearDown();
 
   void testFolder(void);
+  void testOrderedNotification(void);
+  void testHostAffinity(void);
+  void testForestAssignment(void);
 private:
   IConnection* ml;
 };
@@ -0,0 +1,167 @@
+/**
+ * \file DocumentMappingTest.cpp
+ *
+ * \date 18 Oct 2026
+ * \author adamfowler
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <clocale>
+#include <locale>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DocumentMappingTest.hpp"
+#include "mlclient/DocumentContent.hpp"
+#include "mlclient/InvalidFormatException.hpp"
+#include "mlclient/utilities/DocumentMapping.hpp"
+
+#include "mlclient/logging.hpp"
+
+using namespace mlclient;
+using namespace mlclient::utilities;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DocumentMappingTest);
+
+namespace {
+
+struct MappedPerson {
+  std::string name;
+  int32_t age = 0;
+  int64_t id = 0;
+  double score = 0.0;
+  bool active = false;
+  std::vector<std::string> tags;
+};
+
+/**
+ * Number punctuation as in many European locales, whichever locales are installed
+ */
+class CommaDecimalPoint : public std::numpunct<char> {
+protected:
+  char do_decimal_point() const override {
+    return ',';
+  }
+  char do_thousands_sep() const override {
+    return '.';
+  }
+  std::string do_grouping() const override {
+    return "\3";
+  }
+};
+
+} // end anonymous namespace
+
+void DocumentMappingTest::setUp(void) {
+  LOG(DEBUG) << "ENTERING TEST SUITE DocumentMappingTest";
+}
+
+void DocumentMappingTest::tearDown(void) {
+  LOG(DEBUG) << "LEAVING TEST SUITE DocumentMappingTest";
+}
+
+void DocumentMappingTest::testStructMapping() {
+  TIMED_FUNC(testStructMapping);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering DocumentMappingTest::testStructMapping";
+
+  const auto mapping = mapStruct(
+    mapField("name",&MappedPerson::name),
+    mapField("details/age",&MappedPerson::age),
+    mapField("details/id",&MappedPerson::id),
+    mapField("details/score",&MappedPerson::score),
+    mapField("active",&MappedPerson::active),
+    mapField("tags",&MappedPerson::tags)
+  );
+
+  // JSON, with unmapped values of every kind to skip
+  MappedPerson person;
+  mapping.fromJson("{\"ns:name\":\"Adam \\\"A\\\"\",\"other\":{\"name\":\"wrong\",\"list\":[1,{\"age\":2}],\"text\":\"]}\\\"[\"},"
+      "\"details\":{\"age\":42,\"id\":9007199254740993,\"score\":1.5},\"active\":true,\"tags\":[\"a\",\"b\"]}",person);
+  CPPUNIT_ASSERT_MESSAGE("JSON name should ignore the prefix and unescape","Adam \"A\"" == person.name);
+  CPPUNIT_ASSERT_MESSAGE("JSON age should be 42",42 == person.age);
+  CPPUNIT_ASSERT_MESSAGE("JSON id should keep 64 bit precision",9007199254740993LL == person.id);
+  CPPUNIT_ASSERT_MESSAGE("JSON score should be 1.5",1.5 == person.score);
+  CPPUNIT_ASSERT_MESSAGE("JSON active should be true",person.active);
+  CPPUNIT_ASSERT_MESSAGE("JSON tags should have 2 members",2 == person.tags.size() && "b" == person.tags[1]);
+
+  // JSON round trip
+  std::unique_ptr<ITextDocumentContent> json(mapping.toJson(person));
+  CPPUNIT_ASSERT_MESSAGE("toJson should be JSON",IDocumentContent::MIME_JSON == json->getMimeType());
+  MappedPerson copy;
+  mapping.fromContent(*json,copy);
+  CPPUNIT_ASSERT_MESSAGE("JSON round trip should keep name",person.name == copy.name);
+  CPPUNIT_ASSERT_MESSAGE("JSON round trip should keep id",person.id == copy.id);
+  CPPUNIT_ASSERT_MESSAGE("JSON round trip should keep score",person.score == copy.score);
+  CPPUNIT_ASSERT_MESSAGE("JSON round trip should keep tags",person.tags == copy.tags);
+
+  // XML, where the last step may be an attribute and repeated elements fill a vector
+  MappedPerson xperson;
+  mapping.fromXml("<person active=\"true\"><name>Adam &amp; Co</name><details><age>7</age><score>2.25</score></details>"
+      "<tags>x</tags><other><tags>wrong</tags></other><tags>y</tags></person>",xperson);
+  CPPUNIT_ASSERT_MESSAGE("XML name should be unescaped","Adam & Co" == xperson.name);
+  CPPUNIT_ASSERT_MESSAGE("XML age should be 7",7 == xperson.age);
+  CPPUNIT_ASSERT_MESSAGE("XML score should be 2.25",2.25 == xperson.score);
+  CPPUNIT_ASSERT_MESSAGE("XML active attribute should be true",xperson.active);
+  CPPUNIT_ASSERT_MESSAGE("XML tags should have 2 members",2 == xperson.tags.size() && "y" == xperson.tags[1]);
+
+  // XML round trip
+  std::unique_ptr<ITextDocumentContent> xml(mapping.toXml(xperson,"person"));
+  MappedPerson xcopy;
+  mapping.fromContent(*xml,xcopy);
+  CPPUNIT_ASSERT_MESSAGE("XML round trip should keep name",xperson.name == xcopy.name);
+  CPPUNIT_ASSERT_MESSAGE("XML round trip should keep tags",xperson.tags == xcopy.tags);
+
+  bool threw = false;
+  try {
+    MappedPerson invalid;
+    mapping.fromJson("{\"details\":{\"age\":\"old\"}}",invalid);
+  } catch (mlclient::InvalidFormatException& ex) {
+    threw = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("a value that cannot be converted should throw InvalidFormatException",threw);
+};
+
+void DocumentMappingTest::testNumberLocale() {
+  TIMED_FUNC(testNumberLocale);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering DocumentMappingTest::testNumberLocale";
+
+  const auto mapping = mapStruct(
+    mapField("name",&MappedPerson::name),
+    mapField("score",&MappedPerson::score)
+  );
+  MappedPerson person;
+  person.name = "Comma";
+  person.score = 1.5;
+
+  // doubles are read and written with a '.' decimal point, whatever the global C++ and C locales
+  const std::locale global = std::locale::global(std::locale(std::locale(),new CommaDecimalPoint));
+  const std::string numeric(std::setlocale(LC_NUMERIC,nullptr));
+  const char* commaLocales[] = {"de_DE.UTF-8","de_DE","fr_FR.UTF-8","fr_FR"};
+  for (const char* name : commaLocales) {
+    if (nullptr != std::setlocale(LC_NUMERIC,name)) {
+      break; // used if installed
+    }
+  }
+  MappedPerson read;
+  bool threw = false;
+  try {
+    mapping.fromJson("{\"name\":\"Comma\",\"score\":2.25}",read);
+  } catch (mlclient::InvalidFormatException& ex) {
+    threw = true;
+  }
+  std::unique_ptr<ITextDocumentContent> json(mapping.toJson(person));
+  std::unique_ptr<ITextDocumentContent> xml(mapping.toXml(person,"person"));
+  const std::string jsonText(json->getContent());
+  const std::string xmlText(xml->getContent());
+  std::setlocale(LC_NUMERIC,numeric.c_str());
+  std::locale::global(global);
+
+  CPPUNIT_ASSERT_MESSAGE("2.25 should be read in any locale",!threw && 2.25 == read.score);
+  CPPUNIT_ASSERT_MESSAGE("toJson should write 1.5 in any locale",std::string::npos != jsonText.find("1.5") &&
+      std::string::npos == jsonText.find("1,5"));
+  CPPUNIT_ASSERT_MESSAGE("toXml should write 1.5 in any locale",std::string::npos != xmlText.find("1.5") &&
+      std::string::npos == xmlText.find("1,5"));
+}
@@ -0,0 +1,28 @@
+/**
+ * \file DocumentMappingTest.hpp
+ *
+ * \date 18 Oct 2026
+ * \author adamfowler
+ */
+
+#ifndef TEST_DOCUMENTMAPPINGTEST_HPP_
+#define TEST_DOCUMENTMAPPINGTEST_HPP_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class DocumentMappingTest : public CppUnit::TestCase {
+  CPPUNIT_TEST_SUITE(DocumentMappingTest);
+    CPPUNIT_TEST(testStructMapping);
+    CPPUNIT_TEST(testNumberLocale);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  void setUp();
+  void tearDown();
+
+  void testStructMapping(void);
+  void testNumberLocale(void);
+};
+
+#endif /* TEST_DOCUMENTMAPPINGTEST_HPP_ */
@@ -17,10 +17,17 @@
 #include "mlclient/utilities/CppRestJsonHelper.hpp"
 #include "mlclient/utilities/PugiXmlHelper.hpp"
 #include "mlclient/utilities/PugiXmlDocumentContent.hpp"
+#include "mlclient/utilities/NativeJsonDocumentContent.hpp"
+#include "mlclient/utilities/DocumentHelper.hpp"
+#include "mlclient/utilities/JsonEventParser.hpp"
+#include "mlclient/InvalidFormatException.hpp"
 #include <cpprest/http_client.h>
 #include "mlclient/ext/pugixml/pugixml.hpp"
 
+#include <locale>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "mlclient/logging.hpp"
 
@@ -360,3 +367,390 @@ void DocumentTraversalTest::testSubDocumentExtraction() {
   //delete newNav;
 }
 
+void DocumentTraversalTest::testXmlInPlaceParse() {
+  TIMED_FUNC(testXmlInPlaceParse);
+  std::unique_ptr<IDocumentNode> results;
+  {
+    Response resp;
+    resp.setResponseType(ResponseType::XML);
+    resp.setContent(std::string("<response total=\"2\"><result><uri>/a.xml</uri></result><result><uri>/b.xml</uri></result></response>"));
+    std::unique_ptr<ITextDocumentContent> xml(mlclient::utilities::PugiXmlHelper::toDocumentInPlace(resp));
+    CPPUNIT_ASSERT_MESSAGE("Response content should be taken",resp.getContent().empty());
+    CPPUNIT_ASSERT_MESSAGE("Serialised content should contain /b.xml",std::string::npos != xml->getContent().find("/b.xml"));
+
+    std::unique_ptr<IDocumentNavigator> nav(xml->navigate(true));
+    CPPUNIT_ASSERT_MESSAGE("total should be 2",2 == nav->getInteger("total"));
+    results.reset(nav->at("result"));
+  } // response, content and navigator are all deleted
+
+  // the node still owns the buffer it was parsed in
+  CPPUNIT_ASSERT_MESSAGE("result should be an array of 2",results->isArray() && 2 == results->size());
+  std::unique_ptr<IDocumentNode> second(results->at(1));
+  CPPUNIT_ASSERT_MESSAGE("second uri should be /b.xml","/b.xml" == second->getString("uri"));
+
+  // a parse error throws by value, and hands the body back to the response
+  Response bad;
+  bad.setResponseType(ResponseType::XML);
+  const std::string malformed("<response><result></response>");
+  bad.setContent(std::string(malformed));
+  bool thrown = false;
+  try {
+    std::unique_ptr<ITextDocumentContent> xml(mlclient::utilities::PugiXmlHelper::toDocumentInPlace(bad));
+  } catch (mlclient::InvalidFormatException& ife) {
+    thrown = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Malformed XML should throw InvalidFormatException",thrown);
+  CPPUNIT_ASSERT_MESSAGE("Malformed response body should be handed back",malformed.size() == bad.getContent().size());
+}
+
+void DocumentTraversalTest::testNativeJsonTraversal() {
+  TIMED_FUNC(testNativeJsonTraversal);
+  std::unique_ptr<IDocumentNode> results;
+  {
+    mlclient::utilities::NativeJsonDocumentContent json;
+    json.setContent("{\"total\":2,\"escaped\":\"a\\\"b\\u00e9\",\"results\":[{\"uri\":\"/a.json\",\"score\":1.5},"
+        "{\"uri\":\"/b.json\",\"matched\":true,\"content\":{\"x\":[1,2]}}]}");
+    std::unique_ptr<IDocumentNavigator> nav(json.navigate(true));
+    CPPUNIT_ASSERT_MESSAGE("total should be 2",2 == nav->getInteger("search:total"));
+    CPPUNIT_ASSERT_MESSAGE("escaped should be unescaped to UTF-8","a\"b\xc3\xa9" == nav->getString("escaped"));
+    CPPUNIT_ASSERT_MESSAGE("missing property should be null",nullptr == nav->tryAt("missing"));
+    CPPUNIT_ASSERT_MESSAGE("content x should have 2 members",
+        2 == nav->ref().at("results").at(1).at("content").at("x").size());
+    results.reset(nav->at("results"));
+
+    // round trips through its serialised form
+    mlclient::utilities::NativeJsonDocumentContent copy;
+    copy.setContent(json.getContent());
+    CPPUNIT_ASSERT_MESSAGE("serialised content should round trip",json.getContent() == copy.getContent());
+  } // content and navigator are deleted
+
+  CPPUNIT_ASSERT_MESSAGE("results should be an array of 2",results->isArray() && 2 == results->size());
+  std::unique_ptr<IDocumentNode> first(results->at(0));
+  CPPUNIT_ASSERT_MESSAGE("first score should be 1.5",first->getDouble("score") > 1.49 && first->getDouble("score") < 1.51);
+  std::unique_ptr<IDocumentNode> second(results->at(1));
+  CPPUNIT_ASSERT_MESSAGE("second should be matched",second->getBoolean("matched"));
+  CPPUNIT_ASSERT_MESSAGE("second uri should be /b.json","/b.json" == second->getString("uri"));
+
+  bool threw = false;
+  try {
+    mlclient::utilities::NativeJsonDocumentContent invalid;
+    invalid.setContent("{\"a\":[1,}");
+  } catch (mlclient::InvalidFormatException& ex) {
+    threw = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("invalid JSON should throw InvalidFormatException",threw);
+}
+
+namespace {
+
+/**
+ * Number punctuation as in many European locales, whichever locales are installed
+ */
+class CommaDecimalPoint : public std::numpunct<char> {
+protected:
+  char do_decimal_point() const override {
+    return ',';
+  }
+  char do_thousands_sep() const override {
+    return '.';
+  }
+  std::string do_grouping() const override {
+    return "\3";
+  }
+};
+
+} // end anonymous namespace
+
+void DocumentTraversalTest::testNativeJsonBackend() {
+  TIMED_FUNC(testNativeJsonBackend);
+  const mlclient::utilities::JsonBackend previous = mlclient::utilities::DocumentHelper::getJsonBackend();
+  mlclient::utilities::DocumentHelper::setJsonBackend(mlclient::utilities::JsonBackend::NATIVE);
+
+  Response resp;
+  resp.setResponseType(ResponseType::JSON);
+  resp.setContent(std::string("{\"huge\":1e300,\"tiny\":-1e300,\"half\":-2.5,\"count\":4200000}"));
+  std::unique_ptr<IDocumentContent> content(mlclient::utilities::DocumentHelper::contentFromResponse(resp));
+  mlclient::utilities::DocumentHelper::setJsonBackend(previous);
+
+  mlclient::utilities::NativeJsonDocumentContent* json =
+      dynamic_cast<mlclient::utilities::NativeJsonDocumentContent*>(content.get());
+  CPPUNIT_ASSERT_MESSAGE("The native backend should give NativeJsonDocumentContent",nullptr != json);
+  std::unique_ptr<IDocumentNavigator> nav(json->navigate(true));
+  CPPUNIT_ASSERT_MESSAGE("huge should be 1e300",1e300 == nav->getDouble("huge"));
+  CPPUNIT_ASSERT_MESSAGE("tiny should be -1e300",-1e300 == nav->getDouble("tiny"));
+  CPPUNIT_ASSERT_MESSAGE("half should be -2.5",-2.5 == nav->getDouble("half"));
+  CPPUNIT_ASSERT_MESSAGE("count should be 4200000",4200000 == nav->getInteger("count"));
+
+  // numbers are read and written with a '.' decimal point and no grouping, whatever the global locale
+  const std::locale global = std::locale::global(std::locale(std::locale(),new CommaDecimalPoint));
+  const std::string serialized(json->getContent());
+  mlclient::utilities::NativeJsonDocumentContent copy;
+  copy.setContent("{\"half\":-2.5,\"third\":0.3333333333333333}");
+  std::unique_ptr<IDocumentNavigator> copyNav(copy.navigate(true));
+  const double half = copyNav->getDouble("half");
+  const std::string copySerialized(copy.getContent());
+  std::locale::global(global);
+  CPPUNIT_ASSERT_MESSAGE("-2.5 should be read in any locale",-2.5 == half);
+  CPPUNIT_ASSERT_MESSAGE("Serialised doubles should use a '.' decimal point",
+      std::string::npos != copySerialized.find("-2.5") && std::string::npos != copySerialized.find("0.3333"));
+  CPPUNIT_ASSERT_MESSAGE("Serialised integers should not be grouped",std::string::npos != serialized.find("4200000"));
+
+  // serialised doubles round trip
+  mlclient::utilities::NativeJsonDocumentContent reparsed;
+  reparsed.setContent(serialized);
+  std::unique_ptr<IDocumentNavigator> reparsedNav(reparsed.navigate(true));
+  CPPUNIT_ASSERT_MESSAGE("huge should round trip",1e300 == reparsedNav->getDouble("huge"));
+  CPPUNIT_ASSERT_MESSAGE("tiny should round trip",-1e300 == reparsedNav->getDouble("tiny"));
+}
+
+namespace {
+
+/**
+ * Records events as text, and captures each row of a results array
+ */
+class EventRecorder : public mlclient::utilities::IJsonEventHandler {
+public:
+  EventRecorder(mlclient::utilities::JsonEventParser*& p) : parser(p), events(), rows(), depth(0) {
+    ;
+  }
+  void onStartObject() override {
+    events << "{";
+    if (3 == ++depth) {
+      parser->captureValue();
+    }
+  }
+  void onEndObject() override {
+    events << "}";
+    --depth;
+  }
+  void onStartArray() override {
+    events << "[";
+    ++depth;
+  }
+  void onEndArray() override {
+    events << "]";
+    --depth;
+  }
+  void onKey(const std::string& key) override {
+    events << "key:" << key << ",";
+  }
+  void onString(const std::string& value) override {
+    events << "string:" << value << ",";
+  }
+  void onNumber(const std::string& text) override {
+    events << "number:" << text << ",";
+  }
+  void onBoolean(const bool value) override {
+    events << (value ? "true," : "false,");
+  }
+  void onNull() override {
+    events << "null,";
+  }
+  void onCapture(std::string& text) override {
+    events << "row,";
+    --depth;
+    rows.push_back(std::move(text));
+  }
+
+  mlclient::utilities::JsonEventParser*& parser;
+  std::ostringstream events;
+  std::vector<std::string> rows;
+  int depth;
+};
+
+std::string parseInChunks(const std::string& json,const size_t chunk,std::vector<std::string>& rows) {
+  mlclient::utilities::JsonEventParser* parser = nullptr;
+  EventRecorder recorder(parser);
+  mlclient::utilities::JsonEventParser events(recorder);
+  parser = &events;
+  for (size_t i = 0;i < json.length();i += chunk) {
+    events.feed(json.data() + i,std::min(chunk,json.length() - i));
+  }
+  events.finish();
+  rows = recorder.rows;
+  return recorder.events.str();
+}
+
+} // end anonymous namespace
+
+void DocumentTraversalTest::testJsonEventParser() {
+  TIMED_FUNC(testJsonEventParser);
+  const std::string json("{\"total\":2,\"escaped\":\"a\\\"b\\u00e9\",\"d\":-1.5e2,\"t\":true,\"n\":null,"
+      "\"results\":[{\"uri\":\"/a.json\",\"text\":\"]}\"},{\"uri\":\"/b.json\",\"content\":{\"x\":[1,2]}}]}");
+
+  std::vector<std::string> rows;
+  const std::string whole(parseInChunks(json,json.length(),rows));
+  CPPUNIT_ASSERT_MESSAGE("events should be reported in document order",
+      "{key:total,number:2,key:escaped,string:a\"b\xc3\xa9,key:d,number:-1.5e2,key:t,true,key:n,null,key:results,[{row,{row,]}" == whole);
+  CPPUNIT_ASSERT_MESSAGE("both rows should be captured",2 == rows.size());
+
+  // every split of the text gives the same events
+  for (size_t chunk = 1;chunk < json.length();chunk++) {
+    std::vector<std::string> chunkRows;
+    CPPUNIT_ASSERT_MESSAGE("chunked events should match",whole == parseInChunks(json,chunk,chunkRows));
+    CPPUNIT_ASSERT_MESSAGE("chunked rows should match",rows == chunkRows);
+  }
+
+  mlclient::utilities::NativeJsonDocumentContent row;
+  row.setContent(rows[1]);
+  std::unique_ptr<IDocumentNavigator> nav(row.navigate());
+  CPPUNIT_ASSERT_MESSAGE("captured row should parse on its own","/b.json" == nav->getString("uri"));
+
+  bool threw = false;
+  try {
+    parseInChunks("{\"a\":[1,",1,rows);
+  } catch (mlclient::InvalidFormatException& ex) {
+    threw = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("truncated JSON should throw InvalidFormatException",threw);
+}
+
+void DocumentTraversalTest::testSerializedCache() {
+  TIMED_FUNC(testSerializedCache);
+
+  // JSON (cpprest), where each setContent must invalidate the cached text
+  mlclient::utilities::CppRestJsonDocumentContent json;
+  json.setContent("{\"a\":1}");
+  const std::string first = json.getContent();
+  CPPUNIT_ASSERT_MESSAGE("cpprest JSON repeated getContent should match",first == json.getContent());
+  CPPUNIT_ASSERT_MESSAGE("cpprest JSON getLength should match getContent",(int)first.length() == json.getLength());
+  web::json::value replacement = web::json::value::parse(utility::conversions::to_string_t(std::string("{\"b\":22}")));
+  json.setContent(replacement);
+  CPPUNIT_ASSERT_MESSAGE("cpprest JSON setContent(value) should refresh the text",
+      std::string::npos != json.getContent().find("22"));
+  CPPUNIT_ASSERT_MESSAGE("cpprest JSON getLength should follow setContent",
+      (int)json.getContent().length() == json.getLength());
+
+  // XML
+  mlclient::utilities::PugiXmlDocumentContent xml;
+  xml.setContent("<a>1</a>");
+  CPPUNIT_ASSERT_MESSAGE("XML getLength should match getContent",(int)xml.getContent().length() == xml.getLength());
+  xml.setContent("<b>22</b>");
+  CPPUNIT_ASSERT_MESSAGE("XML setContent should refresh the text",std::string::npos != xml.getContent().find("<b>22</b>"));
+  const std::string xtext = xml.getContent();
+  std::unique_ptr<std::istream> xstream(xml.getStream());
+  xml.setContent("<c>333</c>"); // the stream shares the old text, so is still valid
+  std::ostringstream xos;
+  xos << xstream->rdbuf();
+  CPPUNIT_ASSERT_MESSAGE("XML getStream should outlive setContent",xtext == xos.str());
+
+  // JSON (native)
+  mlclient::utilities::NativeJsonDocumentContent native;
+  native.setContent("{\"a\":1}");
+  CPPUNIT_ASSERT_MESSAGE("native JSON getContent should be {\"a\":1}","{\"a\":1}" == native.getContent());
+  native.setContent("[true]");
+  CPPUNIT_ASSERT_MESSAGE("native JSON setContent should refresh the text","[true]" == native.getContent());
+  CPPUNIT_ASSERT_MESSAGE("native JSON getLength should follow setContent",6 == native.getLength());
+  std::unique_ptr<std::istream> nstream;
+  {
+    mlclient::utilities::NativeJsonDocumentContent temporary;
+    temporary.setContent("[1,2]");
+    nstream.reset(temporary.getStream());
+  }
+  std::ostringstream nos;
+  nos << nstream->rdbuf();
+  CPPUNIT_ASSERT_MESSAGE("native JSON getStream should outlive its content","[1,2]" == nos.str());
+}
+
+namespace {
+
+/**
+ * Content that only provides getContent(), to test the default IDocumentContent::contentView()
+ */
+class MinimalContent : public IDocumentContent {
+public:
+  std::istream* getStream() const override {
+    return new std::istringstream(getContent());
+  }
+  std::string getContent() const override {
+    return "minimal";
+  }
+  std::string getMimeType() const override {
+    return IDocumentContent::MIME_TXT;
+  }
+  void setMimeType(const std::string& mt) override {
+    ;
+  }
+};
+
+} // end anonymous namespace
+
+void DocumentTraversalTest::testContentView() {
+  TIMED_FUNC(testContentView);
+
+  GenericTextDocumentContent text;
+  std::string source("<a>text</a>");
+  text.setContent(std::move(source));
+  text.setMimeType(IDocumentContent::MIME_XML);
+  const ContentView view = text.contentView();
+  CPPUNIT_ASSERT_MESSAGE("view should match getContent",view == text.getContent());
+  CPPUNIT_ASSERT_MESSAGE("size should match getLength",(size_t)text.getLength() == text.size());
+  CPPUNIT_ASSERT_MESSAGE("views should share the content's buffer rather than copy it",
+      view.data() == text.contentView().data());
+
+  std::unique_ptr<std::istream> stream(text.getStream());
+  std::ostringstream read;
+  read << stream->rdbuf();
+  CPPUNIT_ASSERT_MESSAGE("stream should read the whole content","<a>text</a>" == read.str());
+  stream->clear();
+  stream->seekg(3);
+  std::string rest;
+  *stream >> rest;
+  CPPUNIT_ASSERT_MESSAGE("stream should seek within the content","text</a>" == rest);
+
+  // helpers parse from the view
+  std::unique_ptr<pugi::xml_document> parsed(mlclient::utilities::PugiXmlHelper::fromDocument(text));
+  CPPUNIT_ASSERT_MESSAGE("PugiXmlHelper::fromDocument should parse the whole content",
+      std::string("text") == parsed->child("a").child_value());
+
+  // the default view owns a copy, so outlives its content
+  ContentView copied;
+  {
+    MinimalContent minimal;
+    copied = minimal.contentView();
+    CPPUNIT_ASSERT_MESSAGE("default size should match getContent",7 == minimal.size());
+  }
+  CPPUNIT_ASSERT_MESSAGE("default view should remain valid","minimal" == copied.str());
+}
+
+void DocumentTraversalTest::testSharedContent() {
+  TIMED_FUNC(testSharedContent);
+
+  GenericTextDocumentContent original;
+  original.setContent("{\"name\":\"original\"}");
+  GenericTextDocumentContent copy(original);
+  CPPUNIT_ASSERT_MESSAGE("a copy should share the content buffer",
+      original.contentView().data() == copy.contentView().data());
+  GenericTextDocumentContent fromText(static_cast<const ITextDocumentContent&>(original));
+  CPPUNIT_ASSERT_MESSAGE("a copy via ITextDocumentContent should share the content buffer",
+      original.contentView().data() == fromText.contentView().data());
+
+  // copy on write - changing the original leaves copies and views alone
+  const ContentView before = original.contentView();
+  original.setContent("{\"name\":\"changed\"}");
+  CPPUNIT_ASSERT_MESSAGE("the copy should keep the old content","{\"name\":\"original\"}" == copy.getContent());
+  CPPUNIT_ASSERT_MESSAGE("an earlier view should keep the old content","{\"name\":\"original\"}" == before.str());
+  CPPUNIT_ASSERT_MESSAGE("the original should have the new content","{\"name\":\"changed\"}" == original.getContent());
+
+  // Document copies share shared fragments
+  std::shared_ptr<GenericTextDocumentContent> content = std::make_shared<GenericTextDocumentContent>(copy);
+  Document doc("/shared.json");
+  doc.setContent(content);
+  Document docCopy(doc);
+  CPPUNIT_ASSERT_MESSAGE("a Document copy should share its content",docCopy.getContent() == doc.getContent());
+  CPPUNIT_ASSERT_MESSAGE("a Document copy should hold a reference to its content",3 == content.use_count());
+  doc.setContent(nullptr);
+  content.reset();
+  CPPUNIT_ASSERT_MESSAGE("the copy should keep the shared content alive",
+      "{\"name\":\"original\"}" == docCopy.getContent()->getContent());
+  CPPUNIT_ASSERT_MESSAGE("a raw pointer should not be reported as shared",nullptr == doc.getSharedContent());
+
+  // SearchDescription copies share the query and options buffers
+  SearchDescription desc;
+  GenericTextDocumentContent query;
+  query.setContent("{\"query\":{\"queries\":[]}}");
+  desc.setQuery(query);
+  SearchDescription descCopy(desc);
+  CPPUNIT_ASSERT_MESSAGE("a SearchDescription copy should share the query",
+      query.contentView().data() == descCopy.getQuery().contentView().data());
+}
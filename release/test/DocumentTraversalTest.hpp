@@ -26,6 +26,13 @@ class DocumentTraversalTest : public CppUnit::TestCase {
   CPPUNIT_TEST(testJsonTraversal);
   CPPUNIT_TEST(testXmlTraversal);
   CPPUNIT_TEST(testSubDocumentExtraction);
+  CPPUNIT_TEST(testXmlInPlaceParse);
+  CPPUNIT_TEST(testNativeJsonTraversal);
+  CPPUNIT_TEST(testNativeJsonBackend);
+  CPPUNIT_TEST(testJsonEventParser);
+  CPPUNIT_TEST(testSerializedCache);
+  CPPUNIT_TEST(testContentView);
+  CPPUNIT_TEST(testSharedContent);
   CPPUNIT_TEST_SUITE_END();
 public:
   void setUp();
@@ -34,6 +41,13 @@ public:
   void testJsonTraversal(void);
   void testXmlTraversal(void);
   void testSubDocumentExtraction(void);
+  void testXmlInPlaceParse(void);
+  void testNativeJsonTraversal(void);
+  void testNativeJsonBackend(void);
+  void testJsonEventParser(void);
+  void testSerializedCache(void);
+  void testContentView(void);
+  void testSharedContent(void);
 
   void testResult(IDocumentNode* root);
   void testResultN(IDocumentNavigator* root);
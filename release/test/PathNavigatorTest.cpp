@@ -16,6 +16,8 @@
 #include "mlclient/utilities/PugiXmlDocumentContent.hpp"
 #include "mlclient/utilities/CppRestJsonHelper.hpp"
 #include "mlclient/utilities/CppRestJsonDocumentContent.hpp"
+#include "mlclient/utilities/NativeJsonDocumentContent.hpp"
+#include "mlclient/InvalidFormatException.hpp"
 #include "mlclient/ext/pugixml/pugixml.hpp"
 
 
@@ -136,4 +138,291 @@ void PathNavigatorTest::testJsonPathExtended() {
   CPPUNIT_ASSERT_MESSAGE("subel1 string from at is null","" !=val2);
 
 
-};
\ No newline at end of file
+};
+
+void PathNavigatorTest::testTryAt() {
+  TIMED_FUNC(testTryAt);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering PathNavigatorTest::testTryAt";
+
+  // JSON
+  std::string raw = "{\"el1\":\"val1\",\"el3\":1234,\"el5\":123.456,\"arr1\": [\"av1\",\"av2\"],\"obj1\":{\"subel1\":\"subval1\"}}";
+  web::json::value val = web::json::value::parse(utility::conversions::to_string_t(raw));
+  std::unique_ptr<ITextDocumentContent> json(mlclient::utilities::CppRestJsonHelper::toDocument(val));
+  std::unique_ptr<IDocumentNavigator> nav(json->navigate(true));
+
+  CPPUNIT_ASSERT_MESSAGE("JSON missing key should be nullptr",nullptr == nav->tryAt("missing"));
+  std::unique_ptr<IDocumentNode> obj1(nav->tryAt("obj1"));
+  CPPUNIT_ASSERT_MESSAGE("JSON obj1 should exist",nullptr != obj1.get());
+  CPPUNIT_ASSERT_MESSAGE("JSON obj1 missing child should be nullptr",nullptr == obj1->tryAt("missing"));
+  CPPUNIT_ASSERT_MESSAGE("JSON obj1 subel1 should be subval1","subval1" == obj1->getString("subel1"));
+  std::unique_ptr<IDocumentNode> arr1(nav->tryAt("arr1"));
+  CPPUNIT_ASSERT_MESSAGE("JSON arr1 should exist",nullptr != arr1.get());
+  std::unique_ptr<IDocumentNode> av2(arr1->tryAt(1));
+  CPPUNIT_ASSERT_MESSAGE("JSON arr1[1] should exist",nullptr != av2.get());
+  CPPUNIT_ASSERT_MESSAGE("JSON arr1[1] should be av2","av2" == av2->asString());
+  CPPUNIT_ASSERT_MESSAGE("JSON arr1[2] should be nullptr",nullptr == arr1->tryAt(2));
+  CPPUNIT_ASSERT_MESSAGE("JSON arr1[-1] should be nullptr",nullptr == arr1->tryAt(-1));
+  CPPUNIT_ASSERT_MESSAGE("JSON el3 should be 1234",1234 == nav->getInteger("el3"));
+  CPPUNIT_ASSERT_MESSAGE("JSON missing integer should be the default",7 == nav->getInteger("missing",7));
+  CPPUNIT_ASSERT_MESSAGE("JSON object read as a string should be the default","fallback" == nav->getString("obj1","fallback"));
+  CPPUNIT_ASSERT_MESSAGE("JSON el5 should be 123.456",nav->getDouble("el5") > 123.455 && nav->getDouble("el5") < 123.457);
+
+  // XML
+  std::string rawXml = "<root total=\"12\"><el1>val1</el1><el3>1234</el3><arr1>av1</arr1><arr1>av2</arr1><obj1 uri=\"/a.xml\"><subel1>subval1</subel1></obj1></root>";
+  std::unique_ptr<pugi::xml_document> xval = mlclient::make_unique<pugi::xml_document>();
+  xval->load_string(rawXml.c_str());
+  std::unique_ptr<ITextDocumentContent> xml(mlclient::utilities::PugiXmlHelper::toDocument(std::move(xval)));
+  std::unique_ptr<IDocumentNavigator> xnav(xml->navigate(true));
+
+  CPPUNIT_ASSERT_MESSAGE("XML missing element should be nullptr",nullptr == xnav->tryAt("missing"));
+  CPPUNIT_ASSERT_MESSAGE("XML total attribute should be 12",12 == xnav->getInteger("total"));
+  CPPUNIT_ASSERT_MESSAGE("XML el1 should be val1","val1" == xnav->getString("el1"));
+  std::unique_ptr<IDocumentNode> xobj1(xnav->tryAt("obj1"));
+  CPPUNIT_ASSERT_MESSAGE("XML obj1 should exist",nullptr != xobj1.get());
+  CPPUNIT_ASSERT_MESSAGE("XML obj1 missing child should be nullptr",nullptr == xobj1->tryAt("missing"));
+  CPPUNIT_ASSERT_MESSAGE("XML obj1 uri attribute should be /a.xml","/a.xml" == xobj1->getString("uri"));
+  CPPUNIT_ASSERT_MESSAGE("XML obj1 subel1 should be subval1","subval1" == xobj1->getString("subel1"));
+  CPPUNIT_ASSERT_MESSAGE("XML missing string should be the default","none" == xobj1->getString("missing","none"));
+};
+
+void PathNavigatorTest::testNodeRef() {
+  TIMED_FUNC(testNodeRef);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering PathNavigatorTest::testNodeRef";
+
+  // JSON
+  std::string raw = "{\"el1\":\"val1\",\"arr1\": [\"av1\",\"av2\"],\"obj1\":{\"subel1\":\"subval1\",\"num\":42}}";
+  web::json::value val = web::json::value::parse(utility::conversions::to_string_t(raw));
+  std::unique_ptr<ITextDocumentContent> json(mlclient::utilities::CppRestJsonHelper::toDocument(val));
+  std::unique_ptr<IDocumentNavigator> nav(json->navigate(true));
+
+  DocumentNodeRef root = nav->ref();
+  CPPUNIT_ASSERT_MESSAGE("JSON root ref should not be empty",!root.isEmpty());
+  CPPUNIT_ASSERT_MESSAGE("JSON obj1/subel1 should be subval1","subval1" == root.at("obj1").at("subel1").asString());
+  CPPUNIT_ASSERT_MESSAGE("JSON obj1 num should be 42",42 == root.at("obj1").getInteger("num"));
+  CPPUNIT_ASSERT_MESSAGE("JSON missing chain should be empty",root.at("missing").at("deeper").isEmpty());
+  DocumentNodeRef arr1 = root.at("arr1");
+  CPPUNIT_ASSERT_MESSAGE("JSON arr1 should be an array of 2",arr1.isArray() && 2 == arr1.size());
+  CPPUNIT_ASSERT_MESSAGE("JSON arr1[1] should be av2","av2" == arr1.at(1).asString());
+  CPPUNIT_ASSERT_MESSAGE("JSON arr1[2] should be empty",arr1.at(2).isEmpty());
+  CPPUNIT_ASSERT_MESSAGE("JSON find obj1/subel1 should match at()",
+      root.at("obj1").at("subel1") == PathNavigator::find(root,"/obj1//subel1/"));
+
+  // the handle outlives the heap node it came from
+  DocumentNodeRef fromNode;
+  {
+    std::unique_ptr<IDocumentNode> obj1(nav->at("obj1"));
+    fromNode = obj1->ref();
+  }
+  CPPUNIT_ASSERT_MESSAGE("JSON ref from deleted node should still read","subval1" == fromNode.getString("subel1"));
+
+  // XML
+  std::string rawXml = "<root total=\"12\"><el1>val1</el1><arr1>av1</arr1><arr1>av2</arr1><arr1>av3</arr1><obj1 uri=\"/a.xml\"><subel1>subval1</subel1></obj1></root>";
+  std::unique_ptr<pugi::xml_document> xval = mlclient::make_unique<pugi::xml_document>();
+  xval->load_string(rawXml.c_str());
+  std::unique_ptr<ITextDocumentContent> xml(mlclient::utilities::PugiXmlHelper::toDocument(std::move(xval)));
+  std::unique_ptr<IDocumentNavigator> xnav(xml->navigate(true));
+
+  DocumentNodeRef xroot = xnav->ref();
+  CPPUNIT_ASSERT_MESSAGE("XML root ref should be an object",xroot.isObject());
+  CPPUNIT_ASSERT_MESSAGE("XML total attribute should be 12",12 == xroot.getInteger("total"));
+  CPPUNIT_ASSERT_MESSAGE("XML obj1 uri should be /a.xml","/a.xml" == xroot.at("obj1").getString("uri"));
+  CPPUNIT_ASSERT_MESSAGE("XML obj1/subel1 should be subval1","subval1" == PathNavigator::find(xroot,"obj1/subel1").asString());
+  DocumentNodeRef xarr1 = xroot.at("arr1");
+  CPPUNIT_ASSERT_MESSAGE("XML arr1 should be an array of 3",xarr1.isArray() && 3 == xarr1.size());
+  CPPUNIT_ASSERT_MESSAGE("XML arr1[2] should be av3","av3" == xarr1.at(2).asString());
+  CPPUNIT_ASSERT_MESSAGE("XML arr1[3] should be empty",xarr1.at(3).isEmpty());
+  CPPUNIT_ASSERT_MESSAGE("XML missing child should be empty",xroot.at("missing").isEmpty());
+
+  std::unique_ptr<IDocumentNode> heap(xarr1.newNode());
+  CPPUNIT_ASSERT_MESSAGE("XML heap node from ref should be an array of 3",heap->isArray() && 3 == heap->size());
+};
+
+namespace {
+
+/**
+ * A navigator that only implements the virtual navigation functions, as an implementation from before
+ * DocumentNodeRef would, so its ref() is empty
+ */
+class UnreferencedNavigator : public IDocumentNavigator {
+public:
+  UnreferencedNavigator(const IDocumentNavigator* wrapped) : wrapped(wrapped) {
+    ;
+  }
+  IDocumentNode* firstChild() const override {
+    return wrapped->firstChild();
+  }
+  IDocumentNode* at(const std::string& key) const override {
+    return wrapped->at(key);
+  }
+  bool has(const std::string& key) const override {
+    return wrapped->has(key);
+  }
+private:
+  const IDocumentNavigator* wrapped;
+};
+
+} // end anonymous namespace
+
+void PathNavigatorTest::testWithoutNodeRef() {
+  TIMED_FUNC(testWithoutNodeRef);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering PathNavigatorTest::testWithoutNodeRef";
+
+  std::string raw = "{\"el1\":\"val1\",\"obj1\":{\"subel1\":\"subval1\",\"obj2\":{\"subel2\":\"subval2\"}}}";
+  web::json::value val = web::json::value::parse(utility::conversions::to_string_t(raw));
+  std::unique_ptr<ITextDocumentContent> doc(mlclient::utilities::CppRestJsonHelper::toDocument(val));
+  std::unique_ptr<IDocumentNavigator> real(doc->navigate(true));
+  UnreferencedNavigator nav(real.get());
+  CPPUNIT_ASSERT_MESSAGE("Navigator should not have a node handle",nav.ref().isEmpty());
+
+  // paths are walked with at() rather than node handles
+  std::unique_ptr<IDocumentNode> el1(PathNavigator::navigate(&nav,"el1"));
+  CPPUNIT_ASSERT_MESSAGE("el1 should be val1","val1" == el1->asString());
+  std::unique_ptr<IDocumentNode> subel2(PathNavigator::navigate(&nav,"/obj1/obj2/subel2"));
+  CPPUNIT_ASSERT_MESSAGE("obj1/obj2/subel2 should be subval2","subval2" == subel2->asString());
+
+  bool thrown = false;
+  try {
+    std::unique_ptr<IDocumentNode> missing(PathNavigator::navigate(&nav,""));
+  } catch (mlclient::InvalidFormatException& ife) {
+    thrown = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("An empty path should throw",thrown);
+}
+
+void PathNavigatorTest::testPathOwnership() {
+  TIMED_FUNC(testPathOwnership);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering PathNavigatorTest::testPathOwnership";
+
+  // XML - nodes from a path share the document, so outlive the content and navigator they came from
+  std::unique_ptr<IDocumentNode> xobj1;
+  std::unique_ptr<IDocumentNode> xsubel1;
+  {
+    std::string rawXml = "<root><obj1 uri=\"/a.xml\"><subel1>subval1</subel1></obj1></root>";
+    std::unique_ptr<pugi::xml_document> xval = mlclient::make_unique<pugi::xml_document>();
+    xval->load_string(rawXml.c_str());
+    std::unique_ptr<ITextDocumentContent> xml(mlclient::utilities::PugiXmlHelper::toDocument(std::move(xval)));
+    std::unique_ptr<IDocumentNavigator> xnav(xml->navigate(true));
+    xobj1.reset(PathNavigator::navigate(xnav.get(),"/obj1"));
+  }
+  xsubel1.reset(PathNavigator::at(xobj1.get(),"subel1"));
+  xobj1.reset();
+  CPPUNIT_ASSERT_MESSAGE("XML node from a path did not outlive its content","subval1" == xsubel1->asString());
+
+  // native JSON
+  std::unique_ptr<IDocumentNode> obj1;
+  std::unique_ptr<IDocumentNode> subel1;
+  {
+    NativeJsonDocumentContent json;
+    json.setContent("{\"obj1\":{\"subel1\":\"subval1\"}}");
+    std::unique_ptr<IDocumentNavigator> nav(json.navigate(false));
+    obj1.reset(PathNavigator::navigate(nav.get(),"/obj1"));
+  }
+  subel1.reset(PathNavigator::at(obj1.get(),"subel1"));
+  obj1.reset();
+  CPPUNIT_ASSERT_MESSAGE("JSON node from a path did not outlive its content","subval1" == subel1->asString());
+}
+
+void PathNavigatorTest::testXmlIndexedChildren() {
+  TIMED_FUNC(testXmlIndexedChildren);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering PathNavigatorTest::testXmlIndexedChildren";
+
+  std::string raw = "<response>";
+  for (int i = 0;i < 5000;i++) {
+    raw += "<result index=\"" + std::to_string(i) + "\"><uri>/doc" + std::to_string(i) + ".xml</uri></result>";
+  }
+  raw += "<total>5000</total></response>";
+  std::unique_ptr<pugi::xml_document> xval = mlclient::make_unique<pugi::xml_document>();
+  xval->load_string(raw.c_str());
+  std::unique_ptr<ITextDocumentContent> xml(mlclient::utilities::PugiXmlHelper::toDocument(std::move(xval)));
+  std::unique_ptr<IDocumentNavigator> nav(xml->navigate(true));
+
+  std::unique_ptr<IDocumentNode> results(nav->at("result"));
+  CPPUNIT_ASSERT_MESSAGE("result should be an array of 5000",results->isArray() && 5000 == results->size());
+  for (int i = 0;i < 5000;i++) {
+    std::unique_ptr<IDocumentNode> row(results->at(i));
+    CPPUNIT_ASSERT_MESSAGE("result index attribute should match its position",i == row->getInteger("index"));
+  }
+  CPPUNIT_ASSERT_MESSAGE("result[5000] should be null",nullptr == results->at(5000));
+
+  std::unique_ptr<IDocumentNode> row(results->at(42));
+  CPPUNIT_ASSERT_MESSAGE("result[42] should have a uri",row->has("uri") && !row->has("missing"));
+  CPPUNIT_ASSERT_MESSAGE("result[42] uri should be /doc42.xml","/doc42.xml" == row->getString("uri"));
+  CPPUNIT_ASSERT_MESSAGE("result[42] missing child should be null",nullptr == row->tryAt("missing"));
+
+  std::vector<DocumentNodeRef> members = nav->ref().at("result").members();
+  CPPUNIT_ASSERT_MESSAGE("result members should be 5000 long",5000 == members.size());
+  CPPUNIT_ASSERT_MESSAGE("last member uri should be /doc4999.xml","/doc4999.xml" == members.back().getString("uri"));
+  CPPUNIT_ASSERT_MESSAGE("a single element should be its only member",1 == nav->ref().at("total").members().size());
+  CPPUNIT_ASSERT_MESSAGE("an empty handle should have no members",DocumentNodeRef().members().empty());
+};
+
+void PathNavigatorTest::testCompiledPath() {
+  TIMED_FUNC(testCompiledPath);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering PathNavigatorTest::testCompiledPath";
+
+  // JSON
+  NativeJsonDocumentContent json;
+  json.setContent("{\"total\":3,\"results\":[{\"uri\":\"/a.json\",\"content\":{\"name\":\"a\"}},"
+      "{\"uri\":\"/b.json\",\"content\":{\"name\":\"b\"}},{\"uri\":\"/c.json\"}]}");
+  std::unique_ptr<IDocumentNavigator> nav(json.navigate(true));
+  DocumentNodeRef root = nav->ref();
+
+  const CompiledPath second("/results[1]/content/name");
+  CPPUNIT_ASSERT_MESSAGE("JSON path should have 4 steps",4 == second.getStepCount());
+  CPPUNIT_ASSERT_MESSAGE("JSON results[1]/content/name should be b","b" == second.find(root).asString());
+  CPPUNIT_ASSERT_MESSAGE("JSON path should match PathNavigator::find",
+      PathNavigator::find(root,"results") == CompiledPath("results").find(root));
+  CPPUNIT_ASSERT_MESSAGE("JSON results[3] should be empty",CompiledPath("results[3]").find(root).isEmpty());
+  CPPUNIT_ASSERT_MESSAGE("JSON empty path should be the root",root == CompiledPath("").find(root));
+  CPPUNIT_ASSERT_MESSAGE("JSON total[0] should be total",3 == CompiledPath("total[0]").find(root).asInteger());
+
+  std::vector<DocumentNodeRef> uris;
+  CPPUNIT_ASSERT_MESSAGE("JSON results/*/uri should match 3",3 == CompiledPath("results/*/uri").findAll(root,uris));
+  CPPUNIT_ASSERT_MESSAGE("JSON matches should be in document order","/c.json" == uris[2].asString());
+  CPPUNIT_ASSERT_MESSAGE("JSON first wildcard match should be /a.json",
+      "/a.json" == CompiledPath("results/*/uri").find(root).asString());
+  std::vector<DocumentNodeRef> names;
+  CPPUNIT_ASSERT_MESSAGE("JSON results/*/content/name should match 2",
+      2 == CompiledPath("results/*/content/name").findAll(root,names));
+
+  // several paths in one traversal
+  CompiledPathSet set;
+  const size_t totalPos = set.add("total");
+  const size_t namePos = set.add("results[1]/content/name");
+  const size_t uriPos = set.add(CompiledPath("results[1]/uri"));
+  const size_t missingPos = set.add("results[1]/missing");
+  CPPUNIT_ASSERT_MESSAGE("set should hold 4 paths",4 == set.size());
+  std::vector<DocumentNodeRef> found;
+  set.find(root,found);
+  CPPUNIT_ASSERT_MESSAGE("set should fill a result per path",4 == found.size());
+  CPPUNIT_ASSERT_MESSAGE("set total should be 3",3 == found[totalPos].asInteger());
+  CPPUNIT_ASSERT_MESSAGE("set name should be b","b" == found[namePos].asString());
+  CPPUNIT_ASSERT_MESSAGE("set uri should be /b.json","/b.json" == found[uriPos].asString());
+  CPPUNIT_ASSERT_MESSAGE("set missing path should be empty",found[missingPos].isEmpty());
+
+  bool threw = false;
+  try {
+    CompiledPath invalid("results[x]");
+  } catch (mlclient::InvalidFormatException& ex) {
+    threw = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("invalid index should throw InvalidFormatException",threw);
+
+  // XML, where a single element and repeated elements are read alike
+  std::string raw = "<root><result><uri>/a.xml</uri></result><result><uri>/b.xml</uri></result><single><uri>/s.xml</uri></single></root>";
+  std::unique_ptr<pugi::xml_document> xval = mlclient::make_unique<pugi::xml_document>();
+  xval->load_string(raw.c_str());
+  std::unique_ptr<ITextDocumentContent> xml(mlclient::utilities::PugiXmlHelper::toDocument(std::move(xval)));
+  std::unique_ptr<IDocumentNavigator> xnav(xml->navigate(true));
+  DocumentNodeRef xroot = xnav->ref();
+  CPPUNIT_ASSERT_MESSAGE("XML result[1]/uri should be /b.xml","/b.xml" == CompiledPath("result[1]/uri").find(xroot).asString());
+  CPPUNIT_ASSERT_MESSAGE("XML single[0]/uri should be /s.xml","/s.xml" == CompiledPath("single[0]/uri").find(xroot).asString());
+  std::vector<DocumentNodeRef> xuris;
+  CPPUNIT_ASSERT_MESSAGE("XML result/*/uri should match 2",2 == CompiledPath("result/*/uri").findAll(xroot,xuris));
+};
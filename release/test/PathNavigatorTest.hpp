@@ -23,6 +23,12 @@ class PathNavigatorTest : public CppUnit::TestCase {
     CPPUNIT_TEST(testXmlPath);
     CPPUNIT_TEST(testJsonPath);
     CPPUNIT_TEST(testJsonPathExtended);
+    CPPUNIT_TEST(testTryAt);
+    CPPUNIT_TEST(testNodeRef);
+    CPPUNIT_TEST(testWithoutNodeRef);
+    CPPUNIT_TEST(testPathOwnership);
+    CPPUNIT_TEST(testXmlIndexedChildren);
+    CPPUNIT_TEST(testCompiledPath);
   CPPUNIT_TEST_SUITE_END();
 public:
   void setUp();
@@ -31,6 +37,12 @@ public:
   void testXmlPath(void);
   void testJsonPath(void);
   void testJsonPathExtended(void);
+  void testTryAt(void);
+  void testNodeRef(void);
+  void testWithoutNodeRef(void);
+  void testPathOwnership(void);
+  void testXmlIndexedChildren(void);
+  void testCompiledPath(void);
 private:
   IConnection* ml;
 };
@@ -0,0 +1,203 @@
+/**
+ * \file QueryBatcherTest.cpp
+ *
+ * \date 18 Oct 2026
+ * \author adamfowler
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "QueryBatcherTest.hpp"
+#include "ConnectionFactory.hpp"
+#include "mlclient/Connection.hpp"
+#include "mlclient/Document.hpp"
+#include "mlclient/DocumentSet.hpp"
+#include "mlclient/utilities/AutoBatchingConnection.hpp"
+#include "mlclient/utilities/QueryBatcher.hpp"
+#include "mlclient/InvalidFormatException.hpp"
+#include "mlclient/DocumentContent.hpp"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mlclient/logging.hpp"
+
+using namespace mlclient;
+using namespace mlclient::utilities;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QueryBatcherTest);
+
+class ReadObserver : public mlclient::utilities::IQueryBatchNotifiable {
+public:
+  ReadObserver() : uris(0), documents(0), failures(0) {
+    ;
+  }
+
+  void queryBatchComplete(QueryBatch& batch) override {
+    LOG(DEBUG) << "Read batch " << batch.getSequence() << " (OK?: " << batch.isSuccess() << ") documents: " << batch.getDocuments().size();
+    uris += batch.getUris().size();
+    documents += batch.getDocuments().size();
+    if (!batch.isSuccess()) {
+      ++failures;
+    }
+  }
+
+  std::atomic<long> uris;
+  std::atomic<long> documents;
+  std::atomic<long> failures;
+};
+
+/**
+ * Counts each URI listed, and saves a matching document once the first batch has been listed
+ */
+class LateIngestObserver : public mlclient::utilities::IQueryBatchNotifiable {
+public:
+  LateIngestObserver(IConnection* conn,const std::string& uri) : mConn(conn), lateUri(uri), saved(false),
+    mtx(), seen() {
+    ;
+  }
+
+  void queryBatchComplete(QueryBatch& batch) override {
+    if (!saved.exchange(true)) {
+      GenericTextDocumentContent content;
+      content.setContent("{\"name\": \"Latecomer\", \"animal\": \"Sloth\"}");
+      content.setMimeType(IDocumentContent::MIME_JSON);
+      Document late(lateUri);
+      late.setContent(&content);
+      late.setCollections(CollectionSet{"zoo"});
+      delete mConn->saveDocument(late);
+    }
+    std::unique_lock<std::mutex> lck(mtx);
+    for (auto& uri : batch.getUris()) {
+      seen[uri]++;
+    }
+  }
+
+  IConnection* mConn;
+  std::string lateUri;
+  std::atomic<bool> saved;
+  std::mutex mtx;
+  std::map<std::string,long> seen;
+};
+
+/**
+ * A connection whose searches always fail, so no page of URIs can be listed. Never contacts the server.
+ */
+class FailingSearchConnection : public mlclient::utilities::AutoBatchingConnection {
+public:
+  FailingSearchConnection(IConnection* conn) : AutoBatchingConnection(conn) {
+    ;
+  }
+
+  Response* search(const SearchDescription& desc) override {
+    throw InvalidFormatException("search unavailable");
+  }
+};
+
+void QueryBatcherTest::setUp(void) {
+  LOG(DEBUG) << "ENTERING TEST SUITE QueryBatcherTest::setUp";
+  ml = ConnectionFactory::getConnection();
+}
+
+void QueryBatcherTest::tearDown(void) {
+  LOG(DEBUG) << "LEAVING TEST SUITE QueryBatcherTest::tearDown";
+  ConnectionFactory::releaseConnection(ml);
+  ml = nullptr;
+}
+
+void QueryBatcherTest::testCollection(void) {
+  TIMED_FUNC(testCollection);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering QueryBatcherTest::testCollection";
+
+  ReadObserver obs;
+
+  // zoo collection is loaded by main() before the tests run
+  QueryBatcher batcher(ml);
+  batcher.setCollection("zoo");
+  batcher.setBatchParameters(2,2,1);
+  batcher.addBatchListener(&obs);
+
+  batcher.send();
+  batcher.wait();
+
+  Progress p = batcher.getProgress();
+  LOG(DEBUG) << "Progress: Complete: " << p.completed << ", total: " << p.total;
+
+  CPPUNIT_ASSERT_MESSAGE("No URIs were listed",obs.uris > 0);
+  CPPUNIT_ASSERT_MESSAGE("A batch failed",0 == obs.failures);
+  CPPUNIT_ASSERT_MESSAGE("Not every listed document was read",obs.uris == obs.documents);
+  CPPUNIT_ASSERT_MESSAGE("Progress does not match listed URIs",obs.uris == p.completed);
+  CPPUNIT_ASSERT_MESSAGE("Batcher not set to finished",batcher.isFinished());
+
+  // quotes and backslashes in a collection name must not break the generated query
+  ReadObserver escaped;
+  QueryBatcher quoted(ml);
+  quoted.setCollection("zoo\"]}} \\");
+  quoted.setBatchParameters(2,2,0);
+  quoted.addBatchListener(&escaped);
+  quoted.send();
+  quoted.wait();
+  CPPUNIT_ASSERT_MESSAGE("A quoted collection name should match no documents",0 == escaped.uris);
+  CPPUNIT_ASSERT_MESSAGE("A quoted collection name should not fail the query",
+      0 == escaped.failures && 0 == quoted.getFailedBatches());
+}
+
+void QueryBatcherTest::testPointInTime(void) {
+  TIMED_FUNC(testPointInTime);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering QueryBatcherTest::testPointInTime";
+
+  // worker tasks send their requests on their own connections
+  std::vector<IConnection*> connections;
+  for (int c = 0;c < 3;c++) {
+    connections.push_back(ConnectionFactory::getConnection());
+  }
+
+  const std::string lateUri("/test/querybatcher/late.json");
+  LateIngestObserver obs(ml,lateUri);
+  QueryBatcher batcher(ml);
+  batcher.setCollection("zoo");
+  batcher.setBatchParameters(3,2,1);
+  batcher.setFetchConnections(connections);
+  batcher.addBatchListener(&obs);
+  batcher.send();
+  batcher.wait();
+  delete ml->deleteDocument(lateUri);
+  for (auto& conn : connections) {
+    ConnectionFactory::releaseConnection(conn);
+  }
+
+  LOG(DEBUG) << "Point in time timestamp: " << batcher.getTimestamp();
+  bool once = true;
+  for (auto& entry : obs.seen) {
+    once = once && 1 == entry.second;
+  }
+  CPPUNIT_ASSERT_MESSAGE("No URIs were listed",!obs.seen.empty());
+  CPPUNIT_ASSERT_MESSAGE("A URI was listed more than once",once);
+  CPPUNIT_ASSERT_MESSAGE("A document ingested after the first listing was listed",obs.seen.end() == obs.seen.find(lateUri));
+  CPPUNIT_ASSERT_MESSAGE("A batch failed",0 == batcher.getFailedBatches());
+  CPPUNIT_ASSERT_MESSAGE("Batcher not set to finished",batcher.isFinished());
+}
+
+void QueryBatcherTest::testListFailure(void) {
+  TIMED_FUNC(testListFailure);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering QueryBatcherTest::testListFailure";
+
+  FailingSearchConnection failing(ml);
+  ReadObserver obs;
+  QueryBatcher batcher(&failing);
+  batcher.setCollection("zoo");
+  batcher.setBatchParameters(2,2,0);
+  batcher.addBatchListener(&obs);
+  batcher.send();
+  batcher.wait();
+
+  CPPUNIT_ASSERT_MESSAGE("The unlisted page should be passed on as failed",obs.failures > 0);
+  CPPUNIT_ASSERT_MESSAGE("Batcher should report the listing failure",batcher.isListFailed());
+  CPPUNIT_ASSERT_MESSAGE("Batcher should not be finished when a page could not be listed",!batcher.isFinished());
+  CPPUNIT_ASSERT_MESSAGE("Batcher should still complete",batcher.isComplete());
+}
@@ -0,0 +1,37 @@
+/**
+ * \file QueryBatcherTest.hpp
+ *
+ * \date 18 Oct 2026
+ * \author adamfowler
+ */
+
+#ifndef TEST_QUERYBATCHERTEST_HPP_
+#define TEST_QUERYBATCHERTEST_HPP_
+
+#include <cppunit/Test.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ConnectionFactory.hpp"
+#include "mlclient/Connection.hpp"
+
+using namespace mlclient;
+
+class QueryBatcherTest : public CppUnit::TestCase {
+  CPPUNIT_TEST_SUITE(QueryBatcherTest);
+    CPPUNIT_TEST(testCollection);
+    CPPUNIT_TEST(testPointInTime);
+    CPPUNIT_TEST(testListFailure);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  void setUp();
+  void tearDown();
+
+  void testCollection(void);
+  void testPointInTime(void);
+  void testListFailure(void);
+private:
+  IConnection* ml;
+};
+
+#endif /* TEST_QUERYBATCHERTEST_HPP_ */
@@ -8,6 +8,8 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 #include "ConnectionFactory.hpp"
 #include "mlclient/Connection.hpp"
@@ -15,9 +17,11 @@
 #include "mlclient/DocumentContent.hpp"
 #include "mlclient/SearchDescription.hpp"
 #include "mlclient/NoCredentialsException.hpp"
+#include "mlclient/InvalidFormatException.hpp"
 
 #include "SearchBuilderTest.hpp"
 #include "mlclient/utilities/SearchBuilder.hpp"
+#include "mlclient/utilities/CppRestJsonHelper.hpp"
 #include "mlclient/SearchResultSet.hpp"
 #include "mlclient/SearchResult.hpp"
 
@@ -109,3 +113,47 @@ void SearchBuilderTest::testAll() {
 
   // NB Response deleted by SearchResultSet fetch() method
 }
+
+void SearchBuilderTest::testRangeQuery() {
+  TIMED_FUNC(testRangeQuery);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchBuilderTest::testRangeQuery";
+  SearchBuilder builder;
+
+  // quotes, backslashes and control characters in the property and value must still give valid JSON
+  const std::string property("na\"me\\");
+  const std::string value("a\"b\\c\nd\te\x01");
+  std::unique_ptr<IQuery> text(builder.jsonRangeQuery(property,RangeOperation::GT,value,RangeIndexType::STRING));
+  std::ostringstream textOs;
+  textOs << *text;
+  LOG(DEBUG) << "String range query: " << textOs.str();
+  const web::json::value json(CppRestJsonHelper::fromString(textOs.str()));
+  const web::json::value& range = json.at(U("range-query"));
+  CPPUNIT_ASSERT_MESSAGE("The property should round trip",
+      property == utility::conversions::to_utf8string(range.at(U("json-property")).as_string()));
+  CPPUNIT_ASSERT_MESSAGE("The value should round trip",
+      value == utility::conversions::to_utf8string(range.at(U("value")).as_string()));
+
+  // numbers are written unquoted, keeping all their digits
+  std::unique_ptr<IQuery> number(builder.jsonRangeQuery("id",RangeOperation::LT,"-12345678901234567890.5e+3",
+      RangeIndexType::DECIMAL));
+  std::ostringstream numberOs;
+  numberOs << *number;
+  CPPUNIT_ASSERT_MESSAGE("A decimal should be written as it was given",
+      std::string::npos != numberOs.str().find("\"value\": -12345678901234567890.5e+3,"));
+
+  bool threw = false;
+  try {
+    std::unique_ptr<IQuery> bad(builder.jsonRangeQuery("id",RangeOperation::GT,"1,\"x\":2",RangeIndexType::LONG));
+  } catch (mlclient::InvalidFormatException& ex) {
+    threw = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("A non numeric value for a numeric type should throw InvalidFormatException",threw);
+  threw = false;
+  try {
+    std::unique_ptr<IQuery> bad(builder.xmlRangeQuery("flag",RangeOperation::GT,"yes",RangeIndexType::BOOLEAN));
+  } catch (mlclient::InvalidFormatException& ex) {
+    threw = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("A non boolean value for a boolean type should throw InvalidFormatException",threw);
+}
@@ -21,12 +21,14 @@ using namespace mlclient;
 class SearchBuilderTest : public CppUnit::TestCase {
   CPPUNIT_TEST_SUITE(SearchBuilderTest);
     CPPUNIT_TEST(testAll);
+    CPPUNIT_TEST(testRangeQuery);
   CPPUNIT_TEST_SUITE_END();
 public:
   void setUp();
   void tearDown();
 
   void testAll(void);
+  void testRangeQuery(void);
 private:
   IConnection* ml;
 };
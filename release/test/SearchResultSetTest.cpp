@@ -6,13 +6,26 @@
  */
 
 #include "SearchResultSetTest.hpp"
+#include "mlclient/Document.hpp"
 #include "mlclient/SearchResult.hpp"
 #include "mlclient/SearchResultSet.hpp"
+#include "mlclient/utilities/AutoBatchingConnection.hpp"
 #include "mlclient/utilities/SearchBuilder.hpp"
 #include "mlclient/utilities/SearchOptionsBuilder.hpp"
 
 #include "mlclient/logging.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 using namespace mlclient;
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SearchResultSetTest);
@@ -40,6 +53,20 @@ void SearchResultSetTest::tearDown(void) {
   ml = nullptr;
 }
 
+/**
+ * A JSON search of the zoo collection, which spans several pages of the given length
+ */
+SearchDescription* SearchResultSetTest::zooSearch(long pageLength) {
+  SearchDescription* desc = new SearchDescription;
+  GenericTextDocumentContent query;
+  query.setContent("{\"collection-query\": {\"uri\": [\"zoo\"]}}");
+  query.setMimeType(IDocumentContent::MIME_JSON);
+  desc->setQuery(query);
+  desc->setResponseMimeType(IDocumentContent::MIME_JSON);
+  desc->setPageLength(pageLength);
+  return desc;
+}
+
 void SearchResultSetTest::testEmptySearch() {
   TIMED_FUNC(testEmptySearch);
   LOG(DEBUG) << " --------------------------------------------";
@@ -464,3 +491,490 @@ void SearchResultSetTest::testCustomSnippetJson() {
 
 
 };
+
+void SearchResultSetTest::testPrefetchPages() {
+  TIMED_FUNC(testPrefetchPages);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testPrefetchPages";
+
+  SearchDescription* desc = zooSearch(2); // many small pages, so several are in flight at once
+  GenericTextDocumentContent options;
+  options.setContent("{\"transform-results\": {\"apply\": \"empty-snippet\"}}");
+  options.setMimeType(IDocumentContent::MIME_JSON);
+  desc->setOptions(options);
+
+  SearchResultSet* results = new SearchResultSet(ml,desc);
+  results->setPrefetchPages(4);
+  CPPUNIT_ASSERT_MESSAGE("Prefetch pages not set",4 == results->getPrefetchPages());
+
+  bool res = results->fetch(); // BLOCKS for the first page only
+  CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+  CPPUNIT_ASSERT_MESSAGE("Zoo collection should span more than 4 pages of 2",results->getTotal() > 8);
+
+  long count = 0;
+  long expectedIndex = 1;
+  bool inOrder = true;
+  SearchResultSetIterator* iter = results->begin();
+  SearchResultSetIterator* end = results->end();
+  for (;(*iter) != (*end);++(*iter)) {
+    SearchResult result(iter->first());
+    inOrder = inOrder && (expectedIndex == result.getIndex());
+    ++expectedIndex;
+    ++count;
+  }
+  LOG(DEBUG) << "Iterated " << count << " of " << results->getTotal() << " results";
+
+  CPPUNIT_ASSERT_MESSAGE("Not every result was iterated",results->getTotal() == count);
+  CPPUNIT_ASSERT_MESSAGE("Prefetched pages were not handed over in order",inOrder);
+
+  delete results;
+}
+
+void SearchResultSetTest::testStreaming() {
+  TIMED_FUNC(testStreaming);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testStreaming";
+
+  SearchDescription* desc = zooSearch(3);
+  GenericTextDocumentContent options;
+  options.setContent("{\"transform-results\": {\"apply\": \"raw\"}}");
+  options.setMimeType(IDocumentContent::MIME_JSON);
+  desc->setOptions(options);
+
+  SearchResultSet* results = new SearchResultSet(ml,desc);
+  results->setStreaming(true);
+  results->setPrefetchPages(2);
+  CPPUNIT_ASSERT_MESSAGE("Streaming not set",results->isStreaming());
+
+  bool res = results->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+
+  long count = 0;
+  std::string blankString("");
+  SearchResultSetIterator* iter = results->begin();
+  SearchResultSetIterator* end = results->end();
+  for (;(*iter) != (*end);++(*iter)) {
+    const SearchResult& result(iter->first());
+    CPPUNIT_ASSERT_MESSAGE("Result does not have a URI",0!=blankString.compare(result.getUri()));
+    CPPUNIT_ASSERT_MESSAGE("Result does not have content",nullptr != result.getDetailContent());
+    std::this_thread::sleep_for(std::chrono::milliseconds(5)); // a slow consumer, so pages arrive ahead of it
+    ++count;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Not every result was streamed",results->getTotal() == count);
+
+  // only the page being iterated, the pages being requested and the parse backlog are ever held
+  PipelineTimings timings = results->getPipelineTimings();
+  LOG(DEBUG) << "Most pages held whilst streaming: " << timings.mostPagesHeld << " of " << results->getPageCount();
+  CPPUNIT_ASSERT_MESSAGE("Streaming held more pages than its window",
+      timings.mostPagesHeld <= 1 + results->getPrefetchPages() + results->getParseBacklog());
+
+  // the first page has been freed, so going back to it must fail cleanly
+  bool released = false;
+  try {
+    results->begin()->first();
+  } catch (std::out_of_range& oor) {
+    released = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Iterated pages were not released",released);
+
+  delete results;
+}
+
+void SearchResultSetTest::testPointInTime() {
+  TIMED_FUNC(testPointInTime);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testPointInTime";
+
+  SearchDescription* desc = zooSearch(4);
+
+  SearchResultSet* results = new SearchResultSet(ml,desc);
+  results->setPrefetchPages(3);
+  CPPUNIT_ASSERT_MESSAGE("Point in time should be enabled by default",results->isPointInTime());
+
+  bool res = results->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+  LOG(DEBUG) << "Point in time timestamp: " << results->getTimestamp();
+  const long total = results->getTotal();
+
+  // a matching document ingested after the first page must not appear on a later page
+  const std::string lateUri("/test/searchresultset/late.json");
+  GenericTextDocumentContent lateContent;
+  lateContent.setContent("{\"name\": \"Latecomer\", \"animal\": \"Sloth\"}");
+  lateContent.setMimeType(IDocumentContent::MIME_JSON);
+  Document late(lateUri);
+  late.setContent(&lateContent);
+  late.setCollections(CollectionSet{"zoo"});
+  delete ml->saveDocument(late);
+
+  std::set<std::string> uris;
+  long count = 0;
+  SearchResultSetIterator* iter = results->begin();
+  SearchResultSetIterator* end = results->end();
+  for (;(*iter) != (*end);++(*iter)) {
+    uris.insert(iter->first().getUri());
+    ++count;
+  }
+  delete ml->deleteDocument(lateUri);
+  CPPUNIT_ASSERT_MESSAGE("Not every result was iterated",total == count);
+  CPPUNIT_ASSERT_MESSAGE("The total changed after the first page",total == results->getTotal());
+  CPPUNIT_ASSERT_MESSAGE("A result was returned on more than one page",(long)uris.size() == count);
+  CPPUNIT_ASSERT_MESSAGE("A document ingested after the first page was returned",uris.end() == uris.find(lateUri));
+
+  // the timestamp must survive being copied for each page request
+  SearchDescription pinned;
+  pinned.setTimestamp(results->getTimestamp());
+  SearchDescription copy(pinned);
+  CPPUNIT_ASSERT_MESSAGE("Timestamp not copied",results->getTimestamp() == copy.getTimestamp());
+
+  delete results;
+}
+
+void SearchResultSetTest::testSearchAfter() {
+  TIMED_FUNC(testSearchAfter);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testSearchAfter";
+
+  // needs a string range index on the name JSON property. Names in the zoo collection are unique.
+  SearchDescription* desc = zooSearch(2);
+  SearchResultSet* results = new SearchResultSet(ml,desc);
+  results->setSearchAfter("name",RangeIndexType::STRING);
+  results->setPrefetchPages(2);
+  CPPUNIT_ASSERT_MESSAGE("Search after was not set",results->isSearchAfter());
+
+  bool res = results->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+  const long total = results->getTotal();
+  CPPUNIT_ASSERT_MESSAGE("Zoo collection should span more than one page of 2",total > 2);
+
+  std::vector<std::string> uris;
+  for (const SearchResult& result : results->items()) {
+    uris.push_back(result.getUri());
+  }
+  delete results;
+
+  // every page after the first is found by the last key of the page before, so any duplicate or skipped key shows
+  std::set<std::string> unique(uris.begin(),uris.end());
+  CPPUNIT_ASSERT_MESSAGE("A result was returned on more than one page",unique.size() == uris.size());
+  CPPUNIT_ASSERT_MESSAGE("Results were skipped between pages",total == (long)uris.size());
+
+  // the same results as offset paging
+  SearchDescription* offsetDesc = zooSearch(2);
+  SearchResultSet* offset = new SearchResultSet(ml,offsetDesc);
+  res = offset->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Offset fetch operation did not succeed", res);
+  std::set<std::string> expected;
+  for (const SearchResult& result : offset->items()) {
+    expected.insert(result.getUri());
+  }
+  delete offset;
+  CPPUNIT_ASSERT_MESSAGE("Search after paging returned different results to offset paging",expected == unique);
+}
+
+namespace {
+
+/**
+ * Sends one search at a time, as a real connection does, and records the most searches being sent at once across
+ * every instance sharing the same counters
+ */
+class SerializingConnection : public mlclient::utilities::AutoBatchingConnection {
+public:
+  SerializingConnection(IConnection* wrapped,std::atomic<int>& sending,std::atomic<int>& mostSending) :
+    mlclient::utilities::AutoBatchingConnection(wrapped), requestMutex(), sending(sending), mostSending(mostSending) {
+    ;
+  }
+  Response* search(const SearchDescription& desc) override {
+    std::unique_lock<std::mutex> lock(requestMutex);
+    int now = ++sending;
+    int most = mostSending.load();
+    while (now > most && !mostSending.compare_exchange_weak(most,now)) {
+      ;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // network latency
+    --sending;
+    return mlclient::utilities::AutoBatchingConnection::search(desc);
+  }
+private:
+  std::mutex requestMutex;
+  std::atomic<int>& sending;
+  std::atomic<int>& mostSending;
+};
+
+} // end anonymous namespace
+
+void SearchResultSetTest::testParallelPages() {
+  TIMED_FUNC(testParallelPages);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testParallelPages";
+
+  SearchDescription* desc = zooSearch(2);
+
+  SearchResultSet* results = new SearchResultSet(ml,desc);
+  results->setParallelPages(4);
+  CPPUNIT_ASSERT_MESSAGE("Parallel pages not set",4 == results->getParallelPages());
+
+  bool res = results->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+
+  long count = 0;
+  long expectedIndex = 1;
+  bool inOrder = true;
+  SearchResultSetIterator* iter = results->begin();
+  SearchResultSetIterator* end = results->end();
+  for (;(*iter) != (*end);++(*iter)) {
+    SearchResult result(iter->first());
+    inOrder = inOrder && (expectedIndex == result.getIndex());
+    ++expectedIndex;
+    ++count;
+  }
+  LOG(DEBUG) << "Iterated " << count << " of " << results->getTotal() << " results";
+
+  CPPUNIT_ASSERT_MESSAGE("Not every result was iterated",results->getTotal() == count);
+  CPPUNIT_ASSERT_MESSAGE("Parallel pages were not slotted in to position",inOrder);
+  const long pageCount = results->getPageCount();
+
+  delete results;
+
+  // one connection sends the page requests one at a time
+  std::atomic<int> sending(0);
+  std::atomic<int> mostSending(0);
+  SerializingConnection shared(ml,sending,mostSending);
+  SearchDescription* sharedDesc = zooSearch(2);
+  results = new SearchResultSet(&shared,sharedDesc);
+  results->setParallelPages(4);
+  res = results->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch on one connection did not succeed", res);
+  count = 0;
+  for (SearchResultSetIterator* it = results->begin();(*it) != (*results->end());++(*it)) {
+    ++count;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Not every result was iterated on one connection",results->getTotal() == count);
+  delete results;
+  CPPUNIT_ASSERT_MESSAGE("Page requests on one connection were sent at once",1 == mostSending.load());
+
+  // a connection per page request sends them at once
+  mostSending = 0;
+  SerializingConnection first(ml,sending,mostSending);
+  SerializingConnection second(ml,sending,mostSending);
+  SerializingConnection third(ml,sending,mostSending);
+  SerializingConnection fourth(ml,sending,mostSending);
+  std::vector<IConnection*> fetchConnections{&first,&second,&third,&fourth};
+  SearchDescription* pooledDesc = zooSearch(2);
+  results = new SearchResultSet(ml,pooledDesc);
+  results->setParallelPages(4);
+  results->setFetchConnections(fetchConnections);
+  res = results->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch on fetch connections did not succeed", res);
+  count = 0;
+  expectedIndex = 1;
+  inOrder = true;
+  for (SearchResultSetIterator* it = results->begin();(*it) != (*results->end());++(*it)) {
+    SearchResult result(it->first());
+    inOrder = inOrder && (expectedIndex == result.getIndex());
+    ++expectedIndex;
+    ++count;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Not every result was iterated on fetch connections",results->getTotal() == count);
+  CPPUNIT_ASSERT_MESSAGE("Pages on fetch connections were not slotted in to position",inOrder);
+  delete results;
+  LOG(DEBUG) << "Most page requests sent at once on fetch connections: " << mostSending.load();
+  // the first page is always requested alone, so only later pages can overlap
+  CPPUNIT_ASSERT_MESSAGE("Page requests on separate connections were not sent at once",
+      pageCount < 3 || 1 < mostSending.load());
+}
+
+void SearchResultSetTest::testLazyResults() {
+  TIMED_FUNC(testLazyResults);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testLazyResults";
+
+  SearchDescription* desc = zooSearch(5);
+
+  SearchResultSet* results = new SearchResultSet(ml,desc);
+  bool res = results->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+
+  // nothing is decoded until a getter is called
+  const SearchResult& untouched(results->begin()->first());
+  CPPUNIT_ASSERT_MESSAGE("Metadata was decoded before it was read",!untouched.isMetadataDecoded());
+  CPPUNIT_ASSERT_MESSAGE("Content was decoded before it was read",!untouched.isContentDecoded());
+
+  // only URIs are read, so no result's content is decoded
+  long count = 0;
+  long contentDecoded = 0;
+  std::string blankString("");
+  SearchResultSetIterator* iter = results->begin();
+  SearchResultSetIterator* end = results->end();
+  for (;(*iter) != (*end);++(*iter)) {
+    const SearchResult& result(iter->first());
+    CPPUNIT_ASSERT_MESSAGE("Result does not have a URI",0!=blankString.compare(result.getUri()));
+    CPPUNIT_ASSERT_MESSAGE("Reading the URI did not decode the metadata",result.isMetadataDecoded());
+    if (result.isContentDecoded()) {
+      ++contentDecoded;
+    }
+    ++count;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Not every result was iterated",results->getTotal() == count);
+  CPPUNIT_ASSERT_MESSAGE("Content was decoded for a URI only iteration",0 == contentDecoded);
+
+  // the content is decoded on first access only
+  const SearchResult& read(results->begin()->first());
+  read.getDetailContent();
+  CPPUNIT_ASSERT_MESSAGE("Reading the content did not decode it",read.isContentDecoded());
+
+  // a copy has its own decoded state, so releasing its content leaves the original's
+  std::shared_ptr<IDocumentNode> readContent(read.getDetailContent());
+  SearchResult released(read);
+  released.releaseContent();
+  CPPUNIT_ASSERT_MESSAGE("Releasing a copy's content released the original's",
+      nullptr == released.getDetailContent().get() && readContent == read.getDetailContent());
+  CPPUNIT_ASSERT_MESSAGE("Releasing a copy's content lost its URI",released.getUri() == read.getUri());
+
+  // a copy shares the page's response, so keeps its metadata and content once the result set is freed
+  SearchResult copy(results->begin()->first());
+  std::string uri(copy.getUri());
+  SearchResult::Detail detail(read.getDetail());
+  bool hasContent(nullptr != readContent.get());
+  delete results;
+  CPPUNIT_ASSERT_MESSAGE("Copied result lost its URI",0!=blankString.compare(uri) && uri == copy.getUri());
+  CPPUNIT_ASSERT_MESSAGE("Copied result decoded different content",detail == copy.getDetail() &&
+      hasContent == (nullptr != copy.getDetailContent().get()));
+
+  // moving never allocates, and leaves the moved from result empty
+  SearchResult moved(std::move(copy));
+  CPPUNIT_ASSERT_MESSAGE("Moved result lost its URI",uri == moved.getUri());
+  CPPUNIT_ASSERT_MESSAGE("Moved from result was not left empty",copy.getUri().empty());
+  CPPUNIT_ASSERT_MESSAGE("SearchResult moves may throw",std::is_nothrow_move_constructible<SearchResult>::value &&
+      std::is_nothrow_move_assignable<SearchResult>::value);
+}
+
+void SearchResultSetTest::testRangeFor() {
+  TIMED_FUNC(testRangeFor);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testRangeFor";
+
+  SearchDescription* desc = zooSearch(5);
+
+  SearchResultSet* results = new SearchResultSet(ml,desc);
+  bool res = results->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+
+  long count = 0;
+  std::string blankString("");
+  for (const SearchResult& result : results->items()) {
+    CPPUNIT_ASSERT_MESSAGE("Result does not have a URI",0!=blankString.compare(result.getUri()));
+    ++count;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Not every result was visited by range for",results->getTotal() == count);
+
+  // references are to the results held by the set, not copies
+  SearchResultSet::const_iterator iter = results->cbegin();
+  CPPUNIT_ASSERT_MESSAGE("Dereference did not return the held result",&(*iter) == &(results->begin()->first()));
+  CPPUNIT_ASSERT_MESSAGE("Member access did not match dereference",iter->getUri() == (*iter).getUri());
+
+  // post increment returns the previous position
+  SearchResultSet::const_iterator previous = iter++;
+  CPPUNIT_ASSERT_MESSAGE("Post increment did not return the previous position",previous == results->cbegin());
+  CPPUNIT_ASSERT_MESSAGE("Post increment did not advance",results->getTotal() < 2 || iter != previous);
+
+  delete results;
+}
+
+namespace {
+
+class UriCollector : public ISearchResultVisitor {
+public:
+  UriCollector() : uris() {
+    ;
+  }
+  void onResult(const std::string& uri,const long score,const IDocumentNode* content) override {
+    uris.push_back(uri);
+  }
+  std::vector<std::string> uris;
+};
+
+} // end anonymous namespace
+
+void SearchResultSetTest::testVisitor() {
+  TIMED_FUNC(testVisitor);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testVisitor";
+
+  SearchDescription* desc = zooSearch(5);
+  SearchResultSet* results = new SearchResultSet(ml,desc);
+  results->setPrefetchPages(2);
+  UriCollector collector;
+  bool res = results->visit(collector);
+  CPPUNIT_ASSERT_MESSAGE("Visit operation did not succeed", res);
+  delete results;
+
+  // the same results, pulled, for comparison
+  SearchDescription* pullDesc = zooSearch(5);
+  SearchResultSet* pulled = new SearchResultSet(ml,pullDesc);
+  res = pulled->fetch();
+  CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+  std::vector<std::string> expected;
+  for (const SearchResult& result : pulled->items()) {
+    expected.push_back(result.getUri());
+  }
+  delete pulled;
+
+  CPPUNIT_ASSERT_MESSAGE("Not every result was visited",expected.size() == collector.uris.size());
+  CPPUNIT_ASSERT_MESSAGE("Results were not visited in order",expected == collector.uris);
+}
+
+void SearchResultSetTest::testPipeline() {
+  TIMED_FUNC(testPipeline);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testPipeline";
+
+  // the same results with no backlog (request only once a page is taken) and with a deep one
+  std::vector<std::string> uris[2];
+  const int backlogs[2] = {0,3};
+  for (int i = 0;i < 2;i++) {
+    SearchDescription* desc = zooSearch(5);
+    SearchResultSet* results = new SearchResultSet(ml,desc);
+    results->setPrefetchPages(2);
+    results->setParseBacklog(backlogs[i]);
+    CPPUNIT_ASSERT_MESSAGE("Parse backlog was not set",backlogs[i] == results->getParseBacklog());
+    bool res = results->fetch();
+    CPPUNIT_ASSERT_MESSAGE("Fetch operation did not succeed", res);
+    for (const SearchResult& result : results->items()) {
+      uris[i].push_back(result.getUri());
+    }
+    CPPUNIT_ASSERT_MESSAGE("Not every result was iterated",results->getTotal() == (long)uris[i].size());
+
+    PipelineTimings timings = results->getPipelineTimings();
+    LOG(DEBUG) << "Pipeline pages: " << timings.pages << ", network ms: " << timings.networkMillis << ", parse ms: " << timings.parseMillis << ", wait ms: " << timings.waitMillis;
+    CPPUNIT_ASSERT_MESSAGE("Every page was not timed",results->getPageCount() == timings.pages);
+    CPPUNIT_ASSERT_MESSAGE("Network stage was not timed",timings.networkMillis > 0);
+    CPPUNIT_ASSERT_MESSAGE("Parse stage was not timed",timings.parseMillis > 0);
+    delete results;
+  }
+  CPPUNIT_ASSERT_MESSAGE("Parse backlog changed the results",uris[0] == uris[1]);
+}
+
+void SearchResultSetTest::testStreamingParse() {
+  TIMED_FUNC(testStreamingParse);
+  LOG(DEBUG) << " --------------------------------------------";
+  LOG(DEBUG) << " Entering SearchResultSetTest::testStreamingParse";
+
+  // the same results, with each page visited once received and whilst being received
+  std::vector<std::string> uris[2];
+  long totals[2] = {0,0};
+  for (int i = 0;i < 2;i++) {
+    SearchDescription* desc = zooSearch(5);
+    SearchResultSet* results = new SearchResultSet(ml,desc);
+    results->setStreamingParse(1 == i);
+    CPPUNIT_ASSERT_MESSAGE("Streaming parse was not set",(1 == i) == results->isStreamingParse());
+    UriCollector collector;
+    bool res = results->visit(collector);
+    CPPUNIT_ASSERT_MESSAGE("Visit operation did not succeed", res);
+    uris[i] = collector.uris;
+    totals[i] = results->getTotal();
+    delete results;
+  }
+
+  CPPUNIT_ASSERT_MESSAGE("Streaming parse should report the same total",totals[0] == totals[1]);
+  CPPUNIT_ASSERT_MESSAGE("Not every result was visited",uris[0].size() == uris[1].size());
+  CPPUNIT_ASSERT_MESSAGE("Results were not visited in order",uris[0] == uris[1]);
+}
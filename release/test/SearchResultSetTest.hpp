@@ -28,6 +28,16 @@ class SearchResultSetTest : public CppUnit::TestCase {
     CPPUNIT_TEST(testThreePages);
     CPPUNIT_TEST(testCustomSnippetXml);
     CPPUNIT_TEST(testCustomSnippetJson);
+    CPPUNIT_TEST(testPrefetchPages);
+    CPPUNIT_TEST(testStreaming);
+    CPPUNIT_TEST(testPointInTime);
+    CPPUNIT_TEST(testSearchAfter);
+    CPPUNIT_TEST(testParallelPages);
+    CPPUNIT_TEST(testLazyResults);
+    CPPUNIT_TEST(testRangeFor);
+    CPPUNIT_TEST(testVisitor);
+    CPPUNIT_TEST(testPipeline);
+    CPPUNIT_TEST(testStreamingParse);
   CPPUNIT_TEST_SUITE_END();
 public:
   void setUp();
@@ -38,7 +48,19 @@ public:
   void testThreePages(void);
   void testCustomSnippetXml(void);
   void testCustomSnippetJson(void);
+  void testPrefetchPages(void);
+  void testStreaming(void);
+  void testPointInTime(void);
+  void testSearchAfter(void);
+  void testParallelPages(void);
+  void testLazyResults(void);
+  void testRangeFor(void);
+  void testVisitor(void);
+  void testPipeline(void);
+  void testStreamingParse(void);
 private:
+  SearchDescription* zooSearch(long pageLength);
+
   IConnection* ml;
 };
 